@@ -7,6 +7,7 @@
 #include "Stream.h"
 #include "Errors.h"
 #include "Utils.h"
+#include "Funcs.h"
 
 BitmapCol BitmapCol_Scale(BitmapCol value, float t) {
 	value.R = (uint8_t)(value.R * t);
@@ -57,6 +58,7 @@ enum PngFilter {
 };
 
 typedef void (*Png_RowExpander)(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst);
+typedef void (*Png_RowReconstructor)(uint8_t type, uint8_t bytesPerPixel, uint8_t* line, uint8_t* prior, uint32_t lineLen);
 static uint8_t png_sig[PNG_SIG_SIZE] = { 137, 80, 78, 71, 13, 10, 26, 10 };
 
 bool Png_Detect(const uint8_t* data, uint32_t len) {
@@ -300,6 +302,369 @@ static Png_RowExpander Png_GetExpander(uint8_t col, uint8_t bitsPerSample) {
 	return NULL;
 }
 
+/* SIMD versions of Png_Reconstruct and the 8 bits per sample row expanders */
+/* x86 uses SSE2 (and SSSE3 when the CPU supports it at runtime), ARM uses NEON */
+/* NOTE: Sub, Average and Paeth filters are only vectorised for 3 and 4 bytes per pixel */
+/* NOTE: Webclient is excluded since BitmapCol is stored as RGBA there */
+#if defined CC_BUILD_WEB
+#elif (defined __GNUC__ && defined __SSE2__) || (defined _MSC_VER && (defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)))
+#define PNG_SIMD_SSE2
+#elif defined __GNUC__ && (defined __ARM_NEON || defined __ARM_NEON__) && !defined __ARM_BIG_ENDIAN
+#define PNG_SIMD_NEON
+#endif
+
+#if defined _MSC_VER && defined PNG_SIMD_SSE2
+/* Windows is always little endian, and unaligned accesses are fine */
+#define Png_Load32(p) (*(const uint32_t*)(p))
+#define Png_Store32(p, value) *((uint32_t*)(p)) = value
+#elif defined PNG_SIMD_SSE2 || defined PNG_SIMD_NEON
+static CC_INLINE uint32_t Png_Load32(const uint8_t* p) {
+	uint32_t value; __builtin_memcpy(&value, p, 4); return value;
+}
+static CC_INLINE void Png_Store32(uint8_t* p, uint32_t value) {
+	__builtin_memcpy(p, &value, 4);
+}
+#endif
+
+/* A 3 byte pixel is loaded/stored as the 4 bytes ending at the pixel, to avoid reading past the end of the row. */
+/* This is always valid memory, since the byte before the first pixel is the filter byte of the scanline. */
+#define Png_LoadPixel(p, bpp) ((bpp) == 4 ? Png_Load32(p) : Png_Load32((p) - 1) >> 8)
+#define Png_StorePixel(p, value, bpp) if ((bpp) == 4) { Png_Store32(p, value); } else { Png_Store32((p) - 1, ((value) << 8) | (p)[-1]); }
+
+#if defined PNG_SIMD_SSE2
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#define PNG_TARGET_SSSE3
+#else
+#define PNG_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+
+static bool png_checkedSSSE3, png_hasSSSE3;
+static bool Png_HasSSSE3(void) {
+	if (png_checkedSSSE3) return png_hasSSSE3;
+#if defined _MSC_VER
+	{
+		int info[4];
+		__cpuid(info, 1);
+		png_hasSSSE3 = (info[2] & (1 << 9)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	png_hasSSSE3 = __builtin_cpu_supports("ssse3") != 0;
+#endif
+	png_checkedSSSE3 = true;
+	return png_hasSSSE3;
+}
+
+#define Png_LoadVec(p, bpp) _mm_cvtsi32_si128((int)Png_LoadPixel(p, bpp))
+#define Png_VecValue(vec) (uint32_t)_mm_cvtsi128_si32(vec)
+
+static void Png_Up_SIMD(uint8_t* line, const uint8_t* prior, uint32_t lineLen) {
+	__m128i a, b;
+	uint32_t i;
+
+	for (i = 0; i + 16 <= lineLen; i += 16) {
+		a = _mm_loadu_si128((const __m128i*)&line[i]);
+		b = _mm_loadu_si128((const __m128i*)&prior[i]);
+		_mm_storeu_si128((__m128i*)&line[i], _mm_add_epi8(a, b));
+	}
+	for (; i < lineLen; i++) { line[i] += prior[i]; }
+}
+
+static void Png_Sub_SIMD(uint8_t bpp, uint8_t* line, uint32_t lineLen) {
+	__m128i x, last = _mm_setzero_si128();
+	uint32_t i = 0, value;
+
+	/* Prefix sum of 4 pixels at once, with the last pixel of the prior 4 added in first */
+	if (bpp == 4) {
+		for (; i + 16 <= lineLen; i += 16) {
+			x = _mm_loadu_si128((const __m128i*)&line[i]);
+			x = _mm_add_epi8(x, last);
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+			_mm_storeu_si128((__m128i*)&line[i], x);
+			last = _mm_srli_si128(x, 12);
+		}
+	}
+
+	for (; i < lineLen; i += bpp) {
+		last  = _mm_add_epi8(Png_LoadVec(&line[i], bpp), last);
+		value = Png_VecValue(last);
+		Png_StorePixel(&line[i], value, bpp);
+	}
+}
+
+static void Png_Average_SIMD(uint8_t bpp, uint8_t* line, const uint8_t* prior, uint32_t lineLen) {
+	__m128i a = _mm_setzero_si128(), b, avg;
+	__m128i one = _mm_set1_epi8(1);
+	uint32_t i, value;
+
+	for (i = 0; i < lineLen; i += bpp) {
+		b = Png_LoadVec(&prior[i], bpp);
+		/* _mm_avg_epu8 rounds up, but PNG needs (a + b) >> 1 which rounds down */
+		avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+		a   = _mm_add_epi8(Png_LoadVec(&line[i], bpp), avg);
+
+		value = Png_VecValue(a);
+		Png_StorePixel(&line[i], value, bpp);
+	}
+}
+
+#define Png_Abs16(x) _mm_max_epi16(x, _mm_sub_epi16(zero, x))
+#define Png_Select(mask, t, f) _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, f))
+
+static void Png_Paeth_SIMD(uint8_t bpp, uint8_t* line, const uint8_t* prior, uint32_t lineLen) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i a = zero, c = zero, b, x;
+	__m128i pa, pb, pc, mask, pred;
+	uint32_t i, value;
+
+	for (i = 0; i < lineLen; i += bpp) {
+		/* Work in 16 bits, since a + b - c can be out of range of a byte */
+		b  = _mm_unpacklo_epi8(Png_LoadVec(&prior[i], bpp), zero);
+		pa = _mm_sub_epi16(b, c); /* p - a */
+		pb = _mm_sub_epi16(a, c); /* p - b */
+		pc = _mm_add_epi16(pa, pb); /* p - c */
+		pa = Png_Abs16(pa); pb = Png_Abs16(pb); pc = Png_Abs16(pc);
+
+		/* b if pb <= pc, otherwise c. Then a if pa <= pb and pa <= pc */
+		mask = _mm_cmpgt_epi16(pb, pc);
+		pred = Png_Select(mask, c, b);
+		mask = _mm_cmpgt_epi16(pa, _mm_min_epi16(pb, pc));
+		pred = Png_Select(mask, pred, a);
+
+		x = _mm_add_epi8(Png_LoadVec(&line[i], bpp), _mm_packus_epi16(pred, pred));
+		value = Png_VecValue(x);
+		Png_StorePixel(&line[i], value, bpp);
+
+		a = _mm_unpacklo_epi8(x, zero);
+		c = b;
+	}
+}
+
+static void Png_Expand_GRAYSCALE_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	__m128i alpha = _mm_set1_epi8(-1);
+	__m128i g, gg, ga;
+	int i; uint8_t rgb;
+
+	for (i = 0; i < (width & ~0xF); i += 16) {
+		g  = _mm_loadu_si128((const __m128i*)&src[i]);
+		gg = _mm_unpacklo_epi8(g, g);
+		ga = _mm_unpacklo_epi8(g, alpha);
+		_mm_storeu_si128((__m128i*)&dst[i],      _mm_unpacklo_epi16(gg, ga));
+		_mm_storeu_si128((__m128i*)&dst[i + 4],  _mm_unpackhi_epi16(gg, ga));
+
+		gg = _mm_unpackhi_epi8(g, g);
+		ga = _mm_unpackhi_epi8(g, alpha);
+		_mm_storeu_si128((__m128i*)&dst[i + 8],  _mm_unpacklo_epi16(gg, ga));
+		_mm_storeu_si128((__m128i*)&dst[i + 12], _mm_unpackhi_epi16(gg, ga));
+	}
+	for (; i < width; i++) { PNG_Do_Grayscale_8(i, i); }
+}
+
+static void Png_Expand_GRAYSCALE_A_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	__m128i grayMask = _mm_set1_epi16(0x00FF);
+	__m128i x, gg;
+	int i, j; uint8_t rgb;
+
+	for (i = 0, j = 0; i < (width & ~0x7); i += 8, j += 16) {
+		x  = _mm_loadu_si128((const __m128i*)&src[j]);
+		gg = _mm_and_si128(x, grayMask);
+		gg = _mm_or_si128(gg, _mm_slli_epi16(gg, 8));
+		_mm_storeu_si128((__m128i*)&dst[i],     _mm_unpacklo_epi16(gg, x));
+		_mm_storeu_si128((__m128i*)&dst[i + 4], _mm_unpackhi_epi16(gg, x));
+	}
+	for (; i < width; i++, j += 2) { PNG_Do_Grayscale_A__8(i, j); }
+}
+
+static PNG_TARGET_SSSE3 void Png_Expand_RGB_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	__m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	__m128i alpha   = _mm_set1_epi32((int)0xFF000000UL);
+	__m128i x;
+	int i, j, srcLen = width * 3;
+
+	/* Loads 16 bytes but only uses 12, so the last few pixels are done one at a time */
+	for (i = 0, j = 0; j + 16 <= srcLen; i += 4, j += 12) {
+		x = _mm_loadu_si128((const __m128i*)&src[j]);
+		x = _mm_or_si128(_mm_shuffle_epi8(x, shuffle), alpha);
+		_mm_storeu_si128((__m128i*)&dst[i], x);
+	}
+	for (; i < width; i++, j += 3) { PNG_Do_RGB__8(i, j); }
+}
+
+static void Png_Expand_RGB_A_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	__m128i gaMask = _mm_set1_epi32((int)0xFF00FF00UL);
+	__m128i rbMask = _mm_set1_epi32(0x00FF00FF);
+	__m128i x, rb;
+	int i, j;
+
+	for (i = 0, j = 0; i < (width & ~0x3); i += 4, j += 16) {
+		x  = _mm_loadu_si128((const __m128i*)&src[j]);
+		/* Swap R and B by swapping the two 16 bit halves of each pixel */
+		rb = _mm_and_si128(x, rbMask);
+		rb = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		x  = _mm_or_si128(_mm_and_si128(x, gaMask), rb);
+		_mm_storeu_si128((__m128i*)&dst[i], x);
+	}
+	for (; i < width; i++, j += 4) { PNG_Do_RGB_A__8(i, j); }
+}
+#define Png_HasRGBExpander() Png_HasSSSE3()
+
+#elif defined PNG_SIMD_NEON
+#include <arm_neon.h>
+#define Png_LoadVec(p, bpp) vreinterpret_u8_u32(vdup_n_u32(Png_LoadPixel(p, bpp)))
+#define Png_VecValue(vec) vget_lane_u32(vreinterpret_u32_u8(vec), 0)
+
+static void Png_Up_SIMD(uint8_t* line, const uint8_t* prior, uint32_t lineLen) {
+	uint32_t i;
+
+	for (i = 0; i + 16 <= lineLen; i += 16) {
+		vst1q_u8(&line[i], vaddq_u8(vld1q_u8(&line[i]), vld1q_u8(&prior[i])));
+	}
+	for (; i < lineLen; i++) { line[i] += prior[i]; }
+}
+
+static void Png_Sub_SIMD(uint8_t bpp, uint8_t* line, uint32_t lineLen) {
+	uint8x8_t last = vdup_n_u8(0);
+	uint32_t i, value;
+
+	for (i = 0; i < lineLen; i += bpp) {
+		last  = vadd_u8(Png_LoadVec(&line[i], bpp), last);
+		value = Png_VecValue(last);
+		Png_StorePixel(&line[i], value, bpp);
+	}
+}
+
+static void Png_Average_SIMD(uint8_t bpp, uint8_t* line, const uint8_t* prior, uint32_t lineLen) {
+	uint8x8_t a = vdup_n_u8(0), b;
+	uint32_t i, value;
+
+	for (i = 0; i < lineLen; i += bpp) {
+		b = Png_LoadVec(&prior[i], bpp);
+		/* vhadd_u8 computes (a + b) >> 1 without overflowing */
+		a = vadd_u8(Png_LoadVec(&line[i], bpp), vhadd_u8(a, b));
+
+		value = Png_VecValue(a);
+		Png_StorePixel(&line[i], value, bpp);
+	}
+}
+
+static void Png_Paeth_SIMD(uint8_t bpp, uint8_t* line, const uint8_t* prior, uint32_t lineLen) {
+	uint8x8_t a = vdup_n_u8(0), c = a, b, pred;
+	uint16x8_t pa, pb, pc, useA, useB;
+	uint32_t i, value;
+
+	for (i = 0; i < lineLen; i += bpp) {
+		b  = Png_LoadVec(&prior[i], bpp);
+		pa = vabdl_u8(b, c);
+		pb = vabdl_u8(a, c);
+		pc = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+
+		/* b if pb <= pc, otherwise c. Then a if pa <= pb and pa <= pc */
+		useA = vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc));
+		useB = vcleq_u16(pb, pc);
+		pred = vbsl_u8(vmovn_u16(useB), b, c);
+		pred = vbsl_u8(vmovn_u16(useA), a, pred);
+
+		a = vadd_u8(Png_LoadVec(&line[i], bpp), pred);
+		value = Png_VecValue(a);
+		Png_StorePixel(&line[i], value, bpp);
+		c = b;
+	}
+}
+
+static void Png_Expand_GRAYSCALE_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	uint8x16x4_t pixels;
+	int i; uint8_t rgb;
+	pixels.val[3] = vdupq_n_u8(255);
+
+	for (i = 0; i < (width & ~0xF); i += 16) {
+		pixels.val[0] = vld1q_u8(&src[i]);
+		pixels.val[1] = pixels.val[0]; pixels.val[2] = pixels.val[0];
+		vst4q_u8((uint8_t*)&dst[i], pixels);
+	}
+	for (; i < width; i++) { PNG_Do_Grayscale_8(i, i); }
+}
+
+static void Png_Expand_GRAYSCALE_A_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	uint8x16x2_t ga;
+	uint8x16x4_t pixels;
+	int i, j; uint8_t rgb;
+
+	for (i = 0, j = 0; i < (width & ~0xF); i += 16, j += 32) {
+		ga = vld2q_u8(&src[j]);
+		pixels.val[0] = ga.val[0]; pixels.val[1] = ga.val[0];
+		pixels.val[2] = ga.val[0]; pixels.val[3] = ga.val[1];
+		vst4q_u8((uint8_t*)&dst[i], pixels);
+	}
+	for (; i < width; i++, j += 2) { PNG_Do_Grayscale_A__8(i, j); }
+}
+
+static void Png_Expand_RGB_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	uint8x16x3_t planes;
+	uint8x16x4_t pixels;
+	int i, j;
+	pixels.val[3] = vdupq_n_u8(255);
+
+	for (i = 0, j = 0; i < (width & ~0xF); i += 16, j += 48) {
+		planes = vld3q_u8(&src[j]);
+		pixels.val[0] = planes.val[2]; pixels.val[1] = planes.val[1]; pixels.val[2] = planes.val[0];
+		vst4q_u8((uint8_t*)&dst[i], pixels);
+	}
+	for (; i < width; i++, j += 3) { PNG_Do_RGB__8(i, j); }
+}
+
+static void Png_Expand_RGB_A_8_SIMD(int width, BitmapCol* palette, uint8_t* src, BitmapCol* dst) {
+	uint8x16x4_t pixels;
+	uint8x16_t tmp;
+	int i, j;
+
+	for (i = 0, j = 0; i < (width & ~0xF); i += 16, j += 64) {
+		pixels = vld4q_u8(&src[j]);
+		tmp = pixels.val[0]; pixels.val[0] = pixels.val[2]; pixels.val[2] = tmp;
+		vst4q_u8((uint8_t*)&dst[i], pixels);
+	}
+	for (; i < width; i++, j += 4) { PNG_Do_RGB_A__8(i, j); }
+}
+#define Png_HasRGBExpander() true
+#endif
+
+#if defined PNG_SIMD_SSE2 || defined PNG_SIMD_NEON
+static void Png_ReconstructSIMD(uint8_t type, uint8_t bytesPerPixel, uint8_t* line, uint8_t* prior, uint32_t lineLen) {
+	if (type == PNG_FILTER_UP) { Png_Up_SIMD(line, prior, lineLen); return; }
+	if (bytesPerPixel != 3 && bytesPerPixel != 4) { Png_Reconstruct(type, bytesPerPixel, line, prior, lineLen); return; }
+
+	switch (type) {
+	case PNG_FILTER_SUB:
+		Png_Sub_SIMD(bytesPerPixel, line, lineLen); return;
+	case PNG_FILTER_AVERAGE:
+		Png_Average_SIMD(bytesPerPixel, line, prior, lineLen); return;
+	case PNG_FILTER_PAETH:
+		Png_Paeth_SIMD(bytesPerPixel, line, prior, lineLen); return;
+	}
+	Png_Reconstruct(type, bytesPerPixel, line, prior, lineLen);
+}
+
+static Png_RowExpander Png_GetSIMDExpander(uint8_t col, uint8_t bitsPerSample, Png_RowExpander fallback) {
+	if (bitsPerSample != 8) return fallback;
+
+	switch (col) {
+	case PNG_COL_GRAYSCALE:   return Png_Expand_GRAYSCALE_8_SIMD;
+	case PNG_COL_GRAYSCALE_A: return Png_Expand_GRAYSCALE_A_8_SIMD;
+	case PNG_COL_RGB_A:       return Png_Expand_RGB_A_8_SIMD;
+	case PNG_COL_RGB:
+		return Png_HasRGBExpander() ? Png_Expand_RGB_8_SIMD : fallback;
+	}
+	return fallback;
+}
+#else
+#define Png_ReconstructSIMD Png_Reconstruct
+#define Png_GetSIMDExpander(col, bitsPerSample, fallback) fallback
+#endif
+
+
 static void Png_ComputeTransparency(Bitmap* bmp, BitmapCol col) {
 	uint32_t trnsRGB = col.B | (col.G << 8) | (col.R << 16); /* TODO: Remove this!! */
 	int x, y, width = bmp->Width, height = bmp->Height;
@@ -318,7 +683,8 @@ static void Png_ComputeTransparency(Bitmap* bmp, BitmapCol col) {
 #define PNG_BUFFER_SIZE ((PNG_MAX_DIMS * 2 * 4 + 1) * 2)
 
 /* TODO: Test a lot of .png files and ensure output is right */
-ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream) {
+/* simd is whether to use the SIMD filters and row expanders, or only the scalar ones (see Png_Benchmark) */
+static ReturnCode Png_DecodeCore(Bitmap* bmp, struct Stream* stream, bool simd) {
 	uint8_t tmp[PNG_PALETTE * 3];
 	uint32_t dataSize, fourCC;
 	ReturnCode res;
@@ -327,6 +693,7 @@ ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream) {
 	static uint32_t samplesPerPixel[7] = { 1, 0, 3, 1, 2, 0, 4 };
 	uint8_t col, bitsPerSample, bytesPerPixel;
 	Png_RowExpander rowExpander;
+	Png_RowReconstructor reconstruct = Png_Reconstruct;
 	uint32_t scanlineSize, scanlineBytes;
 
 	/* palette data */
@@ -381,6 +748,11 @@ ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream) {
 			rowExpander = Png_GetExpander(col, bitsPerSample);
 			if (rowExpander == NULL) return PNG_ERR_INVALID_COL_BPP;
 
+			if (simd) {
+				reconstruct = Png_ReconstructSIMD;
+				rowExpander = Png_GetSIMDExpander(col, bitsPerSample, rowExpander);
+			}
+
 			if (tmp[10] != 0) return PNG_ERR_COMP_METHOD;
 			if (tmp[11] != 0) return PNG_ERR_FILTER;
 			if (tmp[12] != 0) return PNG_ERR_INTERLACED;
@@ -480,7 +852,7 @@ ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream) {
 					uint8_t* prior    = &buffer[(priorY - 1) * scanlineBytes];
 					uint8_t* scanline = &buffer[rowY         * scanlineBytes];
 
-					Png_Reconstruct(scanline[0], bytesPerPixel, &scanline[1], &prior[1], scanlineSize);
+					reconstruct(scanline[0], bytesPerPixel, &scanline[1], &prior[1], scanlineSize);
 					rowExpander(bmp->Width, palette, &scanline[1], Bitmap_GetRow(bmp, curY));
 				}
 			}
@@ -501,6 +873,115 @@ ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream) {
 	}
 }
 
+ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream) {
+	return Png_DecodeCore(bmp, stream, true);
+}
+
+static ReturnCode Png_TimeDecode(Bitmap* bmp, const uint8_t* data, uint32_t size, bool simd, uint64_t* elapsed) {
+	struct Stream stream;
+	uint64_t beg, end;
+	ReturnCode res = 0;
+	int i;
+
+	bmp->Scan0 = NULL;
+	beg = Stopwatch_Measure();
+	for (i = 0; i < PNG_BENCH_ITERATIONS && !res; i++) {
+		Mem_Free(bmp->Scan0);
+		Stream_ReadonlyMemory(&stream, (void*)data, size);
+		res = Png_DecodeCore(bmp, &stream, simd);
+	}
+	end = Stopwatch_Measure();
+
+	*elapsed += Stopwatch_ElapsedMicroseconds(beg, end);
+	return res;
+}
+
+void Png_Benchmark(struct PngBenchmark* bench, const uint8_t* data, uint32_t size) {
+	Bitmap fast, scalar;
+	uint32_t i, len;
+	ReturnCode res;
+
+	fast.Scan0 = NULL;
+	res = Png_TimeDecode(&scalar, data, size, false, &bench->ScalarTime);
+	if (!res) res = Png_TimeDecode(&fast, data, size, true, &bench->FastTime);
+
+	if (res) {
+		bench->Failed++;
+	} else {
+		bench->Images++;
+		bench->Pixels += (uint64_t)fast.Width * fast.Height;
+		len = Bitmap_DataSize(fast.Width, fast.Height);
+
+		for (i = 0; i < len && fast.Scan0[i] == scalar.Scan0[i]; i++) { }
+		if (i != len) bench->Mismatched++;
+	}
+	Mem_Free(fast.Scan0);
+	Mem_Free(scalar.Scan0);
+}
+
+static bool Png_SelectBenchEntry(const String* path) {
+	String png = String_FromConst(".png");
+	return String_CaselessEnds(path, &png);
+}
+
+static ReturnCode Png_ProcessBenchEntry(const String* path, struct Stream* data, struct ZipState* state) {
+	struct PngBenchmark* bench = (struct PngBenchmark*)state->Obj;
+	uint32_t size = state->_curEntry->UncompressedSize;
+	uint8_t* png;
+	ReturnCode res;
+
+	png = (uint8_t*)Mem_Alloc(size, 1, "benchmark png");
+	res = Stream_Read(data, png, size);
+	if (!res) Png_Benchmark(bench, png, size);
+
+	Mem_Free(png);
+	return res;
+}
+
+ReturnCode Png_BenchmarkZip(struct PngBenchmark* bench, struct Stream* stream) {
+	struct ZipState state;
+	Zip_Init(&state, stream);
+	state.SelectEntry  = Png_SelectBenchEntry;
+	state.ProcessEntry = Png_ProcessBenchEntry;
+	state.Obj          = bench;
+	return Zip_Extract(&state);
+}
+
+void Png_PrintBenchmark(struct PngBenchmark* bench, void (*print)(const String* line)) {
+	int megapixels, fastMs, scalarMs, fastRate, scalarRate;
+	String line; char lineBuffer[STRING_SIZE * 2];
+
+	megapixels = (int)(bench->Pixels / 1000000);
+	fastMs     = (int)(bench->FastTime   / 1000);
+	scalarMs   = (int)(bench->ScalarTime / 1000);
+	/* pixels per microsecond is the same as megapixels per second */
+	fastRate   = (int)(bench->Pixels * PNG_BENCH_ITERATIONS / max(1, bench->FastTime));
+	scalarRate = (int)(bench->Pixels * PNG_BENCH_ITERATIONS / max(1, bench->ScalarTime));
+
+	String_InitArray(line, lineBuffer);
+	String_Format2(&line, "Decoded %i .png files (%i megapixels)", &bench->Images, &megapixels);
+	print(&line);
+
+	line.length = 0;
+	String_Format2(&line, "  SIMD filters and expanders: %i ms (%i megapixels/s)", &fastMs, &fastRate);
+	print(&line);
+
+	line.length = 0;
+	String_Format2(&line, "  scalar filters and expanders only: %i ms (%i megapixels/s)", &scalarMs, &scalarRate);
+	print(&line);
+
+	if (bench->Failed) {
+		line.length = 0;
+		String_Format1(&line, "  %i .png files failed to decode", &bench->Failed);
+		print(&line);
+	}
+	if (bench->Mismatched) {
+		line.length = 0;
+		String_Format1(&line, "  %i .png files decoded differently with SIMD code!", &bench->Mismatched);
+		print(&line);
+	}
+}
+
 
 /*########################################################################################################################*
 *------------------------------------------------------PNG encoder--------------------------------------------------------*
@@ -1,6 +1,6 @@
 #ifndef CC_BITMAP_H
 #define CC_BITMAP_H
-#include "Core.h"
+#include "String.h"
 /* Represents a 2D array of pixels.
    Copyright 2014-2017 ClassicalSharp | Licensed under BSD-3
 */
@@ -61,6 +61,22 @@ typedef int (*Png_RowSelector)(Bitmap* bmp, int row);
      https://github.com/nothings/stb/blob/master/stb_image.h
 */
 CC_API ReturnCode Png_Decode(Bitmap* bmp, struct Stream* stream);
+
+/* Number of times Png_Benchmark decodes each .png file */
+#define PNG_BENCH_ITERATIONS 8
+struct PngBenchmark {
+	int Images, Failed, Mismatched;
+	uint64_t Pixels;
+	uint64_t FastTime;   /* Microseconds spent decoding using the SIMD filters and row expanders */
+	uint64_t ScalarTime; /* Microseconds spent decoding using only the scalar filters and row expanders */
+};
+/* Decodes the given .png file several times, both with and without SIMD code, and adds the results to bench. */
+/* NOTE: bench must be zeroed before benchmarking the first file. */
+void Png_Benchmark(struct PngBenchmark* bench, const uint8_t* data, uint32_t size);
+/* Calls Png_Benchmark on every .png file in the given .zip file. (e.g. a texture pack) */
+ReturnCode Png_BenchmarkZip(struct PngBenchmark* bench, struct Stream* stream);
+/* Passes each line of a summary of the results in bench to print. */
+void Png_PrintBenchmark(struct PngBenchmark* bench, void (*print)(const String* line));
 /* Encodes a bitmap in PNG format. */
 /* selectRow is optional. Can be used to modify how rows are encoded. (e.g. flip image) */
 /* if alpha is non-zero, RGBA channels are saved, otherwise only RGB channels are. */
@@ -24,6 +24,17 @@ struct TickQueue {
 	int Tail;        /* Tail index into the buffer */
 };
 
+#ifdef CC_BUILD_SPARSEWORLD
+/* Physics handlers only exist for 8 bit blocks */
+static BlockRaw Physics_GetBlock(int index) {
+	int x, y, z;
+	World_Unpack(index, x, y, z);
+	return (BlockRaw)World_GetBlock(x, y, z);
+}
+#else
+#define Physics_GetBlock(index) World.Blocks[index]
+#endif
+
 static void TickQueue_Init(struct TickQueue* queue) {
 	queue->Entries     = NULL;
 	queue->EntriesSize = 0;
@@ -104,7 +115,7 @@ static void Physics_OnNewMapLoaded(void* obj) {
 	physics_maxWaterY = World.MaxY - 2;
 	physics_maxWaterZ = World.MaxZ - 2;
 
-	Tree_Blocks = World.Blocks;
+	Tree_Blocks = World.Blocks; /* NULL with CC_BUILD_SPARSEWORLD */
 	Random_SeedFromCurrentTime(&physics_rnd);
 	Tree_Rnd = &physics_rnd;
 }
@@ -115,7 +126,7 @@ void Physics_SetEnabled(bool enabled) {
 }
 
 static void Physics_Activate(int index) {
-	BlockID block = World.Blocks[index];
+	BlockID block = Physics_GetBlock(index);
 	PhysicsHandler activate = Physics.OnActivate[block];
 	if (activate) activate(index, block);
 }
@@ -176,17 +187,17 @@ static void Physics_TickRandomBlocks(void) {
 				hi = World_Pack(x2, y2, z2);
 				
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				tick = Physics.OnRandomTick[block];
 				if (tick) tick(index, block);
 
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				tick = Physics.OnRandomTick[block];
 				if (tick) tick(index, block);
 
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				tick = Physics.OnRandomTick[block];
 				if (tick) tick(index, block);
 			}
@@ -203,7 +214,7 @@ static void Physics_DoFalling(int index, BlockID block) {
 	/* Find lowest block can fall into */
 	while (index >= World.OneY) {
 		index -= World.OneY;
-		other  = World.Blocks[index];
+		other  = Physics_GetBlock(index);
 
 		if (other == BLOCK_AIR || (other >= BLOCK_WATER && other <= BLOCK_STILL_LAVA))
 			found = index;
@@ -243,7 +254,7 @@ static void Physics_HandleSapling(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 
 	below = BLOCK_AIR;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (below != BLOCK_GRASS) return;
 
 	height = 5 + Random_Next(&physics_rnd, 3);
@@ -290,7 +301,7 @@ static void Physics_HandleFlower(int index, BlockID block) {
 	}
 
 	below = BLOCK_DIRT;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (!(below == BLOCK_DIRT || below == BLOCK_GRASS)) {
 		Game_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
@@ -309,7 +320,7 @@ static void Physics_HandleMushroom(int index, BlockID block) {
 	}
 
 	below = BLOCK_STONE;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (!(below == BLOCK_STONE || below == BLOCK_COBBLE)) {
 		Game_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
@@ -322,7 +333,7 @@ static void Physics_PlaceLava(int index, BlockID block) {
 }
 
 static void Physics_PropagateLava(int posIndex, int x, int y, int z) {
-	BlockID block = World.Blocks[posIndex];
+	BlockID block = Physics_GetBlock(posIndex);
 	if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
 		Game_UpdateBlock(x, y, z, BLOCK_STONE);
 	} else if (Blocks.Collide[block] == COLLIDE_GAS) {
@@ -347,7 +358,7 @@ static void Physics_TickLava(void) {
 	for (i = 0; i < count; i++) {
 		int index;
 		if (Physics_CheckItem(&lavaQ, &index)) {
-			BlockID block = World.Blocks[index];
+			BlockID block = Physics_GetBlock(index);
 			if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
 			Physics_ActivateLava(index, block);
 		}
@@ -360,7 +371,7 @@ static void Physics_PlaceWater(int index, BlockID block) {
 }
 
 static void Physics_PropagateWater(int posIndex, int x, int y, int z) {
-	BlockID block = World.Blocks[posIndex];
+	BlockID block = Physics_GetBlock(posIndex);
 	int xx, yy, zz;
 
 	if (block == BLOCK_LAVA || block == BLOCK_STILL_LAVA) {
@@ -397,7 +408,7 @@ static void Physics_TickWater(void) {
 	for (i = 0; i < count; i++) {
 		int index;
 		if (Physics_CheckItem(&waterQ, &index)) {
-			BlockID block = World.Blocks[index];
+			BlockID block = Physics_GetBlock(index);
 			if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
 			Physics_ActivateWater(index, block);
 		}
@@ -409,6 +420,7 @@ static void Physics_PlaceSponge(int index, BlockID block) {
 	int x, y, z, xx, yy, zz;
 	World_Unpack(index, x, y, z);
 
+	Game_BeginBatch();
 	for (yy = y - 2; yy <= y + 2; yy++) {
 		for (zz = z - 2; zz <= z + 2; zz++) {
 			for (xx = x - 2; xx <= x + 2; xx++) {
@@ -421,6 +433,7 @@ static void Physics_PlaceSponge(int index, BlockID block) {
 			}
 		}
 	}
+	Game_EndBatch();
 }
 
 static void Physics_DeleteSponge(int index, BlockID block) {
@@ -434,7 +447,7 @@ static void Physics_DeleteSponge(int index, BlockID block) {
 					if (!World_Contains(xx, yy, zz)) continue;
 
 					index = World_Pack(xx, yy, zz);
-					block = World.Blocks[index];
+					block = Physics_GetBlock(index);
 					if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
 						TickQueue_Enqueue(&waterQ, index | PHYSICS_ONE_DELAY);
 					}
@@ -450,7 +463,7 @@ static void Physics_HandleSlab(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 	if (index < World.OneY) return;
 
-	if (World.Blocks[index - World.OneY] != BLOCK_SLAB) return;
+	if (Physics_GetBlock(index - World.OneY) != BLOCK_SLAB) return;
 	Game_UpdateBlock(x, y,     z, BLOCK_AIR);
 	Game_UpdateBlock(x, y - 1, z, BLOCK_DOUBLE_SLAB);
 }
@@ -460,7 +473,7 @@ static void Physics_HandleCobblestoneSlab(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 	if (index < World.OneY) return;
 
-	if (World.Blocks[index - World.OneY] != BLOCK_COBBLE_SLAB) return;
+	if (Physics_GetBlock(index - World.OneY) != BLOCK_COBBLE_SLAB) return;
 	Game_UpdateBlock(x, y,     z, BLOCK_AIR);
 	Game_UpdateBlock(x, y - 1, z, BLOCK_COBBLE);
 }
@@ -478,6 +491,7 @@ static void Physics_Explode(int x, int y, int z, int power) {
 	BlockID block;
 	int dx, dy, dz, xx, yy, zz;
 
+	Game_BeginBatch();
 	Game_UpdateBlock(x, y, z, BLOCK_AIR);
 	Physics_ActivateNeighbours(x, y, z, index);
 	
@@ -490,7 +504,7 @@ static void Physics_Explode(int x, int y, int z, int power) {
 				if (!World_Contains(xx, yy, zz)) continue;
 				index = World_Pack(xx, yy, zz);
 
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				if (block < BLOCK_CPE_COUNT && blocksTnt[block]) continue;
 
 				Game_UpdateBlock(xx, yy, zz, BLOCK_AIR);
@@ -498,6 +512,7 @@ static void Physics_Explode(int x, int y, int z, int power) {
 			}
 		}
 	}
+	Game_EndBatch();
 }
 
 static void Physics_HandleTnt(int index, BlockID block) {
@@ -554,12 +569,15 @@ void Physics_Free(void) {
 }
 
 void Physics_Tick(void) {
-	if (!Physics.Enabled || !World.Blocks) return;
+	if (!Physics.Enabled || !World.Loaded) return;
 
+	/* Blocks changed during the tick are applied together, so lighting and chunks are only updated once */
+	Game_BeginBatch();
 	/*if ((tickCount % 5) == 0) {*/
 	Physics_TickLava();
 	Physics_TickWater();
 	/*}*/
 	physics_tickCount++;
 	Physics_TickRandomBlocks();
+	Game_EndBatch();
 }
@@ -21,25 +21,8 @@ int Builder_SidesLevel, Builder_EdgeLevel;
 /* Packs an index into the 18x18x18 chunk array. Coordinates range from -1 to 16. */
 #define Builder_PackChunk(xx, yy, zz) (((yy) + 1) * EXTCHUNK_SIZE_2 + ((zz) + 1) * EXTCHUNK_SIZE + ((xx) + 1))
 
-static BlockID* Builder_Chunk;
-static uint8_t* Builder_Counts;
-static int* Builder_BitFlags;
-static bool Builder_UseBitFlags;
-static int Builder_X, Builder_Y, Builder_Z;
-static BlockID Builder_Block;
-static int Builder_ChunkIndex;
-static bool Builder_FullBright;
-static bool Builder_Tinted;
-static int Builder_ChunkEndX, Builder_ChunkEndZ;
 static int Builder_Offsets[FACE_COUNT] = { -1,1, -EXTCHUNK_SIZE,EXTCHUNK_SIZE, -EXTCHUNK_SIZE_2,EXTCHUNK_SIZE_2 };
 
-static int (*Builder_StretchXLiquid)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
-static int (*Builder_StretchX)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static int (*Builder_StretchZ)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static void (*Builder_RenderBlock)(int countsIndex);
-static void (*Builder_PreStretchTiles)(int x1, int y1, int z1);
-static void (*Builder_PostStretchTiles)(int x1, int y1, int z1);
-
 /* Contains state for vertices for a portion of a chunk mesh (vertices that are in a 1D atlas) */
 struct Builder1DPart {
 	VertexP3fT2fC4b* fVertices[FACE_COUNT];
@@ -47,11 +30,75 @@ struct Builder1DPart {
 	int sCount, sOffset, sAdvance;
 };
 
-/* Part builder data, for both normal and translucent parts.
-The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
-static struct Builder1DPart Builder_Parts[ATLAS1D_MAX_ATLASES * 2];
-static VertexP3fT2fC4b* Builder_Vertices;
-static int Builder_VerticesElems;
+/* All the state needed to build the mesh of one chunk. */
+/* Each builder worker thread has its own instance, so chunks can be meshed in parallel. */
+struct ChunkBuilder {
+	BlockID* Chunk;
+	uint8_t* Counts;
+	int* BitFlags;
+	int X, Y, Z;
+	BlockID Block;
+	int ChunkIndex;
+	bool FullBright;
+	bool Tinted;
+	int ChunkEndX, ChunkEndY, ChunkEndZ;
+	/* Whether faces are also merged along their second axis. (see Builder_GreedyMeshing) */
+	bool Greedy;
+	/* Number of rows along the second axis that each face covers. Only used when Greedy is true. */
+	uint8_t* Extents;
+	/* Which pairs of chunk faces can see each other through the chunk. (see ChunkInfo.Connectivity) */
+	uint16_t Connectivity;
+	/* Colour of each face of a block when in sunlight, and when in shadow */
+	PackedCol SunCols[FACE_COUNT], ShadowCols[FACE_COUNT];
+	/* Colour of each face of a block at each light level. Only used with Lighting_Fancy. */
+	PackedCol LevelCols[LIGHTING_MAX_LEVEL + 1][FACE_COUNT];
+
+	/* Part builder data, for both normal and translucent parts.
+	The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
+	struct Builder1DPart Parts[ATLAS1D_MAX_ATLASES * 2];
+	VertexP3fT2fC4b* Vertices;
+	int VerticesElems;
+
+	struct _DrawerData Drawer;
+	RNGState SpriteRng;
+	/* Whether time spent in each stage of building is measured. (see Builder_Benchmark) */
+	bool Benchmarking;
+	uint64_t StageTicks[3];
+	/* State only used by the advanced mesh builder */
+	struct AdvBuilderState {
+		Vector3 MinBB, MaxBB;
+		int InitBitFlags, LightFlags, BaseOffset;
+		float X1, Y1, Z1, X2, Y2, Z2;
+		PackedCol Lerp[5], LerpX[5], LerpZ[5], LerpY[5];
+	} Adv;
+};
+
+#ifdef CC_BUILD_COMPACTCHUNKS
+typedef VertexP3sT2sC4b ChunkVertex;
+#else
+typedef VertexP3fT2fC4b ChunkVertex;
+#endif
+
+/* Mesh built for a chunk, which is hooked into the chunk's ChunkInfo on the main thread. */
+struct ChunkMesh {
+	struct ChunkInfo* Info;
+	int X, Y, Z;      /* Coordinates of minimum corner of the chunk */
+	int AtlasesCount; /* Value of MapRenderer_1DUsedCount when the mesh was requested */
+	bool AllAir;
+	uint16_t Connectivity;
+	ChunkVertex* Vertices;
+	int VerticesCount;
+	/* AtlasesCount normal parts, followed by AtlasesCount translucent parts */
+	struct ChunkPartInfo* Parts;
+};
+
+static int (*Builder_StretchXLiquid)(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
+static int (*Builder_StretchX)(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static int (*Builder_StretchZ)(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static bool (*Builder_CanStretch)(struct ChunkBuilder* b, BlockID initial, int chunkIndex, int x, int y, int z, Face face);
+static void (*Builder_RenderBlock)(struct ChunkBuilder* b, int countsIndex);
+static void (*Builder_PreStretchTiles)(struct ChunkBuilder* b, int x1, int y1, int z1);
+static void (*Builder_PostStretchTiles)(struct ChunkBuilder* b, int x1, int y1, int z1);
 
 static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	int i, count = part->sCount;
@@ -59,23 +106,23 @@ static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	return count;
 }
 
-static void Builder1DPart_CalcOffsets(struct Builder1DPart* part, int* offset) {
+static void Builder1DPart_CalcOffsets(struct ChunkBuilder* b, struct Builder1DPart* part, int* offset) {
 	int pos = *offset, i;
 	part->sOffset  = pos;
 	part->sAdvance = part->sCount >> 2;
 
 	pos += part->sCount;
 	for (i = 0; i < FACE_COUNT; i++) {
-		part->fVertices[i] = &Builder_Vertices[pos];
+		part->fVertices[i] = &b->Vertices[pos];
 		pos += part->fCount[i];
 	}
 	*offset = pos;
 }
 
-static int Builder_TotalVerticesCount(void) {
+static int Builder_TotalVerticesCount(struct ChunkBuilder* b) {
 	int i, count = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES * 2; i++) {
-		count += Builder1DPart_VerticesCount(&Builder_Parts[i]);
+		count += Builder1DPart_VerticesCount(&b->Parts[i]);
 	}
 	return count;
 }
@@ -84,31 +131,26 @@ static int Builder_TotalVerticesCount(void) {
 /*########################################################################################################################*
 *----------------------------------------------------Base mesh builder----------------------------------------------------*
 *#########################################################################################################################*/
-static void Builder_AddSpriteVertices(BlockID block) {
+static void Builder_AddSpriteVertices(struct ChunkBuilder* b, BlockID block) {
 	int i = Atlas1D_Index(Block_Tex(block, FACE_XMAX));
-	struct Builder1DPart* part = &Builder_Parts[i];
+	struct Builder1DPart* part = &b->Parts[i];
 	part->sCount += 4 * 4;
 }
 
-static void Builder_AddVertices(BlockID block, Face face) {
+static void Builder_AddVertices(struct ChunkBuilder* b, BlockID block, Face face) {
 	int baseOffset = (Blocks.Draw[block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
 	int i = Atlas1D_Index(Block_Tex(block, face));
-	struct Builder1DPart* part = &Builder_Parts[baseOffset + i];
+	struct Builder1DPart* part = &b->Parts[baseOffset + i];
 	part->fCount[face] += 4;
 }
 
-static void Builder_SetPartInfo(struct Builder1DPart* part, int* offset, struct ChunkPartInfo* info, bool* hasParts) {
+static void Builder_SetPartInfo(struct Builder1DPart* part, int* offset, struct ChunkPartInfo* info) {
 	int vCount = Builder1DPart_VerticesCount(part);
 	info->Offset = -1;
 	if (!vCount) return;
 
 	info->Offset = *offset;
 	*offset += vCount;
-	*hasParts = true;
-
-#ifdef CC_BUILD_GL11
-	info->Vb = Gfx_CreateVb(&Builder_Vertices[info->Offset], VERTEX_FORMAT_P3FT2FC4B, vCount);
-#endif
 
 	info->Counts[FACE_XMIN] = part->fCount[FACE_XMIN];
 	info->Counts[FACE_XMAX] = part->fCount[FACE_XMAX];
@@ -119,121 +161,199 @@ static void Builder_SetPartInfo(struct Builder1DPart* part, int* offset, struct
 	info->SpriteCount       = part->sCount;
 }
 
+/* Whether faces of the given block can be merged along the face's second axis. */
+/* (i.e. Y axis for X/Z faces, Z axis for Y faces) */
+static bool Builder_CanStretchGreedy(BlockID block, Face face) {
+	if (face >= FACE_YMIN) {
+		return Blocks.MinBB[block].Z == 0.0f && Blocks.MaxBB[block].Z == 1.0f;
+	}
+	return Blocks.MinBB[block].Y       == 0.0f && Blocks.MaxBB[block].Y       == 1.0f
+		&& Blocks.RenderMinBB[block].Y == 0.0f && Blocks.RenderMaxBB[block].Y == 1.0f;
+}
+
+/* Merges the row of 'count' faces starting at the given block with the following rows along */
+/* the face's second axis, for as long as every face in the next row can be stretched into. */
+/* Returns number of rows the merged face covers. */
+static int Builder_StretchGreedy(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face, int count) {
+	int extent = 1, i;
+	/* index steps along the face's first (u) and second (v) axes */
+	int uChunk, uCount, vChunk, vCount;
+	bool alongZ = face <= FACE_XMAX;
+	if (!Builder_CanStretchGreedy(block, face)) return 1;
+
+	uChunk = alongZ ? EXTCHUNK_SIZE : 1;
+	uCount = alongZ ? CHUNK_SIZE * FACE_COUNT : FACE_COUNT;
+
+	if (face >= FACE_YMIN) {
+		vChunk = EXTCHUNK_SIZE;   vCount = CHUNK_SIZE * FACE_COUNT;
+	} else {
+		vChunk = EXTCHUNK_SIZE_2; vCount = CHUNK_SIZE * CHUNK_SIZE * FACE_COUNT;
+	}
+
+	for (;;) {
+		if (face >= FACE_YMIN) {
+			if (++z >= b->ChunkEndZ) break;
+		} else {
+			if (++y >= b->ChunkEndY) break;
+		}
+		chunkIndex += vChunk;
+		countIndex += vCount;
+
+		for (i = 0; i < count; i++) {
+			if (!b->Counts[countIndex + i * uCount]) break;
+			if (!Builder_CanStretch(b, block, chunkIndex + i * uChunk,
+				alongZ ? x : x + i, y, alongZ ? z + i : z, face)) break;
+		}
+		if (i < count) break;
+
+		for (i = 0; i < count; i++) {
+			b->Counts[countIndex + i * uCount] = 0;
+		}
+		extent++;
+	}
+	return extent;
+}
+
+/* Moves the far edge of each face just drawn for the current block along the face's second axis, */
+/* so the face covers all the rows it was merged with in Builder_StretchGreedy. */
+/* NOTE: V only ever extends past the bottom of the tile, which repeats vertically either because the */
+/* chunk shader wraps V within the tile or because each 1D atlas contains a single tile. */
+static void Builder_DrawGreedy(struct ChunkBuilder* b, int index, int baseOffset) {
+	struct Builder1DPart* part;
+	VertexP3fT2fC4b* v;
+	float edge, amount, vAmount;
+	int face, extent, i;
+
+	for (face = 0; face < FACE_COUNT; face++) {
+		extent = b->Extents[index + face];
+		if (!b->Counts[index + face] || extent <= 1) continue;
+
+		part   = &b->Parts[baseOffset + Atlas1D_Index(Block_Tex(b->Block, face))];
+		v      = part->fVertices[face] - 4;
+		amount  = (float)(extent - 1);
+		vAmount = amount * Atlas1D.InvTileSize;
+
+		if (face >= FACE_YMIN) {
+			edge = max(max(v[0].Z, v[1].Z), max(v[2].Z, v[3].Z));
+			for (i = 0; i < 4; i++) {
+				if (v[i].Z == edge) { v[i].Z += amount; v[i].V += vAmount; }
+			}
+		} else {
+			/* V texture coordinate increases downwards, so the bottom edge moves further down the tile */
+			edge = max(max(v[0].Y, v[1].Y), max(v[2].Y, v[3].Y));
+			for (i = 0; i < 4; i++) {
+				if (v[i].Y == edge) { v[i].Y += amount; } else { v[i].V += vAmount; }
+			}
+		}
+	}
+}
 
-static void Builder_Stretch(int x1, int y1, int z1) {
+static void Builder_Stretch(struct ChunkBuilder* b, int x1, int y1, int z1) {
 	int xMax = min(World.Width,  x1 + CHUNK_SIZE);
 	int yMax = min(World.Height, y1 + CHUNK_SIZE);
 	int zMax = min(World.Length, z1 + CHUNK_SIZE);
 
 	int cIndex, index, tileIdx, count;
-	BlockID b;
+	BlockID block;
 	int x, y, z, xx, yy, zz;
 
-#ifdef OCCLUSION
-	int flags = ComputeOcclusion();
-#endif
-#ifdef DEBUG_OCCLUSION
-	FastColour col = new FastColour(60, 60, 60, 255);
-	if (flags & 1) col.R = 255; /* x */
-	if (flags & 4) col.G = 255; /* y */
-	if (flags & 2) col.B = 255; /* z */
-	map.Sunlight = map.Shadowlight = col;
-	map.SunlightXSide = map.ShadowlightXSide = col;
-	map.SunlightZSide = map.ShadowlightZSide = col;
-	map.SunlightYBottom = map.ShadowlightYBottom = col;
-#endif
-	
 	for (y = y1, yy = 0; y < yMax; y++, yy++) {
 		for (z = z1, zz = 0; z < zMax; z++, zz++) {
 			cIndex = Builder_PackChunk(0, yy, zz);
 
 			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				b = Builder_Chunk[cIndex];
-				if (Blocks.Draw[b] == DRAW_GAS) continue;
+				block = b->Chunk[cIndex];
+				if (Blocks.Draw[block] == DRAW_GAS) continue;
 				index = Builder_PackCount(xx, yy, zz);
 
 				/* Sprites only use one face to indicate stretching count, so we can take a shortcut here.
 				Note that sprites are not drawn with any of the DrawXFace, they are drawn using DrawSprite. */
-				if (Blocks.Draw[b] == DRAW_SPRITE) {
+				if (Blocks.Draw[block] == DRAW_SPRITE) {
 					index += FACE_YMAX;
-					if (Builder_Counts[index]) {
-						Builder_X = x; Builder_Y = y; Builder_Z = z;
-						Builder_AddSpriteVertices(b);
-						Builder_Counts[index] = 1;
+					if (b->Counts[index]) {
+						b->X = x; b->Y = y; b->Z = z;
+						Builder_AddSpriteVertices(b, block);
+						b->Counts[index] = 1;
 					}
 					continue;
 				}
 
-				Builder_X = x; Builder_Y = y; Builder_Z = z;
-				Builder_FullBright = Blocks.FullBright[b];
-				tileIdx = b * BLOCK_COUNT;
+				b->X = x; b->Y = y; b->Z = z;
+				b->FullBright = Blocks.FullBright[block];
+				tileIdx = block * BLOCK_COUNT;
 				/* All of these function calls are inlined as they can be called tens of millions to hundreds of millions of times. */
 
-				if (Builder_Counts[index] == 0 ||
-					(x == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - 1]] & (1 << FACE_XMIN)) != 0)) {
-					Builder_Counts[index] = 0;
+				if (b->Counts[index] == 0 ||
+					(x == 0 && (y < Builder_SidesLevel || (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+					(x != 0 && (Blocks.Hidden[tileIdx + b->Chunk[cIndex - 1]] & (1 << FACE_XMIN)) != 0)) {
+					b->Counts[index] = 0;
 				} else {
-					count = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMIN);
-					Builder_AddVertices(b, FACE_XMIN);
-					Builder_Counts[index] = count;
+					count = Builder_StretchZ(b, index, x, y, z, cIndex, block, FACE_XMIN);
+					if (b->Greedy) b->Extents[index] = Builder_StretchGreedy(b, index, x, y, z, cIndex, block, FACE_XMIN, count);
+					Builder_AddVertices(b, block, FACE_XMIN);
+					b->Counts[index] = count;
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(x == World.MaxX && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != World.MaxX && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + 1]] & (1 << FACE_XMAX)) != 0)) {
-					Builder_Counts[index] = 0;
+				if (b->Counts[index] == 0 ||
+					(x == World.MaxX && (y < Builder_SidesLevel || (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+					(x != World.MaxX && (Blocks.Hidden[tileIdx + b->Chunk[cIndex + 1]] & (1 << FACE_XMAX)) != 0)) {
+					b->Counts[index] = 0;
 				} else {
-					count = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMAX);
-					Builder_AddVertices(b, FACE_XMAX);
-					Builder_Counts[index] = count;
+					count = Builder_StretchZ(b, index, x, y, z, cIndex, block, FACE_XMAX);
+					if (b->Greedy) b->Extents[index] = Builder_StretchGreedy(b, index, x, y, z, cIndex, block, FACE_XMAX, count);
+					Builder_AddVertices(b, block, FACE_XMAX);
+					b->Counts[index] = count;
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(z == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE]] & (1 << FACE_ZMIN)) != 0)) {
-					Builder_Counts[index] = 0;
+				if (b->Counts[index] == 0 ||
+					(z == 0 && (y < Builder_SidesLevel || (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+					(z != 0 && (Blocks.Hidden[tileIdx + b->Chunk[cIndex - EXTCHUNK_SIZE]] & (1 << FACE_ZMIN)) != 0)) {
+					b->Counts[index] = 0;
 				} else {
-					count = Builder_StretchX(index, Builder_X, Builder_Y, Builder_Z, cIndex, b, FACE_ZMIN);
-					Builder_AddVertices(b, FACE_ZMIN);
-					Builder_Counts[index] = count;
+					count = Builder_StretchX(b, index, b->X, b->Y, b->Z, cIndex, block, FACE_ZMIN);
+					if (b->Greedy) b->Extents[index] = Builder_StretchGreedy(b, index, x, y, z, cIndex, block, FACE_ZMIN, count);
+					Builder_AddVertices(b, block, FACE_ZMIN);
+					b->Counts[index] = count;
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(z == World.MaxZ && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != World.MaxZ && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE]] & (1 << FACE_ZMAX)) != 0)) {
-					Builder_Counts[index] = 0;
+				if (b->Counts[index] == 0 ||
+					(z == World.MaxZ && (y < Builder_SidesLevel || (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+					(z != World.MaxZ && (Blocks.Hidden[tileIdx + b->Chunk[cIndex + EXTCHUNK_SIZE]] & (1 << FACE_ZMAX)) != 0)) {
+					b->Counts[index] = 0;
 				} else {
-					count = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMAX);
-					Builder_AddVertices(b, FACE_ZMAX);
-					Builder_Counts[index] = count;
+					count = Builder_StretchX(b, index, x, y, z, cIndex, block, FACE_ZMAX);
+					if (b->Greedy) b->Extents[index] = Builder_StretchGreedy(b, index, x, y, z, cIndex, block, FACE_ZMAX, count);
+					Builder_AddVertices(b, block, FACE_ZMAX);
+					b->Counts[index] = count;
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 || y == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE_2]] & (1 << FACE_YMIN)) != 0) {
-					Builder_Counts[index] = 0;
+				if (b->Counts[index] == 0 || y == 0 ||
+					(Blocks.Hidden[tileIdx + b->Chunk[cIndex - EXTCHUNK_SIZE_2]] & (1 << FACE_YMIN)) != 0) {
+					b->Counts[index] = 0;
 				} else {
-					count = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMIN);
-					Builder_AddVertices(b, FACE_YMIN);
-					Builder_Counts[index] = count;
+					count = Builder_StretchX(b, index, x, y, z, cIndex, block, FACE_YMIN);
+					if (b->Greedy) b->Extents[index] = Builder_StretchGreedy(b, index, x, y, z, cIndex, block, FACE_YMIN, count);
+					Builder_AddVertices(b, block, FACE_YMIN);
+					b->Counts[index] = count;
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE_2]] & (1 << FACE_YMAX)) != 0) {
-					Builder_Counts[index] = 0;
-				} else if (b < BLOCK_WATER || b > BLOCK_STILL_LAVA) {
-					count = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMAX);
-					Builder_AddVertices(b, FACE_YMAX);
-					Builder_Counts[index] = count;
+				if (b->Counts[index] == 0 ||
+					(Blocks.Hidden[tileIdx + b->Chunk[cIndex + EXTCHUNK_SIZE_2]] & (1 << FACE_YMAX)) != 0) {
+					b->Counts[index] = 0;
+				} else if (block < BLOCK_WATER || block > BLOCK_STILL_LAVA) {
+					count = Builder_StretchX(b, index, x, y, z, cIndex, block, FACE_YMAX);
+					if (b->Greedy) b->Extents[index] = Builder_StretchGreedy(b, index, x, y, z, cIndex, block, FACE_YMAX, count);
+					Builder_AddVertices(b, block, FACE_YMAX);
+					b->Counts[index] = count;
 				} else {
-					count = Builder_StretchXLiquid(index, x, y, z, cIndex, b);
-					if (count > 0) Builder_AddVertices(b, FACE_YMAX);
-					Builder_Counts[index] = count;
+					count = Builder_StretchXLiquid(b, index, x, y, z, cIndex, block);
+					if (count > 0) Builder_AddVertices(b, block, FACE_YMAX);
+					b->Counts[index] = count;
 				}
 			}
 		}
@@ -252,18 +372,20 @@ for (yy = -1; yy < 17; ++yy) {\
 			block    = get_block;\
 			allAir   = allAir   && Blocks.Draw[block] == DRAW_GAS;\
 			allSolid = allSolid && Blocks.FullOpaque[block];\
-			Builder_Chunk[cIndex] = block;\
+			b->Chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static bool ReadChunkData(int x1, int y1, int z1, bool* outAllAir) {
+static bool ReadChunkData(struct ChunkBuilder* b, int x1, int y1, int z1, bool* outAllAir) {
 	bool allAir = true, allSolid = true;
 	int index, cIndex;
 	BlockID block;
 	int xx, yy, zz, y;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_SPARSEWORLD
+	ReadChunkBody(World_GetBlock(x1 + xx, y, z1 + zz));
+#elif !defined EXTENDED_BLOCKS
 	ReadChunkBody(World.Blocks[index]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -298,18 +420,20 @@ for (yy = -1; yy < 17; ++yy) {\
 \
 			block  = get_block;\
 			allAir = allAir && Blocks.Draw[block] == DRAW_GAS;\
-			Builder_Chunk[cIndex] = block;\
+			b->Chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static bool ReadBorderChunkData(int x1, int y1, int z1, bool* outAllAir) {
+static bool ReadBorderChunkData(struct ChunkBuilder* b, int x1, int y1, int z1, bool* outAllAir) {
 	bool allAir = true;
 	int index, cIndex;
 	BlockID block;
 	int xx, yy, zz, x, y, z;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_SPARSEWORLD
+	ReadBorderChunkBody(World_GetBlock(x, y, z));
+#elif !defined EXTENDED_BLOCKS
 	ReadBorderChunkBody(World.Blocks[index]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -323,92 +447,260 @@ static bool ReadBorderChunkData(int x1, int y1, int z1, bool* outAllAir) {
 	return false;
 }
 
-static bool Builder_BuildChunk(int x1, int y1, int z1, bool* allAir) {
+/* Returns the ChunkInfo.Connectivity bits for every pair of faces in the given mask of faces. */
+static uint16_t Builder_ConnectFaces(int faces) {
+	uint16_t connectivity = 0;
+	int i, j;
+
+	for (i = 0; i < FACE_COUNT; i++) {
+		if (!(faces & (1 << i))) continue;
+		for (j = i + 1; j < FACE_COUNT; j++) {
+			if (faces & (1 << j)) connectivity |= Chunk_ConnectivityBit(i, j);
+		}
+	}
+	return connectivity;
+}
+
+/* Flood fills each region of connected non-opaque blocks in the chunk, */
+/* and records which faces of the chunk each region touches. */
+/* Regions of the chunk that touch two faces means those faces can see each other through the chunk. */
+static void Builder_CalcConnectivity(struct ChunkBuilder* b, int maxX, int maxY, int maxZ) {
+	/* Opaque blocks are pre-marked as visited, as flood fill never enters them */
+	uint8_t visited[CHUNK_SIZE_3];
+	uint16_t stack[CHUNK_SIZE_3];
+	uint16_t connectivity = 0;
+	int i, idx, top, faces, xx, yy, zz;
+
+	for (yy = 0; yy < CHUNK_SIZE; yy++) {
+		for (zz = 0; zz < CHUNK_SIZE; zz++) {
+			for (xx = 0; xx < CHUNK_SIZE; xx++) {
+				i = (yy << 8) | (zz << 4) | xx;
+				/* Parts of chunk past edge of the map are treated as opaque */
+				visited[i] = xx >= maxX || yy >= maxY || zz >= maxZ
+					|| Blocks.FullOpaque[b->Chunk[Builder_PackChunk(xx, yy, zz)]];
+			}
+		}
+	}
+
+	for (i = 0; i < CHUNK_SIZE_3 && connectivity != CHUNK_ALL_CONNECTED; i++) {
+		if (visited[i]) continue;
+		visited[i] = true;
+		stack[0]   = i;
+		top = 1; faces = 0;
+
+		while (top) {
+			idx = stack[--top];
+			xx = idx & CHUNK_MASK; zz = (idx >> 4) & CHUNK_MASK; yy = idx >> 8;
+
+			if (xx == 0)        faces |= 1 << FACE_XMIN;
+			if (xx == maxX - 1) faces |= 1 << FACE_XMAX;
+			if (zz == 0)        faces |= 1 << FACE_ZMIN;
+			if (zz == maxZ - 1) faces |= 1 << FACE_ZMAX;
+			if (yy == 0)        faces |= 1 << FACE_YMIN;
+			if (yy == maxY - 1) faces |= 1 << FACE_YMAX;
+
+			/* Each cell is only ever pushed once, so stack can't overflow */
+			if (xx > 0        && !visited[idx - 1])   { visited[idx - 1]   = true; stack[top++] = idx - 1; }
+			if (xx < maxX - 1 && !visited[idx + 1])   { visited[idx + 1]   = true; stack[top++] = idx + 1; }
+			if (zz > 0        && !visited[idx - 16])  { visited[idx - 16]  = true; stack[top++] = idx - 16; }
+			if (zz < maxZ - 1 && !visited[idx + 16])  { visited[idx + 16]  = true; stack[top++] = idx + 16; }
+			if (yy > 0        && !visited[idx - 256]) { visited[idx - 256] = true; stack[top++] = idx - 256; }
+			if (yy < maxY - 1 && !visited[idx + 256]) { visited[idx + 256] = true; stack[top++] = idx + 256; }
+		}
+		connectivity |= Builder_ConnectFaces(faces);
+	}
+	b->Connectivity = connectivity;
+}
+
+#define BUILDER_STAGE_READ    0
+#define BUILDER_STAGE_STRETCH 1
+#define BUILDER_STAGE_RENDER  2
+/* Starts measuring time spent in a stage of building the chunk, if benchmarking */
+#define Builder_BeginStage(b, beg) if (b->Benchmarking) { beg = Stopwatch_Measure(); }
+/* Adds time spent since Builder_BeginStage to the given stage of building the chunk, if benchmarking */
+#define Builder_EndStage(b, beg, stage) if (b->Benchmarking) { b->StageTicks[stage] += Stopwatch_Measure() - beg; }
+
+static bool Builder_BuildChunk(struct ChunkBuilder* b, int x1, int y1, int z1, bool* allAir) {
 	BlockID chunk[EXTCHUNK_SIZE_3]; 
 	uint8_t counts[CHUNK_SIZE_3 * FACE_COUNT]; 
+	uint8_t extents[CHUNK_SIZE_3 * FACE_COUNT];
 	int bitFlags[EXTCHUNK_SIZE_3];
 
 	bool allSolid, onBorder;
 	int xMax, yMax, zMax;
 	int cIndex, index;
 	int x, y, z, xx, yy, zz;
-
-	Builder_Chunk  = chunk;
-	Builder_Counts = counts;
-	Builder_BitFlags = bitFlags;
-	Builder_PreStretchTiles(x1, y1, z1);
+	uint64_t beg = 0;
+
+	b->Chunk  = chunk;
+	b->Counts = counts;
+	b->BitFlags = bitFlags;
+	b->Extents  = extents;
+	/* Greedy mode is only possible when the atlas textures can repeat vertically */
+#ifdef CC_BUILD_SHADEDCHUNKS
+	b->Greedy   = Builder_GreedyMeshing;
+#else
+	b->Greedy   = Builder_GreedyMeshing && Atlas1D.TilesPerAtlas == 1;
+#endif
+	Builder_PreStretchTiles(b, x1, y1, z1);
 	
 	onBorder = 
 		x1 == 0 || y1 == 0 || z1 == 0   || x1 + CHUNK_SIZE >= World.Width ||
 		y1 + CHUNK_SIZE >= World.Height || z1 + CHUNK_SIZE >= World.Length;
 
+	Builder_BeginStage(b, beg);
 	if (onBorder) {
 		/* less optimal case here */
 		Mem_Set(chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
-		allSolid = ReadBorderChunkData(x1, y1, z1, allAir);
+		allSolid = ReadBorderChunkData(b, x1, y1, z1, allAir);
 	} else {
-		allSolid = ReadChunkData(x1, y1, z1, allAir);
+		allSolid = ReadChunkData(b, x1, y1, z1, allAir);
 	}
+	Builder_EndStage(b, beg, BUILDER_STAGE_READ);
 
-	if (*allAir || allSolid) return false;
-	Lighting_LightHint(x1 - 1, z1 - 1);
-
+	if (*allAir || allSolid) {
+		b->Connectivity = *allAir ? CHUNK_ALL_CONNECTED : 0;
+		return false;
+	}
 	Mem_Set(counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
+	if (b->Greedy) Mem_Set(extents, 1, CHUNK_SIZE_3 * FACE_COUNT);
 	xMax = min(World.Width,  x1 + CHUNK_SIZE);
 	yMax = min(World.Height, y1 + CHUNK_SIZE);
 	zMax = min(World.Length, z1 + CHUNK_SIZE);
 
-	Builder_ChunkEndX = xMax; Builder_ChunkEndZ = zMax;
-	Builder_Stretch(x1, y1, z1);
-	Builder_PostStretchTiles(x1, y1, z1);
+	b->ChunkEndX = xMax; b->ChunkEndY = yMax; b->ChunkEndZ = zMax;
+	Builder_CalcConnectivity(b, xMax - x1, yMax - y1, zMax - z1);
+
+	Builder_BeginStage(b, beg);
+	Builder_Stretch(b, x1, y1, z1);
+	Builder_EndStage(b, beg, BUILDER_STAGE_STRETCH);
+	Builder_PostStretchTiles(b, x1, y1, z1);
+
+	Builder_BeginStage(b, beg);
 
 	for (y = y1, yy = 0; y < yMax; y++, yy++) {
 		for (z = z1, zz = 0; z < zMax; z++, zz++) {
 			cIndex = Builder_PackChunk(0, yy, zz);
 
 			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				Builder_Block = chunk[cIndex];
-				if (Blocks.Draw[Builder_Block] == DRAW_GAS) continue;
+				b->Block = chunk[cIndex];
+				if (Blocks.Draw[b->Block] == DRAW_GAS) continue;
 
 				index = Builder_PackCount(xx, yy, zz);
-				Builder_X = x; Builder_Y = y; Builder_Z = z;
-				Builder_ChunkIndex = cIndex;
-				Builder_RenderBlock(index);
+				b->X = x; b->Y = y; b->Z = z;
+				b->ChunkIndex = cIndex;
+				Builder_RenderBlock(b, index);
 			}
 		}
 	}
+	Builder_EndStage(b, beg, BUILDER_STAGE_RENDER);
 	return true;
 }
 
-void Builder_MakeChunk(struct ChunkInfo* info) {
-	int x = info->CentreX - 8, y = info->CentreY - 8, z = info->CentreZ - 8;
-	bool allAir, hasMesh, hasNorm, hasTran;
-	int totalVerts, partsIndex;
-	int i, j, curIdx, offset;
-
-	allAir  = false;
-	hasMesh = Builder_BuildChunk(x, y, z, &allAir);
-	info->AllAir = allAir;
-	if (!hasMesh) return;
-
-	totalVerts = Builder_TotalVerticesCount();
-	if (!totalVerts) return;
+#ifdef CC_BUILD_COMPACTCHUNKS
+/* Converts the built quads in place to compact vertices, relative to the chunk's minimum corner. */
+/* W is the index within the 1D atlas of the tile the quad starts in, which V wraps around within. */
+/* NOTE: Compact vertices are smaller, so this never overwrites vertices not yet converted. */
+static void Builder_PackVertices(struct ChunkBuilder* b, struct ChunkMesh* mesh) {
+	VertexP3fT2fC4b* src = b->Vertices;
+	VertexP3sT2sC4b* dst = (VertexP3sT2sC4b*)b->Vertices;
+	VertexP3fT2fC4b v[4];
+	float x = (float)mesh->X, y = (float)mesh->Y, z = (float)mesh->Z;
+	float vScale = CHUNK_V_SCALE, minV;
+	int i, j, tile;
+
+	for (i = 0; i < mesh->VerticesCount; i += 4, src += 4, dst += 4) {
+		v[0] = src[0]; v[1] = src[1]; v[2] = src[2]; v[3] = src[3];
+		/* Greedy meshing only moves V past the bottom of the tile (see Builder_DrawGreedy) */
+		minV = min(min(v[0].V, v[1].V), min(v[2].V, v[3].V));
+		tile = Math_Floor(minV * Atlas1D.TilesPerAtlas + 0.001f);
+
+		for (j = 0; j < 4; j++) {
+			dst[j].X = (int16_t)Math_Floor((v[j].X - x) * CHUNK_POS_SCALE + 0.5f);
+			dst[j].Y = (int16_t)Math_Floor((v[j].Y - y) * CHUNK_POS_SCALE + 0.5f);
+			dst[j].Z = (int16_t)Math_Floor((v[j].Z - z) * CHUNK_POS_SCALE + 0.5f);
+			dst[j].W = (int16_t)tile;
+			dst[j].Col = v[j].Col;
+			/* Round down so texture coordinates still stay slightly inside the tile (see UV2_Scale) */
+			dst[j].U = (int16_t)Math_Floor(v[j].U * CHUNK_U_SCALE + 0.01f);
+			dst[j].V = (int16_t)Math_Floor(v[j].V * vScale        + 0.01f);
+		}
+	}
+}
+#else
+static void Builder_PackVertices(struct ChunkBuilder* b, struct ChunkMesh* mesh) { }
+#endif
+
+static void Builder_BuildMesh(struct ChunkBuilder* b, struct ChunkMesh* mesh) {
+	bool allAir = false;
+	int i, j, offset, count;
+
+	mesh->Vertices      = NULL;
+	mesh->VerticesCount = 0;
+	mesh->Parts         = NULL;
+
+	mesh->AllAir = false;
+	if (!Builder_BuildChunk(b, mesh->X, mesh->Y, mesh->Z, &allAir)) {
+		mesh->AllAir       = allAir;
+		mesh->Connectivity = b->Connectivity; return;
+	}
+	mesh->Connectivity = b->Connectivity;
+
+	mesh->VerticesCount = Builder_TotalVerticesCount(b);
+	if (!mesh->VerticesCount) return;
+	Builder_PackVertices(b, mesh);
+	mesh->Vertices = (ChunkVertex*)b->Vertices;
+
+	count = mesh->AtlasesCount;
+	mesh->Parts = (struct ChunkPartInfo*)Mem_Alloc(count * 2, sizeof(struct ChunkPartInfo), "chunk mesh parts");
+	offset = 0;
+
+	for (i = 0; i < count; i++) {
+		j = i + ATLAS1D_MAX_ATLASES;
+		Builder_SetPartInfo(&b->Parts[i], &offset, &mesh->Parts[i]);
+		Builder_SetPartInfo(&b->Parts[j], &offset, &mesh->Parts[i + count]);
+	}
+}
+
+static void Builder_HookPart(struct ChunkMesh* mesh, struct ChunkPartInfo* src, struct ChunkPartInfo* dst, bool* hasParts) {
+#ifdef CC_BUILD_GL11
+	int i, vCount;
+#endif
+	*dst = *src;
+	if (src->Offset < 0) return;
+	*hasParts = true;
+
+#ifdef CC_BUILD_GL11
+	vCount = src->SpriteCount;
+	for (i = 0; i < FACE_COUNT; i++) { vCount += src->Counts[i]; }
+	dst->Vb = Gfx_CreateVb(&mesh->Vertices[src->Offset], CHUNK_VERTEX_FORMAT, vCount);
+#endif
+}
+
+static void Builder_HookMesh(struct ChunkMesh* mesh) {
+	struct ChunkInfo* info = mesh->Info;
+	int i, count, partsIndex, curIdx;
+	bool hasNorm, hasTran;
+
+	info->AllAir       = mesh->AllAir;
+	info->Reconnected  = info->Connectivity != mesh->Connectivity;
+	info->Connectivity = mesh->Connectivity;
+	if (!mesh->VerticesCount) return;
 #ifndef CC_BUILD_GL11
 	/* add an extra element to fix crashing on some GPUs */
-	info->Vb = Gfx_CreateVb(Builder_Vertices, VERTEX_FORMAT_P3FT2FC4B, totalVerts + 1);
+	MapRenderer_AllocVertices(info, mesh->Vertices, mesh->VerticesCount + 1);
 #endif
 
-	partsIndex = MapRenderer_Pack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
-	offset  = 0;
+	partsIndex = MapRenderer_Pack(mesh->X >> CHUNK_SHIFT, mesh->Y >> CHUNK_SHIFT, mesh->Z >> CHUNK_SHIFT);
+	count   = mesh->AtlasesCount;
 	hasNorm = false;
 	hasTran = false;
 
-	for (i = 0; i < MapRenderer_1DUsedCount; i++) {
-		j = i + ATLAS1D_MAX_ATLASES;
+	for (i = 0; i < count; i++) {
 		curIdx = partsIndex + i * MapRenderer_ChunksCount;
 
-		Builder_SetPartInfo(&Builder_Parts[i], &offset, &MapRenderer_PartsNormal[curIdx],      &hasNorm);
-		Builder_SetPartInfo(&Builder_Parts[j], &offset, &MapRenderer_PartsTranslucent[curIdx], &hasTran);
+		Builder_HookPart(mesh, &mesh->Parts[i],         &MapRenderer_PartsNormal[curIdx],      &hasNorm);
+		Builder_HookPart(mesh, &mesh->Parts[i + count], &MapRenderer_PartsTranslucent[curIdx], &hasTran);
 	}
 
 	if (hasNorm) {
@@ -417,47 +709,90 @@ void Builder_MakeChunk(struct ChunkInfo* info) {
 	if (hasTran) {
 		info->TranslucentParts = &MapRenderer_PartsTranslucent[partsIndex];
 	}
+}
 
-#ifdef OCCLUSION
-	if (info.NormalParts != null || info.TranslucentParts != null)
-		info.occlusionFlags = (uint8_t)ComputeOcclusion();
-#endif
+static void Builder_InitMesh(struct ChunkMesh* mesh, struct ChunkInfo* info) {
+	mesh->Info = info;
+	mesh->X = info->CentreX - 8;
+	mesh->Y = info->CentreY - 8;
+	mesh->Z = info->CentreZ - 8;
+	mesh->AtlasesCount = MapRenderer_1DUsedCount;
 }
 
-static bool Builder_OccludedLiquid(int chunkIndex) {
+static void Builder_FreeMesh(struct ChunkMesh* mesh) {
+	Mem_Free(mesh->Vertices);
+	Mem_Free(mesh->Parts);
+	mesh->Vertices = NULL;
+	mesh->Parts    = NULL;
+}
+
+static bool Builder_OccludedLiquid(struct ChunkBuilder* b, int chunkIndex) {
 	chunkIndex += EXTCHUNK_SIZE_2; /* Checking y above */
 	return
-		Blocks.FullOpaque[Builder_Chunk[chunkIndex]]
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
+		Blocks.FullOpaque[b->Chunk[chunkIndex]]
+		&& Blocks.Draw[b->Chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
+		&& Blocks.Draw[b->Chunk[chunkIndex - 1]] != DRAW_GAS
+		&& Blocks.Draw[b->Chunk[chunkIndex + 1]] != DRAW_GAS
+		&& Blocks.Draw[b->Chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
 }
 
-static void Builder_DefaultPreStretchTiles(int x1, int y1, int z1) {
-	Mem_Set(Builder_Parts, 0, sizeof(Builder_Parts));
+#define Builder_LightCol(b, lit, face) ((lit) ? (b)->SunCols[face] : (b)->ShadowCols[face])
+#define Builder_LevelCol(b, level, face) ((b)->LevelCols[level][face])
+
+static void Builder_ShadeLightCols(PackedCol* cols, PackedCol normal) {
+	cols[FACE_YMAX] = normal;
+	PackedCol_GetShaded(normal, &cols[FACE_XMIN], &cols[FACE_ZMIN], &cols[FACE_YMIN]);
+	cols[FACE_XMAX] = cols[FACE_XMIN];
+	cols[FACE_ZMAX] = cols[FACE_ZMIN];
+}
+
+static PackedCol Builder_LerpLight(struct ChunkBuilder* b, Face face, float t) {
+	PackedCol shadow = b->ShadowCols[face], sun = b->SunCols[face];
+	PackedCol col    = PackedCol_Lerp(shadow, sun, t);
+	/* Alpha stores how lit the vertex is with CC_BUILD_SHADEDCHUNKS */
+	col.A = (uint8_t)Math_Lerp(shadow.A, sun.A, t);
+	return col;
+}
+
+static void Builder_DefaultPreStretchTiles(struct ChunkBuilder* b, int x1, int y1, int z1) {
+#ifdef CC_BUILD_SHADEDCHUNKS
+	PackedCol sun    = PACKEDCOL_CONST(255, 255, 255, CHUNK_LIGHT_SUN);
+	PackedCol shadow = PACKEDCOL_CONST(255, 255, 255, CHUNK_LIGHT_SHADOW);
+#else
+	PackedCol sun = Env.SunCol, shadow = Env.ShadowCol;
+#endif
+	int level, face;
+	Mem_Set(b->Parts, 0, sizeof(b->Parts));
+	Builder_ShadeLightCols(b->SunCols,    sun);
+	Builder_ShadeLightCols(b->ShadowCols, shadow);
+	if (!Lighting_Fancy) return;
+
+	for (level = 0; level <= LIGHTING_MAX_LEVEL; level++) {
+		for (face = 0; face < FACE_COUNT; face++) {
+			b->LevelCols[level][face] = Builder_LerpLight(b, face, level / (float)LIGHTING_MAX_LEVEL);
+		}
+	}
 }
 
-static void Builder_DefaultPostStretchTiles(int x1, int y1, int z1) {
-	int i, j, vertsCount = Builder_TotalVerticesCount();
-	if (vertsCount > Builder_VerticesElems) {
-		Mem_Free(Builder_Vertices);
+static void Builder_DefaultPostStretchTiles(struct ChunkBuilder* b, int x1, int y1, int z1) {
+	int i, j, vertsCount = Builder_TotalVerticesCount(b);
+	if (vertsCount > b->VerticesElems) {
+		Mem_Free(b->Vertices);
 		/* ensure buffer can be accessed with 64 bytes alignment by putting 2 extra vertices at end. */
-		Builder_Vertices = (VertexP3fT2fC4b*)Mem_Alloc(vertsCount + 2, sizeof(VertexP3fT2fC4b), "chunk vertices");
-		Builder_VerticesElems = vertsCount;
+		b->Vertices = (VertexP3fT2fC4b*)Mem_Alloc(vertsCount + 2, sizeof(VertexP3fT2fC4b), "chunk vertices");
+		b->VerticesElems = vertsCount;
 	}
 
 	vertsCount = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES; i++) {
 		j = i + ATLAS1D_MAX_ATLASES;
 
-		Builder1DPart_CalcOffsets(&Builder_Parts[i], &vertsCount);
-		Builder1DPart_CalcOffsets(&Builder_Parts[j], &vertsCount);
+		Builder1DPart_CalcOffsets(b, &b->Parts[i], &vertsCount);
+		Builder1DPart_CalcOffsets(b, &b->Parts[j], &vertsCount);
 	}
 }
 
-static RNGState spriteRng;
-static void Builder_DrawSprite(int count) {
+static void Builder_DrawSprite(struct ChunkBuilder* b, int count) {
 	struct Builder1DPart* part;
 	VertexP3fT2fC4b v;
 	PackedCol white = PACKEDCOL_WHITE;
@@ -471,59 +806,65 @@ static void Builder_DrawSprite(int count) {
 	float valX, valY, valZ;
 	float x1,y1,z1, x2,y2,z2;
 	
-	X  = (float)Builder_X; Y = (float)Builder_Y; Z = (float)Builder_Z;
+	X  = (float)b->X; Y = (float)b->Y; Z = (float)b->Z;
 	x1 = X + 2.50f/16.0f; y1 = Y;        z1 = Z + 2.50f/16.0f;
 	x2 = X + 13.5f/16.0f; y2 = Y + 1.0f; z2 = Z + 13.5f/16.0f;
 
 #define s_u1 0.0f
 #define s_u2 UV2_Scale
-	loc = Block_Tex(Builder_Block, FACE_XMAX);
+	loc = Block_Tex(b->Block, FACE_XMAX);
 	v1  = Atlas1D_RowId(loc) * Atlas1D.InvTileSize;
 	v2  = v1 + Atlas1D.InvTileSize * UV2_Scale;
 
-	offsetType = Blocks.SpriteOffset[Builder_Block];
+	offsetType = Blocks.SpriteOffset[b->Block];
 	if (offsetType >= 6 && offsetType <= 7) {
-		Random_Seed(&spriteRng, (Builder_X + 1217 * Builder_Z) & 0x7fffffff);
-		valX = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
-		valY = Random_Range(&spriteRng, 0,  3 + 1) / 16.0f;
-		valZ = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
+		Random_Seed(&b->SpriteRng, (b->X + 1217 * b->Z) & 0x7fffffff);
+		valX = Random_Range(&b->SpriteRng, -3, 3 + 1) / 16.0f;
+		valY = Random_Range(&b->SpriteRng, 0,  3 + 1) / 16.0f;
+		valZ = Random_Range(&b->SpriteRng, -3, 3 + 1) / 16.0f;
 
 		x1 += valX - 1.7f/16.0f; x2 += valX + 1.7f/16.0f;
 		z1 += valZ - 1.7f/16.0f; z2 += valZ + 1.7f/16.0f;
 		if (offsetType == 7) { y1 -= valY; y2 -= valY; }
 	}
 	
-	part  = &Builder_Parts[Atlas1D_Index(loc)];
-	v.Col = Builder_FullBright ? white : Lighting_Col_Sprite_Fast(Builder_X, Builder_Y, Builder_Z);
-	Block_Tint(v.Col, Builder_Block);
+	part  = &b->Parts[Atlas1D_Index(loc)];
+	if (b->FullBright) {
+		v.Col = white;
+	} else if (Lighting_Fancy) {
+		v.Col = Builder_LevelCol(b, Lighting_Level(b->X, b->Y, b->Z), FACE_YMAX);
+	} else {
+		v.Col = Builder_LightCol(b, Lighting_IsLit_Fast(b->X, b->Y, b->Z), FACE_YMAX);
+	}
+	Block_Tint(v.Col, b->Block);
 
 	/* Draw Z axis */
 	index = part->sOffset;
-	v.X = x1; v.Y = y1; v.Z = z1; v.U = s_u2; v.V = v2; Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x2;           v.Z = z2; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x1; v.Y = y1; v.Z = z1; v.U = s_u2; v.V = v2; b->Vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; b->Vertices[index + 1] = v;
+	v.X = x2;           v.Z = z2; v.U = s_u1;           b->Vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; b->Vertices[index + 3] = v;
 
 	/* Draw Z axis mirrored */
 	index += part->sAdvance;
-	v.X = x2; v.Y = y1; v.Z = z2; v.U = s_u2;           Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x1;           v.Z = z1; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x2; v.Y = y1; v.Z = z2; v.U = s_u2;           b->Vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; b->Vertices[index + 1] = v;
+	v.X = x1;           v.Z = z1; v.U = s_u1;           b->Vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; b->Vertices[index + 3] = v;
 
 	/* Draw X axis */
 	index += part->sAdvance;
-	v.X = x1; v.Y = y1; v.Z = z2; v.U = s_u2;           Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x2;           v.Z = z1; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x1; v.Y = y1; v.Z = z2; v.U = s_u2;           b->Vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; b->Vertices[index + 1] = v;
+	v.X = x2;           v.Z = z1; v.U = s_u1;           b->Vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; b->Vertices[index + 3] = v;
 
 	/* Draw X axis mirrored */
 	index += part->sAdvance;
-	v.X = x2; v.Y = y1; v.Z = z1; v.U = s_u2;           Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x1;           v.Z = z2; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x2; v.Y = y1; v.Z = z1; v.U = s_u2;           b->Vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; b->Vertices[index + 1] = v;
+	v.X = x1;           v.Z = z2; v.U = s_u1;           b->Vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; b->Vertices[index + 3] = v;
 
 	part->sOffset += 4;
 }
@@ -532,50 +873,71 @@ static void Builder_DrawSprite(int count) {
 /*########################################################################################################################*
 *--------------------------------------------------Normal mesh builder----------------------------------------------------*
 *#########################################################################################################################*/
-static PackedCol Normal_LightCol(int x, int y, int z, Face face, BlockID block) {
+/* Light level of the given face of a block, which is the light of the block that the face looks into. */
+/* (or of the block itself, when the face is inside the block. e.g. the sides of a fence post) */
+static int Normal_LightLevel(int x, int y, int z, Face face, int offset) {
+	switch (face) {
+	case FACE_XMIN: x -= offset; break;
+	case FACE_XMAX: x += offset; break;
+	case FACE_ZMIN: z -= offset; break;
+	case FACE_ZMAX: z += offset; break;
+	case FACE_YMIN: y--; break;
+	case FACE_YMAX: y++; break;
+	}
+	return Lighting_Level(x, y, z);
+}
+
+static PackedCol Normal_LightCol(struct ChunkBuilder* b, int x, int y, int z, Face face, BlockID block) {
 	PackedCol invalid = PACKEDCOL_CONST(0, 0, 0, 0);
 	int offset = (Blocks.LightOffset[block] >> face) & 1;
+	bool lit;
+
+	if (Lighting_Fancy) {
+		return Builder_LevelCol(b, Normal_LightLevel(x, y, z, face, offset), face);
+	}
 
 	switch (face) {
 	case FACE_XMIN:
-		return x < offset                ? Env.SunXSide : Lighting_Col_XSide_Fast(x - offset, y, z);
+		lit = x < offset                || Lighting_IsLit_Fast(x - offset, y, z); break;
 	case FACE_XMAX:
-		return x > (World.MaxX - offset) ? Env.SunXSide : Lighting_Col_XSide_Fast(x + offset, y, z);
+		lit = x > (World.MaxX - offset) || Lighting_IsLit_Fast(x + offset, y, z); break;
 	case FACE_ZMIN:
-		return z < offset                ? Env.SunZSide : Lighting_Col_ZSide_Fast(x, y, z - offset);
+		lit = z < offset                || Lighting_IsLit_Fast(x, y, z - offset); break;
 	case FACE_ZMAX:
-		return z > (World.MaxZ - offset) ? Env.SunZSide : Lighting_Col_ZSide_Fast(x, y, z + offset);
+		lit = z > (World.MaxZ - offset) || Lighting_IsLit_Fast(x, y, z + offset); break;
 	case FACE_YMIN:
-		return y <= 0                    ? Env.SunYMin  : Lighting_Col_YMin_Fast(x, y - offset, z);
+		lit = y <= 0                    || Lighting_IsLit_Fast(x, y - offset, z); break;
 	case FACE_YMAX:
-		return y >= World.MaxY           ? Env.SunCol   : Lighting_Col_YMax_Fast(x, (y + 1) - offset, z);
+		lit = y >= World.MaxY           || Lighting_IsLit_Fast(x, (y + 1) - offset, z); break;
+	default:
+		return invalid; /* should never happen */
 	}
-	return invalid; /* should never happen */
+	return Builder_LightCol(b, lit, face);
 }
 
-static bool Normal_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
+static bool Normal_CanStretch(struct ChunkBuilder* b, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = b->Chunk[chunkIndex];
 	PackedColUnion initCol, curCol;
 
-	if (cur != initial || Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
-	if (Builder_FullBright) return true;
+	if (cur != initial || Block_IsFaceHidden(cur, b->Chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
+	if (b->FullBright) return true;
 
-	initCol.C = Normal_LightCol(Builder_X, Builder_Y, Builder_Z, face, initial);
-	curCol.C  = Normal_LightCol(x, y, z, face, cur);
+	initCol.C = Normal_LightCol(b, b->X, b->Y, b->Z, face, initial);
+	curCol.C  = Normal_LightCol(b, x, y, z, face, cur);
 	return initCol.Raw == curCol.Raw;
 }
 
-static int NormalBuilder_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int NormalBuilder_StretchXLiquid(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
+	if (Builder_OccludedLiquid(b, chunkIndex)) return 0;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < b->ChunkEndX && stretchTile && b->Counts[countIndex] && Normal_CanStretch(b, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(b, chunkIndex)) {
+		b->Counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
@@ -584,15 +946,15 @@ static int NormalBuilder_StretchXLiquid(int countIndex, int x, int y, int z, int
 	return count;
 }
 
-static int NormalBuilder_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchX(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; bool stretchTile;
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < b->ChunkEndX && stretchTile && b->Counts[countIndex] && Normal_CanStretch(b, block, chunkIndex, x, y, z, face)) {
+		b->Counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
@@ -601,15 +963,15 @@ static int NormalBuilder_StretchX(int countIndex, int x, int y, int z, int chunk
 	return count;
 }
 
-static int NormalBuilder_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchZ(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; bool stretchTile;
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < b->ChunkEndZ && stretchTile && b->Counts[countIndex] && Normal_CanStretch(b, block, chunkIndex, x, y, z, face)) {
+		b->Counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
@@ -618,7 +980,7 @@ static int NormalBuilder_StretchZ(int countIndex, int x, int y, int z, int chunk
 	return count;
 }
 
-static void NormalBuilder_RenderBlock(int index) {	
+static void NormalBuilder_RenderBlock(struct ChunkBuilder* b, int index) {	
 	/* counters */
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
@@ -627,114 +989,103 @@ static void NormalBuilder_RenderBlock(int index) {
 	/* block state */
 	PackedCol white = PACKEDCOL_WHITE;
 	Vector3 min, max;
-	int baseOffset, lightFlags;
+	int baseOffset;
 	bool fullBright;
 
 	/* per-face state */
 	struct Builder1DPart* part;
 	TextureLoc loc;
 	PackedCol col;
-	int offset;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_FullBright = Blocks.FullBright[Builder_Block];
-		Builder_Tinted     = Blocks.Tinted[Builder_Block];
+	if (Blocks.Draw[b->Block] == DRAW_SPRITE) {
+		b->FullBright = Blocks.FullBright[b->Block];
+		b->Tinted     = Blocks.Tinted[b->Block];
 
-		count = Builder_Counts[index + FACE_YMAX];
-		if (count) Builder_DrawSprite(count);
+		count = b->Counts[index + FACE_YMAX];
+		if (count) Builder_DrawSprite(b, count);
 		return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = b->Counts[index + FACE_XMIN];
+	count_XMax = b->Counts[index + FACE_XMAX];
+	count_ZMin = b->Counts[index + FACE_ZMIN];
+	count_ZMax = b->Counts[index + FACE_ZMAX];
+	count_YMin = b->Counts[index + FACE_YMIN];
+	count_YMax = b->Counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	fullBright = Blocks.FullBright[Builder_Block];
-	baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	lightFlags = Blocks.LightOffset[Builder_Block];
+	fullBright = Blocks.FullBright[b->Block];
+	baseOffset = (Blocks.Draw[b->Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
 
-	Drawer.MinBB = Blocks.MinBB[Builder_Block]; Drawer.MinBB.Y = 1.0f - Drawer.MinBB.Y;
-	Drawer.MaxBB = Blocks.MaxBB[Builder_Block]; Drawer.MaxBB.Y = 1.0f - Drawer.MaxBB.Y;
+	b->Drawer.MinBB = Blocks.MinBB[b->Block]; b->Drawer.MinBB.Y = 1.0f - b->Drawer.MinBB.Y;
+	b->Drawer.MaxBB = Blocks.MaxBB[b->Block]; b->Drawer.MaxBB.Y = 1.0f - b->Drawer.MaxBB.Y;
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	Drawer.X1 = Builder_X + min.X; Drawer.Y1 = Builder_Y + min.Y; Drawer.Z1 = Builder_Z + min.Z;
-	Drawer.X2 = Builder_X + max.X; Drawer.Y2 = Builder_Y + max.Y; Drawer.Z2 = Builder_Z + max.Z;
+	min = Blocks.RenderMinBB[b->Block]; max = Blocks.RenderMaxBB[b->Block];
+	b->Drawer.X1 = b->X + min.X; b->Drawer.Y1 = b->Y + min.Y; b->Drawer.Z1 = b->Z + min.Z;
+	b->Drawer.X2 = b->X + max.X; b->Drawer.Y2 = b->Y + max.Y; b->Drawer.Z2 = b->Z + max.Z;
 
-	Drawer.Tinted  = Blocks.Tinted[Builder_Block];
-	Drawer.TintCol = Blocks.FogCol[Builder_Block];
+	b->Drawer.Tinted  = Blocks.Tinted[b->Block];
+	b->Drawer.TintCol = Blocks.FogCol[b->Block];
 
 	if (count_XMin) {
-		loc    = Block_Tex(Builder_Block, FACE_XMIN);
-		offset = (lightFlags >> FACE_XMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		loc    = Block_Tex(b->Block, FACE_XMIN);
+		part   = &b->Parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? white :
-			Builder_X >= offset ? Lighting_Col_XSide_Fast(Builder_X - offset, Builder_Y, Builder_Z) : Env.SunXSide;
-		Drawer_XMin(count_XMin, col, loc, &part->fVertices[FACE_XMIN]);
+		col = fullBright ? white : Normal_LightCol(b, b->X, b->Y, b->Z, FACE_XMIN, b->Block);
+		Drawer_XMin(&b->Drawer, count_XMin, col, loc, &part->fVertices[FACE_XMIN]);
 	}
 
 	if (count_XMax) {
-		loc    = Block_Tex(Builder_Block, FACE_XMAX);
-		offset = (lightFlags >> FACE_XMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		loc    = Block_Tex(b->Block, FACE_XMAX);
+		part   = &b->Parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? white :
-			Builder_X <= (World.MaxX - offset) ? Lighting_Col_XSide_Fast(Builder_X + offset, Builder_Y, Builder_Z) : Env.SunXSide;
-		Drawer_XMax(count_XMax, col, loc, &part->fVertices[FACE_XMAX]);
+		col = fullBright ? white : Normal_LightCol(b, b->X, b->Y, b->Z, FACE_XMAX, b->Block);
+		Drawer_XMax(&b->Drawer, count_XMax, col, loc, &part->fVertices[FACE_XMAX]);
 	}
 
 	if (count_ZMin) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMIN);
-		offset = (lightFlags >> FACE_ZMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		loc    = Block_Tex(b->Block, FACE_ZMIN);
+		part   = &b->Parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? white :
-			Builder_Z >= offset ? Lighting_Col_ZSide_Fast(Builder_X, Builder_Y, Builder_Z - offset) : Env.SunZSide;
-		Drawer_ZMin(count_ZMin, col, loc, &part->fVertices[FACE_ZMIN]);
+		col = fullBright ? white : Normal_LightCol(b, b->X, b->Y, b->Z, FACE_ZMIN, b->Block);
+		Drawer_ZMin(&b->Drawer, count_ZMin, col, loc, &part->fVertices[FACE_ZMIN]);
 	}
 
 	if (count_ZMax) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMAX);
-		offset = (lightFlags >> FACE_ZMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		loc    = Block_Tex(b->Block, FACE_ZMAX);
+		part   = &b->Parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? white :
-			Builder_Z <= (World.MaxZ - offset) ? Lighting_Col_ZSide_Fast(Builder_X, Builder_Y, Builder_Z + offset) : Env.SunZSide;
-		Drawer_ZMax(count_ZMax, col, loc, &part->fVertices[FACE_ZMAX]);
+		col = fullBright ? white : Normal_LightCol(b, b->X, b->Y, b->Z, FACE_ZMAX, b->Block);
+		Drawer_ZMax(&b->Drawer, count_ZMax, col, loc, &part->fVertices[FACE_ZMAX]);
 	}
 
 	if (count_YMin) {
-		loc    = Block_Tex(Builder_Block, FACE_YMIN);
-		offset = (lightFlags >> FACE_YMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		loc    = Block_Tex(b->Block, FACE_YMIN);
+		part   = &b->Parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? white : Lighting_Col_YMin_Fast(Builder_X, Builder_Y - offset, Builder_Z);
-		Drawer_YMin(count_YMin, col, loc, &part->fVertices[FACE_YMIN]);
+		col = fullBright ? white : Normal_LightCol(b, b->X, b->Y, b->Z, FACE_YMIN, b->Block);
+		Drawer_YMin(&b->Drawer, count_YMin, col, loc, &part->fVertices[FACE_YMIN]);
 	}
 
 	if (count_YMax) {
-		loc    = Block_Tex(Builder_Block, FACE_YMAX);
-		offset = (lightFlags >> FACE_YMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		loc    = Block_Tex(b->Block, FACE_YMAX);
+		part   = &b->Parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? white : Lighting_Col_YMax_Fast(Builder_X, (Builder_Y + 1) - offset, Builder_Z);
-		Drawer_YMax(count_YMax, col, loc, &part->fVertices[FACE_YMAX]);
+		col = fullBright ? white : Normal_LightCol(b, b->X, b->Y, b->Z, FACE_YMAX, b->Block);
+		Drawer_YMax(&b->Drawer, count_YMax, col, loc, &part->fVertices[FACE_YMAX]);
 	}
+	if (b->Greedy) Builder_DrawGreedy(b, index, baseOffset);
 }
 
 static void Builder_SetDefault(void) {
 	Builder_StretchXLiquid = NULL;
 	Builder_StretchX       = NULL;
 	Builder_StretchZ       = NULL;
+	Builder_CanStretch     = NULL;
 	Builder_RenderBlock    = NULL;
 
-	Builder_UseBitFlags      = false;
 	Builder_PreStretchTiles  = Builder_DefaultPreStretchTiles;
 	Builder_PostStretchTiles = Builder_DefaultPostStretchTiles;
 }
@@ -744,6 +1095,7 @@ void NormalBuilder_SetActive(void) {
 	Builder_StretchXLiquid = NormalBuilder_StretchXLiquid;
 	Builder_StretchX       = NormalBuilder_StretchX;
 	Builder_StretchZ       = NormalBuilder_StretchZ;
+	Builder_CanStretch     = Normal_CanStretch;
 	Builder_RenderBlock    = NormalBuilder_RenderBlock;
 }
 
@@ -751,12 +1103,6 @@ void NormalBuilder_SetActive(void) {
 /*########################################################################################################################*
 *-------------------------------------------------Advanced mesh builder---------------------------------------------------*
 *#########################################################################################################################*/
-static Vector3 adv_minBB, adv_maxBB;
-static int adv_initBitFlags, adv_lightFlags, adv_baseOffset;
-static int* adv_bitFlags;
-static float adv_x1, adv_y1, adv_z1, adv_x2, adv_y2, adv_z2;
-static PackedCol adv_lerp[5], adv_lerpX[5], adv_lerpZ[5], adv_lerpY[5];
-
 enum ADV_MASK {
 	/* z-1 cube points */
 	xM1_yM1_zM1, xM1_yCC_zM1, xM1_yP1_zM1,
@@ -772,7 +1118,7 @@ enum ADV_MASK {
 	xP1_yM1_zP1, xP1_yCC_zP1, xP1_yP1_zP1,
 };
 
-static int Adv_Lit(int x, int y, int z, int cIndex) {
+static int Adv_Lit(struct ChunkBuilder* b, int x, int y, int z, int cIndex) {
 	int flags, offset, lightHeight;
 	BlockID block;
 	if (y < 0 || y >= World.Height) return 7; /* all faces lit */
@@ -783,41 +1129,67 @@ static int Adv_Lit(int x, int y, int z, int cIndex) {
 	}
 
 	flags = 0;
-	block = Builder_Chunk[cIndex];
-	lightHeight    = Lighting_Heightmap[Lighting_Pack(x, z)];
-	adv_lightFlags = Blocks.LightOffset[block];
+	block = b->Chunk[cIndex];
+	/* Vertex colours use the light levels instead with flood fill lighting (see Adv_SumLevels), */
+	/* so the flags only need to track which blocks are fully lit for stretching */
+	if (Lighting_Fancy) {
+		flags |= Lighting_Level(x, y - 1, z) == LIGHTING_MAX_LEVEL ? 1 : 0;
+		flags |= Lighting_Level(x, y,     z) == LIGHTING_MAX_LEVEL ? 2 : 0;
+		flags |= Lighting_Level(x, y + 1, z) == LIGHTING_MAX_LEVEL ? 4 : 0;
+		return flags;
+	}
+
+	lightHeight    = Lighting_Height(x, z);
+	b->Adv.LightFlags = Blocks.LightOffset[block];
 
 	/* Use fact Light(Y.YMin) == Light((Y-1).YMax) */
-	offset = (adv_lightFlags >> FACE_YMIN) & 1;
+	offset = (b->Adv.LightFlags >> FACE_YMIN) & 1;
 	flags |= ((y - offset) > lightHeight ? 1 : 0);
 
 	/* Light is same for all the horizontal faces */
 	flags |= (y > lightHeight ? 2 : 0);
 
 	/* Use fact Light((Y+1).YMin) == Light(Y.YMax) */
-	offset = (adv_lightFlags >> FACE_YMAX) & 1;
+	offset = (b->Adv.LightFlags >> FACE_YMAX) & 1;
 	flags |= ((y - offset) >= lightHeight ? 4 : 0);
 
 	/* Dynamic lighting */
 	if (Blocks.FullBright[block])                       flags |= 5;
-	if (Blocks.FullBright[Builder_Chunk[cIndex + 324]]) flags |= 4;
-	if (Blocks.FullBright[Builder_Chunk[cIndex - 324]]) flags |= 1;
+	if (Blocks.FullBright[b->Chunk[cIndex + 324]]) flags |= 4;
+	if (Blocks.FullBright[b->Chunk[cIndex - 324]]) flags |= 1;
 	return flags;
 }
 
-static int Adv_ComputeLightFlags(int x, int y, int z, int cIndex) {
-	if (Builder_FullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
+/* Light level of the given cube point around the current block, with points outside the map lit like in Adv_Lit */
+static int Adv_PointLevel(struct ChunkBuilder* b, int point) {
+	/* Cube points are ordered by Z, then X, then Y (see ADV_MASK) */
+	int x = b->X + (point / 3) % 3 - 1;
+	int y = b->Y + point % 3 - 1;
+	int z = b->Z + point / 9 - 1;
+
+	if (y < 0 || y >= World.Height) return LIGHTING_MAX_LEVEL;
+	if (!World_ContainsXZ(x, z)) return y >= Builder_EdgeLevel - 1 ? LIGHTING_MAX_LEVEL : 0;
+	return Lighting_Level(x, y, z);
+}
+
+/* Sum of the light levels of the 4 cube points around a vertex, from 0 to 4 * LIGHTING_MAX_LEVEL */
+static int Adv_SumLevels(struct ChunkBuilder* b, int p1, int p2, int p3, int p4) {
+	return Adv_PointLevel(b, p1) + Adv_PointLevel(b, p2) + Adv_PointLevel(b, p3) + Adv_PointLevel(b, p4);
+}
+
+static int Adv_ComputeLightFlags(struct ChunkBuilder* b, int x, int y, int z, int cIndex) {
+	if (b->FullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
 
 	return
-		Adv_Lit(x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
-		Adv_Lit(x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
-		Adv_Lit(x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
-		Adv_Lit(x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
-		Adv_Lit(x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
-		Adv_Lit(x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
-		Adv_Lit(x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
-		Adv_Lit(x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
-		Adv_Lit(x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
+		Adv_Lit(b, x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
+		Adv_Lit(b, x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
+		Adv_Lit(b, x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
+		Adv_Lit(b, x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
+		Adv_Lit(b, x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
+		Adv_Lit(b, x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
+		Adv_Lit(b, x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
+		Adv_Lit(b, x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
+		Adv_Lit(b, x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
 }
 
 static int adv_masks[FACE_COUNT] = {
@@ -848,30 +1220,31 @@ static int adv_masks[FACE_COUNT] = {
 };
 
 
-static bool Adv_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
-	adv_bitFlags[chunkIndex] = Adv_ComputeLightFlags(x, y, z, chunkIndex);
+static bool Adv_CanStretch(struct ChunkBuilder* b, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = b->Chunk[chunkIndex];
+	b->BitFlags[chunkIndex] = Adv_ComputeLightFlags(b, x, y, z, chunkIndex);
 
 	return cur == initial
-		&& !Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)
-		&& (adv_initBitFlags == adv_bitFlags[chunkIndex]
+		&& !Block_IsFaceHidden(cur, b->Chunk[chunkIndex + Builder_Offsets[face]], face)
+		&& (b->Adv.InitBitFlags == b->BitFlags[chunkIndex]
 		/* Check that this face is either fully bright or fully in shadow */
-		&& (adv_initBitFlags == 0 || (adv_initBitFlags & adv_masks[face]) == adv_masks[face]));
+		/* (with flood fill lighting, blocks that are not fully lit can still have different levels) */
+		&& ((b->Adv.InitBitFlags == 0 && !Lighting_Fancy) || (b->Adv.InitBitFlags & adv_masks[face]) == adv_masks[face]));
 }
 
-static int Adv_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int Adv_StretchXLiquid(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	if (Builder_OccludedLiquid(b, chunkIndex)) return 0;
+	b->Adv.InitBitFlags = Adv_ComputeLightFlags(b, x, y, z, chunkIndex);
+	b->BitFlags[chunkIndex] = b->Adv.InitBitFlags;
 
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < b->ChunkEndX && stretchTile && b->Counts[countIndex] && Adv_CanStretch(b, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(b, chunkIndex)) {
+		b->Counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
@@ -880,18 +1253,18 @@ static int Adv_StretchXLiquid(int countIndex, int x, int y, int z, int chunkInde
 	return count;
 }
 
-static int Adv_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchX(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	b->Adv.InitBitFlags = Adv_ComputeLightFlags(b, x, y, z, chunkIndex);
+	b->BitFlags[chunkIndex] = b->Adv.InitBitFlags;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < b->ChunkEndX && stretchTile && b->Counts[countIndex] && Adv_CanStretch(b, block, chunkIndex, x, y, z, face)) {
+		b->Counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
@@ -900,18 +1273,18 @@ static int Adv_StretchX(int countIndex, int x, int y, int z, int chunkIndex, Blo
 	return count;
 }
 
-static int Adv_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchZ(struct ChunkBuilder* b, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	b->Adv.InitBitFlags = Adv_ComputeLightFlags(b, x, y, z, chunkIndex);
+	b->BitFlags[chunkIndex] = b->Adv.InitBitFlags;
 
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < b->ChunkEndZ && stretchTile && b->Counts[countIndex] && Adv_CanStretch(b, block, chunkIndex, x, y, z, face)) {
+		b->Counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
@@ -922,309 +1295,313 @@ static int Adv_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, Blo
 
 
 #define Adv_CountBits(F, a, b, c, d) (((F >> a) & 1) + ((F >> b) & 1) + ((F >> c) & 1) + ((F >> d) & 1))
+/* Number of lit cube points around a vertex, or the sum of their light levels with flood fill lighting */
+#define Adv_CountLit(F, p1, p2, p3, p4) (Lighting_Fancy ? Adv_SumLevels(b, p1, p2, p3, p4) : Adv_CountBits(F, p1, p2, p3, p4))
+/* Colour of a vertex from its Adv_CountLit */
+#define Adv_VertexCol(lerp, face, count) (b->FullBright ? white : Lighting_Fancy ? Builder_LevelCol(b, ((count) + 2) / 4, face) : b->Adv.lerp[count])
 #define Adv_Tint(c) c.R = (uint8_t)(c.R * tint.R / 255); c.G = (uint8_t)(c.G * tint.G / 255); c.B = (uint8_t)(c.B * tint.B / 255);
 
-static void Adv_DrawXMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMIN);
+static void Adv_DrawXMin(struct ChunkBuilder* b, int count) {
+	TextureLoc texLoc = Block_Tex(b->Block, FACE_XMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.Z, u2 = (count - 1) + adv_maxBB.Z * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = b->Adv.MinBB.Z, u2 = (count - 1) + b->Adv.MaxBB.Z * UV2_Scale;
+	float v1 = vOrigin + b->Adv.MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + b->Adv.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &b->Parts[b->Adv.BaseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aY0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xM1_yM1_zCC, xM1_yCC_zCC);
-	int aY0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xM1_yM1_zCC, xM1_yCC_zCC);
-	int aY1_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xM1_yP1_zCC, xM1_yCC_zCC);
-	int aY1_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xM1_yP1_zCC, xM1_yCC_zCC);
+	int F = b->BitFlags[b->ChunkIndex];
+	int aY0_Z0 = Adv_CountLit(F, xM1_yM1_zM1, xM1_yCC_zM1, xM1_yM1_zCC, xM1_yCC_zCC);
+	int aY0_Z1 = Adv_CountLit(F, xM1_yM1_zP1, xM1_yCC_zP1, xM1_yM1_zCC, xM1_yCC_zCC);
+	int aY1_Z0 = Adv_CountLit(F, xM1_yP1_zM1, xM1_yCC_zM1, xM1_yP1_zCC, xM1_yCC_zCC);
+	int aY1_Z1 = Adv_CountLit(F, xM1_yP1_zP1, xM1_yCC_zP1, xM1_yP1_zCC, xM1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = Adv_VertexCol(LerpX, FACE_XMIN, aY0_Z0), col1_0 = Adv_VertexCol(LerpX, FACE_XMIN, aY1_Z0);
+	PackedCol col1_1 = Adv_VertexCol(LerpX, FACE_XMIN, aY1_Z1), col0_1 = Adv_VertexCol(LerpX, FACE_XMIN, aY0_Z1);
 	VertexP3fT2fC4b* vertices, v;
 
-	if (Builder_Tinted) {
-		tint = Blocks.FogCol[Builder_Block];
+	if (b->Tinted) {
+		tint = Blocks.FogCol[b->Block];
 		Adv_Tint(col0_0); Adv_Tint(col1_0); Adv_Tint(col1_1); Adv_Tint(col0_1);
 	}
 
 	vertices = part->fVertices[FACE_XMIN];
-	v.X = adv_x1;
+	v.X = b->Adv.X1;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.Y = adv_y2; v.Z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.Z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
-		v.Y = adv_y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.Y = b->Adv.Y2; v.Z = b->Adv.Z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.Y = b->Adv.Y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.Z = b->Adv.Z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.Y = b->Adv.Y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.Y = adv_y2; v.Z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		              v.Z = adv_z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.Z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.Y = b->Adv.Y2; v.Z = b->Adv.Z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		              v.Z = b->Adv.Z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
+		v.Y = b->Adv.Y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.Z = b->Adv.Z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
 	}
 	part->fVertices[FACE_XMIN] = vertices;
 }
 
-static void Adv_DrawXMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMAX);
+static void Adv_DrawXMax(struct ChunkBuilder* b, int count) {
+	TextureLoc texLoc = Block_Tex(b->Block, FACE_XMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.Z), u2 = (1 - adv_maxBB.Z) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - b->Adv.MinBB.Z), u2 = (1 - b->Adv.MaxBB.Z) * UV2_Scale;
+	float v1 = vOrigin + b->Adv.MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + b->Adv.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &b->Parts[b->Adv.BaseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aY0_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xP1_yM1_zCC, xP1_yCC_zCC);
-	int aY0_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xP1_yM1_zCC, xP1_yCC_zCC);
-	int aY1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xP1_yP1_zCC, xP1_yCC_zCC);
-	int aY1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xP1_yP1_zCC, xP1_yCC_zCC);
+	int F = b->BitFlags[b->ChunkIndex];
+	int aY0_Z0 = Adv_CountLit(F, xP1_yM1_zM1, xP1_yCC_zM1, xP1_yM1_zCC, xP1_yCC_zCC);
+	int aY0_Z1 = Adv_CountLit(F, xP1_yM1_zP1, xP1_yCC_zP1, xP1_yM1_zCC, xP1_yCC_zCC);
+	int aY1_Z0 = Adv_CountLit(F, xP1_yP1_zM1, xP1_yCC_zM1, xP1_yP1_zCC, xP1_yCC_zCC);
+	int aY1_Z1 = Adv_CountLit(F, xP1_yP1_zP1, xP1_yCC_zP1, xP1_yP1_zCC, xP1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = Adv_VertexCol(LerpX, FACE_XMIN, aY0_Z0), col1_0 = Adv_VertexCol(LerpX, FACE_XMIN, aY1_Z0);
+	PackedCol col1_1 = Adv_VertexCol(LerpX, FACE_XMIN, aY1_Z1), col0_1 = Adv_VertexCol(LerpX, FACE_XMIN, aY0_Z1);
 	VertexP3fT2fC4b* vertices, v;
 
-	if (Builder_Tinted) {
-		tint = Blocks.FogCol[Builder_Block];
+	if (b->Tinted) {
+		tint = Blocks.FogCol[b->Block];
 		Adv_Tint(col0_0); Adv_Tint(col1_0); Adv_Tint(col1_1); Adv_Tint(col0_1);
 	}
 
 	vertices = part->fVertices[FACE_XMAX];
-	v.X = adv_x2;
+	v.X = b->Adv.X2;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.Y = adv_y2; v.Z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		              v.Z = adv_z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.Z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.Y = b->Adv.Y2; v.Z = b->Adv.Z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		              v.Z = b->Adv.Z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.Y = b->Adv.Y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.Z = b->Adv.Z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
 	} else {
-		v.Y = adv_y2; v.Z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.Z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		v.Y = adv_y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.Y = b->Adv.Y2; v.Z = b->Adv.Z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.Y = b->Adv.Y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.Z = b->Adv.Z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.Y = b->Adv.Y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_XMAX] = vertices;
 }
 
-static void Adv_DrawZMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMIN);
+static void Adv_DrawZMin(struct ChunkBuilder* b, int count) {
+	TextureLoc texLoc = Block_Tex(b->Block, FACE_ZMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.X), u2 = (1 - adv_maxBB.X) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - b->Adv.MinBB.X), u2 = (1 - b->Adv.MaxBB.X) * UV2_Scale;
+	float v1 = vOrigin + b->Adv.MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + b->Adv.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &b->Parts[b->Adv.BaseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
-	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
-	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
-	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
+	int F = b->BitFlags[b->ChunkIndex];
+	int aX0_Y0 = Adv_CountLit(F, xM1_yM1_zM1, xM1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
+	int aX0_Y1 = Adv_CountLit(F, xM1_yP1_zM1, xM1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
+	int aX1_Y0 = Adv_CountLit(F, xP1_yM1_zM1, xP1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
+	int aX1_Y1 = Adv_CountLit(F, xP1_yP1_zM1, xP1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col0_0 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX0_Y0), col1_0 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX1_Y0);
+	PackedCol col1_1 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX1_Y1), col0_1 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX0_Y1);
 	VertexP3fT2fC4b* vertices, v;
 
-	if (Builder_Tinted) {
-		tint = Blocks.FogCol[Builder_Block];
+	if (b->Tinted) {
+		tint = Blocks.FogCol[b->Block];
 		Adv_Tint(col0_0); Adv_Tint(col1_0); Adv_Tint(col1_1); Adv_Tint(col0_1);
 	}
 
 	vertices = part->fVertices[FACE_ZMIN];
-	v.Z = adv_z1;
+	v.Z = b->Adv.Z1;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.X = adv_x2 + (count - 1); v.Y = adv_y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.Y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1); v.Y = b->Adv.Y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.X = b->Adv.X1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.Y = b->Adv.Y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.X = adv_x1;               v.Y = adv_y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
-		                            v.Y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.Y = adv_y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.X = b->Adv.X1;               v.Y = b->Adv.Y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
+		                            v.Y = b->Adv.Y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.Y = b->Adv.Y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_ZMIN] = vertices;
 }
 
-static void Adv_DrawZMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMAX);
+static void Adv_DrawZMax(struct ChunkBuilder* b, int count) {
+	TextureLoc texLoc = Block_Tex(b->Block, FACE_ZMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.X, u2 = (count - 1) + adv_maxBB.X * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = b->Adv.MinBB.X, u2 = (count - 1) + b->Adv.MaxBB.X * UV2_Scale;
+	float v1 = vOrigin + b->Adv.MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + b->Adv.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &b->Parts[b->Adv.BaseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
-	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
-	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
-	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
+	int F = b->BitFlags[b->ChunkIndex];
+	int aX0_Y0 = Adv_CountLit(F, xM1_yM1_zP1, xM1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
+	int aX1_Y0 = Adv_CountLit(F, xP1_yM1_zP1, xP1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
+	int aX0_Y1 = Adv_CountLit(F, xM1_yP1_zP1, xM1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
+	int aX1_Y1 = Adv_CountLit(F, xP1_yP1_zP1, xP1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col1_1 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX1_Y1), col1_0 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX1_Y0);
+	PackedCol col0_0 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX0_Y0), col0_1 = Adv_VertexCol(LerpZ, FACE_ZMIN, aX0_Y1);
 	VertexP3fT2fC4b* vertices, v;
 
-	if (Builder_Tinted) {
-		tint = Blocks.FogCol[Builder_Block];
+	if (b->Tinted) {
+		tint = Blocks.FogCol[b->Block];
 		Adv_Tint(col0_0); Adv_Tint(col1_0); Adv_Tint(col1_1); Adv_Tint(col0_1);
 	}
 
 	vertices = part->fVertices[FACE_ZMAX];
-	v.Z = adv_z2;
+	v.Z = b->Adv.Z2;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.X = adv_x1;               v.Y = adv_y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
-		                            v.Y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.Y = adv_y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.X = b->Adv.X1;               v.Y = b->Adv.Y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
+		                            v.Y = b->Adv.Y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.Y = b->Adv.Y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.X = adv_x2 + (count - 1); v.Y = adv_y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.Y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1); v.Y = b->Adv.Y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.X = b->Adv.X1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.Y = b->Adv.Y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_ZMAX] = vertices;
 }
 
-static void Adv_DrawYMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMIN);
+static void Adv_DrawYMin(struct ChunkBuilder* b, int count) {
+	TextureLoc texLoc = Block_Tex(b->Block, FACE_YMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.X, u2 = (count - 1) + adv_maxBB.X * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.Z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = b->Adv.MinBB.X, u2 = (count - 1) + b->Adv.MaxBB.X * UV2_Scale;
+	float v1 = vOrigin + b->Adv.MinBB.Z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + b->Adv.MaxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &b->Parts[b->Adv.BaseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
-	int aX1_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
-	int aX0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
-	int aX1_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
+	int F = b->BitFlags[b->ChunkIndex];
+	int aX0_Z0 = Adv_CountLit(F, xM1_yM1_zM1, xM1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
+	int aX1_Z0 = Adv_CountLit(F, xP1_yM1_zM1, xP1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
+	int aX0_Z1 = Adv_CountLit(F, xM1_yM1_zP1, xM1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
+	int aX1_Z1 = Adv_CountLit(F, xP1_yM1_zP1, xP1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_1 = Builder_FullBright ? white : adv_lerpY[aX0_Z1], col1_1 = Builder_FullBright ? white : adv_lerpY[aX1_Z1];
-	PackedCol col1_0 = Builder_FullBright ? white : adv_lerpY[aX1_Z0], col0_0 = Builder_FullBright ? white : adv_lerpY[aX0_Z0];
+	PackedCol col0_1 = Adv_VertexCol(LerpY, FACE_YMIN, aX0_Z1), col1_1 = Adv_VertexCol(LerpY, FACE_YMIN, aX1_Z1);
+	PackedCol col1_0 = Adv_VertexCol(LerpY, FACE_YMIN, aX1_Z0), col0_0 = Adv_VertexCol(LerpY, FACE_YMIN, aX0_Z0);
 	VertexP3fT2fC4b* vertices, v;
 
-	if (Builder_Tinted) {
-		tint = Blocks.FogCol[Builder_Block];
+	if (b->Tinted) {
+		tint = Blocks.FogCol[b->Block];
 		Adv_Tint(col0_0); Adv_Tint(col1_0); Adv_Tint(col1_1); Adv_Tint(col0_1);
 	}
 
 	vertices = part->fVertices[FACE_YMIN];
-	v.Y = adv_y1;
+	v.Y = b->Adv.Y1;
 	if (aX0_Z1 + aX1_Z0 > aX0_Z0 + aX1_Z1) {
-		v.X = adv_x2 + (count - 1); v.Z = adv_z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.Z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1); v.Z = b->Adv.Z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.X = b->Adv.X1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.Z = b->Adv.Z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	} else {
-		v.X = adv_x1;               v.Z = adv_z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
-		                            v.Z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.Z = adv_z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.X = b->Adv.X1;               v.Z = b->Adv.Z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
+		                            v.Z = b->Adv.Z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.Z = b->Adv.Z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
 	}
 	part->fVertices[FACE_YMIN] = vertices;
 }
 
-static void Adv_DrawYMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMAX);
+static void Adv_DrawYMax(struct ChunkBuilder* b, int count) {
+	TextureLoc texLoc = Block_Tex(b->Block, FACE_YMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.X, u2 = (count - 1) + adv_maxBB.X * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.Z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = b->Adv.MinBB.X, u2 = (count - 1) + b->Adv.MaxBB.X * UV2_Scale;
+	float v1 = vOrigin + b->Adv.MinBB.Z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + b->Adv.MaxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &b->Parts[b->Adv.BaseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
-	int aX1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
-	int aX0_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
-	int aX1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
+	int F = b->BitFlags[b->ChunkIndex];
+	int aX0_Z0 = Adv_CountLit(F, xM1_yP1_zM1, xM1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
+	int aX1_Z0 = Adv_CountLit(F, xP1_yP1_zM1, xP1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
+	int aX0_Z1 = Adv_CountLit(F, xM1_yP1_zP1, xM1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
+	int aX1_Z1 = Adv_CountLit(F, xP1_yP1_zP1, xP1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerp[aX0_Z0], col1_0 = Builder_FullBright ? white : adv_lerp[aX1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerp[aX1_Z1], col0_1 = Builder_FullBright ? white : adv_lerp[aX0_Z1];
+	PackedCol col0_0 = Adv_VertexCol(Lerp, FACE_YMAX, aX0_Z0), col1_0 = Adv_VertexCol(Lerp, FACE_YMAX, aX1_Z0);
+	PackedCol col1_1 = Adv_VertexCol(Lerp, FACE_YMAX, aX1_Z1), col0_1 = Adv_VertexCol(Lerp, FACE_YMAX, aX0_Z1);
 	VertexP3fT2fC4b* vertices, v;
 
-	if (Builder_Tinted) {
-		tint = Blocks.FogCol[Builder_Block];
+	if (b->Tinted) {
+		tint = Blocks.FogCol[b->Block];
 		Adv_Tint(col0_0); Adv_Tint(col1_0); Adv_Tint(col1_1); Adv_Tint(col0_1);
 	}
 
 	vertices = part->fVertices[FACE_YMAX];
-	v.Y = adv_y2;
+	v.Y = b->Adv.Y2;
 	if (aX0_Z0 + aX1_Z1 > aX0_Z1 + aX1_Z0) {
-		v.X = adv_x2 + (count - 1); v.Z = adv_z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.Z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1); v.Z = b->Adv.Z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.X = b->Adv.X1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.Z = b->Adv.Z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.X = adv_x1;               v.Z = adv_z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
-		                            v.Z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.Z = adv_z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.X = b->Adv.X1;               v.Z = b->Adv.Z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
+		                            v.Z = b->Adv.Z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.X = b->Adv.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.Z = b->Adv.Z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_YMAX] = vertices;
 }
 
-static void Adv_RenderBlock(int index) {
+static void Adv_RenderBlock(struct ChunkBuilder* b, int index) {
 	Vector3 min, max;
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
 	int count;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_FullBright = Blocks.FullBright[Builder_Block];
-		Builder_Tinted     = Blocks.Tinted[Builder_Block];
+	if (Blocks.Draw[b->Block] == DRAW_SPRITE) {
+		b->FullBright = Blocks.FullBright[b->Block];
+		b->Tinted     = Blocks.Tinted[b->Block];
 
-		count = Builder_Counts[index + FACE_YMAX];
-		if (count) Builder_DrawSprite(count);
+		count = b->Counts[index + FACE_YMAX];
+		if (count) Builder_DrawSprite(b, count);
 		return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = b->Counts[index + FACE_XMIN];
+	count_XMax = b->Counts[index + FACE_XMAX];
+	count_ZMin = b->Counts[index + FACE_ZMIN];
+	count_ZMax = b->Counts[index + FACE_ZMAX];
+	count_YMin = b->Counts[index + FACE_YMIN];
+	count_YMax = b->Counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	Builder_FullBright = Blocks.FullBright[Builder_Block];
-	adv_baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	adv_lightFlags = Blocks.LightOffset[Builder_Block];
-	Builder_Tinted = Blocks.Tinted[Builder_Block];
-
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	adv_x1 = Builder_X + min.X; adv_y1 = Builder_Y + min.Y; adv_z1 = Builder_Z + min.Z;
-	adv_x2 = Builder_X + max.X; adv_y2 = Builder_Y + max.Y; adv_z2 = Builder_Z + max.Z;
-
-	adv_minBB = Blocks.MinBB[Builder_Block]; adv_maxBB = Blocks.MaxBB[Builder_Block];
-	adv_minBB.Y = 1.0f - adv_minBB.Y; adv_maxBB.Y = 1.0f - adv_maxBB.Y;
-
-	if (count_XMin) Adv_DrawXMin(count_XMin);
-	if (count_XMax) Adv_DrawXMax(count_XMax);
-	if (count_ZMin) Adv_DrawZMin(count_ZMin);
-	if (count_ZMax) Adv_DrawZMax(count_ZMax);
-	if (count_YMin) Adv_DrawYMin(count_YMin);
-	if (count_YMax) Adv_DrawYMax(count_YMax);
+	b->FullBright = Blocks.FullBright[b->Block];
+	b->Adv.BaseOffset = (Blocks.Draw[b->Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	b->Adv.LightFlags = Blocks.LightOffset[b->Block];
+	b->Tinted = Blocks.Tinted[b->Block];
+
+	min = Blocks.RenderMinBB[b->Block]; max = Blocks.RenderMaxBB[b->Block];
+	b->Adv.X1 = b->X + min.X; b->Adv.Y1 = b->Y + min.Y; b->Adv.Z1 = b->Z + min.Z;
+	b->Adv.X2 = b->X + max.X; b->Adv.Y2 = b->Y + max.Y; b->Adv.Z2 = b->Z + max.Z;
+
+	b->Adv.MinBB = Blocks.MinBB[b->Block]; b->Adv.MaxBB = Blocks.MaxBB[b->Block];
+	b->Adv.MinBB.Y = 1.0f - b->Adv.MinBB.Y; b->Adv.MaxBB.Y = 1.0f - b->Adv.MaxBB.Y;
+
+	if (count_XMin) Adv_DrawXMin(b, count_XMin);
+	if (count_XMax) Adv_DrawXMax(b, count_XMax);
+	if (count_ZMin) Adv_DrawZMin(b, count_ZMin);
+	if (count_ZMax) Adv_DrawZMax(b, count_ZMax);
+	if (count_YMin) Adv_DrawYMin(b, count_YMin);
+	if (count_YMax) Adv_DrawYMax(b, count_YMax);
+	if (b->Greedy) Builder_DrawGreedy(b, index, b->Adv.BaseOffset);
 }
 
-static void Adv_PreStretchTiles(int x1, int y1, int z1) {
+static void Adv_PreStretchTiles(struct ChunkBuilder* b, int x1, int y1, int z1) {
 	int i;
-	Builder_DefaultPreStretchTiles(x1, y1, z1);
-	adv_bitFlags = Builder_BitFlags;
+	Builder_DefaultPreStretchTiles(b, x1, y1, z1);
 
 	for (i = 0; i <= 4; i++) {
-		adv_lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / 4.0f);
-		adv_lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / 4.0f);
-		adv_lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / 4.0f);
-		adv_lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / 4.0f);
+		b->Adv.Lerp[i]  = Builder_LerpLight(b, FACE_YMAX, i / 4.0f);
+		b->Adv.LerpX[i] = Builder_LerpLight(b, FACE_XMIN, i / 4.0f);
+		b->Adv.LerpZ[i] = Builder_LerpLight(b, FACE_ZMIN, i / 4.0f);
+		b->Adv.LerpY[i] = Builder_LerpLight(b, FACE_YMIN, i / 4.0f);
 	}
 }
 
@@ -1233,15 +1610,231 @@ void AdvBuilder_SetActive(void) {
 	Builder_StretchXLiquid  = Adv_StretchXLiquid;
 	Builder_StretchX        = Adv_StretchX;
 	Builder_StretchZ        = Adv_StretchZ;
+	Builder_CanStretch      = Adv_CanStretch;
 	Builder_RenderBlock     = Adv_RenderBlock;
 	Builder_PreStretchTiles = Adv_PreStretchTiles;
 }
 
 
+/*########################################################################################################################*
+*----------------------------------------------------Builder workers------------------------------------------------------*
+*#########################################################################################################################*/
+#define BUILDER_MAX_WORKERS 8
+/* Max number of meshes that can be pending, being built, or waiting to be hooked at once. */
+#define BUILDER_MAX_JOBS 64
+
+int Builder_WorkersCount;
+static void* builder_threads[BUILDER_MAX_WORKERS];
+static void* builder_mutex;
+static void* builder_waitable;
+/* Signalled whenever the last mesh being built finishes, see Builder_CancelChunks */
+static void* builder_idleWaitable;
+static volatile bool builder_terminate;
+
+/* Pending and finished meshes are both queues, so meshes are built and hooked in the order they were queued */
+static struct ChunkMesh builder_pending[BUILDER_MAX_JOBS];
+static struct ChunkMesh builder_finished[BUILDER_MAX_JOBS];
+static int builder_pendingHead,  builder_pendingCount;
+static int builder_finishedHead, builder_finishedCount;
+static int builder_running;
+/* Incremented whenever pending builds are cancelled, so meshes from builds in progress are discarded */
+static int builder_generation;
+/* Number of meshes workers have started building, see Builder_StartedBuilds */
+static uint32_t builder_started;
+/* Value of builder_started when each worker started its current mesh, 0 if the worker is idle */
+static uint32_t builder_workerStarts[BUILDER_MAX_WORKERS];
+static int builder_workersCreated;
+
+static void Builder_WorkerLoop(void) {
+	struct ChunkBuilder* b;
+	struct ChunkMesh mesh;
+	bool hasMesh, stop, moreMeshes;
+	int generation, index, worker;
+	b = (struct ChunkBuilder*)Mem_AllocCleared(1, sizeof(struct ChunkBuilder), "chunk builder");
+
+	Mutex_Lock(builder_mutex);
+	worker = builder_workersCreated++;
+	Mutex_Unlock(builder_mutex);
+
+	for (;;) {
+		hasMesh = false;
+
+		Mutex_Lock(builder_mutex);
+		{
+			stop = builder_terminate;
+			if (!stop && builder_pendingCount) {
+				mesh = builder_pending[builder_pendingHead];
+				builder_pendingHead = (builder_pendingHead + 1) % BUILDER_MAX_JOBS;
+				builder_pendingCount--;
+
+				builder_running++;
+				builder_workerStarts[worker] = ++builder_started;
+				generation = builder_generation;
+				hasMesh    = true;
+			}
+			moreMeshes = builder_pendingCount > 0;
+		}
+		Mutex_Unlock(builder_mutex);
+
+		/* Each signal only wakes up one worker, so pass it on to the next worker */
+		if (stop || moreMeshes) Waitable_Signal(builder_waitable);
+		if (stop) break;
+		/* Block until main thread queues more chunks to build */
+		if (!hasMesh) { Waitable_Wait(builder_waitable); continue; }
+
+		Builder_BuildMesh(b, &mesh);
+		/* Mesh now owns the vertices, so allocate a new buffer for the next chunk */
+		if (mesh.Vertices) { b->Vertices = NULL; b->VerticesElems = 0; }
+
+		Mutex_Lock(builder_mutex);
+		{
+			builder_running--;
+			builder_workerStarts[worker] = 0;
+			if (generation == builder_generation) {
+				index = (builder_finishedHead + builder_finishedCount) % BUILDER_MAX_JOBS;
+				builder_finished[index] = mesh;
+				builder_finishedCount++;
+			} else {
+				Builder_FreeMesh(&mesh);
+			}
+			if (!builder_running) Waitable_Signal(builder_idleWaitable);
+		}
+		Mutex_Unlock(builder_mutex);
+	}
+
+	Mem_Free(b->Vertices);
+	Mem_Free(b);
+}
+
+bool Builder_QueueChunk(struct ChunkInfo* info) {
+	int index;
+	bool queued = false;
+	if (!Builder_WorkersCount) return false;
+
+	Mutex_Lock(builder_mutex);
+	{
+		if (builder_pendingCount + builder_running + builder_finishedCount < BUILDER_MAX_JOBS) {
+			index = (builder_pendingHead + builder_pendingCount) % BUILDER_MAX_JOBS;
+			Builder_InitMesh(&builder_pending[index], info);
+			builder_pendingCount++;
+			queued = true;
+		}
+	}
+	Mutex_Unlock(builder_mutex);
+
+	if (queued) Waitable_Signal(builder_waitable);
+	return queued;
+}
+
+struct ChunkInfo* Builder_HookNextChunk(void) {
+	struct ChunkMesh mesh;
+	bool hasMesh;
+
+	for (;;) {
+		hasMesh = false;
+
+		Mutex_Lock(builder_mutex);
+		{
+			if (builder_finishedCount) {
+				mesh = builder_finished[builder_finishedHead];
+				builder_finishedHead = (builder_finishedHead + 1) % BUILDER_MAX_JOBS;
+				builder_finishedCount--;
+				hasMesh = true;
+			}
+		}
+		Mutex_Unlock(builder_mutex);
+		if (!hasMesh) return NULL;
+
+		mesh.Info->Building = false;
+		/* Atlases changed while building, so the parts no longer line up */
+		if (mesh.AtlasesCount != MapRenderer_1DUsedCount) {
+			MapRenderer_RefreshChunk(mesh.X >> CHUNK_SHIFT, mesh.Y >> CHUNK_SHIFT, mesh.Z >> CHUNK_SHIFT);
+			Builder_FreeMesh(&mesh); continue;
+		}
+
+		MapRenderer_DeleteChunk(mesh.Info);
+		Builder_HookMesh(&mesh);
+		Builder_FreeMesh(&mesh);
+		return mesh.Info;
+	}
+}
+
+void Builder_CancelChunks(void) {
+	int i, running;
+	if (!Builder_WorkersCount) return;
+
+	Mutex_Lock(builder_mutex);
+	{
+		builder_generation++;
+		builder_pendingCount = 0;
+
+		for (i = 0; i < builder_finishedCount; i++) {
+			Builder_FreeMesh(&builder_finished[(builder_finishedHead + i) % BUILDER_MAX_JOBS]);
+		}
+		builder_finishedCount = 0;
+	}
+	Mutex_Unlock(builder_mutex);
+
+	/* Builds in progress may still be reading from the world */
+	for (;;) {
+		Mutex_Lock(builder_mutex);
+		running = builder_running;
+		Mutex_Unlock(builder_mutex);
+
+		if (!running) return;
+		Waitable_Wait(builder_idleWaitable);
+	}
+}
+
+uint32_t Builder_StartedBuilds(void) {
+	uint32_t started;
+	if (!Builder_WorkersCount) return 0;
+
+	Mutex_Lock(builder_mutex);
+	started = builder_started;
+	Mutex_Unlock(builder_mutex);
+	return started;
+}
+
+bool Builder_FinishedBuilds(uint32_t started) {
+	bool finished = true;
+	int i;
+	if (!Builder_WorkersCount) return true;
+
+	Mutex_Lock(builder_mutex);
+	for (i = 0; i < Builder_WorkersCount; i++) {
+		if (builder_workerStarts[i] && builder_workerStarts[i] <= started) finished = false;
+	}
+	Mutex_Unlock(builder_mutex);
+	return finished;
+}
+
+static void Builder_StartWorkers(void) {
+	int i;
+#ifdef CC_BUILD_WEB
+	Builder_WorkersCount = 0;
+#else
+	Builder_WorkersCount = Options_GetInt(OPT_BUILDER_THREADS, 0, BUILDER_MAX_WORKERS, 2);
+#endif
+	if (!Builder_WorkersCount) return;
+
+	builder_terminate    = false;
+	builder_mutex        = Mutex_Create();
+	builder_waitable     = Waitable_Create();
+	builder_idleWaitable = Waitable_Create();
+
+	builder_workersCreated = 0;
+	for (i = 0; i < Builder_WorkersCount; i++) {
+		builder_threads[i] = Thread_Start(Builder_WorkerLoop, false);
+	}
+}
+
+
 /*########################################################################################################################*
 *---------------------------------------------------Builder interface-----------------------------------------------------*
 *#########################################################################################################################*/
-bool Builder_SmoothLighting;
+static struct ChunkBuilder builder_main;
+bool Builder_SmoothLighting, Builder_GreedyMeshing;
 void Builder_ApplyActive(void) {
 	if (Builder_SmoothLighting) {
 		AdvBuilder_SetActive();
@@ -1259,6 +1852,109 @@ void Builder_Init(void) {
 	Builder_Offsets[FACE_YMAX] =  EXTCHUNK_SIZE_2;
 
 	Builder_SmoothLighting = Options_GetBool(OPT_SMOOTH_LIGHTING, false);
+	Builder_GreedyMeshing  = Options_GetBool(OPT_GREEDY_MESHING, false);
+	Builder_StartWorkers();
+}
+
+void Builder_Free(void) {
+	int i;
+	Mem_Free(builder_main.Vertices);
+	builder_main.Vertices      = NULL;
+	builder_main.VerticesElems = 0;
+	if (!Builder_WorkersCount) return;
+
+	Builder_CancelChunks();
+	builder_terminate = true;
+	/* Each worker wakes up the next one when stopping */
+	Waitable_Signal(builder_waitable);
+	for (i = 0; i < Builder_WorkersCount; i++) {
+		Thread_Join(builder_threads[i]);
+	}
+
+	Waitable_Free(builder_waitable);
+	Waitable_Free(builder_idleWaitable);
+	Mutex_Free(builder_mutex);
+	Builder_WorkersCount = 0;
+}
+
+void Builder_MakeChunk(struct ChunkInfo* info) {
+	struct ChunkMesh mesh;
+	Builder_InitMesh(&mesh, info);
+	Builder_BuildMesh(&builder_main, &mesh);
+	Builder_HookMesh(&mesh);
+
+	/* Main thread builder keeps reusing its own vertices buffer */
+	mesh.Vertices = NULL;
+	Builder_FreeMesh(&mesh);
+}
+
+void Builder_Benchmark(struct BuilderBenchmark* bench) {
+	struct ChunkBuilder* b = &builder_main;
+	struct ChunkMesh mesh;
+	uint64_t beg, end;
+	int x, y, z;
+
+	Mem_Set(bench, 0, sizeof(struct BuilderBenchmark));
+	Mem_Set(b->StageTicks, 0, sizeof(b->StageTicks));
+	b->Benchmarking = true;
+	beg = Stopwatch_Measure();
+
+	for (y = 0; y < World.Height; y += CHUNK_SIZE) {
+		for (z = 0; z < World.Length; z += CHUNK_SIZE) {
+			for (x = 0; x < World.Width; x += CHUNK_SIZE) {
+				mesh.Info = NULL;
+				mesh.X = x; mesh.Y = y; mesh.Z = z;
+				mesh.AtlasesCount = MapRenderer_1DUsedCount;
+
+				Builder_BuildMesh(b, &mesh);
+				bench->Chunks++;
+				bench->Vertices += mesh.VerticesCount;
+				/* Main thread builder keeps reusing its own vertices buffer */
+				mesh.Vertices = NULL;
+				Builder_FreeMesh(&mesh);
+			}
+		}
+	}
+
+	end = Stopwatch_Measure();
+	b->Benchmarking = false;
+	bench->Bytes       = (uint64_t)bench->Vertices * sizeof(ChunkVertex);
+	bench->TotalTime   = Stopwatch_ElapsedMicroseconds(beg, end);
+	bench->ReadTime    = Stopwatch_ElapsedMicroseconds(0, b->StageTicks[BUILDER_STAGE_READ]);
+	bench->StretchTime = Stopwatch_ElapsedMicroseconds(0, b->StageTicks[BUILDER_STAGE_STRETCH]);
+	bench->RenderTime  = Stopwatch_ElapsedMicroseconds(0, b->StageTicks[BUILDER_STAGE_RENDER]);
+}
+
+void Builder_RunBenchmark(const char* name, bool smooth, void (*print)(const String* line)) {
+	struct BuilderBenchmark bench;
+	int totalMs, readMs, stretchMs, renderMs, otherMs;
+	int perSec, perChunk, kb;
+	String line; char lineBuffer[STRING_SIZE * 2];
+
+	if (smooth) { AdvBuilder_SetActive(); } else { NormalBuilder_SetActive(); }
+	Builder_Benchmark(&bench);
+
+	totalMs   = (int)(bench.TotalTime   / 1000);
+	readMs    = (int)(bench.ReadTime    / 1000);
+	stretchMs = (int)(bench.StretchTime / 1000);
+	renderMs  = (int)(bench.RenderTime  / 1000);
+	otherMs   = totalMs - readMs - stretchMs - renderMs;
+
+	perSec   = (int)(bench.Chunks * 1000000.0 / max(1, bench.TotalTime));
+	perChunk = bench.Vertices / max(1, bench.Chunks);
+	kb       = (int)(bench.Bytes >> 10);
+
+	String_InitArray(line, lineBuffer);
+	String_Format4(&line, "%c: %i chunks in %i ms (%i chunks/s)", name, &bench.Chunks, &totalMs, &perSec);
+	print(&line);
+
+	line.length = 0;
+	String_Format2(&line, "  %i vertices per chunk, %i KB of vertices", &perChunk, &kb);
+	print(&line);
+
+	line.length = 0;
+	String_Format4(&line, "  read %i ms, stretch %i ms, render %i ms, other %i ms", &readMs, &stretchMs, &renderMs, &otherMs);
+	print(&line);
 }
 
 void Builder_OnNewMapLoaded(void) {
@@ -1,6 +1,6 @@
 #ifndef CC_BUILDER_H
 #define CC_BUILDER_H
-#include "Core.h"
+#include "String.h"
 /* Converts a 16x16x16 chunk into a mesh of vertices.
 NormalMeshBuilder:
    Implements a simple chunk mesh builder, where each block face is a single colour.
@@ -13,12 +13,53 @@ struct ChunkInfo;
 extern int Builder_SidesLevel, Builder_EdgeLevel;
 /* Whether smooth/advanced lighting mesh builder is used. */
 extern bool Builder_SmoothLighting;
+/* Whether faces are merged into rectangles along both axes, instead of only into rows along one axis. */
+/* NOTE: Without shaded chunks, requires each 1D terrain atlas to only contain one tile, */
+/* so the terrain atlas must be reloaded after changing this. */
+extern bool Builder_GreedyMeshing;
+/* Number of background threads building chunk meshes. (0 if all meshes are built on main thread) */
+extern int Builder_WorkersCount;
 
 void Builder_Init(void);
+/* Stops the background mesh builder threads. */
+void Builder_Free(void);
 void Builder_OnNewMapLoaded(void);
-/* Builds the mesh of vertices for the given chunk. */
+/* Builds the mesh of vertices for the given chunk on the calling thread. */
 void Builder_MakeChunk(struct ChunkInfo* info);
 
+/* Queues the given chunk to have its mesh built by a background worker thread. */
+/* Returns false if there are no workers, or too many chunks are already queued. */
+bool Builder_QueueChunk(struct ChunkInfo* info);
+/* Hooks the next mesh finished by a background worker into its chunk, replacing the chunk's previous mesh. */
+/* Returns the chunk the mesh was for, or NULL if there are no more finished meshes. */
+/* NOTE: Vertex buffers are created here, so this must only be called from the main thread. */
+struct ChunkInfo* Builder_HookNextChunk(void);
+/* Discards all queued and finished meshes, and waits for meshes currently being built to finish. */
+/* NOTE: Must be called before freeing any world data that background workers may be reading. */
+void Builder_CancelChunks(void);
+/* Returns how many meshes background workers have started building so far. */
+uint32_t Builder_StartedBuilds(void);
+/* Returns whether all of the given number of first meshes started by background workers have finished building. */
+/* Data no longer reachable from the world can be freed once all builds started before then have finished. */
+bool Builder_FinishedBuilds(uint32_t started);
+
+/* Time spent building the meshes of all chunks in the world, split by stage of building. */
+struct BuilderBenchmark {
+	int Chunks, Vertices;
+	uint64_t Bytes;       /* Size of all the vertices in the built meshes */
+	uint64_t TotalTime;   /* Microseconds spent building all the meshes */
+	uint64_t ReadTime;    /* Microseconds spent copying blocks from the world into the builder */
+	uint64_t StretchTime; /* Microseconds spent merging visible faces of blocks together */
+	uint64_t RenderTime;  /* Microseconds spent creating vertices for the merged faces */
+};
+/* Builds the meshes of all chunks in the world on the calling thread, using the active mesh builder. */
+/* The meshes are then thrown away, instead of replacing the meshes of the chunks. */
+/* NOTE: Background workers must not be building any chunks when this is called. */
+void Builder_Benchmark(struct BuilderBenchmark* bench);
+/* Activates the normal or smooth lighting mesh builder, then runs Builder_Benchmark. */
+/* Each line of the summary of the results is then passed to print. */
+void Builder_RunBenchmark(const char* name, bool smooth, void (*print)(const String* line));
+
 void NormalBuilder_SetActive(void);
 void AdvBuilder_SetActive(void);
 void Builder_ApplyActive(void);
@@ -14,6 +14,10 @@
 #include "Block.h"
 #include "EnvRenderer.h"
 #include "GameStructs.h"
+#include "MapRenderer.h"
+#include "Builder.h"
+#include "Deflate.h"
+#include "Bitmap.h"
 
 static char msgs[10][STRING_SIZE];
 String Chat_Status[3]       = { String_FromArray(msgs[0]), String_FromArray(msgs[1]), String_FromArray(msgs[2]) };
@@ -339,6 +343,9 @@ static struct ChatCommand HelpCommand = {
 };
 
 static void GpuInfoCommand_Execute(const String* args, int argsCount) {
+#ifndef CC_BUILD_GL11
+	struct ChunkArenaStats stats;
+#endif
 	int i;
 	Gfx_UpdateApiInfo();
 	
@@ -346,6 +353,14 @@ static void GpuInfoCommand_Execute(const String* args, int argsCount) {
 		if (!Gfx_ApiInfo[i].length) continue;
 		Chat_Add1("&a%s", &Gfx_ApiInfo[i]);
 	}
+
+#ifndef CC_BUILD_GL11
+	MapRenderer_GetArenaStats(&stats);
+	Chat_Add2("&aChunk vertex arenas: %i (%i chunks)", &stats.Arenas, &stats.Allocs);
+	Chat_Add4("&aArena vertices: %i used, %i free in %i ranges (largest %i)",
+		&stats.UsedVertices, &stats.FreeVertices, &stats.FreeRanges, &stats.LargestFree);
+	Chat_Add1("&aArena vertices waiting to be freed: %i", &stats.PendingVertices);
+#endif
 }
 
 static struct ChatCommand GpuInfoCommand = {
@@ -559,6 +574,114 @@ static struct ChatCommand TeleportCommand = {
 	}
 };
 
+static void BenchMesherCommand_Print(const String* line) { Chat_Add1("&e%s", line); }
+
+static void BenchMesherCommand_Execute(const String* args, int argsCount) {
+	if (!World.Loaded) { Chat_AddRaw("&eNo world to benchmark"); return; }
+
+	/* Also stops background workers from building chunks while benchmarking */
+	MapRenderer_Refresh();
+	Builder_RunBenchmark("Normal",          false, BenchMesherCommand_Print);
+	Builder_RunBenchmark("Smooth lighting", true,  BenchMesherCommand_Print);
+	Builder_ApplyActive();
+}
+
+static struct ChatCommand BenchMesherCommand = {
+	"BenchMesher", BenchMesherCommand_Execute, false,
+	{
+		"&a/client benchmesher",
+		"&eBuilds the mesh of every chunk in the world, using both the",
+		"&enormal and smooth lighting mesh builders, and shows how long",
+		"&eeach stage of building the meshes took.",
+		"&eFor a headless run on a map file, see 'make bench-mesher'.",
+	}
+};
+
+static void BenchInflateCommand_Execute(const String* args, int argsCount) {
+	struct InflateBenchmark bench;
+	uint8_t* blocks;
+	int x, y, z, i = 0;
+	int kb, compKb, compMs, fastMs, slowMs, fastRate, slowRate;
+	if (!World.Loaded) { Chat_AddRaw("&eNo world to benchmark"); return; }
+
+	blocks = (uint8_t*)Mem_Alloc(World.Volume, 1, "benchmark blocks");
+	for (y = 0; y < World.Height; y++) {
+		for (z = 0; z < World.Length; z++) {
+			for (x = 0; x < World.Width; x++) {
+				blocks[i++] = (uint8_t)World_GetBlock(x, y, z);
+			}
+		}
+	}
+	Inflate_Benchmark(&bench, blocks, World.Volume);
+	Mem_Free(blocks);
+
+	kb     = (int)(bench.Size >> 10);
+	compKb = (int)(bench.CompressedSize >> 10);
+	compMs = (int)(bench.CompressTime / 1000);
+	fastMs = (int)(bench.FastTime     / 1000);
+	slowMs = (int)(bench.SlowTime     / 1000);
+	/* bytes per microsecond is the same as MB per second */
+	fastRate = (int)(bench.Size / max(1, bench.FastTime));
+	slowRate = (int)(bench.Size / max(1, bench.SlowTime));
+
+	Chat_Add3("&eCompressed %i KB of blocks to %i KB in %i ms", &kb, &compKb, &compMs);
+	Chat_Add2("&e  decompressed in %i ms (%i MB/s)", &fastMs, &fastRate);
+	Chat_Add2("&e  bit by bit decoder only: %i ms (%i MB/s)", &slowMs, &slowRate);
+	if (!bench.Valid) Chat_AddRaw("&c  Decompressed data did not match original data!");
+}
+
+static struct ChatCommand BenchInflateCommand = {
+	"BenchInflate", BenchInflateCommand_Execute, false,
+	{
+		"&a/client benchinflate",
+		"&eCompresses the blocks of the world, then shows how long",
+		"&edecompressing them takes, both normally and when only",
+		"&eusing the slower bit by bit decoder.",
+		"&eTo compare with the previous decoder, see 'make bench-inflate'.",
+	}
+};
+
+static void BenchPngCommand_Print(const String* line) { Chat_Add1("&e%s", line); }
+
+static void BenchPngCommand_Execute(const String* args, int argsCount) {
+	String texPack; char texPackBuffer[STRING_SIZE];
+	String path;    char pathBuffer[FILENAME_SIZE];
+	struct PngBenchmark bench;
+	struct Stream stream;
+	ReturnCode res;
+
+	String_InitArray(texPack, texPackBuffer);
+	if (argsCount) {
+		String_Copy(&texPack, &args[0]);
+	} else {
+		Game_GetDefaultTexturePack(&texPack);
+	}
+
+	String_InitArray(path, pathBuffer);
+	String_Format1(&path, "texpacks/%s", &texPack);
+	res = Stream_OpenFile(&stream, &path);
+	if (res) { Logger_Warn2(res, "opening", &path); return; }
+
+	Mem_Set(&bench, 0, sizeof(struct PngBenchmark));
+	res = Png_BenchmarkZip(&bench, &stream);
+	if (res) Logger_Warn2(res, "extracting", &path);
+	stream.Close(&stream);
+
+	Chat_Add1("&eBenchmarked %s:", &texPack);
+	Png_PrintBenchmark(&bench, BenchPngCommand_Print);
+}
+
+static struct ChatCommand BenchPngCommand = {
+	"BenchPng", BenchPngCommand_Execute, false,
+	{
+		"&a/client benchpng [texture pack]",
+		"&eDecodes every .png file in the given texture pack (or the",
+		"&edefault texture pack), both with and without the SIMD PNG",
+		"&efilters and row expanders, and shows how long each took.",
+		"&eFor a headless run on any .zip or .png files, see 'make bench-png'.",
+	}
+};
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------Generic chat------------------------------------------------------*
@@ -583,6 +706,9 @@ static void Chat_Init(void) {
 	Commands_Register(&ModelCommand);
 	Commands_Register(&CuboidCommand);
 	Commands_Register(&TeleportCommand);
+	Commands_Register(&BenchMesherCommand);
+	Commands_Register(&BenchInflateCommand);
+	Commands_Register(&BenchPngCommand);
 
 	Chat_Logging = Options_GetBool(OPT_CHAT_LOGGING, true);
 }
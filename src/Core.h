@@ -158,6 +158,41 @@ typedef struct TextureRec_ { float U1, V1, U2, V2; } TextureRec;
 #endif
 #endif
 
+/* Null graphics backend, which renders nothing and instead records what would have been rendered. */
+/* (so the rendering code can be benchmarked on machines without a GPU) */
+#ifdef CC_BUILD_NULLGFX
+#undef CC_BUILD_D3D9
+#undef CC_BUILD_GL11
+#undef CC_BUILD_GLMODERN
+/* No window or OpenGL context is created either, so it can also run on machines without a display */
+#undef CC_BUILD_WINGUI
+#undef CC_BUILD_X11
+#undef CC_BUILD_CARBON
+#undef CC_BUILD_SDL
+#undef CC_BUILD_WEBCANVAS
+#undef CC_BUILD_WGL
+#undef CC_BUILD_GLX
+#undef CC_BUILD_AGL
+#undef CC_BUILD_EGL
+#undef CC_BUILD_WEBGL
+#endif
+
+/* Stores the blocks of the world in 16x16x16 palette compressed sections, instead of flat arrays. */
+/* (uses far less memory for large maps that are mostly air or stone, but block access is slower) */
+/*#define CC_BUILD_SPARSEWORLD*/
+
+/* Chunk meshes use the compact VertexP3sT2sC4b format, except with Direct3D9. */
+/* (fixed function Direct3D9 requires vertex positions to be floats) */
+#ifndef CC_BUILD_D3D9
+#define CC_BUILD_COMPACTCHUNKS
+#endif
+/* Chunk mesh vertex colours are resolved by shaders using the current sun and shadow colours. */
+/* (only programmable pipelines can do this, so Direct3D9 and fixed function OpenGL still bake */
+/*  colours into chunk meshes, and rebuild every chunk when the sun or shadow colour changes) */
+#ifdef CC_BUILD_GLMODERN
+#define CC_BUILD_SHADEDCHUNKS
+#endif
+
 #ifdef CC_BUILD_D3D9
 typedef void* GfxResourceID;
 #define GFX_NULL NULL
@@ -141,7 +141,7 @@ enum INFLATE_STATE_ {
 };
 
 /* Insert next byte into the bit buffer */
-#define Inflate_GetByte(state) state->AvailIn--; state->Bits |= (uint32_t)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
+#define Inflate_GetByte(state) state->AvailIn--; state->Bits |= (uint64_t)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
 /* Retrieves bits from the bit buffer */
 #define Inflate_PeekBits(state, bits) (state->Bits & ((1UL << (bits)) - 1UL))
 /* Consumes/eats up bits from the bit buffer */
@@ -150,19 +150,46 @@ enum INFLATE_STATE_ {
 #define Inflate_AlignBits(state) uint32_t alignSkip = state->NumBits & 7; Inflate_ConsumeBits(state, alignSkip);
 /* Ensures there are 'bitsCount' bits, or returns if not */
 #define Inflate_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { if (!state->AvailIn) return; Inflate_GetByte(state); }
-/* Ensures there are 'bitsCount' bits */
-#define Inflate_UNSAFE_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { Inflate_GetByte(state); }
+/* Fills the bit buffer with as many whole bytes as will fit, so it then holds at least 56 bits */
+/* NOTE: Reads 8 bytes, so there must be at least 8 bytes of input left */
+/* NOTE: Bits above NumBits may be left set, but are always the same as the bits that will later be inserted there */
+#define Inflate_UNSAFE_Refill(state) \
+	state->Bits |= Inflate_Load64(state->NextIn) << state->NumBits;\
+	refill = (63 - state->NumBits) >> 3;\
+	state->NextIn += refill; state->AvailIn -= refill; state->NumBits += refill << 3;
 /* Peeks then consumes given bits */
 #define Inflate_ReadBits(state, bitsCount) Inflate_PeekBits(state, bitsCount); Inflate_ConsumeBits(state, bitsCount);
 
 /* Goes to the next state, after having read data of a block */
 #define Inflate_NextBlockState(state) (state->LastBlock ? INFLATE_STATE_DONE : INFLATE_STATE_HEADER)
 /* Goes to the next state, after having finished reading a compressed entry */
-#define Inflate_NextCompressState(state) ((state->AvailIn >= INFLATE_FASTINF_IN && state->AvailOut >= INFLATE_FASTINF_OUT) ? INFLATE_STATE_FASTCOMPRESSED : INFLATE_STATE_COMPRESSED_LIT)
-/* The maximum amount of bytes that can be output is 258 */
-#define INFLATE_FASTINF_OUT 258
-/* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Add 3 extra bytes to account for putting data into the bit buffer. */
+#define Inflate_NextCompressState(state) ((state->AvailIn >= INFLATE_FASTINF_IN && state->AvailOut >= INFLATE_FASTINF_OUT && !inflate_slowOnly) ? INFLATE_STATE_FASTCOMPRESSED : INFLATE_STATE_COMPRESSED_LIT)
+/* The maximum amount of bytes that can be output is 258. Add 8 extra bytes, as matches are copied 8 bytes at a time. */
+#define INFLATE_FASTINF_OUT (258 + 8)
+/* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Refilling the bit buffer reads 8 bytes, so add 2 extra bytes. */
 #define INFLATE_FASTINF_IN 10
+/* Mask for the value/symbol part of a fast lookup table entry */
+#define INFLATE_FAST_VAL_MASK ((1 << INFLATE_FAST_BITS) - 1)
+/* Fast lookup table entries for lengths have this added to the length, to distinguish them from symbols */
+#define INFLATE_FAST_LEN 512
+/* Whether to only use the bit by bit decoder (see Inflate_Benchmark) */
+static bool inflate_slowOnly;
+
+#if defined __GNUC__ && defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static CC_INLINE uint64_t Inflate_Load64(const uint8_t* data) {
+	uint64_t value; __builtin_memcpy(&value, data, 8); return value;
+}
+#define Inflate_Copy8(dst, src) __builtin_memcpy(dst, src, 8)
+#elif defined _MSC_VER
+/* Windows is always little endian, and unaligned accesses are fine */
+#define Inflate_Load64(data) (*(const uint64_t*)(data))
+#define Inflate_Copy8(dst, src) *((uint64_t*)(dst)) = *((const uint64_t*)(src))
+#else
+static uint64_t Inflate_Load64(const uint8_t* data) {
+	return (uint64_t)Stream_GetU32_LE(data) | ((uint64_t)Stream_GetU32_LE(data + 4) << 32);
+}
+#define Inflate_Copy8(dst, src) Mem_Copy(dst, src, 8)
+#endif
 
 static uint32_t Huffman_ReverseBits(uint32_t n, uint8_t bits) {
 	n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
@@ -272,7 +299,7 @@ static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table
 		if (packed >= 0) {
 			bits = packed >> INFLATE_FAST_BITS;
 			Inflate_ConsumeBits(state, bits);
-			return packed & 0x1FF;
+			return packed & INFLATE_FAST_VAL_MASK;
 		}
 	}
 
@@ -293,15 +320,15 @@ static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table
 	return -1;
 }
 
-/* Inline the common <= 9 bits case */
+/* Inline the common <= 10 bits case */
+/* NOTE: There must be at least 16 bits in the bit buffer */
 #define Huffman_Unsafe_Decode(state, table, result) \
 {\
-	Inflate_UNSAFE_EnsureBits(state, INFLATE_MAX_BITS);\
 	packed = table.Fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];\
 	if (packed >= 0) {\
 		consumedBits = packed >> INFLATE_FAST_BITS;\
 		Inflate_ConsumeBits(state, consumedBits);\
-		result = packed & 0x1FF;\
+		result = packed & INFLATE_FAST_VAL_MASK;\
 	} else {\
 		result = Huffman_Unsafe_Decode_Slow(state, &table);\
 	}\
@@ -381,79 +408,124 @@ const static uint8_t codelens_order[INFLATE_MAX_CODELENS] = {
 	16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 
 };
 
+/* Merges length symbols and their extra bits into single entries in the fast lookup table, */
+/*  so that the whole length can be decoded with just one table lookup in most cases */
+static void Huffman_BuildLens(struct HuffmanTable* table) {
+	int i, packed, value, bits, extra;
+
+	for (i = 0; i < (1 << INFLATE_FAST_BITS); i++) {
+		packed = table->Fast[i];
+		if (packed < 0) continue;
+
+		value = packed & INFLATE_FAST_VAL_MASK;
+		bits  = packed >> INFLATE_FAST_BITS;
+		/* 286 and 287 are invalid length symbols */
+		if (value <= 256 || value >= 286) continue;
+
+		/* Extra bits follow the codeword, i.e. they are the next bits of the index */
+		extra = len_bits[value - 257];
+		if (bits + extra > INFLATE_FAST_BITS) continue;
+		value = len_base[value - 257] + ((i >> bits) & ((1 << extra) - 1));
+
+		table->Fast[i] = (int16_t)(((bits + extra) << INFLATE_FAST_BITS) | (INFLATE_FAST_LEN + value));
+	}
+}
+
+/* Decodes straight into the output, using the window only for matches that go back before start of the output */
 static void Inflate_InflateFast(struct InflateState* state) {
 	/* huffman variables */
-	uint32_t lit, len, dist;
+	uint32_t lit, len, dist, refill;
 	uint32_t bits, lenIdx, distIdx;
 	int packed, consumedBits;
 
-	/* window variables */
+	/* output/window variables */
 	uint8_t* window;
-	uint32_t i, curIdx, startIdx;
-	uint32_t copyStart, copyLen, partLen;
+	uint8_t* out;
+	uint8_t* outBeg;
+	uint8_t* src;
+	uint32_t i, written, back, startIdx, partLen, step;
 
 	window = state->Window;
-	curIdx = state->WindowIndex;
-	copyStart = state->WindowIndex;
-	copyLen   = 0;
+	outBeg = state->Output;
+	out    = state->Output;
 
-#define INFLATE_FAST_COPY_MAX (INFLATE_WINDOW_SIZE - INFLATE_FASTINF_OUT)
-	while (state->AvailOut >= INFLATE_FASTINF_OUT && state->AvailIn >= INFLATE_FASTINF_IN && copyLen < INFLATE_FAST_COPY_MAX) {
+	while (state->AvailOut >= INFLATE_FASTINF_OUT && state->AvailIn >= INFLATE_FASTINF_IN) {
+		/* Bit buffer now holds enough bits for a length, distance and their extra bits */
+		Inflate_UNSAFE_Refill(state);
 		Huffman_Unsafe_Decode(state, state->Table.Lits, lit);
 
-		if (lit <= 256) {
-			if (lit < 256) {
-				window[curIdx] = (uint8_t)lit;
-				state->AvailOut--; copyLen++;
-				curIdx = (curIdx + 1) & INFLATE_WINDOW_MASK;
-			} else {
-				state->State = Inflate_NextBlockState(state);
-				break;
-			}
+		if (lit < 256) {
+			*out++ = (uint8_t)lit;
+			state->AvailOut--;
+			continue;
+		} else if (lit == 256) {
+			state->State = Inflate_NextBlockState(state);
+			break;
+		} else if (lit >= INFLATE_FAST_LEN) {
+			len = lit - INFLATE_FAST_LEN;
 		} else {
 			lenIdx = lit - 257;
 			bits = len_bits[lenIdx];
-			Inflate_UNSAFE_EnsureBits(state, bits);
 			len  = len_base[lenIdx] + Inflate_ReadBits(state, bits);
+		}
 
-			Huffman_Unsafe_Decode(state, state->TableDists, distIdx);
-			bits = dist_bits[distIdx];
-			Inflate_UNSAFE_EnsureBits(state, bits);
-			dist = dist_base[distIdx] + Inflate_ReadBits(state, bits);
-	
-			/* Window is infinitely repeating like ... [xyz][xyz][xyz] ... */
-			/* If start and end don't cross a boundary, can avoid masking index */
-			startIdx = (curIdx - dist) & INFLATE_WINDOW_MASK;
-			if (curIdx >= startIdx && (curIdx + len) < INFLATE_WINDOW_SIZE) {
-				uint8_t* src = &window[startIdx]; 
-				uint8_t* dst = &window[curIdx];
-
-				for (i = 0; i < (len & ~0x3); i += 4) {
-					*dst++ = *src++; *dst++ = *src++; *dst++ = *src++; *dst++ = *src++;
+		Huffman_Unsafe_Decode(state, state->TableDists, distIdx);
+		bits = dist_bits[distIdx];
+		dist = dist_base[distIdx] + Inflate_ReadBits(state, bits);
+
+		written = (uint32_t)(out - outBeg);
+		state->AvailOut -= len;
+
+		if (dist <= written) {
+			src = out - dist;
+			if (dist >= 8) {
+				/* Can copy 8 bytes at a time, since each copy only reads bytes already written */
+				/* May copy up to 7 bytes past end of the match, but INFLATE_FASTINF_OUT leaves room for this */
+				for (i = 0; i < len; i += 8) {
+					Inflate_Copy8(out + i, src + i);
 				}
-				for (; i < len; i++) { *dst++ = *src++; }
 			} else {
-				for (i = 0; i < len; i++) {
-					window[(curIdx + i) & INFLATE_WINDOW_MASK] = window[(startIdx + i) & INFLATE_WINDOW_MASK];
+				/* Match repeats every 'dist' bytes, so after copying first few bytes one at a time, */
+				/*  can copy 8 bytes at a time from a multiple of 'dist' bytes back instead */
+				step    = dist * ((8 + dist - 1) / dist);
+				partLen = min(len, step);
+
+				for (i = 0; i < partLen; i++) { out[i] = src[i]; }
+				for (; i < len; i += 8) {
+					Inflate_Copy8(out + i, out + i - step);
 				}
 			}
-			curIdx = (curIdx + len) & INFLATE_WINDOW_MASK;
-			state->AvailOut -= len; copyLen += len;
+			out += len;
+		} else {
+			/* Start of the match is in the window, before the start of the output */
+			back     = dist - written;
+			startIdx = (state->WindowIndex - back) & INFLATE_WINDOW_MASK;
+			partLen  = min(back, len);
+
+			for (i = 0; i < partLen; i++) {
+				*out++ = window[(startIdx + i) & INFLATE_WINDOW_MASK];
+			}
+			/* Rest of the match then continues from start of the output */
+			for (; i < len; i++) { *out = *(out - dist); out++; }
 		}
 	}
 
-	state->WindowIndex = curIdx;
-	if (!copyLen) return;
-
-	if (copyStart + copyLen < INFLATE_WINDOW_SIZE) {
-		Mem_Copy(state->Output, &state->Window[copyStart], copyLen);
-		state->Output += copyLen;
-	} else {
-		partLen = INFLATE_WINDOW_SIZE - copyStart;
-		Mem_Copy(state->Output, &state->Window[copyStart], partLen);
-		state->Output += partLen;
-		Mem_Copy(state->Output, state->Window, copyLen - partLen);
-		state->Output += (copyLen - partLen);
+	/* Remove bits above NumBits left by Inflate_UNSAFE_Refill, as slow path assumes they are 0 */
+	state->Bits &= ((uint64_t)1 << state->NumBits) - 1;
+	state->Output = out;
+
+	/* Window must hold the most recent 32 KB of output */
+	written = (uint32_t)(out - outBeg);
+	if (written >= INFLATE_WINDOW_SIZE) {
+		Mem_Copy(window, out - INFLATE_WINDOW_SIZE, INFLATE_WINDOW_SIZE);
+		state->WindowIndex = 0;
+	} else if (written) {
+		partLen = INFLATE_WINDOW_SIZE - state->WindowIndex;
+		partLen = min(partLen, written);
+
+		Mem_Copy(&window[state->WindowIndex], outBeg, partLen);
+		Mem_Copy(window, outBeg + partLen, written - partLen);
+		state->WindowIndex = (state->WindowIndex + written) & INFLATE_WINDOW_MASK;
 	}
 }
 
@@ -487,6 +559,7 @@ void Inflate_Process(struct InflateState* state) {
 
 			case 1: { /* Fixed/static huffman compressed */
 				Huffman_Build(&state->Table.Lits, fixed_lits,  INFLATE_MAX_LITS);
+				Huffman_BuildLens(&state->Table.Lits);
 				Huffman_Build(&state->TableDists, fixed_dists, INFLATE_MAX_DISTS);
 				state->State = Inflate_NextCompressState(state);
 			} break;
@@ -592,6 +665,7 @@ void Inflate_Process(struct InflateState* state) {
 				state->Index = 0;
 				state->State = Inflate_NextCompressState(state);
 				Huffman_Build(&state->Table.Lits, state->Buffer, state->NumLits);
+				Huffman_BuildLens(&state->Table.Lits);
 				Huffman_Build(&state->TableDists, &state->Buffer[state->NumLits], state->NumDists);
 			}
 			break;
@@ -644,6 +718,11 @@ void Inflate_Process(struct InflateState* state) {
 			} else if (lit == 256) {
 				state->State = Inflate_NextBlockState(state);
 				break;
+			} else if (lit >= INFLATE_FAST_LEN) {
+				/* Extra bits were already read as part of fast lookup table entry */
+				state->TmpLit = lit - INFLATE_FAST_LEN;
+				state->State  = INFLATE_STATE_COMPRESSED_DIST;
+				break;
 			} else {
 				state->TmpLit = lit - 257;
 				state->State  = INFLATE_STATE_COMPRESSED_LITREPEAT;
@@ -755,6 +834,62 @@ void Inflate_MakeStream(struct Stream* stream, struct InflateState* state, struc
 	stream->Read = Inflate_StreamRead;
 }
 
+static uint64_t Inflate_TimeDecompress(uint8_t* comp, uint32_t compSize, uint8_t* dst, uint32_t size) {
+	struct Stream src, stream;
+	struct InflateState* state;
+	uint64_t beg, end;
+
+	state = (struct InflateState*)Mem_Alloc(1, sizeof(struct InflateState), "inflate state");
+	Stream_ReadonlyMemory(&src, comp, compSize);
+	Inflate_MakeStream(&stream, state, &src);
+
+	beg = Stopwatch_Measure();
+	Stream_Read(&stream, dst, size);
+	end = Stopwatch_Measure();
+
+	Mem_Free(state);
+	return Stopwatch_ElapsedMicroseconds(beg, end);
+}
+
+void Inflate_Benchmark(struct InflateBenchmark* bench, const uint8_t* data, uint32_t size) {
+	struct Stream dst, stream;
+	struct DeflateState* state;
+	uint8_t* comp;
+	uint8_t* decomp;
+	uint32_t i, compMax;
+	uint64_t beg, end;
+
+	Mem_Set(bench, 0, sizeof(struct InflateBenchmark));
+	bench->Size = size;
+	/* DEFLATE may make incompressible data slightly larger */
+	compMax = size + (size >> 3) + 1024;
+	comp    = (uint8_t*)Mem_Alloc(compMax, 1, "inflate benchmark");
+	decomp  = (uint8_t*)Mem_Alloc(size,    1, "inflate benchmark");
+	state   = (struct DeflateState*)Mem_Alloc(1, sizeof(struct DeflateState), "deflate state");
+
+	Stream_WriteonlyMemory(&dst, comp, compMax);
+	Deflate_MakeStream(&stream, state, &dst);
+	beg = Stopwatch_Measure();
+	Stream_Write(&stream, data, size);
+	stream.Close(&stream);
+	end = Stopwatch_Measure();
+
+	bench->CompressTime   = Stopwatch_ElapsedMicroseconds(beg, end);
+	bench->CompressedSize = compMax - dst.Meta.Mem.Left;
+	Mem_Free(state);
+
+	inflate_slowOnly = true;
+	bench->SlowTime  = Inflate_TimeDecompress(comp, bench->CompressedSize, decomp, size);
+	inflate_slowOnly = false;
+	bench->FastTime  = Inflate_TimeDecompress(comp, bench->CompressedSize, decomp, size);
+
+	for (i = 0; i < size && data[i] == decomp[i]; i++) { }
+	bench->Valid = i == size;
+
+	Mem_Free(comp);
+	Mem_Free(decomp);
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Deflate (compress)----------------------------------------------------*
@@ -26,12 +26,12 @@ ReturnCode ZLibHeader_Read(struct Stream* s, struct ZLibHeader* header);
 #define INFLATE_MAX_DISTS 32
 #define INFLATE_MAX_LITS_DISTS (INFLATE_MAX_LITS + INFLATE_MAX_DISTS)
 #define INFLATE_MAX_BITS 16
-#define INFLATE_FAST_BITS 9
+#define INFLATE_FAST_BITS 10
 #define INFLATE_WINDOW_SIZE 0x8000UL
 #define INFLATE_WINDOW_MASK 0x7FFFUL
 
 struct HuffmanTable {
-	int16_t Fast[1 << INFLATE_FAST_BITS];      /* Fast lookup table for huffman codes */
+	int16_t Fast[1 << INFLATE_FAST_BITS];      /* Fast lookup table for huffman codes (and lengths, see Huffman_BuildLens) */
 	uint16_t FirstCodewords[INFLATE_MAX_BITS]; /* Starting codeword for each bit length */
 	uint16_t EndCodewords[INFLATE_MAX_BITS];   /* (Last codeword + 1) for each bit length. 0 is ignored. */
 	uint16_t FirstOffsets[INFLATE_MAX_BITS];   /* Base offset into Values for codewords of each bit length. */
@@ -41,7 +41,7 @@ struct HuffmanTable {
 struct InflateState {
 	uint8_t State;
 	bool LastBlock;   /* Whether the last DEFLATE block has been encounted in the stream */
-	uint32_t Bits;    /* Holds bits across byte boundaries */
+	uint64_t Bits;    /* Holds bits across byte boundaries */
 	uint32_t NumBits; /* Number of bits in Bits buffer */
 
 	uint8_t* NextIn;   /* Pointer within Input buffer to next byte that can be read */
@@ -75,6 +75,17 @@ void Inflate_Process(struct InflateState* state);
 /* If data starts with a GZIP or ZLIB header, use GZipHeader_Read or ZLibHeader_Read to first skip it. */
 CC_API void Inflate_MakeStream(struct Stream* stream, struct InflateState* state, struct Stream* underlying);
 
+/* Time spent decompressing the same DEFLATE compressed data, using different decoding paths. */
+struct InflateBenchmark {
+	uint32_t Size, CompressedSize;
+	uint64_t CompressTime; /* Microseconds spent compressing the data */
+	uint64_t FastTime;     /* Microseconds spent decompressing the data normally */
+	uint64_t SlowTime;     /* Microseconds spent decompressing the data using only the bit by bit decoder */
+	bool Valid;            /* Whether the decompressed data was identical to the original data */
+};
+/* Compresses the given data using DEFLATE, then measures how long decompressing it again takes. */
+void Inflate_Benchmark(struct InflateBenchmark* bench, const uint8_t* data, uint32_t size);
+
 
 #define DEFLATE_BLOCK_SIZE  16384
 #define DEFLATE_BUFFER_SIZE 32768
@@ -6,123 +6,123 @@ struct _DrawerData Drawer;
 
 /* Performance critical, use macro to ensure always inlined. */
 #define ApplyTint \
-if (Drawer.Tinted) {\
-col.R = (uint8_t)(col.R * Drawer.TintCol.R / 255);\
-col.G = (uint8_t)(col.G * Drawer.TintCol.G / 255);\
-col.B = (uint8_t)(col.B * Drawer.TintCol.B / 255);\
+if (d->Tinted) {\
+col.R = (uint8_t)(col.R * d->TintCol.R / 255);\
+col.G = (uint8_t)(col.G * d->TintCol.G / 255);\
+col.B = (uint8_t)(col.B * d->TintCol.B / 255);\
 }
 
 
-void Drawer_XMin(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
+void Drawer_XMin(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
 	VertexP3fT2fC4b* ptr = *vertices; VertexP3fT2fC4b v;
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = Drawer.MinBB.Z;
-	float u2 = (count - 1) + Drawer.MaxBB.Z * UV2_Scale;
-	float v1 = vOrigin + Drawer.MaxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + Drawer.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	float u1 = d->MinBB.Z;
+	float u2 = (count - 1) + d->MaxBB.Z * UV2_Scale;
+	float v1 = vOrigin + d->MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + d->MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
 
 	ApplyTint;
-	v.X = Drawer.X1; v.Col = col;
+	v.X = d->X1; v.Col = col;
 
-	v.Y = Drawer.Y2; v.Z = Drawer.Z2 + (count - 1); v.U = u2; v.V = v1; *ptr++ = v;
-	v.Z = Drawer.Z1;							    v.U = u1;           *ptr++ = v;
-	v.Y = Drawer.Y1;										  v.V = v2; *ptr++ = v;
-	v.Z = Drawer.Z2 + (count - 1);                  v.U = u2;           *ptr++ = v;
+	v.Y = d->Y2; v.Z = d->Z2 + (count - 1); v.U = u2; v.V = v1; *ptr++ = v;
+	v.Z = d->Z1;							    v.U = u1;           *ptr++ = v;
+	v.Y = d->Y1;										  v.V = v2; *ptr++ = v;
+	v.Z = d->Z2 + (count - 1);                  v.U = u2;           *ptr++ = v;
 	*vertices = ptr;
 }
 
-void Drawer_XMax(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
+void Drawer_XMax(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
 	VertexP3fT2fC4b* ptr = *vertices; VertexP3fT2fC4b v;
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - Drawer.MinBB.Z);
-	float u2 = (1 - Drawer.MaxBB.Z) * UV2_Scale;
-	float v1 = vOrigin + Drawer.MaxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + Drawer.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	float u1 = (count - d->MinBB.Z);
+	float u2 = (1 - d->MaxBB.Z) * UV2_Scale;
+	float v1 = vOrigin + d->MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + d->MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
 
 	ApplyTint;
-	v.X = Drawer.X2; v.Col = col;
+	v.X = d->X2; v.Col = col;
 
-	v.Y = Drawer.Y2; v.Z = Drawer.Z1; v.U = u1; v.V = v1; *ptr++ = v;
-	v.Z = Drawer.Z2 + (count - 1);    v.U = u2;           *ptr++ = v;
-	v.Y = Drawer.Y1;                            v.V = v2; *ptr++ = v;
-	v.Z = Drawer.Z1;                  v.U = u1;           *ptr++ = v;
+	v.Y = d->Y2; v.Z = d->Z1; v.U = u1; v.V = v1; *ptr++ = v;
+	v.Z = d->Z2 + (count - 1);    v.U = u2;           *ptr++ = v;
+	v.Y = d->Y1;                            v.V = v2; *ptr++ = v;
+	v.Z = d->Z1;                  v.U = u1;           *ptr++ = v;
 	*vertices = ptr;
 }
 
-void Drawer_ZMin(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
+void Drawer_ZMin(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
 	VertexP3fT2fC4b* ptr = *vertices; VertexP3fT2fC4b v;
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - Drawer.MinBB.X);
-	float u2 = (1 - Drawer.MaxBB.X) * UV2_Scale;
-	float v1 = vOrigin + Drawer.MaxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + Drawer.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	float u1 = (count - d->MinBB.X);
+	float u2 = (1 - d->MaxBB.X) * UV2_Scale;
+	float v1 = vOrigin + d->MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + d->MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
 
 	ApplyTint;
-	v.Z = Drawer.Z1; v.Col = col;
+	v.Z = d->Z1; v.Col = col;
 
-	v.X = Drawer.X2 + (count - 1); v.Y = Drawer.Y1; v.U = u2; v.V = v2; *ptr++ = v;
-	v.X = Drawer.X1;                                v.U = u1;           *ptr++ = v;
-	v.Y = Drawer.Y2;                                          v.V = v1; *ptr++ = v;
-	v.X = Drawer.X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
+	v.X = d->X2 + (count - 1); v.Y = d->Y1; v.U = u2; v.V = v2; *ptr++ = v;
+	v.X = d->X1;                                v.U = u1;           *ptr++ = v;
+	v.Y = d->Y2;                                          v.V = v1; *ptr++ = v;
+	v.X = d->X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
 	*vertices = ptr;
 }
 
-void Drawer_ZMax(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
+void Drawer_ZMax(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
 	VertexP3fT2fC4b* ptr = *vertices; VertexP3fT2fC4b v;
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = Drawer.MinBB.X;
-	float u2 = (count - 1) + Drawer.MaxBB.X * UV2_Scale;
-	float v1 = vOrigin + Drawer.MaxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + Drawer.MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	float u1 = d->MinBB.X;
+	float u2 = (count - 1) + d->MaxBB.X * UV2_Scale;
+	float v1 = vOrigin + d->MaxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + d->MinBB.Y * Atlas1D.InvTileSize * UV2_Scale;
 
 	ApplyTint;
-	v.Z = Drawer.Z2; v.Col = col;
+	v.Z = d->Z2; v.Col = col;
 
-	v.X = Drawer.X2 + (count - 1); v.Y = Drawer.Y2; v.U = u2; v.V = v1; *ptr++ = v;
-	v.X = Drawer.X1;                                v.U = u1;           *ptr++ = v;
-	v.Y = Drawer.Y1;                                          v.V = v2; *ptr++ = v;
-	v.X = Drawer.X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
+	v.X = d->X2 + (count - 1); v.Y = d->Y2; v.U = u2; v.V = v1; *ptr++ = v;
+	v.X = d->X1;                                v.U = u1;           *ptr++ = v;
+	v.Y = d->Y1;                                          v.V = v2; *ptr++ = v;
+	v.X = d->X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
 	*vertices = ptr;
 }
 
-void Drawer_YMin(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
+void Drawer_YMin(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
 	VertexP3fT2fC4b* ptr = *vertices; VertexP3fT2fC4b v;
 
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
-	float u1 = Drawer.MinBB.X;
-	float u2 = (count - 1) + Drawer.MaxBB.X * UV2_Scale;
-	float v1 = vOrigin + Drawer.MinBB.Z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + Drawer.MaxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
+	float u1 = d->MinBB.X;
+	float u2 = (count - 1) + d->MaxBB.X * UV2_Scale;
+	float v1 = vOrigin + d->MinBB.Z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + d->MaxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
 
 	ApplyTint;
-	v.Y = Drawer.Y1; v.Col = col;
+	v.Y = d->Y1; v.Col = col;
 
-	v.X = Drawer.X2 + (count - 1); v.Z = Drawer.Z2; v.U = u2; v.V = v2; *ptr++ = v;
-	v.X = Drawer.X1;                                v.U = u1;           *ptr++ = v;
-	v.Z = Drawer.Z1;                                          v.V = v1; *ptr++ = v;
-	v.X = Drawer.X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
+	v.X = d->X2 + (count - 1); v.Z = d->Z2; v.U = u2; v.V = v2; *ptr++ = v;
+	v.X = d->X1;                                v.U = u1;           *ptr++ = v;
+	v.Z = d->Z1;                                          v.V = v1; *ptr++ = v;
+	v.X = d->X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
 	*vertices = ptr;
 }
 
-void Drawer_YMax(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
+void Drawer_YMax(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices) {
 	VertexP3fT2fC4b* ptr = *vertices; VertexP3fT2fC4b v;
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = Drawer.MinBB.X;
-	float u2 = (count - 1) + Drawer.MaxBB.X * UV2_Scale;
-	float v1 = vOrigin + Drawer.MinBB.Z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + Drawer.MaxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
+	float u1 = d->MinBB.X;
+	float u2 = (count - 1) + d->MaxBB.X * UV2_Scale;
+	float v1 = vOrigin + d->MinBB.Z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + d->MaxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
 
 	ApplyTint;
-	v.Y = Drawer.Y2; v.Col = col;
+	v.Y = d->Y2; v.Col = col;
 
-	v.X = Drawer.X2 + (count - 1); v.Z = Drawer.Z1; v.U = u2; v.V = v1; *ptr++ = v;
-	v.X = Drawer.X1;                                v.U = u1;           *ptr++ = v;
-	v.Z = Drawer.Z2;                                          v.V = v2; *ptr++ = v;
-	v.X = Drawer.X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
+	v.X = d->X2 + (count - 1); v.Z = d->Z1; v.U = u2; v.V = v1; *ptr++ = v;
+	v.X = d->X1;                                v.U = u1;           *ptr++ = v;
+	v.Z = d->Z2;                                          v.V = v2; *ptr++ = v;
+	v.X = d->X2 + (count - 1);                  v.U = u2;           *ptr++ = v;
 	*vertices = ptr;
 }
@@ -6,6 +6,8 @@
    Copyright 2014-2017 ClassicalSharp | Licensed under BSD-3
 */
 
+/* Describes the cuboid region being drawn. */
+/* NOTE: Chunk mesh builders have their own instances, as they may run on background threads. */
 CC_VAR extern struct _DrawerData {
 	/* Whether a colour tinting effect should be applied to all faces. */
 	bool Tinted;
@@ -22,15 +24,15 @@ CC_VAR extern struct _DrawerData {
 } Drawer;
 
 /* Draws minimum X face of the cuboid. (i.e. at X1) */
-CC_API void Drawer_XMin(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
+CC_API void Drawer_XMin(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
 /* Draws maximum X face of the cuboid. (i.e. at X2) */
-CC_API void Drawer_XMax(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
+CC_API void Drawer_XMax(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
 /* Draws minimum Z face of the cuboid. (i.e. at Z1) */
-CC_API void Drawer_ZMin(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
+CC_API void Drawer_ZMin(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
 /* Draws maximum Z face of the cuboid. (i.e. at Z2) */
-CC_API void Drawer_ZMax(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
+CC_API void Drawer_ZMax(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
 /* Draws minimum Y face of the cuboid. (i.e. at Y1) */
-CC_API void Drawer_YMin(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
+CC_API void Drawer_YMin(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
 /* Draws maximum Y face of the cuboid. (i.e. at Y2) */
-CC_API void Drawer_YMax(int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
+CC_API void Drawer_YMax(struct _DrawerData* d, int count, PackedCol col, TextureLoc texLoc, VertexP3fT2fC4b** vertices);
 #endif
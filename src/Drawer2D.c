@@ -8,6 +8,7 @@
 #include "Game.h"
 #include "Event.h"
 #include "Chat.h"
+#include "TexturePack.h"
 
 bool Drawer2D_BitmappedText;
 bool Drawer2D_BlackTextShadows;
@@ -674,7 +675,7 @@ static void Drawer2D_TextureChanged(void* obj, struct Stream* src, const String*
 	ReturnCode res;
 	if (!String_CaselessEqualsConst(name, "default.png")) return;
 
-	if ((res = Png_Decode(&bmp, src))) {
+	if ((res = TexturePack_DecodeFile(&bmp, src))) {
 		Logger_Warn2(res, "decoding", name);
 		Mem_Free(bmp.Scan0);
 	} else {
@@ -19,6 +19,7 @@
 #include "Stream.h"
 #include "Bitmap.h"
 #include "Logger.h"
+#include "Errors.h"
 
 const char* NameMode_Names[NAME_MODE_COUNT]   = { "None", "Hovered", "All", "AllHovered", "AllUnscaled" };
 const char* ShadowMode_Names[SHADOW_MODE_COUNT] = { "None", "SnapToBlock", "Circle", "CircleAll" };
@@ -221,9 +222,16 @@ bool Entity_TouchesAnyWater(struct Entity* e) {
 *#########################################################################################################################*/
 struct _EntitiesData Entities;
 static EntityID entities_closestId;
+/* Whether players should check for downloaded skins this tick, see Player_CheckSkin */
+static bool entities_skinsReady, entities_httpCompleted;
+static void SkinCache_Tick(void);
 
 void Entities_Tick(struct ScheduledTask* task) {
 	int i;
+	entities_skinsReady    = entities_httpCompleted;
+	entities_httpCompleted = false;
+	SkinCache_Tick();
+
 	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
 		if (!Entities.List[i]) continue;
 		Entities.List[i]->VTABLE->Tick(Entities.List[i], task->Interval);
@@ -324,6 +332,8 @@ static void Entities_ChatFontChanged(void* obj) {
 	}
 }
 
+static void Entities_HttpCompleted(void* obj) { entities_httpCompleted = true; }
+
 void Entities_Remove(EntityID id) {
 	Event_RaiseInt(&EntityEvents.Removed, id);
 	Entities.List[id]->VTABLE->Despawn(Entities.List[id]);
@@ -463,6 +473,641 @@ struct IGameComponent TabList_Component = {
 };
 
 
+/*########################################################################################################################*
+*-------------------------------------------------------Skin decoder------------------------------------------------------*
+*#########################################################################################################################*/
+/* Clears hat area from a skin bitmap if it's completely white or black,
+   so skins edited with Microsoft Paint or similiar don't have a solid hat */
+static void Player_ClearHat(Bitmap* bmp, uint8_t skinType) {
+	int sizeX  = (bmp->Width / 64) * 32;
+	int yScale = skinType == SKIN_64x32 ? 32 : 64;
+	int sizeY  = (bmp->Height / yScale) * 16;
+	int x, y;
+
+	/* determine if we actually need filtering */
+	for (y = 0; y < sizeY; y++) {
+		BitmapCol* row = Bitmap_GetRow(bmp, y) + sizeX;
+		for (x = 0; x < sizeX; x++) {
+			if (row[x].A != 255) return;
+		}
+	}
+
+	/* only perform filtering when the entire hat is opaque */
+	uint32_t white = PackedCol_ARGB(255, 255, 255, 255);
+	uint32_t black = PackedCol_ARGB(0,   0,   0,   255);
+	for (y = 0; y < sizeY; y++) {
+		uint32_t* row = Bitmap_RawRow(bmp, y) + sizeX;
+		for (x = 0; x < sizeX; x++) {
+			uint32_t pixel = row[x];
+			if (pixel == white || pixel == black) row[x] = 0;
+		}
+	}
+}
+
+/* Ensures skin is a power of two size, resizing if needed. */
+static void Player_EnsurePow2(Bitmap* bmp, float* uScale, float* vScale) {
+	uint32_t stride;
+	int width, height;
+	Bitmap scaled;
+	int y;
+
+	width  = Math_NextPowOf2(bmp->Width);
+	height = Math_NextPowOf2(bmp->Height);
+	if (width == bmp->Width && height == bmp->Height) return;
+
+	Bitmap_Allocate(&scaled, width, height);
+	*uScale = (float)bmp->Width  / width;
+	*vScale = (float)bmp->Height / height;
+	stride = bmp->Width * 4;
+
+	for (y = 0; y < bmp->Height; y++) {
+		BitmapCol* src = Bitmap_GetRow(bmp, y);
+		BitmapCol* dst = Bitmap_GetRow(&scaled, y);
+		Mem_Copy(dst, src, stride);
+	}
+
+	Mem_Free(bmp->Scan0);
+	*bmp = scaled;
+}
+
+/* Skins are decoded, padded and have their hat cleared (or are read from the disk cache) on a */
+/* background thread, so that lots of (possibly large) skins at once does not freeze the game. */
+enum SkinJobType { SKIN_JOB_DECODE, SKIN_JOB_READ };
+struct SkinJob {
+	struct HttpRequest Req; /* Downloaded skin (ID and URL are the skin's URL) */
+	int Index;              /* Index of the skin cache entry this job is for */
+	uint32_t Hash;          /* Hash of the skin cache entry, see SkinEntry.Hash */
+	uint8_t Type;           /* See the various SKIN_JOB_ */
+	bool ClearHat;
+	ReturnCode Res;         /* Result of decoding or reading the skin */
+	Bitmap Bmp;
+	float uScale, vScale;
+	uint8_t SkinType;
+};
+
+#define SKINS_DEF_JOBS 8
+struct SkinJobList {
+	uint32_t MaxElems, Count;
+	uint32_t Head; /* Index of the oldest job, jobs are taken from the front of the list */
+	struct SkinJob* Entries;
+	struct SkinJob DefaultEntries[SKINS_DEF_JOBS];
+};
+
+static struct SkinJobList skins_queued, skins_done;
+static void* skins_mutex;
+static void* skins_waitable;
+static void* skins_thread;
+static volatile bool skins_stop;
+static volatile uint32_t skins_doneCount;
+static bool skins_diskCache;
+
+static void SkinJobList_Init(struct SkinJobList* list) {
+	list->MaxElems = SKINS_DEF_JOBS;
+	list->Count    = 0;
+	list->Head     = 0;
+	list->Entries  = list->DefaultEntries;
+}
+
+static void SkinJobList_Append(struct SkinJobList* list, struct SkinJob* job) {
+	uint32_t i;
+	/* Reuse the space of jobs already taken from the front before resizing */
+	if (list->Count == list->MaxElems && list->Head) {
+		for (i = list->Head; i < list->Count; i++) {
+			list->Entries[i - list->Head] = list->Entries[i];
+		}
+		list->Count -= list->Head;
+		list->Head   = 0;
+	}
+
+	if (list->Count == list->MaxElems) {
+		list->Entries = Utils_Resize(list->Entries, &list->MaxElems,
+									sizeof(struct SkinJob), SKINS_DEF_JOBS, 8);
+	}
+	list->Entries[list->Count++] = *job;
+}
+
+/* Removes the oldest job from the list, returning false if the list is empty */
+static bool SkinJobList_Take(struct SkinJobList* list, struct SkinJob* job) {
+	if (list->Head == list->Count) return false;
+	*job = list->Entries[list->Head++];
+
+	if (list->Head == list->Count) { list->Head = 0; list->Count = 0; }
+	return true;
+}
+
+static void SkinJobList_Free(struct SkinJobList* list) {
+	uint32_t i;
+	for (i = list->Head; i < list->Count; i++) {
+		HttpRequest_Free(&list->Entries[i].Req);
+		Mem_Free(list->Entries[i].Bmp.Scan0);
+	}
+
+	if (list->Entries != list->DefaultEntries) Mem_Free(list->Entries);
+	SkinJobList_Init(list);
+}
+
+/* Decoded skins are cached on disk as a header, the skin's URL, then the raw pixels of the (padded) bitmap. */
+/* Files are named by the CRC32 of the URL, so the URL is stored too to reject files of other skins with the same hash. */
+#define SKINFILE_HEADER_SIZE 32
+#define SKINFILE_MAX_SIZE 4096
+/* Files not used for over SKINFILE_MAX_AGE are deleted, then the least recently used files */
+/* are deleted until all of them are under SKINFILE_DISK_BUDGET bytes */
+#define SKINFILE_MAX_AGE ((TimeMS)30 * 24 * 60 * 60 * 1000)
+#define SKINFILE_DISK_BUDGET (64 * 1024 * 1024)
+static const uint8_t skinFile_sig[4] = { 'C', 'C', 'S', 'K' };
+
+static void SkinDecoder_MakePath(String* path, uint32_t hash) {
+	String key; char keyBuffer[STRING_INT_CHARS];
+	String_InitArray(key, keyBuffer);
+
+	String_AppendUInt32(&key, hash);
+	String_Format1(path, "skincache/%s", &key);
+}
+
+static ReturnCode SkinDecoder_WriteFile(struct SkinJob* job) {
+	String path; char pathBuffer[FILENAME_SIZE];
+	uint8_t header[SKINFILE_HEADER_SIZE] = { 0 };
+	struct Stream stream;
+	ReturnCode res, res2;
+	int urlLen;
+
+	String_InitArray(path, pathBuffer);
+	SkinDecoder_MakePath(&path, job->Hash);
+	res = Stream_CreateFile(&stream, &path);
+	if (res) return res;
+
+	Mem_Copy(header, skinFile_sig, sizeof(skinFile_sig));
+	Stream_SetU32_BE(&header[4],  job->Bmp.Width);
+	Stream_SetU32_BE(&header[8],  job->Bmp.Height);
+	/* Size of the skin before it was padded to power of two */
+	Stream_SetU32_BE(&header[12], (uint32_t)(job->uScale * job->Bmp.Width  + 0.5f));
+	Stream_SetU32_BE(&header[16], (uint32_t)(job->vScale * job->Bmp.Height + 0.5f));
+	Stream_SetU32_BE(&header[20], (uint32_t)(job->Req.LastModified >> 32));
+	Stream_SetU32_BE(&header[24], (uint32_t)job->Req.LastModified);
+	header[28] = job->SkinType;
+	urlLen     = String_CalcLen(job->Req.URL, URL_MAX_SIZE);
+	Stream_SetU16_BE(&header[30], urlLen);
+
+	res = Stream_Write(&stream, header, SKINFILE_HEADER_SIZE);
+	if (!res) res = Stream_Write(&stream, (uint8_t*)job->Req.URL, urlLen);
+	if (!res) res = Stream_Write(&stream, (uint8_t*)job->Bmp.Scan0, Bitmap_DataSize(job->Bmp.Width, job->Bmp.Height));
+
+	res2 = stream.Close(&stream);
+	return res ? res : res2;
+}
+
+static ReturnCode SkinDecoder_ReadFile(struct SkinJob* job) {
+	String path; char pathBuffer[FILENAME_SIZE];
+	uint8_t header[SKINFILE_HEADER_SIZE];
+	String url; char urlBuffer[URL_MAX_SIZE];
+	String reqUrl;
+	struct Stream stream;
+	uint32_t i, width, height, urlLen;
+	ReturnCode res, res2;
+
+	String_InitArray(path, pathBuffer);
+	SkinDecoder_MakePath(&path, job->Hash);
+	res = Stream_OpenFile(&stream, &path);
+	if (res) return res;
+
+	res = Stream_Read(&stream, header, SKINFILE_HEADER_SIZE);
+	for (i = 0; !res && i < sizeof(skinFile_sig); i++) {
+		if (header[i] != skinFile_sig[i]) res = ERR_INVALID_ARGUMENT;
+	}
+
+	if (!res) {
+		width  = Stream_GetU32_BE(&header[4]);
+		height = Stream_GetU32_BE(&header[8]);
+		if (!width || !height || width > SKINFILE_MAX_SIZE || height > SKINFILE_MAX_SIZE) res = ERR_INVALID_ARGUMENT;
+	}
+
+	if (!res) {
+		urlLen = Stream_GetU16_BE(&header[30]);
+		if (urlLen != String_CalcLen(job->Req.URL, URL_MAX_SIZE)) res = ERR_INVALID_ARGUMENT;
+	}
+	if (!res) res = Stream_Read(&stream, (uint8_t*)urlBuffer, urlLen);
+	if (!res) {
+		url    = String_Init(urlBuffer, urlLen, urlLen);
+		reqUrl = String_FromRawArray(job->Req.URL);
+		if (!String_Equals(&url, &reqUrl)) res = ERR_INVALID_ARGUMENT;
+	}
+
+	if (!res) {
+		job->uScale   = (float)Stream_GetU32_BE(&header[12]) / width;
+		job->vScale   = (float)Stream_GetU32_BE(&header[16]) / height;
+		job->SkinType = header[28];
+		job->Req.LastModified = ((TimeMS)Stream_GetU32_BE(&header[20]) << 32) | Stream_GetU32_BE(&header[24]);
+
+		Bitmap_Allocate(&job->Bmp, width, height);
+		res = Stream_Read(&stream, (uint8_t*)job->Bmp.Scan0, Bitmap_DataSize(width, height));
+	}
+
+	res2 = stream.Close(&stream);
+	if (res || res2) return res ? res : res2;
+
+	/* Modified time is used as the last time the file was used, see SkinDecoder_PruneFiles */
+	File_SetModifiedTime(&path, DateTime_CurrentUTC_MS());
+	return 0;
+}
+
+struct SkinFileInfo { TimeMS Time; uint32_t Size, Hash; };
+struct SkinFileList { struct SkinFileInfo* Entries; int Count, Capacity; TimeMS Now; };
+
+static void SkinDecoder_AddFile(const String* path, void* obj) {
+	struct SkinFileList* list = (struct SkinFileList*)obj;
+	struct SkinFileInfo info;
+	String name = *path;
+	FileHandle file;
+	uint64_t hash;
+
+	Utils_UNSAFE_GetFilename(&name);
+	if (!Convert_ParseUInt64(&name, &hash) || (uint32_t)hash != hash) return;
+	if (File_GetModifiedTime(path, &info.Time)) return;
+
+	/* Delete files not used in a long time straight away */
+	if (info.Time + SKINFILE_MAX_AGE < list->Now) { File_Delete(path); return; }
+	if (File_Open(&file, path)) return;
+	if (File_Length(file, &info.Size)) info.Size = 0;
+	File_Close(file);
+	info.Hash = (uint32_t)hash;
+
+	if (list->Count == list->Capacity) {
+		list->Capacity = list->Capacity ? list->Capacity * 2 : 256;
+		list->Entries  = Mem_Realloc(list->Entries, list->Capacity, sizeof(struct SkinFileInfo), "skin files");
+	}
+	list->Entries[list->Count++] = info;
+}
+
+static struct SkinFileInfo* skinFiles_sort;
+static void SkinDecoder_QuickSort(int left, int right) {
+	struct SkinFileInfo* keys = skinFiles_sort; struct SkinFileInfo key;
+
+	while (left < right) {
+		int i = left, j = right;
+		TimeMS pivot = keys[(i + j) >> 1].Time;
+
+		/* partition the list */
+		while (i <= j) {
+			while (pivot > keys[i].Time) i++;
+			while (pivot < keys[j].Time) j--;
+			QuickSort_Swap_Maybe();
+		}
+		/* recurse into the smaller subset */
+		QuickSort_Recurse(SkinDecoder_QuickSort)
+	}
+}
+
+/* Deletes old files from the disk cache, and least recently used files while over SKINFILE_DISK_BUDGET */
+static void SkinDecoder_PruneFiles(void) {
+	String path; char pathBuffer[FILENAME_SIZE];
+	String dir = String_FromConst("skincache");
+	struct SkinFileList list = { 0 };
+	uint64_t totalSize = 0;
+	int i;
+
+	list.Now = DateTime_CurrentUTC_MS();
+	Directory_Enum(&dir, &list, SkinDecoder_AddFile);
+	for (i = 0; i < list.Count; i++) { totalSize += list.Entries[i].Size; }
+
+	if (totalSize > SKINFILE_DISK_BUDGET) {
+		skinFiles_sort = list.Entries;
+		SkinDecoder_QuickSort(0, list.Count - 1);
+	}
+
+	for (i = 0; i < list.Count && totalSize > SKINFILE_DISK_BUDGET; i++) {
+		String_InitArray(path, pathBuffer);
+		SkinDecoder_MakePath(&path, list.Entries[i].Hash);
+		if (!File_Delete(&path)) totalSize -= list.Entries[i].Size;
+	}
+	Mem_Free(list.Entries);
+}
+
+static void SkinDecoder_Decode(struct SkinJob* job) {
+	struct Stream mem;
+	if (job->Type == SKIN_JOB_READ) { job->Res = SkinDecoder_ReadFile(job); return; }
+
+	Stream_ReadonlyMemory(&mem, job->Req.Data, job->Req.Size);
+	job->Res = Png_Decode(&job->Bmp, &mem);
+	HttpRequest_Free(&job->Req);
+	if (job->Res) return;
+
+	job->uScale = 1.0f; job->vScale = 1.0f;
+	Player_EnsurePow2(&job->Bmp, &job->uScale, &job->vScale);
+	job->SkinType = Utils_CalcSkinType(&job->Bmp);
+	if (job->SkinType == SKIN_INVALID) return;
+
+	if (job->ClearHat) Player_ClearHat(&job->Bmp, job->SkinType);
+	/* Failing to cache the skin doesn't matter, it will just be decoded again next time */
+	if (skins_diskCache) SkinDecoder_WriteFile(job);
+}
+
+#ifndef CC_BUILD_WEB
+static void SkinDecoder_Loop(void) {
+	struct SkinJob job;
+	bool hasJob;
+	/* Pruning here means jobs never read or write a file while it is being deleted */
+	if (skins_diskCache) SkinDecoder_PruneFiles();
+
+	for (;;) {
+		Mutex_Lock(skins_mutex);
+		{
+			hasJob = SkinJobList_Take(&skins_queued, &job);
+		}
+		Mutex_Unlock(skins_mutex);
+
+		if (skins_stop) { if (hasJob) HttpRequest_Free(&job.Req); return; }
+		if (!hasJob) { Waitable_Wait(skins_waitable); continue; }
+		SkinDecoder_Decode(&job);
+
+		Mutex_Lock(skins_mutex);
+		{
+			SkinJobList_Append(&skins_done, &job);
+			skins_doneCount = skins_done.Count;
+		}
+		Mutex_Unlock(skins_mutex);
+	}
+}
+#endif
+
+/* Queues a job to be done on the background thread, see SkinCache_Tick */
+static void SkinDecoder_Queue(struct SkinJob* job) {
+#ifdef CC_BUILD_WEB
+	SkinDecoder_Decode(job);
+	SkinJobList_Append(&skins_done, job);
+	skins_doneCount = skins_done.Count;
+#else
+	Mutex_Lock(skins_mutex);
+	{
+		SkinJobList_Append(&skins_queued, job);
+	}
+	Mutex_Unlock(skins_mutex);
+	Waitable_Signal(skins_waitable);
+#endif
+}
+
+static void SkinDecoder_Init(void) {
+	SkinJobList_Init(&skins_queued);
+	SkinJobList_Init(&skins_done);
+	skins_stop = false;
+
+	skins_diskCache = Options_GetBool(OPT_SKIN_DISK_CACHE, true);
+	if (skins_diskCache) skins_diskCache = Utils_EnsureDirectory("skincache");
+#ifdef CC_BUILD_WEB
+	if (skins_diskCache) SkinDecoder_PruneFiles();
+#else
+	skins_mutex    = Mutex_Create();
+	skins_waitable = Waitable_Create();
+	skins_thread   = Thread_Start(SkinDecoder_Loop, false);
+#endif
+}
+
+static void SkinDecoder_Free(void) {
+	skins_stop = true;
+#ifndef CC_BUILD_WEB
+	Waitable_Signal(skins_waitable);
+	Thread_Join(skins_thread);
+
+	Mutex_Free(skins_mutex);
+	Waitable_Free(skins_waitable);
+#endif
+	SkinJobList_Free(&skins_queued);
+	SkinJobList_Free(&skins_done);
+	skins_doneCount = 0;
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------Skin cache--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Skins are shared by all players using the same skin URL, and are kept after all of those players */
+/* have despawned (until over SKINS_CACHE_BUDGET bytes), so that rejoining a server or changing map */
+/* does not download or decode them again. */
+#define SKINS_MAX_ENTRIES 512
+#define SKINS_CACHE_BUDGET (32 * 1024 * 1024)
+enum SkinState { SKIN_STATE_EMPTY, SKIN_STATE_READING, SKIN_STATE_DOWNLOADING, SKIN_STATE_DECODING, SKIN_STATE_LOADED };
+
+struct SkinEntry {
+	char URL[URL_MAX_SIZE];
+	uint32_t Hash;        /* CRC32 of the URL, used to quickly find entries and as the disk cache filename */
+	GfxResourceID TexID;
+	float uScale, vScale;
+	uint8_t SkinType;
+	uint8_t State;        /* See the various SKIN_STATE_ */
+	bool ClearHat;        /* Whether to clear the hat area, see Player_ClearHat */
+	int RefCount;         /* Number of players currently using this skin */
+	uint32_t LastUsed;    /* Value of skins_useCounter when last released, for freeing least recently used skins */
+	uint32_t Size;        /* Size of the texture in bytes */
+	TimeMS LastModified;  /* Last-Modified time of the downloaded skin, used to check it is still up to date */
+};
+static struct SkinEntry skins_entries[SKINS_MAX_ENTRIES];
+static uint32_t skins_useCounter, skins_totalSize;
+
+static void SkinCache_DeleteTexture(struct SkinEntry* entry) {
+	Gfx_DeleteTexture(&entry->TexID);
+	skins_totalSize -= entry->Size;
+
+	entry->Size     = 0;
+	entry->uScale   = 1.0f;
+	entry->vScale   = 1.0f;
+	entry->SkinType = SKIN_64x32;
+}
+
+/* Replaces the texture of the given entry with the given decoded skin */
+static void SkinCache_SetTexture(struct SkinEntry* entry, struct SkinJob* job) {
+	String url = String_FromRawArray(entry->URL);
+	SkinCache_DeleteTexture(entry);
+	entry->LastModified = job->Req.LastModified;
+
+	if (job->Bmp.Width > Gfx.MaxTexWidth || job->Bmp.Height > Gfx.MaxTexHeight) {
+		Chat_Add1("&cSkin %s is too large", &url);
+	} else if (job->SkinType != SKIN_INVALID) {
+		entry->TexID    = Gfx_CreateTexture(&job->Bmp, true, false);
+		entry->uScale   = job->uScale;
+		entry->vScale   = job->vScale;
+		entry->SkinType = job->SkinType;
+
+		entry->Size      = Bitmap_DataSize(job->Bmp.Width, job->Bmp.Height);
+		skins_totalSize += entry->Size;
+	}
+}
+
+/* Queues a job for the given entry, see SkinDecoder_Queue */
+static void SkinCache_QueueJob(int index, uint8_t type, struct HttpRequest* item) {
+	struct SkinEntry* entry = &skins_entries[index];
+	struct SkinJob job = { 0 };
+	String url;
+
+	if (item) job.Req = *item;
+	/* The disk cache is keyed by the entry's URL, see SkinDecoder_WriteFile */
+	url = String_ClearedArray(job.Req.URL);
+	String_AppendConst(&url, entry->URL);
+
+	job.Index    = index;
+	job.Hash     = entry->Hash;
+	job.Type     = type;
+	job.ClearHat = entry->ClearHat;
+	entry->State = type == SKIN_JOB_READ ? SKIN_STATE_READING : SKIN_STATE_DECODING;
+	SkinDecoder_Queue(&job);
+}
+
+/* Downloads the skin for the given entry, or only checks it is unchanged if it was read from disk */
+static void SkinCache_Download(struct SkinEntry* entry) {
+	String url = String_FromRawArray(entry->URL);
+	entry->State = SKIN_STATE_DOWNLOADING;
+	Http_AsyncGetSkin(&url, &url, entry->TexID ? &entry->LastModified : NULL);
+}
+
+static void SkinCache_FinishJob(struct SkinJob* job) {
+	struct SkinEntry* entry = &skins_entries[job->Index];
+	String url = String_FromRawArray(job->Req.URL);
+	/* Entry was freed while the job was being done */
+	if (entry->State == SKIN_STATE_EMPTY || entry->Hash != job->Hash) return;
+
+	if (job->Res) {
+		/* Skin not being in disk cache is the common case */
+		if (job->Type == SKIN_JOB_DECODE) Logger_Warn2(job->Res, "decoding", &url);
+	} else {
+		SkinCache_SetTexture(entry, job);
+	}
+
+	if (job->Type == SKIN_JOB_READ) {
+		SkinCache_Download(entry);
+	} else {
+		entry->State = SKIN_STATE_LOADED;
+	}
+}
+
+/* Returns index of the least recently used entry which isn't used by any players, -1 if none */
+static int SkinCache_FindUnused(bool withTexture) {
+	struct SkinEntry* entry;
+	int i, oldest = -1;
+
+	for (i = 0; i < SKINS_MAX_ENTRIES; i++) {
+		entry = &skins_entries[i];
+		if (entry->RefCount || entry->State != SKIN_STATE_LOADED) continue;
+		if (withTexture && !entry->Size) continue;
+
+		if (oldest == -1 || entry->LastUsed < skins_entries[oldest].LastUsed) oldest = i;
+	}
+	return oldest;
+}
+
+static void SkinCache_FreeEntry(int index) {
+	SkinCache_DeleteTexture(&skins_entries[index]);
+	skins_entries[index].State = SKIN_STATE_EMPTY;
+}
+
+/* Returns the index of the entry for the given skin, loading the skin if it is not cached already */
+/* NOTE: The entry must be released with SkinCache_Release when no longer used */
+static int SkinCache_Acquire(const String* skin, bool clearHat) {
+	String url; char urlBuffer[URL_MAX_SIZE];
+	struct SkinEntry* entry;
+	String entryUrl;
+	uint32_t hash;
+	int i, index = -1;
+
+	String_InitArray(url, urlBuffer);
+	Http_GetSkinUrl(skin, &url);
+	hash = Utils_CRC32((const uint8_t*)url.buffer, url.length);
+
+	for (i = 0; i < SKINS_MAX_ENTRIES; i++) {
+		entry = &skins_entries[i];
+		if (entry->State == SKIN_STATE_EMPTY) {
+			if (index == -1) index = i;
+			continue;
+		}
+		if (entry->Hash != hash) continue;
+
+		entryUrl = String_FromRawArray(entry->URL);
+		if (!String_Equals(&url, &entryUrl)) continue;
+		entry->RefCount++;
+		return i;
+	}
+
+	if (index == -1) index = SkinCache_FindUnused(false);
+	/* Every entry is being used, so just use the default skin */
+	if (index == -1) return -1;
+
+	SkinCache_FreeEntry(index);
+	entry = &skins_entries[index];
+	Mem_Set(entry, 0, sizeof(struct SkinEntry));
+	SkinCache_DeleteTexture(entry);
+
+	entryUrl = String_ClearedArray(entry->URL);
+	String_AppendString(&entryUrl, &url);
+	entry->Hash     = hash;
+	entry->ClearHat = clearHat;
+	entry->RefCount = 1;
+
+	if (skins_diskCache) {
+		SkinCache_QueueJob(index, SKIN_JOB_READ, NULL);
+	} else {
+		SkinCache_Download(entry);
+	}
+	return index;
+}
+
+static void SkinCache_Release(int index) {
+	struct SkinEntry* entry = &skins_entries[index];
+	entry->RefCount--;
+	entry->LastUsed = ++skins_useCounter;
+
+	while (skins_totalSize > SKINS_CACHE_BUDGET) {
+		if ((index = SkinCache_FindUnused(true)) == -1) return;
+		SkinCache_FreeEntry(index);
+	}
+}
+
+/* Finishes jobs done by the background thread, and checks for downloaded skins */
+static void SkinCache_Tick(void) {
+	struct SkinEntry* entry;
+	struct HttpRequest item;
+	struct SkinJob job;
+	String url;
+	bool hasJob;
+	int i;
+
+	while (skins_doneCount) {
+		Mutex_Lock(skins_mutex);
+		{
+			hasJob = skins_done.Count > 0;
+			if (hasJob) job = skins_done.Entries[--skins_done.Count];
+			skins_doneCount = skins_done.Count;
+		}
+		Mutex_Unlock(skins_mutex);
+
+		if (!hasJob) break;
+		SkinCache_FinishJob(&job);
+		Mem_Free(job.Bmp.Scan0);
+	}
+
+	if (!entities_skinsReady) return;
+	for (i = 0; i < SKINS_MAX_ENTRIES; i++) {
+		entry = &skins_entries[i];
+		if (entry->State != SKIN_STATE_DOWNLOADING) continue;
+
+		url = String_FromRawArray(entry->URL);
+		if (!Http_GetResult(&url, &item)) continue;
+		if (item.Success) { SkinCache_QueueJob(i, SKIN_JOB_DECODE, &item); continue; }
+
+		/* 304 means the skin read from the disk cache is still up to date, and on network errors the */
+		/* skin from the disk cache (if any) is better than nothing. Otherwise (e.g. 404), the skin */
+		/* doesn't exist anymore, so the default skin should be used instead. */
+		if (item.StatusCode != 304 && !item.Result) SkinCache_DeleteTexture(entry);
+		entry->State = SKIN_STATE_LOADED;
+		HttpRequest_Free(&item);
+	}
+}
+
+static void SkinCache_Init(void) { SkinDecoder_Init(); }
+
+static void SkinCache_Free(void) {
+	int i;
+	SkinDecoder_Free();
+	for (i = 0; i < SKINS_MAX_ENTRIES; i++) { SkinCache_FreeEntry(i); }
+}
+
+
 /*########################################################################################################################*
 *---------------------------------------------------------Player----------------------------------------------------------*
 *#########################################################################################################################*/
@@ -557,57 +1202,20 @@ static void Player_DrawName(struct Player* p) {
 	Gfx_UpdateDynamicVb_IndexedTris(Gfx_texVb, vertices, 4);
 }
 
-static struct Player* Player_FirstOtherWithSameSkin(struct Player* player) {
-	struct Entity* entity = &player->Base;
-	struct Player* p;
-	String skin, pSkin;
-	int i;
-
-	skin = String_FromRawArray(entity->SkinNameRaw);
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities.List[i] || Entities.List[i] == entity) continue;
-		if (Entities.List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
-
-		p     = (struct Player*)Entities.List[i];
-		pSkin = String_FromRawArray(p->Base.SkinNameRaw);
-		if (String_Equals(&skin, &pSkin)) return p;
-	}
-	return NULL;
-}
-
-static struct Player* Player_FirstOtherWithSameSkinAndFetchedSkin(struct Player* player) {
-	struct Entity* entity = &player->Base;
-	struct Player* p;
-	String skin, pSkin;
-	int i;
-
-	skin = String_FromRawArray(entity->SkinNameRaw);
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities.List[i] || Entities.List[i] == entity) continue;
-		if (Entities.List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
-
-		p     = (struct Player*)Entities.List[i];
-		pSkin = String_FromRawArray(p->Base.SkinNameRaw);
-		if (p->FetchedSkin && String_Equals(&skin, &pSkin)) return p;
-	}
-	return NULL;
-}
-
-/* Copies skin data from another player */
-static void Player_CopySkin(struct Player* player, struct Player* from) {
-	struct Entity* dst = &player->Base;
-	struct Entity* src = &from->Base;
+/* Makes the given player use the skin of the given skin cache entry */
+static void Player_ApplySkin(struct Player* player, struct SkinEntry* entry) {
+	struct Entity* e = &player->Base;
 	String skin;
 
-	dst->TextureId = src->TextureId;	
-	dst->SkinType  = src->SkinType;
-	dst->uScale    = src->uScale;
-	dst->vScale    = src->vScale;
+	e->TextureId = entry->TexID;
+	e->SkinType  = entry->SkinType;
+	e->uScale    = entry->uScale;
+	e->vScale    = entry->vScale;
 
 	/* Custom mob textures */
-	dst->MobTextureId = GFX_NULL;
-	skin = String_FromRawArray(dst->SkinNameRaw);
-	if (Utils_IsUrlPrefix(&skin, 0)) dst->MobTextureId = dst->TextureId;
+	e->MobTextureId = GFX_NULL;
+	skin = String_FromRawArray(e->SkinNameRaw);
+	if (Utils_IsUrlPrefix(&skin, 0)) e->MobTextureId = e->TextureId;
 }
 
 /* Resets skin data for the given player */
@@ -619,137 +1227,24 @@ void Player_ResetSkin(struct Player* player) {
 	e->SkinType     = SKIN_64x32;
 }
 
-/* Copies or resets skin data for all players with same skin */
-static void Player_SetSkinAll(struct Player* player, bool reset) {
-	struct Entity* entity = &player->Base;
-	struct Player* p;
-	String skin, pSkin;
-	int i;
-
-	skin = String_FromRawArray(entity->SkinNameRaw);
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities.List[i]) continue;
-		if (Entities.List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
-
-		p     = (struct Player*)Entities.List[i];
-		pSkin = String_FromRawArray(p->Base.SkinNameRaw);
-		if (!String_Equals(&skin, &pSkin)) continue;
-
-		if (reset) {
-			Player_ResetSkin(p);
-		} else {
-			Player_CopySkin(p, player);
-		}
-	}
-}
-
-/* Clears hat area from a skin bitmap if it's completely white or black,
-   so skins edited with Microsoft Paint or similiar don't have a solid hat */
-static void Player_ClearHat(Bitmap* bmp, uint8_t skinType) {
-	int sizeX  = (bmp->Width / 64) * 32;
-	int yScale = skinType == SKIN_64x32 ? 32 : 64;
-	int sizeY  = (bmp->Height / yScale) * 16;
-	int x, y;
-
-	/* determine if we actually need filtering */
-	for (y = 0; y < sizeY; y++) {
-		BitmapCol* row = Bitmap_GetRow(bmp, y) + sizeX;
-		for (x = 0; x < sizeX; x++) {
-			if (row[x].A != 255) return;
-		}
-	}
-
-	/* only perform filtering when the entire hat is opaque */
-	uint32_t white = PackedCol_ARGB(255, 255, 255, 255);
-	uint32_t black = PackedCol_ARGB(0,   0,   0,   255);
-	for (y = 0; y < sizeY; y++) {
-		uint32_t* row = Bitmap_RawRow(bmp, y) + sizeX;
-		for (x = 0; x < sizeX; x++) {
-			uint32_t pixel = row[x];
-			if (pixel == white || pixel == black) row[x] = 0;
-		}
-	}
-}
-
-/* Ensures skin is a power of two size, resizing if needed. */
-static void Player_EnsurePow2(struct Player* p, Bitmap* bmp) {
-	uint32_t stride;
-	int width, height;
-	Bitmap scaled;
-	int y;
-
-	width  = Math_NextPowOf2(bmp->Width);
-	height = Math_NextPowOf2(bmp->Height);
-	if (width == bmp->Width && height == bmp->Height) return;
-
-	Bitmap_Allocate(&scaled, width, height);
-	p->Base.uScale = (float)bmp->Width  / width;
-	p->Base.vScale = (float)bmp->Height / height;
-	stride = bmp->Width * 4;
-
-	for (y = 0; y < bmp->Height; y++) {
-		BitmapCol* src = Bitmap_GetRow(bmp, y);
-		BitmapCol* dst = Bitmap_GetRow(&scaled, y);
-		Mem_Copy(dst, src, stride);
-	}
-
-	Mem_Free(bmp->Scan0);
-	*bmp = scaled;
-}
-
 static void Player_CheckSkin(struct Player* p) {
 	struct Entity* e = &p->Base;
-	struct Player* first;
-	String url, skin = String_FromRawArray(e->SkinNameRaw);
-
-	struct HttpRequest item;
-	struct Stream mem;
-	Bitmap bmp;
-	ReturnCode res;
+	String skin = String_FromRawArray(e->SkinNameRaw);
 
 	if (!p->FetchedSkin && e->Model->UsesSkin) {
-		first = Player_FirstOtherWithSameSkinAndFetchedSkin(p);
-		if (!first) {
-			Http_AsyncGetSkin(&skin, &skin);
-		} else {
-			Player_CopySkin(p, first);
-		}
+		p->SkinIndex   = SkinCache_Acquire(&skin, e->Model->UsesHumanSkin);
 		p->FetchedSkin = true;
 	}
-
-	if (!Http_GetResult(&skin, &item)) return;
-	if (!item.Success) { Player_SetSkinAll(p, true); return; }
-	Stream_ReadonlyMemory(&mem, item.Data, item.Size);
-
-	if ((res = Png_Decode(&bmp, &mem))) {
-		url = String_FromRawArray(item.URL);
-		Logger_Warn2(res, "decoding", &url);
-		Mem_Free(bmp.Scan0); return;
-	}
-
-	Gfx_DeleteTexture(&e->TextureId);
-	Player_SetSkinAll(p, true);
-	Player_EnsurePow2(p, &bmp);
-	e->SkinType = Utils_CalcSkinType(&bmp);
-
-	if (bmp.Width > Gfx.MaxTexWidth || bmp.Height > Gfx.MaxTexHeight) {
-		Chat_Add1("&cSkin %s is too large", &skin);
-	} else if (e->SkinType != SKIN_INVALID) {
-		if (e->Model->UsesHumanSkin) Player_ClearHat(&bmp, e->SkinType);
-		e->TextureId = Gfx_CreateTexture(&bmp, true, false);
-		Player_SetSkinAll(p, false);
-	}
-	Mem_Free(bmp.Scan0);
+	/* Skin texture may be replaced later (e.g. when skin read from disk cache has changed) */
+	if (p->SkinIndex >= 0) Player_ApplySkin(p, &skins_entries[p->SkinIndex]);
 }
 
 static void Player_Despawn(struct Entity* e) {
 	struct Player* player = (struct Player*)e;
-	struct Player* first  = Player_FirstOtherWithSameSkin(player);
+	if (player->SkinIndex >= 0) SkinCache_Release(player->SkinIndex);
 
-	if (!first) {
-		Gfx_DeleteTexture(&e->TextureId);
-		Player_ResetSkin(player);
-	}
+	player->SkinIndex = -1;
+	Player_ResetSkin(player);
 	e->VTABLE->ContextLost(e);
 }
 
@@ -778,6 +1273,7 @@ static void Player_Init(struct Entity* e) {
 
 	e->StepSize   = 0.5f;
 	e->EntityType = ENTITY_TYPE_PLAYER;
+	((struct Player*)e)->SkinIndex = -1;
 	Entity_SetModel(e, &model);
 }
 
@@ -838,7 +1334,7 @@ static void LocalPlayer_Tick(struct Entity* e, double delta) {
 	bool wasOnGround;
 	Vector3 headingVelocity;
 
-	if (!World.Blocks) return;
+	if (!World.Loaded) return;
 	e->StepSize = hacks->FullBlockStep && hacks->Enabled && hacks->CanSpeed ? 1.0f : 0.5f;
 	p->OldVelocity = e->Velocity;
 	wasOnGround    = e->OnGround;
@@ -956,7 +1452,7 @@ static void LocalPlayer_DoRespawn(void) {
 	float height, spawnY;
 	int y;
 
-	if (!World.Blocks) return;
+	if (!World.Loaded) return;
 	Vector3I_Floor(&pos, &spawn);	
 
 	/* Spawn player at highest solid position to match vanilla Minecraft classic */
@@ -1136,6 +1632,8 @@ static void Entities_Init(void) {
 	Event_RegisterVoid(&GfxEvents.ContextLost,      NULL, Entities_ContextLost);
 	Event_RegisterVoid(&GfxEvents.ContextRecreated, NULL, Entities_ContextRecreated);
 	Event_RegisterVoid(&ChatEvents.FontChanged,     NULL, Entities_ChatFontChanged);
+	Event_RegisterVoid(&HttpEvents.RequestsCompleted, NULL, Entities_HttpCompleted);
+	SkinCache_Init();
 
 	Entities.NamesMode = Options_GetEnum(OPT_NAMES_MODE, NAME_MODE_HOVERED,
 		NameMode_Names, Array_Elems(NameMode_Names));
@@ -1159,6 +1657,8 @@ static void Entities_Free(void) {
 	Event_UnregisterVoid(&GfxEvents.ContextLost,      NULL, Entities_ContextLost);
 	Event_UnregisterVoid(&GfxEvents.ContextRecreated, NULL, Entities_ContextRecreated);
 	Event_UnregisterVoid(&ChatEvents.FontChanged,     NULL, Entities_ChatFontChanged);
+	Event_UnregisterVoid(&HttpEvents.RequestsCompleted, NULL, Entities_HttpCompleted);
+	SkinCache_Free();
 
 	if (ShadowComponent_ShadowTex) {
 		Gfx_DeleteTexture(&ShadowComponent_ShadowTex);
@@ -109,7 +109,7 @@ static void EnvRenderer_UpdateFogNormal(float fogDensity, PackedCol fogCol) {
 
 void EnvRenderer_UpdateFog(void) {
 	float fogDensity; PackedCol fogCol;
-	if (!World.Blocks) return;
+	if (!World.Loaded) return;
 
 	EnvRenderer_CalcFog(&fogDensity, &fogCol);
 	Gfx_ClearCol(fogCol);
@@ -183,7 +183,7 @@ static void EnvRenderer_UpdateClouds(void) {
 	int extent;
 	int x1, z1, x2, z2;
 	
-	if (!World.Blocks || Gfx.LostContext) return;
+	if (!World.Loaded || Gfx.LostContext) return;
 	Gfx_DeleteVb(&clouds_vb);
 	if (EnvRenderer_Minimal) return;
 
@@ -262,7 +262,7 @@ static void EnvRenderer_UpdateSky(void) {
 	int extent, height;
 	int x1, z1, x2, z2;
 
-	if (!World.Blocks || Gfx.LostContext) return;
+	if (!World.Loaded || Gfx.LostContext) return;
 	Gfx_DeleteVb(&sky_vb);
 	if (EnvRenderer_Minimal) return;
 
@@ -357,87 +357,21 @@ static void EnvRenderer_UpdateSkybox(void) {
 /*########################################################################################################################*
 *----------------------------------------------------------Weather--------------------------------------------------------*
 *#########################################################################################################################*/
-int16_t* Weather_Heightmap;
 static GfxResourceID rain_tex, snow_tex, weather_vb;
 static double weather_accumulator;
 static Vector3I weather_lastPos;
 
 #define WEATHER_EXTENT 4
 #define WEATHER_VERTS_COUNT 8 * (WEATHER_EXTENT * 2 + 1) * (WEATHER_EXTENT * 2 + 1)
-#define Weather_Pack(x, z) ((x) * World.Length + (z))
-
-static void EnvRenderer_InitWeatherHeightmap(void) {
-	int i;
-	Weather_Heightmap = (int16_t*)Mem_Alloc(World.Width * World.Length, 2, "weather heightmap");
-	
-	for (i = 0; i < World.Width * World.Length; i++) {
-		Weather_Heightmap[i] = Int16_MaxValue;
-	}
-}
-
-#define EnvRenderer_RainCalcBody(get_block)\
-for (y = maxY; y >= 0; y--, i -= World.OneY) {\
-	draw = Blocks.Draw[get_block];\
-\
-	if (!(draw == DRAW_GAS || draw == DRAW_SPRITE)) {\
-		Weather_Heightmap[hIndex] = y;\
-		return y;\
-	}\
-}
-
-static int EnvRenderer_CalcRainHeightAt(int x, int maxY, int z, int hIndex) {
-	int i = World_Pack(x, maxY, z), y;
-	uint8_t draw;
-
-#ifndef EXTENDED_BLOCKS
-	EnvRenderer_RainCalcBody(World.Blocks[i]);
-#else
-	if (World.IDMask <= 0xFF) {
-		EnvRenderer_RainCalcBody(World.Blocks[i]);
-	} else {
-		EnvRenderer_RainCalcBody(World.Blocks[i] | (World.Blocks2[i] << 8));
-	}
-#endif
-
-	Weather_Heightmap[hIndex] = -1;
-	return -1;
-}
 
 static float EnvRenderer_RainHeight(int x, int z) {
-	int hIndex, height;
 	int y;
 	if (!World_ContainsXZ(x, z)) return (float)Env.EdgeHeight;
 
-	hIndex = Weather_Pack(x, z);
-	height = Weather_Heightmap[hIndex];
-
-	y = height == Int16_MaxValue ? EnvRenderer_CalcRainHeightAt(x, World.MaxY, z, hIndex) : height;
+	y = World.Columns[World_ColumnPack(x, z)].RainY;
 	return y == -1 ? 0 : y + Blocks.MaxBB[World_GetBlock(x, y, z)].Y;
 }
 
-void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
-	bool didBlock = !(Blocks.Draw[oldBlock] == DRAW_GAS || Blocks.Draw[oldBlock] == DRAW_SPRITE);
-	bool nowBlock = !(Blocks.Draw[newBlock] == DRAW_GAS || Blocks.Draw[newBlock] == DRAW_SPRITE);
-	int hIndex, height;
-	if (didBlock == nowBlock) return;
-
-	hIndex = Weather_Pack(x, z);
-	height = Weather_Heightmap[hIndex];
-	/* Two cases can be skipped here: */
-	/* a) rain height was not calculated to begin with (height is short.MaxValue) */
-	/* b) changed y is below current calculated rain height */
-	if (y < height) return;
-
-	if (nowBlock) {
-		/* Simple case: Rest of column below is now not visible to rain. */
-		Weather_Heightmap[hIndex] = y;
-	} else {
-		/* Part of the column is now visible to rain, we don't know how exactly how high it should be though. */
-		/* However, we know that if the old block was above or equal to rain height, then the new rain height must be <= old block.y */
-		EnvRenderer_CalcRainHeightAt(x, y, z, hIndex);
-	}
-}
-
 static float EnvRenderer_RainAlphaAt(float x) {
 	/* Wolfram Alpha: fit {0,178},{1,169},{4,147},{9,114},{16,59},{25,9} */
 	float falloff = 0.05f * x * x - 7 * x;
@@ -459,7 +393,6 @@ void EnvRenderer_RenderWeather(double deltaTime) {
 
 	weather = Env.Weather;
 	if (weather == WEATHER_SUNNY) return;
-	if (!Weather_Heightmap) EnvRenderer_InitWeatherHeightmap();
 	Gfx_BindTexture(weather == WEATHER_RAINY ? rain_tex : snow_tex);
 
 	Vector3I_Floor(&pos, &Camera.CurrentPos);
@@ -694,7 +627,7 @@ static void EnvRenderer_UpdateMapSides(void) {
 	VertexP3fT2fC4b* ptr;
 	VertexP3fT2fC4b* cur;
 
-	if (!World.Blocks || Gfx.LostContext) return;
+	if (!World.Loaded || Gfx.LostContext) return;
 	Gfx_DeleteVb(&sides_vb);
 	block = Env.SidesBlock;
 
@@ -753,7 +686,7 @@ static void EnvRenderer_UpdateMapEdges(void) {
 	VertexP3fT2fC4b* ptr;
 	VertexP3fT2fC4b* cur;
 
-	if (!World.Blocks || Gfx.LostContext) return;
+	if (!World.Loaded || Gfx.LostContext) return;
 	Gfx_DeleteVb(&edges_vb);
 	block = Env.EdgeBlock;
 
@@ -932,8 +865,6 @@ static void EnvRenderer_Free(void) {
 	Event_UnregisterVoid(&GfxEvents.ContextRecreated,    NULL, EnvRenderer_ContextRecreated);
 
 	EnvRenderer_ContextLost(NULL);
-	Mem_Free(Weather_Heightmap);
-	Weather_Heightmap = NULL;
 
 	Gfx_DeleteTexture(&clouds_tex);
 	Gfx_DeleteTexture(&skybox_tex);
@@ -945,9 +876,7 @@ static void EnvRenderer_Reset(void) {
 	Gfx_SetFog(false);
 	EnvRenderer_DeleteVbs();
 
-	Mem_Free(Weather_Heightmap);
-	Weather_Heightmap = NULL;
-	weather_lastPos   = Vector3I_MaxValue();
+	weather_lastPos = Vector3I_MaxValue();
 }
 
 static void EnvRenderer_OnNewMapLoaded(void) {
@@ -26,8 +26,6 @@ void EnvRenderer_RenderSkybox(double deltaTime);
 /* Whether a skybox should be rendered. */
 bool EnvRenderer_ShouldRenderSkybox(void);
 
-extern int16_t* Weather_Heightmap;
-void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
 /* Renders rainfall/snowfall weather. */
 void EnvRenderer_RenderWeather(double deltaTime);
 
@@ -13,6 +13,7 @@ struct _WindowEventsList  WindowEvents;
 struct _KeyEventsList     KeyEvents;
 struct _MouseEventsList   MouseEvents;
 struct _NetEventsList     NetEvents;
+struct _HttpEventsList    HttpEvents;
 
 void Event_Register(struct Event_Void* handlers, void* obj, Event_Void_Callback handler) {
 	int i;
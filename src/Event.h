@@ -193,4 +193,8 @@ CC_VAR extern struct _NetEventsList {
 	struct Event_Void Connected;    /* Connection to a server was established. */
 	struct Event_Void Disconnected; /* Connection to the server was lost. */
 } NetEvents;
+
+CC_VAR extern struct _HttpEventsList {
+	struct Event_Void RequestsCompleted; /* One or more requests finished, results can now be retrieved with Http_GetResult */
+} HttpEvents;
 #endif
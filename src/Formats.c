@@ -15,15 +15,63 @@
 #include "Chat.h"
 #include "Inventory.h"
 #include "TexturePack.h"
+#include "Gui.h"
+#include "Screens.h"
+#include "Utils.h"
+#include "GameStructs.h"
 
 
 /*########################################################################################################################*
 *--------------------------------------------------------General----------------------------------------------------------*
 *#########################################################################################################################*/
-static ReturnCode Map_ReadBlocks(struct Stream* stream) {
-	World.Volume = World.Width * World.Length * World.Height;
-	World.Blocks = Mem_Alloc(World.Volume, 1, "map blocks");
-	return Stream_Read(stream, World.Blocks, World.Volume);
+/* Importers are run on a background thread by Map_LoadFrom, so they fill this in instead of World */
+/* and LocalPlayer_Instance. Map_FinishLoad then sets the world from it on the main thread. */
+static struct MapImport {
+	int Width, Height, Length, Volume;
+	BlockRaw* Blocks;
+#ifdef EXTENDED_BLOCKS
+	BlockRaw* Blocks2;
+#endif
+#ifdef CC_BUILD_SPARSEWORLD
+	/* Sections of the map, when built directly from the blocks as they were read */
+	struct WorldSectionsBuilder Sections;
+#endif
+	uint8_t Uuid[16];
+	Vector3 Spawn;
+	float SpawnRotY, SpawnHeadX;
+} map_import;
+#define Map_Pack(x, y, z) (((y) * map_import.Length + (z)) * map_import.Width + (x))
+
+/* Reads the blocks of the map, converting them to table[block] if table is non-NULL */
+static ReturnCode Map_ReadBlocks(struct Stream* stream, const BlockRaw* table) {
+#ifndef CC_BUILD_SPARSEWORLD
+	BlockRaw* blocks;
+	ReturnCode res;
+	int i;
+#endif
+	map_import.Volume = map_import.Width * map_import.Length * map_import.Height;
+
+#ifdef CC_BUILD_SPARSEWORLD
+	WorldSections_Begin(&map_import.Sections, map_import.Width, map_import.Height, map_import.Length);
+	return WorldSections_Read(&map_import.Sections, stream, table);
+#else
+	map_import.Blocks = Mem_Alloc(map_import.Volume, 1, "map blocks");
+	res = Stream_Read(stream, map_import.Blocks, map_import.Volume);
+	if (res || !table) return res;
+
+	blocks = map_import.Blocks;
+	/* Bulk convert 4 blocks at once */
+	for (i = 0; i < (map_import.Volume & ~3); i += 4) {
+		*blocks = table[*blocks]; blocks++;
+		*blocks = table[*blocks]; blocks++;
+		*blocks = table[*blocks]; blocks++;
+		*blocks = table[*blocks]; blocks++;
+	}
+	for (; i < map_import.Volume; i++) {
+		*blocks = table[*blocks]; blocks++;
+	}
+	return 0;
+#endif
 }
 
 static ReturnCode Map_SkipGZipHeader(struct Stream* stream) {
@@ -51,33 +99,222 @@ IMapImporter Map_FindImporter(const String* path) {
 	return NULL;
 }
 
-void Map_LoadFrom(const String* path) {
-	struct LocalPlayer* p = &LocalPlayer_Instance;
-	struct LocationUpdate update;
-	IMapImporter importer;
+
+/*########################################################################################################################*
+*--------------------------------------------------------Map loading------------------------------------------------------*
+*#########################################################################################################################*/
+/* fCraft header isn't compressed, rest of data is though */
+#define FCM_HEADER_SIZE 79
+#define MAP_PROGRESS_INTERVAL (64 * 1024)
+
+volatile float Map_LoadProgress;
+bool Map_Loading;
+static bool map_loadDone;
+static void* map_loadThread;
+static ReturnCode map_loadRes;
+/* Guards the results handed back by the load and save threads */
+static void* map_mutex;
+
+static struct Stream map_file;
+static struct Stream map_inflate;
+static struct InflateState map_inflateState;
+static uint32_t map_fileLen, map_rawLeft, map_sinceProgress;
+static IMapImporter map_importer;
+static String map_path; static char map_pathBuffer[FILENAME_SIZE];
+static void Cw_FreeMetadata(void);
+static void Cw_ApplyMetadata(void);
+
+/* Reads the map file, decompressing it as the importer reads it */
+static ReturnCode Map_ReadFile(struct Stream* s, uint8_t* data, uint32_t count, uint32_t* modified) {
+	uint32_t pos;
+	ReturnCode res;
+
+	if (map_rawLeft) {
+		res = map_file.Read(&map_file, data, min(count, map_rawLeft), modified);
+		map_rawLeft -= *modified;
+		return res;
+	}
+	res = map_inflate.Read(&map_inflate, data, count, modified);
+
+	/* Only check position occasionally, since importers do lots of tiny reads */
+	map_sinceProgress += *modified;
+	if (map_sinceProgress < MAP_PROGRESS_INTERVAL) return res;
+	map_sinceProgress = 0;
+
+	if (map_fileLen && !map_file.Position(&map_file, &pos)) Map_LoadProgress = (float)pos / map_fileLen;
+	return res;
+}
+
+/* Runs the importer on the map file. Usually runs on a background thread, */
+/* so must not touch any game state (see map_import and Cw_ApplyMetadata) */
+static ReturnCode Map_ImportFile(void) {
 	struct Stream stream;
 	ReturnCode res;
+
+	if (map_file.Length(&map_file, &map_fileLen)) map_fileLen = 0;
+	Inflate_MakeStream(&map_inflate, &map_inflateState, &map_file);
+	Stream_Init(&stream);
+	stream.Read = Map_ReadFile;
+
+	if (map_importer == Fcm_Load) {
+		map_rawLeft = FCM_HEADER_SIZE;
+		res = 0;
+	} else {
+		map_rawLeft = 0;
+		res = Map_SkipGZipHeader(&map_file);
+	}
+	if (!res) res = map_importer(&stream);
+	return res;
+}
+
+static void Map_ImportWorker(void) {
+	ReturnCode res = Map_ImportFile();
+
+	Mutex_Lock(map_mutex);
+	{
+		map_loadRes  = res;
+		map_loadDone = true;
+	}
+	Mutex_Unlock(map_mutex);
+}
+
+static void Map_FreeImport(void) {
+#ifdef EXTENDED_BLOCKS
+	if (map_import.Blocks2 != map_import.Blocks) Mem_Free(map_import.Blocks2);
+#endif
+	Mem_Free(map_import.Blocks);
+#ifdef CC_BUILD_SPARSEWORLD
+	WorldSections_Free(&map_import.Sections);
+#endif
+	Cw_FreeMetadata();
+	Mem_Set(&map_import, 0, sizeof(map_import));
+}
+
+static void Map_CloseFile(void) {
+	ReturnCode res = map_file.Close(&map_file);
+	if (res) { Logger_Warn2(res, "closing", &map_path); }
+}
+
+/* Waits for the background thread to finish, then closes the map file */
+static ReturnCode Map_EndLoad(void) {
+	Thread_Join(map_loadThread);
+	Map_Loading  = false;
+	map_loadDone = false;
+
+	Map_CloseFile();
+	return map_loadRes;
+}
+
+/* Opens the map file, and resets the staging data the importer fills in */
+static ReturnCode Map_BeginImport(const String* path) {
+	struct LocalPlayer* p = &LocalPlayer_Instance;
+	ReturnCode res;
+
+	res = Stream_OpenFile(&map_file, path);
+	if (res) { Logger_Warn2(res, "opening", path); return res; }
+
+	String_InitArray(map_path, map_pathBuffer);
+	String_Copy(&map_path, path);
+	map_importer = Map_FindImporter(path);
+
+	/* Importers only change the spawn if the map file has one */
+	Mem_Set(&map_import, 0, sizeof(map_import));
+	map_import.Spawn      = p->Spawn;
+	map_import.SpawnRotY  = p->SpawnRotY;
+	map_import.SpawnHeadX = p->SpawnHeadX;
+
+	map_sinceProgress = 0;
+	map_loadRes       = 0;
+	Map_LoadProgress  = 0.0f;
+	return 0;
+}
+
+void Map_LoadFrom(const String* path) {
+	if (Map_Loading || Map_BeginImport(path)) return;
+	Map_Loading = true;
+
+	/* Freeing old map (e.g. chunk meshes) happens while the file is being imported */
+	map_loadThread = Thread_Start(Map_ImportWorker, false);
 	Game_Reset();
-	
-	res = Stream_OpenFile(&stream, path);
-	if (res) { Logger_Warn2(res, "opening", path); return; }
+	Gui_FreeActive();
+	Gui_SetActive(MapLoadingScreen_MakeInstance());
+}
+
+/* Sets the imported map as the current world, or frees it if importing failed */
+static ReturnCode Map_SetImported(ReturnCode res) {
+	struct LocalPlayer* p = &LocalPlayer_Instance;
 
-	importer = Map_FindImporter(path);
-	if ((res = importer(&stream))) {
+	/* Truncated block arrays would be read past the end of */
+	if (!res && map_import.Volume != map_import.Width * map_import.Height * map_import.Length) {
+		res = ERR_INVALID_ARGUMENT;
+	}
+
+	if (res) {
+		Map_FreeImport();
 		World_Reset();
-		Logger_Warn2(res, "decoding", path); stream.Close(&stream); return;
+		Logger_Warn2(res, "decoding", &map_path); return res;
 	}
 
-	res = stream.Close(&stream);
-	if (res) { Logger_Warn2(res, "closing", path); }
+	if (map_importer == Cw_Load) Cw_ApplyMetadata();
+	p->Spawn      = map_import.Spawn;
+	p->SpawnRotY  = map_import.SpawnRotY;
+	p->SpawnHeadX = map_import.SpawnHeadX;
 
-	World_SetNewMap(World.Blocks, World.Width, World.Height, World.Length);
+	Mem_Copy(World.Uuid, map_import.Uuid, sizeof(World.Uuid));
+#if defined CC_BUILD_SPARSEWORLD
+	if (map_import.Sections.Sections) {
+		World_SetNewSections(&map_import.Sections);
+	} else {
+		World_SetNewMap(map_import.Blocks, map_import.Width, map_import.Height, map_import.Length);
+	}
+	/* Merged into the sections, since they've already been built by now */
+	if (map_import.Blocks2) World_SetMapUpper(map_import.Blocks2);
+#else
+#ifdef EXTENDED_BLOCKS
+	if (map_import.Blocks2) World_SetMapUpper(map_import.Blocks2);
+#endif
+	World_SetNewMap(map_import.Blocks, map_import.Width, map_import.Height, map_import.Length);
+#endif
+	Mem_Set(&map_import, 0, sizeof(map_import));
 	Event_RaiseVoid(&WorldEvents.MapLoaded);
+	return 0;
+}
+
+/* Sets the imported map as the current world, once the background thread has finished importing it */
+static void Map_FinishLoad(void) {
+	struct LocalPlayer* p = &LocalPlayer_Instance;
+	struct LocationUpdate update;
+	if (Map_SetImported(Map_EndLoad())) return;
 
 	LocationUpdate_MakePosAndOri(&update, p->Spawn, p->SpawnRotY, p->SpawnHeadX, false);
 	p->Base.VTABLE->SetLocation(&p->Base, &update, false);
 }
 
+ReturnCode Map_ImportFrom(const String* path) {
+	ReturnCode res;
+	if (Map_Loading || !Map_FindImporter(path)) return ERR_NOT_SUPPORTED;
+	if ((res = Map_BeginImport(path))) return res;
+
+	res = Map_ImportFile();
+	Map_CloseFile();
+	World_Reset();
+	return Map_SetImported(res);
+}
+
+/* Checked from a scheduled task instead of by the loading screen, */
+/* so that the load still finishes if the loading screen is replaced */
+static void Map_CheckLoad(struct ScheduledTask* task) {
+	bool done;
+	if (!Map_Loading) return;
+
+	Mutex_Lock(map_mutex);
+	{
+		done = map_loadDone;
+	}
+	Mutex_Unlock(map_mutex);
+	if (done) Map_FinishLoad();
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------MCSharp level Format---------------------------------------------------*
@@ -124,33 +361,39 @@ static ReturnCode Lvl_ReadCustomBlocks(struct Stream* stream) {
 	int x, y, z, i;
 
 	/* skip bounds checks when we know chunk is entirely inside map */
-	int adjWidth  = World.Width  & ~0x0F;
-	int adjHeight = World.Height & ~0x0F;
-	int adjLength = World.Length & ~0x0F;
+	int adjWidth  = map_import.Width  & ~0x0F;
+	int adjHeight = map_import.Height & ~0x0F;
+	int adjLength = map_import.Length & ~0x0F;
+	BlockRaw* blocks = map_import.Blocks;
 
-	for (y = 0; y < World.Height; y += LVL_CHUNKSIZE) {
-		for (z = 0; z < World.Length; z += LVL_CHUNKSIZE) {
-			for (x = 0; x < World.Width; x += LVL_CHUNKSIZE) {
+	for (y = 0; y < map_import.Height; y += LVL_CHUNKSIZE) {
+		for (z = 0; z < map_import.Length; z += LVL_CHUNKSIZE) {
+			for (x = 0; x < map_import.Width; x += LVL_CHUNKSIZE) {
 
 				if ((res = stream->ReadU8(stream, &hasCustom))) return res;
 				if (hasCustom != 1) continue;
 				if ((res = Stream_Read(stream, chunk, sizeof(chunk)))) return res;
-				baseIndex = World_Pack(x, y, z);
+#ifdef CC_BUILD_SPARSEWORLD
+				/* Chunks are the same size and layout as sections */
+				WorldSections_Replace(&map_import.Sections, x, y, z, LVL_CUSTOMTILE, chunk);
+				continue;
+#endif
+				baseIndex = Map_Pack(x, y, z);
 
 				if ((x + LVL_CHUNKSIZE) <= adjWidth && (y + LVL_CHUNKSIZE) <= adjHeight && (z + LVL_CHUNKSIZE) <= adjLength) {
 					for (i = 0; i < sizeof(chunk); i++) {
 						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
 
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+						index = baseIndex + Map_Pack(xx, yy, zz);
+						blocks[index] = blocks[index] == LVL_CUSTOMTILE ? chunk[i] : blocks[index];
 					}
 				} else {
 					for (i = 0; i < sizeof(chunk); i++) {
 						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
-						if ((x + xx) >= World.Width || (y + yy) >= World.Height || (z + zz) >= World.Length) continue;
+						if ((x + xx) >= map_import.Width || (y + yy) >= map_import.Height || (z + zz) >= map_import.Length) continue;
 
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+						index = baseIndex + Map_Pack(xx, yy, zz);
+						blocks[index] = blocks[index] == LVL_CUSTOMTILE ? chunk[i] : blocks[index];
 					}
 				}
 			}
@@ -161,50 +404,30 @@ static ReturnCode Lvl_ReadCustomBlocks(struct Stream* stream) {
 
 ReturnCode Lvl_Load(struct Stream* stream) {
 	uint8_t header[18];
-	uint8_t* blocks;
 	uint8_t section;
 	ReturnCode res;
-	int i;
 
-	struct LocalPlayer* p = &LocalPlayer_Instance;
-	struct Stream compStream;
-	struct InflateState state;
-	Inflate_MakeStream(&compStream, &state, stream);
-	
-	if ((res = Map_SkipGZipHeader(stream)))                       return res;
-	if ((res = Stream_Read(&compStream, header, sizeof(header)))) return res;
+	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
 	if (Stream_GetU16_LE(&header[0]) != 1874) return LVL_ERR_VERSION;
 
-	World.Width  = Stream_GetU16_LE(&header[2]);
-	World.Length = Stream_GetU16_LE(&header[4]);
-	World.Height = Stream_GetU16_LE(&header[6]);
+	map_import.Width  = Stream_GetU16_LE(&header[2]);
+	map_import.Length = Stream_GetU16_LE(&header[4]);
+	map_import.Height = Stream_GetU16_LE(&header[6]);
 
-	p->Spawn.X = Stream_GetU16_LE(&header[8]);
-	p->Spawn.Z = Stream_GetU16_LE(&header[10]);
-	p->Spawn.Y = Stream_GetU16_LE(&header[12]);
-	p->SpawnRotY  = Math_Packed2Deg(header[14]);
-	p->SpawnHeadX = Math_Packed2Deg(header[15]);
+	map_import.Spawn.X = Stream_GetU16_LE(&header[8]);
+	map_import.Spawn.Z = Stream_GetU16_LE(&header[10]);
+	map_import.Spawn.Y = Stream_GetU16_LE(&header[12]);
+	map_import.SpawnRotY  = Math_Packed2Deg(header[14]);
+	map_import.SpawnHeadX = Math_Packed2Deg(header[15]);
 	/* (2) pervisit, perbuild permissions */
-
-	if ((res = Map_ReadBlocks(&compStream))) return res;
-	blocks = World.Blocks;
-	/* Bulk convert 4 blocks at once */
-	for (i = 0; i < (World.Volume & ~3); i += 4) {
-		*blocks = Lvl_table[*blocks]; blocks++;
-		*blocks = Lvl_table[*blocks]; blocks++;
-		*blocks = Lvl_table[*blocks]; blocks++;
-		*blocks = Lvl_table[*blocks]; blocks++;
-	}
-	for (; i < World.Volume; i++) {
-		*blocks = Lvl_table[*blocks]; blocks++;
-	}
+	if ((res = Map_ReadBlocks(stream, Lvl_table))) return res;
 
 	/* 0xBD section type is not present in older .lvl files */
-	res = compStream.ReadU8(&compStream, &section);
+	res = stream->ReadU8(stream, &section);
 	if (res == ERR_END_OF_STREAM) return 0;
 
 	if (res) return res;
-	return section == 0xBD ? Lvl_ReadCustomBlocks(&compStream) : 0;
+	return section == 0xBD ? Lvl_ReadCustomBlocks(stream) : 0;
 }
 
 
@@ -237,43 +460,37 @@ static ReturnCode Fcm_ReadString(struct Stream* stream) {
 }
 
 ReturnCode Fcm_Load(struct Stream* stream) {
-	uint8_t header[79];	
+	uint8_t header[FCM_HEADER_SIZE];
 	ReturnCode res;
 	int i, count;
 
-	struct LocalPlayer* p = &LocalPlayer_Instance;
-	struct Stream compStream;
-	struct InflateState state;
-	Inflate_MakeStream(&compStream, &state, stream);
-
 	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
 	if (Stream_GetU32_LE(&header[0]) != 0x0FC2AF40UL)        return FCM_ERR_IDENTIFIER;
 	if (header[4] != 13) return FCM_ERR_REVISION;
 	
-	World.Width  = Stream_GetU16_LE(&header[5]);
-	World.Height = Stream_GetU16_LE(&header[7]);
-	World.Length = Stream_GetU16_LE(&header[9]);
+	map_import.Width  = Stream_GetU16_LE(&header[5]);
+	map_import.Height = Stream_GetU16_LE(&header[7]);
+	map_import.Length = Stream_GetU16_LE(&header[9]);
 	
-	p->Spawn.X = ((int)Stream_GetU32_LE(&header[11])) / 32.0f;
-	p->Spawn.Y = ((int)Stream_GetU32_LE(&header[15])) / 32.0f;
-	p->Spawn.Z = ((int)Stream_GetU32_LE(&header[19])) / 32.0f;
-	p->SpawnRotY  = Math_Packed2Deg(header[23]);
-	p->SpawnHeadX = Math_Packed2Deg(header[24]);
+	map_import.Spawn.X = ((int)Stream_GetU32_LE(&header[11])) / 32.0f;
+	map_import.Spawn.Y = ((int)Stream_GetU32_LE(&header[15])) / 32.0f;
+	map_import.Spawn.Z = ((int)Stream_GetU32_LE(&header[19])) / 32.0f;
+	map_import.SpawnRotY  = Math_Packed2Deg(header[23]);
+	map_import.SpawnHeadX = Math_Packed2Deg(header[24]);
 
 	/* header[25] (4) date modified */
 	/* header[29] (4) date created */
-	Mem_Copy(&World.Uuid, &header[33], sizeof(World.Uuid));
+	Mem_Copy(map_import.Uuid, &header[33], sizeof(map_import.Uuid));
 	/* header[49] (26) layer index */
 	count = (int)Stream_GetU32_LE(&header[75]);
 
-	/* header isn't compressed, rest of data is though */
 	for (i = 0; i < count; i++) {
-		if ((res = Fcm_ReadString(&compStream))) return res; /* Group */
-		if ((res = Fcm_ReadString(&compStream))) return res; /* Key   */
-		if ((res = Fcm_ReadString(&compStream))) return res; /* Value */
+		if ((res = Fcm_ReadString(stream))) return res; /* Group */
+		if ((res = Fcm_ReadString(stream))) return res; /* Key   */
+		if ((res = Fcm_ReadString(stream))) return res; /* Value */
 	}
 
-	return Map_ReadBlocks(&compStream);
+	return Map_ReadBlocks(stream, NULL);
 }
 
 
@@ -356,6 +573,10 @@ static ReturnCode Nbt_ReadString(struct Stream* stream, String* str) {
 	return 0;
 }
 
+#ifdef CC_BUILD_SPARSEWORLD
+static bool Cw_ReadSections(struct NbtTag* tag, struct Stream* stream, ReturnCode* res);
+#endif
+
 typedef void (*Nbt_Callback)(struct NbtTag* tag);
 static ReturnCode Nbt_ReadTag(uint8_t typeId, bool readTagName, struct Stream* stream, struct NbtTag* parent, Nbt_Callback callback) {
 	struct NbtTag tag;
@@ -394,6 +615,9 @@ static ReturnCode Nbt_ReadTag(uint8_t typeId, bool readTagName, struct Stream* s
 
 	case NBT_I8S:
 		if ((res = Stream_ReadU32_BE(stream, &tag.DataSize))) break;
+#ifdef CC_BUILD_SPARSEWORLD
+		if (Cw_ReadSections(&tag, stream, &res)) break;
+#endif
 
 		if (NbtTag_IsSmall(&tag)) {
 			res = Stream_Read(stream, tag.Value.Small, tag.DataSize);
@@ -491,40 +715,56 @@ static void* Cw_GetBlocks(struct NbtTag* tag) {
 		Mem_Copy(ptr, tag->Value.Small, tag->DataSize);
 	} else {
 		ptr = tag->Value.Big;
-		tag->Value.Big = NULL; /* So Nbt_ReadTag doesn't call Mem_Free on World.Blocks */
+		tag->Value.Big = NULL; /* So Nbt_ReadTag doesn't call Mem_Free on the blocks */
 	}
 	return ptr;
 }
 
 static void Cw_Callback_1(struct NbtTag* tag) {
-	if (IsTag(tag, "X")) { World.Width  = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "Y")) { World.Height = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "Z")) { World.Length = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "X")) { map_import.Width  = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "Y")) { map_import.Height = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "Z")) { map_import.Length = NbtTag_U16(tag); return; }
 
 	if (IsTag(tag, "UUID")) {
-		if (tag->DataSize != sizeof(World.Uuid)) Logger_Abort("Map UUID must be 16 bytes");
-		Mem_Copy(World.Uuid, tag->Value.Small, sizeof(World.Uuid));
+		if (tag->DataSize != sizeof(map_import.Uuid)) Logger_Abort("Map UUID must be 16 bytes");
+		Mem_Copy(map_import.Uuid, tag->Value.Small, sizeof(map_import.Uuid));
 		return;
 	}
 
 	if (IsTag(tag, "BlockArray")) {
-		World.Volume = tag->DataSize;
-		World.Blocks = Cw_GetBlocks(tag);
+#ifdef CC_BUILD_SPARSEWORLD
+		if (map_import.Sections.Sections) return;
+#endif
+		map_import.Volume = tag->DataSize;
+		map_import.Blocks = Cw_GetBlocks(tag);
 	}
 #ifdef EXTENDED_BLOCKS
-	if (IsTag(tag, "BlockArray2")) World_SetMapUpper(Cw_GetBlocks(tag));
+	if (IsTag(tag, "BlockArray2")) map_import.Blocks2 = Cw_GetBlocks(tag);
 #endif
 }
 
+#ifdef CC_BUILD_SPARSEWORLD
+/* Reads BlockArray directly into sections, if the map's dimensions have already been read */
+static bool Cw_ReadSections(struct NbtTag* tag, struct Stream* stream, ReturnCode* res) {
+	int volume = map_import.Width * map_import.Height * map_import.Length;
+	if (!tag->Parent || tag->Parent->Parent || !IsTag(tag, "BlockArray")) return false;
+	if (!volume || tag->DataSize != volume) return false;
+
+	*res = Map_ReadBlocks(stream, NULL);
+	/* So Nbt_ReadTag doesn't call Mem_Free on the tag's data */
+	tag->DataSize = 0;
+	return true;
+}
+#endif
+
 static void Cw_Callback_2(struct NbtTag* tag) {
-	struct LocalPlayer* p = &LocalPlayer_Instance;
 	if (!IsTag(tag->Parent, "Spawn")) return;
 	
-	if (IsTag(tag, "X")) { p->Spawn.X = NbtTag_I16(tag); return; }
-	if (IsTag(tag, "Y")) { p->Spawn.Y = NbtTag_I16(tag); return; }
-	if (IsTag(tag, "Z")) { p->Spawn.Z = NbtTag_I16(tag); return; }
-	if (IsTag(tag, "H")) { p->SpawnRotY  = Math_Deg2Packed(NbtTag_U8(tag)); return; }
-	if (IsTag(tag, "P")) { p->SpawnHeadX = Math_Deg2Packed(NbtTag_U8(tag)); return; }
+	if (IsTag(tag, "X")) { map_import.Spawn.X = NbtTag_I16(tag); return; }
+	if (IsTag(tag, "Y")) { map_import.Spawn.Y = NbtTag_I16(tag); return; }
+	if (IsTag(tag, "Z")) { map_import.Spawn.Z = NbtTag_I16(tag); return; }
+	if (IsTag(tag, "H")) { map_import.SpawnRotY  = Math_Deg2Packed(NbtTag_U8(tag)); return; }
+	if (IsTag(tag, "P")) { map_import.SpawnHeadX = Math_Deg2Packed(NbtTag_U8(tag)); return; }
 }
 
 static BlockID cw_curID;
@@ -678,6 +918,70 @@ static void Cw_Callback_5(struct NbtTag* tag) {
 	}
 }
 
+/* Metadata tags change game state, so are recorded while importing and applied afterwards on the main thread */
+#define CW_MAX_DEPTH 5
+struct CwMetaTag {
+	struct NbtTag Tag;
+	char ParentNames[CW_MAX_DEPTH][NBT_STRING_SIZE];
+	uint8_t ParentLens[CW_MAX_DEPTH];
+	int Depth;
+};
+static struct CwMetaTag* cw_meta;
+static int cw_metaCount, cw_metaCapacity;
+
+static void Cw_RecordMetadata(struct NbtTag* tag, int depth) {
+	struct CwMetaTag* meta;
+	struct NbtTag* parent;
+	int i;
+	/* None of the metadata values are big byte arrays */
+	if (!NbtTag_IsSmall(tag)) return;
+
+	if (cw_metaCount == cw_metaCapacity) {
+		cw_metaCapacity = cw_metaCapacity ? cw_metaCapacity * 2 : 64;
+		cw_meta = Mem_Realloc(cw_meta, cw_metaCapacity, sizeof(struct CwMetaTag), "CW metadata");
+	}
+	meta = &cw_meta[cw_metaCount++];
+	meta->Tag   = *tag;
+	meta->Depth = depth;
+
+	for (i = depth - 1, parent = tag->Parent; i >= 0; i--, parent = parent->Parent) {
+		Mem_Copy(meta->ParentNames[i], parent->Name.buffer, parent->Name.length);
+		meta->ParentLens[i] = (uint8_t)parent->Name.length;
+	}
+}
+
+static void Cw_FreeMetadata(void) {
+	Mem_Free(cw_meta);
+	cw_meta         = NULL;
+	cw_metaCount    = 0;
+	cw_metaCapacity = 0;
+}
+
+static void Cw_ApplyMetadata(void) {
+	struct NbtTag parents[CW_MAX_DEPTH];
+	struct CwMetaTag* meta;
+	struct NbtTag* tag;
+	int i, j;
+
+	for (i = 0; i < cw_metaCount; i++) {
+		meta = &cw_meta[i];
+		for (j = 0; j < meta->Depth; j++) {
+			parents[j].Name   = String_Init(meta->ParentNames[j], meta->ParentLens[j], NBT_STRING_SIZE);
+			parents[j].Parent = j ? &parents[j - 1] : NULL;
+		}
+
+		/* Strings still point into the tag that was copied */
+		tag = &meta->Tag;
+		tag->Parent      = &parents[meta->Depth - 1];
+		tag->Name.buffer = tag->NameBuffer;
+		if (tag->TagID == NBT_STR) tag->Value.Str.Text.buffer = tag->Value.Str.Buffer;
+
+		if (meta->Depth == 4) Cw_Callback_4(tag);
+		else Cw_Callback_5(tag);
+	}
+	Cw_FreeMetadata();
+}
+
 static void Cw_Callback(struct NbtTag* tag) {
 	struct NbtTag* tmp = tag->Parent;
 	int depth = 0;
@@ -686,8 +990,8 @@ static void Cw_Callback(struct NbtTag* tag) {
 	switch (depth) {
 	case 1: Cw_Callback_1(tag); return;
 	case 2: Cw_Callback_2(tag); return;
-	case 4: Cw_Callback_4(tag); return;
-	case 5: Cw_Callback_5(tag); return;
+	case 4: 
+	case 5: Cw_RecordMetadata(tag, depth); return;
 	}
 	/* ClassicWorld -> Metadata -> CPE -> ExtName -> [values]
 	        0             1         2        3          4   */
@@ -695,24 +999,20 @@ static void Cw_Callback(struct NbtTag* tag) {
 
 ReturnCode Cw_Load(struct Stream* stream) {
 	uint8_t tag;
-	struct Stream compStream;
-	struct InflateState state;
 	Vector3* spawn; Vector3I pos;
 	ReturnCode res;
 
-	Inflate_MakeStream(&compStream, &state, stream);
-	if ((res = Map_SkipGZipHeader(stream))) return res;
-	if ((res = compStream.ReadU8(&compStream, &tag))) return res;
-
+	if ((res = stream->ReadU8(stream, &tag))) return res;
 	if (tag != NBT_DICT) return CW_ERR_ROOT_TAG;
-	res = Nbt_ReadTag(NBT_DICT, true, &compStream, NULL, Cw_Callback);
+	res = Nbt_ReadTag(NBT_DICT, true, stream, NULL, Cw_Callback);
 	if (res) return res;
 
 	/* Older versions incorrectly multiplied spawn coords by * 32, so we check for that */
-	spawn = &LocalPlayer_Instance.Spawn; 
+	spawn = &map_import.Spawn;
 	Vector3I_Floor(&pos, spawn);
 
-	if (!World_Contains(pos.X, pos.Y, pos.Z)) { 
+	if ((unsigned)pos.X >= (unsigned)map_import.Width  || (unsigned)pos.Y >= (unsigned)map_import.Height
+		|| (unsigned)pos.Z >= (unsigned)map_import.Length) {
 		spawn->X /= 32.0f; spawn->Y /= 32.0f; spawn->Z /= 32.0f; 
 	}
 	return 0;
@@ -900,13 +1200,7 @@ ReturnCode Dat_Load(struct Stream* stream) {
 	ReturnCode res;
 	int i;
 
-	struct LocalPlayer* p = &LocalPlayer_Instance;
-	struct Stream compStream;
-	struct InflateState state;
-	Inflate_MakeStream(&compStream, &state, stream);
-
-	if ((res = Map_SkipGZipHeader(stream)))                       return res;
-	if ((res = Stream_Read(&compStream, header, sizeof(header)))) return res;
+	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
 	/* .dat header */
 	if (Stream_GetU32_BE(&header[0]) != 0x271BB788) return DAT_ERR_IDENTIFIER;
 	if (header[4] != 0x02) return DAT_ERR_VERSION;
@@ -915,40 +1209,220 @@ ReturnCode Dat_Load(struct Stream* stream) {
 	if (Stream_GetU16_BE(&header[5]) != 0xACED) return DAT_ERR_JIDENTIFIER;
 	if (Stream_GetU16_BE(&header[7]) != 0x0005) return DAT_ERR_JVERSION;
 	if (header[9] != TC_OBJECT)                 return DAT_ERR_ROOT_TYPE;
-	if ((res = Dat_ReadClassDesc(&compStream, &obj))) return res;
+	if ((res = Dat_ReadClassDesc(stream, &obj))) return res;
 
 	for (i = 0; i < obj.FieldsCount; i++) {
 		field = &obj.Fields[i];
-		if ((res = Dat_ReadFieldData(&compStream, field))) return res;
+		if ((res = Dat_ReadFieldData(stream, field))) return res;
 		fieldName = String_FromRawArray(field->FieldName);
 
 		if (String_CaselessEqualsConst(&fieldName, "width")) {
-			World.Width  = Dat_I32(field);
+			map_import.Width  = Dat_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "height")) {
-			World.Length = Dat_I32(field);
+			map_import.Length = Dat_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "depth")) {
-			World.Height = Dat_I32(field);
+			map_import.Height = Dat_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "blocks")) {
 			if (field->Type != JFIELD_ARRAY) Logger_Abort("Blocks field must be Array");
-			World.Blocks = field->Value.Array.Ptr;
-			World.Volume = field->Value.Array.Size;
+			map_import.Blocks = field->Value.Array.Ptr;
+			map_import.Volume = field->Value.Array.Size;
 		} else if (String_CaselessEqualsConst(&fieldName, "xSpawn")) {
-			p->Spawn.X = (float)Dat_I32(field);
+			map_import.Spawn.X = (float)Dat_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "ySpawn")) {
-			p->Spawn.Y = (float)Dat_I32(field);
+			map_import.Spawn.Y = (float)Dat_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "zSpawn")) {
-			p->Spawn.Z = (float)Dat_I32(field);
+			map_import.Spawn.Z = (float)Dat_I32(field);
 		}
 	}
 	return 0;
 }
 
 
+/*########################################################################################################################*
+*--------------------------------------------------------Map saving-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Exporters are run on the main thread into memory, with only placeholders recorded for the blocks. */
+/* The save thread then writes out the recorded data, filling in blocks from a snapshot of the world. */
+#define MAP_SHIFT_ZEROS -1
+#define MAP_MAX_PARTS 4
+#define MAP_DEF_SAVE 4096
+struct MapSavePart { uint32_t Offset; int Shift; };
+
+volatile float Map_SaveProgress;
+bool Map_Saving;
+static bool map_saveDone;
+static void* map_saveThread;
+static struct Stream map_saveFile;
+static String map_savePath; static char map_savePathBuffer[FILENAME_SIZE];
+static ReturnCode map_saveRes;
+
+static uint8_t  map_defSave[MAP_DEF_SAVE];
+static uint8_t* map_save = map_defSave;
+static uint32_t map_saveLen, map_saveMax = MAP_DEF_SAVE;
+static struct MapSavePart map_parts[MAP_MAX_PARTS];
+static int map_partsCount, map_saveVolume;
+
+static ReturnCode Map_RecordWrite(struct Stream* s, const uint8_t* data, uint32_t count, uint32_t* modified) {
+	while (map_saveMax - map_saveLen < count) {
+		map_save = (uint8_t*)Utils_Resize(map_save, &map_saveMax, 1, MAP_DEF_SAVE, 16384);
+	}
+	Mem_Copy(map_save + map_saveLen, data, count);
+
+	map_saveLen += count;
+	*modified    = count;
+	return 0;
+}
+
+/* Writes either the lower or upper 8 bits of every block in the world (or 0 for MAP_SHIFT_ZEROS) */
+/* part is the index of the recorded part being written, or -1 when not saving in the background */
+static ReturnCode Map_WriteBlockData(struct Stream* stream, int shift, int volume, int part) {
+	BlockID blocks[4096];
+	uint8_t buffer[4096];
+	int i, j, count;
+	ReturnCode res;
+	if (shift == MAP_SHIFT_ZEROS) Mem_Set(buffer, 0, sizeof(buffer));
+
+	for (i = 0; i < volume; i += count) {
+		count = min(volume - i, sizeof(buffer));
+		if (shift != MAP_SHIFT_ZEROS) {
+			World_ReadSnapshot(i, count, blocks);
+			for (j = 0; j < count; j++) { buffer[j] = (uint8_t)(blocks[j] >> shift); }
+		}
+
+		if ((res = Stream_Write(stream, buffer, count))) return res;
+		if (part >= 0) Map_SaveProgress = (part + (float)i / volume) / map_partsCount;
+	}
+	return 0;
+}
+
+static ReturnCode Map_WriteBlocks(struct Stream* stream, int shift) {
+	struct MapSavePart* part;
+	if (stream->Write != Map_RecordWrite) return Map_WriteBlockData(stream, shift, World.Volume, -1);
+	if (map_partsCount == MAP_MAX_PARTS) Logger_Abort("Map_WriteBlocks - hit max count");
+
+	part = &map_parts[map_partsCount++];
+	part->Offset = map_saveLen;
+	part->Shift  = shift;
+	return 0;
+}
+
+static void Map_SaveWorker(void) {
+	struct Stream compStream;
+	struct GZipState state;
+	struct MapSavePart* part;
+	uint32_t offset = 0;
+	ReturnCode res  = 0;
+	int i;
+
+	GZip_MakeStream(&compStream, &state, &map_saveFile);
+	for (i = 0; i < map_partsCount && !res; i++) {
+		part = &map_parts[i];
+		res  = Stream_Write(&compStream, map_save + offset, part->Offset - offset);
+		offset = part->Offset;
+
+		if (res) break;
+		res = Map_WriteBlockData(&compStream, part->Shift, map_saveVolume, i);
+	}
+
+	if (!res) res = Stream_Write(&compStream, map_save + offset, map_saveLen - offset);
+	if (!res) res = compStream.Close(&compStream);
+
+	Mutex_Lock(map_mutex);
+	{
+		map_saveRes  = res;
+		map_saveDone = true;
+	}
+	Mutex_Unlock(map_mutex);
+}
+
+static void Map_EndSave(void) {
+	ReturnCode res;
+	Thread_Join(map_saveThread);
+	World_EndSnapshot();
+	map_saveDone = false;
+	Map_Saving   = false;
+
+	if (map_save != map_defSave) Mem_Free(map_save);
+	map_save    = map_defSave;
+	map_saveLen = 0;
+	map_saveMax = MAP_DEF_SAVE;
+
+	res = map_saveFile.Close(&map_saveFile);
+	if (map_saveRes) {
+		Logger_Warn2(map_saveRes, "encoding", &map_savePath);
+	} else if (res) {
+		Logger_Warn2(res, "closing", &map_savePath);
+	} else {
+		Chat_Add1("&eSaved map to: %s", &map_savePath);
+	}
+}
+
+static void Map_CheckSave(struct ScheduledTask* task) {
+	bool done;
+	if (!Map_Saving) return;
+
+	Mutex_Lock(map_mutex);
+	{
+		done = map_saveDone;
+	}
+	Mutex_Unlock(map_mutex);
+	if (done) Map_EndSave();
+}
+
+void Map_SaveTo(const String* path) {
+	const static String cw = String_FromConst(".cw");
+	struct Stream recorder;
+	ReturnCode res;
+	if (Map_Saving) return;
+
+	res = Stream_CreateFile(&map_saveFile, path);
+	if (res) { Logger_Warn2(res, "creating", path); return; }
+	String_InitArray(map_savePath, map_savePathBuffer);
+	String_Copy(&map_savePath, path);
+
+	Stream_Init(&recorder);
+	recorder.Write = Map_RecordWrite;
+
+	map_partsCount = 0;
+	map_saveVolume = World.Volume;
+	/* Never fails, since recording only writes to memory */
+	if (String_CaselessEnds(path, &cw)) {
+		Cw_Save(&recorder);
+	} else {
+		Schematic_Save(&recorder);
+	}
+
+	World_BeginSnapshot();
+	Map_SaveProgress = 0.0f;
+	Map_Saving       = true;
+	map_saveThread   = Thread_Start(Map_SaveWorker, false);
+}
+
+static void Map_Init(void) {
+	map_mutex = Mutex_Create();
+	ScheduledTask_Add(GAME_DEF_TICKS, Map_CheckLoad);
+	ScheduledTask_Add(0.1,            Map_CheckSave);
+}
+
+/* Don't lose the map being saved when closing the game */
+static void Map_Free(void) {
+	if (Map_Saving)  Map_EndSave();
+	if (Map_Loading) { Map_EndLoad(); Map_FreeImport(); }
+	Mutex_Free(map_mutex);
+}
+
+struct IGameComponent Formats_Component = {
+	Map_Init, /* Init  */
+	Map_Free  /* Free  */
+};
+
+
 /*########################################################################################################################*
 *--------------------------------------------------ClassicWorld export----------------------------------------------------*
 *#########################################################################################################################*/
 #define CW_META_RGB NBT_I16,0,1,'R',0,0,  NBT_I16,0,1,'G',0,0,  NBT_I16,0,1,'B',0,0,
 
+
 static int Cw_WriteEndString(uint8_t* data, const String* text) {
 	Codepoint cp;
 	uint8_t* cur = data + 2;
@@ -1119,14 +1593,14 @@ ReturnCode Cw_Save(struct Stream* stream) {
 		tmp[112] = Math_Deg2Packed(p->SpawnHeadX);
 	}
 	if ((res = Stream_Write(stream, tmp,      sizeof(cw_begin)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume))) return res;
+	if ((res = Map_WriteBlocks(stream, 0))) return res;
 
-	if (World.Blocks != World.Blocks2) {
+	if (World.IDMask > 0xFF) {
 		Mem_Copy(tmp, cw_map2, sizeof(cw_map2));
 		Stream_SetU32_BE(&tmp[14], World.Volume);
 
 		if ((res = Stream_Write(stream, tmp,        sizeof(cw_map2)))) return res;
-		if ((res = Stream_Write(stream, World.Blocks2, World.Volume))) return res;
+		if ((res = Map_WriteBlocks(stream, 8))) return res;
 	}
 
 	Mem_Copy(tmp, cw_meta_cpe, sizeof(cw_meta_cpe));
@@ -1180,9 +1654,8 @@ NBT_END,
 };
 
 ReturnCode Schematic_Save(struct Stream* stream) {
-	uint8_t tmp[256], chunk[8192] = { 0 };
+	uint8_t tmp[256];
 	ReturnCode res;
-	int i;
 
 	Mem_Copy(tmp, sc_begin, sizeof(sc_begin));
 	{
@@ -1192,7 +1665,7 @@ ReturnCode Schematic_Save(struct Stream* stream) {
 		Stream_SetU32_BE(&tmp[74], World.Volume);
 	}
 	if ((res = Stream_Write(stream, tmp, sizeof(sc_begin)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume))) return res;
+	if ((res = Map_WriteBlocks(stream, 0))) return res;
 
 	Mem_Copy(tmp, sc_data, sizeof(sc_data));
 	{
@@ -1200,9 +1673,6 @@ ReturnCode Schematic_Save(struct Stream* stream) {
 	}
 	if ((res = Stream_Write(stream, tmp, sizeof(sc_data)))) return res;
 
-	for (i = 0; i < World.Volume; i += sizeof(chunk)) {
-		int count = World.Volume - i; count = min(count, sizeof(chunk));
-		if ((res = Stream_Write(stream, chunk, count))) return res;
-	}
+	if ((res = Map_WriteBlocks(stream, MAP_SHIFT_ZEROS))) return res;
 	return Stream_Write(stream, sc_end, sizeof(sc_end));
 }
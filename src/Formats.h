@@ -6,14 +6,29 @@
 */
 
 struct Stream;
+struct IGameComponent;
+extern struct IGameComponent Formats_Component;
+
 /* Imports a world encoded in a particular map file format. */
+/* NOTE: stream is the decompressed contents of the map file. Importers are run on a background thread, */
+/* so store the map in staging data that is then set as the world on the main thread. */
 typedef ReturnCode (*IMapImporter)(struct Stream* stream);
 /* Attempts to find a suitable importer based on filename. */
 /* Returns NULL if no match found. */
 CC_API IMapImporter Map_FindImporter(const String* path);
 /* Attempts to import the map from the given file. */
 /* NOTE: Uses Map_FindImporter to import based on filename. */
+/* The file is decompressed and imported on a background thread while a loading screen is shown. */
 CC_API void Map_LoadFrom(const String* path);
+/* Imports the map from the given file on the calling thread, then sets it as the current world. */
+/* NOTE: Unlike Map_LoadFrom, no other game state is reset, and the local player is not moved to the spawn. */
+CC_API ReturnCode Map_ImportFrom(const String* path);
+
+/* Fraction of the map file read so far by Map_LoadFrom. */
+extern volatile float Map_LoadProgress;
+/* Whether Map_LoadFrom is still importing a map in the background. */
+/* NOTE: The imported map is set as the current world by a scheduled task once importing finishes. */
+extern bool Map_Loading;
 
 /* Imports a world from a .lvl MCSharp server map file. */
 /* Used by MCSharp/MCLawl/MCForge/MCDzienny/MCGalaxy. */
@@ -28,6 +43,15 @@ ReturnCode Cw_Load(struct Stream* stream);
 /* Used by Minecraft Classic/WoM client. */
 ReturnCode Dat_Load(struct Stream* stream);
 
+/* Begins saving the current map to the given file on a background thread. */
+/* NOTE: .cw saves a ClassicWorld map file, otherwise a schematic map file is saved. */
+/* Blocks are snapshotted copy-on-write, so the world can still be changed while saving. */
+CC_API void Map_SaveTo(const String* path);
+/* Fraction of the map written so far by Map_SaveTo. */
+extern volatile float Map_SaveProgress;
+/* Whether Map_SaveTo is still saving a map in the background. */
+extern bool Map_Saving;
+
 /* Exports a world to a .cw ClassicWorld map file. */
 /* Compatible with ClassiCube/ClassicalSharp. */
 ReturnCode Cw_Save(struct Stream* stream);
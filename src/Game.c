@@ -3,6 +3,7 @@
 #include "World.h"
 #include "Lighting.h"
 #include "MapRenderer.h"
+#include "Builder.h"
 #include "Graphics.h"
 #include "Camera.h"
 #include "Options.h"
@@ -32,6 +33,7 @@
 #include "Menus.h"
 #include "Audio.h"
 #include "Stream.h"
+#include "Formats.h"
 
 struct _GameData Game;
 int  Game_Port;
@@ -52,7 +54,10 @@ bool Game_ViewBobbing, Game_HideGui;
 bool Game_BreakableLiquids, Game_ScreenshotRequested;
 float Game_RawHotbarScale, Game_RawChatScale, Game_RawInventoryScale;
 
-static struct ScheduledTask Game_Tasks[6];
+#define GAME_DEF_TASKS 6
+static struct ScheduledTask game_defTasks[GAME_DEF_TASKS];
+static struct ScheduledTask* Game_Tasks = game_defTasks;
+static uint32_t game_tasksMax = GAME_DEF_TASKS;
 static int Game_TasksCount, entTaskI;
 
 static char Game_UsernameBuffer[FILENAME_SIZE];
@@ -81,8 +86,9 @@ int ScheduledTask_Add(double interval, ScheduledTaskCallback callback) {
 	task.Interval    = interval;
 	task.Callback    = callback;
 
-	if (Game_TasksCount == Array_Elems(Game_Tasks)) {
-		Logger_Abort("ScheduledTask_Add - hit max count");
+	if (Game_TasksCount == game_tasksMax) {
+		Game_Tasks = (struct ScheduledTask*)Utils_Resize(Game_Tasks, &game_tasksMax,
+									sizeof(struct ScheduledTask), GAME_DEF_TASKS, GAME_DEF_TASKS);
 	}
 	Game_Tasks[Game_TasksCount++] = task;
 	return Game_TasksCount - 1;
@@ -203,16 +209,47 @@ void Game_Reset(void) {
 	}
 }
 
+static int game_batchDepth;
+#define GAME_DEF_EDITS 256
+static struct BlockEdit game_defEdits[GAME_DEF_EDITS];
+static struct BlockEdit* game_edits = game_defEdits;
+static uint32_t game_editsCount, game_editsMax = GAME_DEF_EDITS;
+
+static void Game_BatchEdit(int x, int y, int z, BlockID old, BlockID block) {
+	struct BlockEdit* edit;
+	if (game_editsCount == game_editsMax) {
+		game_edits = (struct BlockEdit*)Utils_Resize(game_edits, &game_editsMax,
+									sizeof(struct BlockEdit), GAME_DEF_EDITS, GAME_DEF_EDITS);
+	}
+
+	edit = &game_edits[game_editsCount++];
+	edit->X = x; edit->Y = y; edit->Z = z;
+	edit->Old = old; edit->New = block;
+}
+
+void Game_BeginBatch(void) { game_batchDepth++; }
+
+void Game_EndBatch(void) {
+	if (--game_batchDepth) return;
+	if (game_editsCount) Lighting_OnBlocksChanged(game_edits, game_editsCount);
+
+	if (game_editsMax > GAME_DEF_EDITS) Mem_Free(game_edits);
+	game_edits      = game_defEdits;
+	game_editsCount = 0;
+	game_editsMax   = GAME_DEF_EDITS;
+}
+
 void Game_UpdateBlock(int x, int y, int z, BlockID block) {
 	struct ChunkInfo* chunk;
 	int cx = x >> 4, cy = y >> 4, cz = z >> 4;
 	BlockID old = World_GetBlock(x, y, z);
 	World_SetBlock(x, y, z, block);
 
-	if (Weather_Heightmap) {
-		EnvRenderer_OnBlockChanged(x, y, z, old, block);
+	if (game_batchDepth) {
+		Game_BatchEdit(x, y, z, old, block);
+	} else {
+		Lighting_OnBlockChanged(x, y, z, old, block);
 	}
-	Lighting_OnBlockChanged(x, y, z, old, block);
 
 	/* Refresh the chunk the block was located in. */
 	chunk = MapRenderer_GetChunk(cx, cy, cz);
@@ -237,7 +274,7 @@ bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, const String*
 	bool success;
 	ReturnCode res;
 	
-	res = Png_Decode(&bmp, src);
+	res = TexturePack_DecodeFile(&bmp, src);
 	if (res) { Logger_Warn2(res, "decoding", file); }
 
 	success = !res && Game_ValidateBitmap(file, &bmp);
@@ -307,7 +344,7 @@ static void Game_TextureChangedCore(void* obj, struct Stream* src, const String*
 	ReturnCode res;
 
 	if (String_CaselessEqualsConst(name, "terrain.png")) {
-		res = Png_Decode(&bmp, src);
+		res = TexturePack_DecodeFile(&bmp, src);
 
 		if (res) { 
 			Logger_Warn2(res, "decoding", name);
@@ -463,6 +500,7 @@ static void Game_Load(void) {
 	/* TODO: Survival vs Creative game mode */
 
 	InputHandler_Init();
+	Game_AddComponent(&Formats_Component);
 	Game_AddComponent(&Blocks_Component);
 	Game_AddComponent(&Drawer2D_Component);
 
@@ -475,6 +513,7 @@ static void Game_Load(void) {
 	Game_AddComponent(&Http_Component);
 	Game_AddComponent(&Lighting_Component);
 
+	Game_AddComponent(&Textures_Component);
 	Game_AddComponent(&Animations_Component);
 	Game_AddComponent(&Inventory_Component);
 	World_Reset();
@@ -663,7 +702,7 @@ static void Game_RenderFrame(double delta) {
 	Game_UpdateViewMatrix();
 
 	visible = !Gui_Active || !Gui_Active->BlocksWorld;
-	if (visible && World.Blocks) {
+	if (visible && World.Loaded) {
 		Game_Render3D(delta, t);
 	} else {
 		PickedPos_SetAsInvalid(&Game_SelectedPos);
@@ -672,10 +711,15 @@ static void Game_RenderFrame(double delta) {
 	Gui_RenderGui(delta);
 	if (Game_ScreenshotRequested) Game_TakeScreenshot();
 	Gfx_EndFrame();
+#ifdef CC_BUILD_SPARSEWORLD
+	World_FreeRetiredSections();
+#endif
 }
 
 void Game_Free(void* obj) {
 	struct IGameComponent* comp;
+	/* Background chunk builders may still be reading world, lighting and atlas data */
+	Builder_CancelChunks();
 	Atlas_Free();
 
 	Event_UnregisterVoid(&WorldEvents.NewMap,         NULL, Game_OnNewMapCore);
@@ -85,6 +85,17 @@ CC_API void Game_UpdateBlock(int x, int y, int z, BlockID block);
 /* In multiplayer this is sent to the server, in singleplayer just activates physics. */
 CC_API void Game_ChangeBlock(int x, int y, int z, BlockID block);
 
+/* A block change made by Game_UpdateBlock while a batch is active. */
+struct BlockEdit { int X, Y, Z; BlockID Old, New; };
+/* Starts recording changes made by Game_UpdateBlock, instead of updating state after every single change. */
+/* When the outermost batch ends, light heights of changed columns are recalculated once, */
+/* and each affected chunk is only marked as needing to be redrawn once. */
+/* NOTE: Batches can be nested, and must always be ended with Game_EndBatch. */
+/* NOTE: Light heights (see Lighting_IsLit) are not updated until the batch has ended. */
+CC_API void Game_BeginBatch(void);
+/* Ends a batch started by Game_BeginBatch, updating state for all the changes made during it. */
+CC_API void Game_EndBatch(void);
+
 bool Game_CanPick(BlockID block);
 bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, const String* file, uint8_t* skinType);
 /* Checks that the given bitmap can be loaded into a native gfx texture. */
@@ -643,6 +643,13 @@ void NotchyGen_Generate(void) {
 BlockRaw* Tree_Blocks;
 RNGState* Tree_Rnd;
 
+#ifdef CC_BUILD_SPARSEWORLD
+/* Physics sets Tree_Blocks to NULL, as the world doesn't have a flat blocks array */
+#define TreeGen_IsAir(index, x, y, z) (Tree_Blocks ? Tree_Blocks[index] == BLOCK_AIR : World_GetBlock(x, y, z) == BLOCK_AIR)
+#else
+#define TreeGen_IsAir(index, x, y, z) (Tree_Blocks[index] == BLOCK_AIR)
+#endif
+
 bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 	int baseHeight = treeHeight - 4;
 	int index;
@@ -655,7 +662,7 @@ bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 
 				if (!World_Contains(x, y, z)) return false;
 				index = World_Pack(x, y, z);
-				if (Tree_Blocks[index] != BLOCK_AIR) return false;
+				if (!TreeGen_IsAir(index, x, y, z)) return false;
 			}
 		}
 	}
@@ -667,7 +674,7 @@ bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 
 				if (!World_Contains(x, y, z)) return false;
 				index = World_Pack(x, y, z);
-				if (Tree_Blocks[index] != BLOCK_AIR) return false;
+				if (!TreeGen_IsAir(index, x, y, z)) return false;
 			}
 		}
 	}
@@ -9,6 +9,7 @@
 #include "Event.h"
 #include "Block.h"
 #include "ExtMath.h"
+#include "Errors.h"
 
 #define WIN32_LEAN_AND_MEAN
 #define NOSERVICE
@@ -28,7 +29,7 @@ String Gfx_ApiInfo[7] = {
 GfxResourceID Gfx_defaultIb;
 GfxResourceID Gfx_quadVb, Gfx_texVb;
 
-const static int gfx_strideSizes[2] = { 16, 24 };
+const static int gfx_strideSizes[3] = { 16, 24, 16 };
 static int gfx_batchStride, gfx_batchFormat = -1;
 
 static bool gfx_vsync, gfx_fogEnabled;
@@ -284,7 +285,8 @@ void Texture_RenderShaded(const struct Texture* tex, PackedCol shadeCol) {
 #include <d3d9types.h>
 
 static D3DCMPFUNC d3d9_compareFuncs[8] = { D3DCMP_ALWAYS, D3DCMP_NOTEQUAL, D3DCMP_NEVER, D3DCMP_LESS, D3DCMP_LESSEQUAL, D3DCMP_EQUAL, D3DCMP_GREATEREQUAL, D3DCMP_GREATER };
-static DWORD d3d9_formatMappings[2] = { D3DFVF_XYZ | D3DFVF_DIFFUSE, D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX2 };
+/* NOTE: VERTEX_FORMAT_P3ST2SC4B has no FVF equivalent, and so is unsupported */
+static DWORD d3d9_formatMappings[3] = { D3DFVF_XYZ | D3DFVF_DIFFUSE, D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX2, 0 };
 
 static IDirect3D9* d3d;
 static IDirect3DDevice9* device;
@@ -720,9 +722,9 @@ GfxResourceID Gfx_CreateDynamicVb(VertexFormat fmt, int maxVertices) {
 	return vbuffer;
 }
 
-static void D3D9_SetVbData(IDirect3DVertexBuffer9* buffer, void* data, int size, const char* lockMsg, const char* unlockMsg, int lockFlags) {
+static void D3D9_SetVbData(IDirect3DVertexBuffer9* buffer, void* data, int offset, int size, const char* lockMsg, const char* unlockMsg, int lockFlags) {
 	void* dst = NULL;
-	ReturnCode res = IDirect3DVertexBuffer9_Lock(buffer, 0, size, &dst, lockFlags);
+	ReturnCode res = IDirect3DVertexBuffer9_Lock(buffer, offset, size, &dst, lockFlags);
 	if (res) Logger_Abort2(res, lockMsg);
 
 	Mem_Copy(dst, data, size);
@@ -744,7 +746,7 @@ GfxResourceID Gfx_CreateVb(void* vertices, VertexFormat fmt, int count) {
 		Event_RaiseVoid(&GfxEvents.LowVRAMDetected);
 	}
 
-	D3D9_SetVbData(vbuffer, vertices, size, "D3D9_CreateVb - Lock", "D3D9_CreateVb - Unlock", 0);
+	D3D9_SetVbData(vbuffer, vertices, 0, size, "D3D9_CreateVb - Lock", "D3D9_CreateVb - Unlock", 0);
 	return vbuffer;
 }
 
@@ -795,12 +797,21 @@ void Gfx_SetVertexFormat(VertexFormat fmt) {
 void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	int size = vCount * gfx_batchStride;
 	IDirect3DVertexBuffer9* vbuffer = (IDirect3DVertexBuffer9*)vb;
-	D3D9_SetVbData(vbuffer, vertices, size, "D3D9_SetDynamicVbData - Lock", "D3D9_SetDynamicVbData - Unlock", D3DLOCK_DISCARD);
+	D3D9_SetVbData(vbuffer, vertices, 0, size, "D3D9_SetDynamicVbData - Lock", "D3D9_SetDynamicVbData - Unlock", D3DLOCK_DISCARD);
 
 	ReturnCode res = IDirect3DDevice9_SetStreamSource(device, 0, vbuffer, 0, gfx_batchStride);
 	if (res) Logger_Abort2(res, "D3D9_SetDynamicVbData - Bind");
 }
 
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	int stride = gfx_strideSizes[fmt];
+	IDirect3DVertexBuffer9* vbuffer = (IDirect3DVertexBuffer9*)vb;
+	/* Can't use D3DLOCK_DISCARD here, as that would throw away the rest of the buffer's data */
+	/* D3DLOCK_NOOVERWRITE avoids stalling until the GPU has finished with the whole buffer */
+	D3D9_SetVbData(vbuffer, vertices, startVertex * stride, vCount * stride, 
+		"D3D9_SetDynamicVbRange - Lock", "D3D9_SetDynamicVbRange - Unlock", D3DLOCK_NOOVERWRITE);
+}
+
 void Gfx_DrawVb_Lines(int verticesCount) {
 	/* NOTE: Skip checking return result for Gfx_DrawXYZ for performance */
 	IDirect3DDevice9_DrawPrimitive(device, D3DPT_LINELIST, 0, verticesCount >> 1);
@@ -983,6 +994,215 @@ void Gfx_OnWindowResize(void) {
 }
 #endif
 
+/*########################################################################################################################*
+*-------------------------------------------------------Null graphics-----------------------------------------------------*
+*#########################################################################################################################*/
+#ifdef CC_BUILD_NULLGFX
+struct GfxNullStats GfxNull_Frame, GfxNull_LastFrame;
+static GfxResourceID null_lastId;
+/* Currently bound resources */
+static GfxResourceID null_tex, null_vb, null_ib;
+/* Current render state */
+static bool null_texturing, null_mipmaps, null_faceCulling, null_alphaTest, null_alphaBlending, null_alphaArgBlend;
+static bool null_depthTest, null_depthWrite, null_colWrite[4];
+static int  null_fogMode, null_alphaFunc, null_srcBlend, null_dstBlend, null_depthFunc;
+static float null_fogDensity, null_fogEnd, null_alphaRef;
+static PackedCol null_fogCol, null_clearCol;
+
+/* Only counts as a state change when the state actually changes */
+#define NullGfx_Set(state, value) if (state != (value)) { state = (value); GfxNull_Frame.StateChanges++; }
+#define NullGfx_SetCol(state, value) if (!PackedCol_Equals(state, value)) { state = value; GfxNull_Frame.StateChanges++; }
+#define NullGfx_Draw(verticesCount) GfxNull_Frame.DrawCalls++; GfxNull_Frame.Vertices += verticesCount;
+
+void Gfx_Init(void) {
+	Gfx.MinZNear     = 0.1f;
+	Gfx.MaxTexWidth  = 8192;
+	Gfx.MaxTexHeight = 8192;
+	Gfx_InitDefaultResources();
+}
+
+void Gfx_Free(void) { Gfx_FreeDefaultResources(); }
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------Textures--------------------------------------------------------*
+*#########################################################################################################################*/
+GfxResourceID Gfx_CreateTexture(Bitmap* bmp, bool managedPool, bool mipmaps) {
+	GfxNull_Frame.Textures++;
+	GfxNull_Frame.BytesUploaded += Bitmap_DataSize(bmp->Width, bmp->Height);
+	return ++null_lastId;
+}
+
+void Gfx_UpdateTexturePart(GfxResourceID texId, int x, int y, Bitmap* part, bool mipmaps) {
+	GfxNull_Frame.BytesUploaded += Bitmap_DataSize(part->Width, part->Height);
+}
+
+void Gfx_BindTexture(GfxResourceID texId) { NullGfx_Set(null_tex, texId); }
+
+void Gfx_DeleteTexture(GfxResourceID* texId) {
+	if (!texId || *texId == GFX_NULL) return;
+	GfxNull_Frame.Textures--;
+	*texId = GFX_NULL;
+}
+
+void Gfx_SetTexturing(bool enabled) { NullGfx_Set(null_texturing, enabled); }
+void Gfx_EnableMipmaps(void)  { NullGfx_Set(null_mipmaps, true); }
+void Gfx_DisableMipmaps(void) { NullGfx_Set(null_mipmaps, false); }
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------State management----------------------------------------------------*
+*#########################################################################################################################*/
+void Gfx_SetFog(bool enabled)          { NullGfx_Set(gfx_fogEnabled, enabled); }
+void Gfx_SetFogCol(PackedCol col)      { NullGfx_SetCol(null_fogCol, col); }
+void Gfx_SetFogDensity(float value)    { NullGfx_Set(null_fogDensity, value); }
+void Gfx_SetFogEnd(float value)        { NullGfx_Set(null_fogEnd, value); }
+void Gfx_SetFogMode(FogFunc func)      { NullGfx_Set(null_fogMode, func); }
+
+void Gfx_SetFaceCulling(bool enabled)  { NullGfx_Set(null_faceCulling, enabled); }
+void Gfx_SetAlphaTest(bool enabled)    { NullGfx_Set(null_alphaTest, enabled); }
+void Gfx_SetAlphaTestFunc(CompareFunc func, float refValue) {
+	NullGfx_Set(null_alphaFunc, func);
+	NullGfx_Set(null_alphaRef, refValue);
+}
+void Gfx_SetAlphaBlending(bool enabled) { NullGfx_Set(null_alphaBlending, enabled); }
+void Gfx_SetAlphaBlendFunc(BlendFunc srcFunc, BlendFunc dstFunc) {
+	NullGfx_Set(null_srcBlend, srcFunc);
+	NullGfx_Set(null_dstBlend, dstFunc);
+}
+void Gfx_SetAlphaArgBlend(bool enabled) { NullGfx_Set(null_alphaArgBlend, enabled); }
+
+void Gfx_Clear(void) { }
+void Gfx_ClearCol(PackedCol col)           { NullGfx_SetCol(null_clearCol, col); }
+void Gfx_SetDepthTest(bool enabled)        { NullGfx_Set(null_depthTest, enabled); }
+void Gfx_SetDepthTestFunc(CompareFunc func) { NullGfx_Set(null_depthFunc, func); }
+void Gfx_SetDepthWrite(bool enabled)       { NullGfx_Set(null_depthWrite, enabled); }
+void Gfx_SetColWriteMask(bool r, bool g, bool b, bool a) {
+	NullGfx_Set(null_colWrite[0], r); NullGfx_Set(null_colWrite[1], g);
+	NullGfx_Set(null_colWrite[2], b); NullGfx_Set(null_colWrite[3], a);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Vertex/Index buffers--------------------------------------------------*
+*#########################################################################################################################*/
+GfxResourceID Gfx_CreateDynamicVb(VertexFormat fmt, int maxVertices) {
+	GfxNull_Frame.VertexBuffers++;
+	return ++null_lastId;
+}
+
+GfxResourceID Gfx_CreateVb(void* vertices, VertexFormat fmt, int count) {
+	GfxNull_Frame.VertexBuffers++;
+	GfxNull_Frame.BytesUploaded += count * gfx_strideSizes[fmt];
+	return ++null_lastId;
+}
+
+GfxResourceID Gfx_CreateIb(void* indices, int indicesCount) {
+	GfxNull_Frame.IndexBuffers++;
+	GfxNull_Frame.BytesUploaded += indicesCount * 2;
+	return ++null_lastId;
+}
+
+void Gfx_BindVb(GfxResourceID vb) { NullGfx_Set(null_vb, vb); }
+void Gfx_BindIb(GfxResourceID ib) { NullGfx_Set(null_ib, ib); }
+
+void Gfx_DeleteVb(GfxResourceID* vb) {
+	if (!vb || *vb == GFX_NULL) return;
+	GfxNull_Frame.VertexBuffers--;
+	*vb = GFX_NULL;
+}
+
+void Gfx_DeleteIb(GfxResourceID* ib) {
+	if (!ib || *ib == GFX_NULL) return;
+	GfxNull_Frame.IndexBuffers--;
+	*ib = GFX_NULL;
+}
+
+void Gfx_SetVertexFormat(VertexFormat fmt) {
+	if (fmt == gfx_batchFormat) return;
+	gfx_batchFormat = fmt;
+	gfx_batchStride = gfx_strideSizes[fmt];
+	GfxNull_Frame.StateChanges++;
+}
+
+void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
+	GfxNull_Frame.BytesUploaded += vCount * gfx_batchStride;
+	NullGfx_Set(null_vb, vb);
+}
+
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	GfxNull_Frame.BytesUploaded += vCount * gfx_strideSizes[fmt];
+}
+
+void Gfx_DrawVb_Lines(int verticesCount)                           { NullGfx_Draw(verticesCount); }
+void Gfx_DrawVb_IndexedTris_Range(int verticesCount, int startVertex) { NullGfx_Draw(verticesCount); }
+void Gfx_DrawVb_IndexedTris(int verticesCount)                     { NullGfx_Draw(verticesCount); }
+void Gfx_DrawIndexedVb_TrisT2fC4b(int verticesCount, int startVertex) { NullGfx_Draw(verticesCount); }
+#ifdef CC_BUILD_COMPACTCHUNKS
+void Gfx_DrawIndexedVb_TrisT2sC4b(int verticesCount, int startVertex) { NullGfx_Draw(verticesCount); }
+#endif
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------Matrices--------------------------------------------------------*
+*#########################################################################################################################*/
+void Gfx_LoadMatrix(MatrixType type, struct Matrix* matrix) { GfxNull_Frame.StateChanges++; }
+void Gfx_LoadIdentityMatrix(MatrixType type)                { GfxNull_Frame.StateChanges++; }
+
+void Gfx_CalcOrthoMatrix(float width, float height, struct Matrix* matrix) {
+	Matrix_OrthographicOffCenter(matrix, 0.0f, width, height, 0.0f, -10000.0f, 10000.0f);
+}
+void Gfx_CalcPerspectiveMatrix(float fov, float aspect, float zNear, float zFar, struct Matrix* matrix) {
+	Matrix_PerspectiveFieldOfView(matrix, fov, aspect, zNear, zFar);
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------------Misc----------------------------------------------------------*
+*#########################################################################################################################*/
+ReturnCode Gfx_TakeScreenshot(struct Stream* output) { return ERR_NOT_SUPPORTED; }
+bool Gfx_WarnIfNecessary(void) { return false; }
+
+void Gfx_SetFpsLimit(bool vsync, float minFrameMs) {
+	gfx_minFrameMs = minFrameMs;
+	gfx_vsync      = vsync;
+}
+
+void Gfx_BeginFrame(void) {
+	frameStart = Stopwatch_Measure();
+	GfxNull_Frame.DrawCalls     = 0;
+	GfxNull_Frame.Vertices      = 0;
+	GfxNull_Frame.StateChanges  = 0;
+	GfxNull_Frame.BytesUploaded = 0;
+}
+
+void Gfx_EndFrame(void) {
+	GfxNull_LastFrame = GfxNull_Frame;
+	if (gfx_minFrameMs) Gfx_LimitFPS();
+}
+
+void Gfx_OnWindowResize(void) { }
+
+void Gfx_MakeApiInfo(void) {
+	int pointerSize = sizeof(void*) * 8;
+	String_Format1(&Gfx_ApiInfo[0], "-- Using null graphics (%i bit) --", &pointerSize);
+	String_Format2(&Gfx_ApiInfo[1], "Max texture size: (%i, %i)", &Gfx.MaxTexWidth, &Gfx.MaxTexHeight);
+	Gfx_UpdateApiInfo();
+}
+
+void Gfx_UpdateApiInfo(void) {
+	struct GfxNullStats* s = &GfxNull_LastFrame;
+	Gfx_ApiInfo[2].length = 0;
+	Gfx_ApiInfo[3].length = 0;
+	Gfx_ApiInfo[4].length = 0;
+
+	String_Format3(&Gfx_ApiInfo[2], "Resources: %i vertex buffers, %i index buffers, %i textures",
+		&s->VertexBuffers, &s->IndexBuffers, &s->Textures);
+	String_Format2(&Gfx_ApiInfo[3], "Last frame: %i draw calls, %i vertices", &s->DrawCalls, &s->Vertices);
+	String_Format2(&Gfx_ApiInfo[4], "Last frame: %i state changes, %i bytes uploaded", &s->StateChanges, &s->BytesUploaded);
+}
+#endif
+
 
 /*########################################################################################################################*
 *----------------------------------------------------------OpenGL---------------------------------------------------------*
@@ -992,7 +1212,7 @@ void Gfx_OnWindowResize(void) {
  * - OpenGL 1.5 or OpenGL 1.2 + GL_ARB_vertex_buffer_object (default desktop backend)
  * - OpenGL 2.0 (alternative modern-ish backend)
 */
-#ifndef CC_BUILD_D3D9
+#if !defined CC_BUILD_D3D9 && !defined CC_BUILD_NULLGFX
 #if defined CC_BUILD_WIN
 #include <windows.h>
 #include <GL/gl.h>
@@ -1249,6 +1469,12 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	_glBindBuffer(GL_ARRAY_BUFFER, (GLuint)vb);
 	_glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
 }
+
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	uint32_t stride = gfx_strideSizes[fmt];
+	_glBindBuffer(GL_ARRAY_BUFFER, (GLuint)vb);
+	_glBufferSubData(GL_ARRAY_BUFFER, startVertex * stride, vCount * stride, vertices);
+}
 #endif
 
 
@@ -1347,24 +1573,29 @@ void Gfx_OnWindowResize(void) {
 #define FTR_LINEAR_FOG (1 << 3)
 #define FTR_DENSIT_FOG (1 << 4)
 #define FTR_HASANY_FOG (FTR_LINEAR_FOG | FTR_DENSIT_FOG)
+#define FTR_CHUNK_LIGHT (1 << 5)
 
 #define UNI_MVP_MATRIX (1 << 0)
 #define UNI_TEX_MATRIX (1 << 1)
 #define UNI_FOG_COL    (1 << 2)
 #define UNI_FOG_END    (1 << 3)
 #define UNI_FOG_DENS   (1 << 4)
+#define UNI_LIGHT_COLS (1 << 5)
+#define UNI_TILE_SIZE  (1 << 6)
 
 /* cached uniforms (cached for multiple programs */
 static struct Matrix _view, _proj, _tex, _mvp;
 static bool gfx_alphaTest, gfx_texTransform;
+static PackedCol gfx_sunCol, gfx_shadowCol;
+static float gfx_tileSize;
 
 /* shader programs (emulate fixed function) */
 static struct GLShader {
 	int Features;     /* what features are enabled for this shader */
 	int Uniforms;     /* which associated uniforms need to be resent to GPU */
 	GLuint Program;   /* OpenGL program ID (0 if not yet compiled) */
-	int Locations[5]; /* location of uniforms (not constant) */
-} shaders[6 * 3] = {
+	int Locations[8]; /* location of uniforms (not constant) */
+} shaders[10 * 3] = {
 	/* no fog */
 	{ 0              },
 	{ 0              | FTR_ALPHA_TEST },
@@ -1372,6 +1603,10 @@ static struct GLShader {
 	{ FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_TEXTURE_UV | FTR_TEX_MATRIX },
 	{ FTR_TEXTURE_UV | FTR_TEX_MATRIX | FTR_ALPHA_TEST },
+	{ FTR_TEXTURE_UV | FTR_CHUNK_LIGHT },
+	{ FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_ALPHA_TEST },
+	{ FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_TEX_MATRIX },
+	{ FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_TEX_MATRIX | FTR_ALPHA_TEST },
 	/* linear fog */
 	{ FTR_LINEAR_FOG | 0              },
 	{ FTR_LINEAR_FOG | 0              | FTR_ALPHA_TEST },
@@ -1379,6 +1614,10 @@ static struct GLShader {
 	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_TEX_MATRIX },
 	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_TEX_MATRIX | FTR_ALPHA_TEST },
+	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT },
+	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_ALPHA_TEST },
+	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_TEX_MATRIX },
+	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_TEX_MATRIX | FTR_ALPHA_TEST },
 	/* density fog */
 	{ FTR_DENSIT_FOG | 0              },
 	{ FTR_DENSIT_FOG | 0              | FTR_ALPHA_TEST },
@@ -1386,6 +1625,10 @@ static struct GLShader {
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_MATRIX },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_MATRIX | FTR_ALPHA_TEST },
+	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT },
+	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_ALPHA_TEST },
+	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_TEX_MATRIX },
+	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_CHUNK_LIGHT | FTR_TEX_MATRIX | FTR_ALPHA_TEST },
 };
 static struct GLShader* gfx_activeShader;
 
@@ -1393,21 +1636,35 @@ static struct GLShader* gfx_activeShader;
 static void Gfx_GenVertexShader(const struct GLShader* shader, String* dst) {
 	int uv = shader->Features & FTR_TEXTURE_UV;
 	int tm = shader->Features & FTR_TEX_MATRIX;
+	int lt = shader->Features & FTR_CHUNK_LIGHT;
 
-	String_AppendConst(dst,         "attribute vec3 in_pos;\n");
+	/* W of chunk vertices is the index of the tile within the 1D atlas (see Builder_PackVertices) */
+	if (lt) String_AppendConst(dst, "attribute vec4 in_pos;\n");
+	else    String_AppendConst(dst, "attribute vec3 in_pos;\n");
 	String_AppendConst(dst,         "attribute vec4 in_col;\n");
 	if (uv) String_AppendConst(dst, "attribute vec2 in_uv;\n");
 	String_AppendConst(dst,         "varying vec4 out_col;\n");
 	if (uv) String_AppendConst(dst, "varying vec2 out_uv;\n");
+	if (lt) String_AppendConst(dst, "varying float out_tile;\n");
 	String_AppendConst(dst,         "uniform mat4 mvp;\n");
 	if (tm) String_AppendConst(dst, "uniform mat4 texMatrix;\n");
+	if (lt) String_AppendConst(dst, "uniform vec3 sunCol;\n");
+	if (lt) String_AppendConst(dst, "uniform vec3 shadowCol;\n");
+	if (lt) String_AppendConst(dst, "uniform float tileSize;\n");
 
 	String_AppendConst(dst,         "void main() {\n");
-	String_AppendConst(dst,         "  gl_Position = mvp * vec4(in_pos, 1.0);\n");
-	String_AppendConst(dst,         "  out_col = in_col;\n");
+	if (lt) String_AppendConst(dst, "  gl_Position = mvp * vec4(in_pos.xyz, 1.0);\n");
+	else    String_AppendConst(dst, "  gl_Position = mvp * vec4(in_pos, 1.0);\n");
+	/* see CHUNK_LIGHT_SUN and CHUNK_LIGHT_FULLBRIGHT */
+	if (lt) String_AppendConst(dst, "  vec3 light = in_col.a > 0.998 ? vec3(1.0) : mix(shadowCol, sunCol, in_col.a * (255.0 / 254.0));\n");
+	if (lt) String_AppendConst(dst, "  out_col = vec4(in_col.rgb * light, 1.0);\n");
+	else    String_AppendConst(dst, "  out_col = in_col;\n");
 	if (uv) String_AppendConst(dst, "  out_uv  = in_uv;\n");
 	/* TODO: Fix this dirty hack for clouds */
 	if (tm) String_AppendConst(dst, "  out_uv = (texMatrix * vec4(out_uv,0.0,1.0)).xy;\n");
+	/* V relative to the top of the tile, in tiles. Greedy meshing merges faces past the tile's bottom edge */
+	if (lt) String_AppendConst(dst, "  out_uv.y = out_uv.y / tileSize - in_pos.w;\n");
+	if (lt) String_AppendConst(dst, "  out_tile = in_pos.w;\n");
 	String_AppendConst(dst,         "}");
 }
 
@@ -1418,20 +1675,26 @@ static void Gfx_GenFragmentShader(const struct GLShader* shader, String* dst) {
 	int fl = shader->Features & FTR_LINEAR_FOG;
 	int fd = shader->Features & FTR_DENSIT_FOG;
 	int fm = shader->Features & FTR_HASANY_FOG;
+	int lt = shader->Features & FTR_CHUNK_LIGHT;
 
 #ifdef CC_BUILD_GLES
 	String_AppendConst(dst,         "precision highp float;\n");
 #endif
 	String_AppendConst(dst,         "varying vec4 out_col;\n");
 	if (uv) String_AppendConst(dst, "varying vec2 out_uv;\n");
+	if (lt) String_AppendConst(dst, "varying float out_tile;\n");
 	if (uv) String_AppendConst(dst, "uniform sampler2D texImage;\n");
+	if (lt) String_AppendConst(dst, "uniform float tileSize;\n");
 	if (fm) String_AppendConst(dst, "uniform vec4 fogCol;\n");
 	if (fl) String_AppendConst(dst, "uniform float fogEnd;\n");
 	if (fd) String_AppendConst(dst, "uniform float fogDensity;\n");
 
 	String_AppendConst(dst,         "void main() {\n");
-	if (uv) String_AppendConst(dst, "  vec4 col = texture2D(texImage, out_uv) * out_col;\n");
-	else    String_AppendConst(dst, "  vec4 col = out_col;\n");
+	/* Repeats the tile vertically, instead of running into the tiles below it in the atlas */
+	/* (V can be slightly below the top of the tile from rounding, which must not wrap to the bottom) */
+	if (lt)      String_AppendConst(dst, "  vec4 col = texture2D(texImage, vec2(out_uv.x, (out_tile + fract(max(out_uv.y, 0.0))) * tileSize)) * out_col;\n");
+	else if (uv) String_AppendConst(dst, "  vec4 col = texture2D(texImage, out_uv) * out_col;\n");
+	else         String_AppendConst(dst, "  vec4 col = out_col;\n");
 	if (al) String_AppendConst(dst, "  if (col.a < 0.5) discard;\n");
 	if (fm) String_AppendConst(dst, "  float depth = gl_FragCoord.z / gl_FragCoord.w;\n");
 	if (fl) String_AppendConst(dst, "  float f = clamp((fogEnd - depth) / fogEnd, 0.0, 1.0);\n");
@@ -1504,6 +1767,9 @@ static void Gfx_CompileProgram(struct GLShader* shader) {
 		shader->Locations[2] = glGetUniformLocation(program, "fogCol");
 		shader->Locations[3] = glGetUniformLocation(program, "fogEnd");
 		shader->Locations[4] = glGetUniformLocation(program, "fogDensity");
+		shader->Locations[5] = glGetUniformLocation(program, "sunCol");
+		shader->Locations[6] = glGetUniformLocation(program, "shadowCol");
+		shader->Locations[7] = glGetUniformLocation(program, "tileSize");
 		return;
     }
 	temp = 0;
@@ -1552,6 +1818,15 @@ static void Gfx_ReloadUniforms(void) {
 		glUniform1f(s->Locations[4], -gfx_fogDensity);
 		s->Uniforms &= ~UNI_FOG_DENS;
 	}
+	if ((s->Uniforms & UNI_LIGHT_COLS) && (s->Features & FTR_CHUNK_LIGHT)) {
+		glUniform3f(s->Locations[5], gfx_sunCol.R / 255.0f,    gfx_sunCol.G / 255.0f,    gfx_sunCol.B / 255.0f);
+		glUniform3f(s->Locations[6], gfx_shadowCol.R / 255.0f, gfx_shadowCol.G / 255.0f, gfx_shadowCol.B / 255.0f);
+		s->Uniforms &= ~UNI_LIGHT_COLS;
+	}
+	if ((s->Uniforms & UNI_TILE_SIZE) && (s->Features & FTR_CHUNK_LIGHT)) {
+		glUniform1f(s->Locations[7], gfx_tileSize);
+		s->Uniforms &= ~UNI_TILE_SIZE;
+	}
 }
 
 /* Switches program to one that duplicates current fixed function state */
@@ -1561,11 +1836,12 @@ static void Gfx_SwitchProgram(void) {
 	int index = 0;
 
 	if (gfx_fogEnabled) {
-		index += 6;                       /* linear fog */
-		if (gfx_fogMode >= 1) index += 6; /* exp fog */
+		index += 10;                       /* linear fog */
+		if (gfx_fogMode >= 1) index += 10; /* exp fog */
 	}
 
-	if (gfx_batchFormat == VERTEX_FORMAT_P3FT2FC4B) index += 2;
+	if (gfx_batchFormat != VERTEX_FORMAT_P3FC4B) index += 2;
+	if (gfx_batchFormat == VERTEX_FORMAT_P3ST2SC4B) index += 4;
 	if (gfx_texTransform) index += 2;
 	if (gfx_alphaTest)    index += 1;
 
@@ -1607,6 +1883,21 @@ void Gfx_SetFogMode(FogFunc func) {
 	Gfx_SwitchProgram();
 }
 
+void Gfx_SetChunkLightCols(PackedCol sun, PackedCol shadow) {
+	if (PackedCol_Equals(sun, gfx_sunCol) && PackedCol_Equals(shadow, gfx_shadowCol)) return;
+	gfx_sunCol    = sun;
+	gfx_shadowCol = shadow;
+	Gfx_DirtyUniform(UNI_LIGHT_COLS);
+	Gfx_ReloadUniforms();
+}
+
+void Gfx_SetChunkTileSize(float size) {
+	if (gfx_tileSize == size) return;
+	gfx_tileSize = size;
+	Gfx_DirtyUniform(UNI_TILE_SIZE);
+	Gfx_ReloadUniforms();
+}
+
 void Gfx_SetTexturing(bool enabled) { }
 void Gfx_SetAlphaTest(bool enabled) { gfx_alphaTest = enabled; Gfx_SwitchProgram(); }
 void Gfx_SetAlphaTestFunc(CompareFunc func, float refValue) { }
@@ -1658,6 +1949,12 @@ static void GL_SetupVbPos3fTex2fCol4b(void) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, sizeof(VertexP3fT2fC4b), (void*)16);
 }
 
+static void GL_SetupVbPos3sTex2sCol4b(void) {
+	glVertexAttribPointer(0, 4, GL_SHORT,         false, sizeof(VertexP3sT2sC4b), (void*)0);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true,  sizeof(VertexP3sT2sC4b), (void*)8);
+	glVertexAttribPointer(2, 2, GL_SHORT,         false, sizeof(VertexP3sT2sC4b), (void*)12);
+}
+
 static void GL_SetupVbPos3fCol4b_Range(int startVertex) {
 	uint32_t offset = startVertex * (uint32_t)sizeof(VertexP3fC4b);
 	glVertexAttribPointer(0, 3, GL_FLOAT,         false, sizeof(VertexP3fC4b), (void*)(offset));
@@ -1671,6 +1968,13 @@ static void GL_SetupVbPos3fTex2fCol4b_Range(int startVertex) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, sizeof(VertexP3fT2fC4b), (void*)(offset + 16));
 }
 
+static void GL_SetupVbPos3sTex2sCol4b_Range(int startVertex) {
+	uint32_t offset = startVertex * (uint32_t)sizeof(VertexP3sT2sC4b);
+	glVertexAttribPointer(0, 4, GL_SHORT,         false, sizeof(VertexP3sT2sC4b), (void*)(offset));
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true,  sizeof(VertexP3sT2sC4b), (void*)(offset + 8));
+	glVertexAttribPointer(2, 2, GL_SHORT,         false, sizeof(VertexP3sT2sC4b), (void*)(offset + 12));
+}
+
 void Gfx_SetVertexFormat(VertexFormat fmt) {
 	if (fmt == gfx_batchFormat) return;
 	gfx_batchFormat = fmt;
@@ -1680,6 +1984,10 @@ void Gfx_SetVertexFormat(VertexFormat fmt) {
 		glEnableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbPos3fTex2fCol4b;
 		gfx_setupVBRangeFunc = GL_SetupVbPos3fTex2fCol4b_Range;
+	} else if (fmt == VERTEX_FORMAT_P3ST2SC4B) {
+		glEnableVertexAttribArray(2);
+		gfx_setupVBFunc      = GL_SetupVbPos3sTex2sCol4b;
+		gfx_setupVBRangeFunc = GL_SetupVbPos3sTex2sCol4b_Range;
 	} else {
 		glDisableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbPos3fCol4b;
@@ -1710,6 +2018,14 @@ void Gfx_DrawIndexedVb_TrisT2fC4b(int verticesCount, int startVertex) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, sizeof(VertexP3fT2fC4b), (void*)(offset + 16));
 	glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
  }
+
+void Gfx_DrawIndexedVb_TrisT2sC4b(int verticesCount, int startVertex) {
+	uint32_t offset = startVertex * (uint32_t)sizeof(VertexP3sT2sC4b);
+	glVertexAttribPointer(0, 4, GL_SHORT,         false, sizeof(VertexP3sT2sC4b), (void*)(offset));
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true,  sizeof(VertexP3sT2sC4b), (void*)(offset + 8));
+	glVertexAttribPointer(2, 2, GL_SHORT,         false, sizeof(VertexP3sT2sC4b), (void*)(offset + 12));
+	glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
+}
 #endif
 
 
@@ -1803,6 +2119,12 @@ static void GL_SetupVbPos3fTex2fCol4b(void) {
 	glTexCoordPointer(2, GL_FLOAT,      sizeof(VertexP3fT2fC4b), (void*)(VB_PTR + 16));
 }
 
+static void GL_SetupVbPos3sTex2sCol4b(void) {
+	glVertexPointer(3, GL_SHORT,        sizeof(VertexP3sT2sC4b), (void*)(VB_PTR + 0));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(VertexP3sT2sC4b), (void*)(VB_PTR + 8));
+	glTexCoordPointer(2, GL_SHORT,      sizeof(VertexP3sT2sC4b), (void*)(VB_PTR + 12));
+}
+
 static void GL_SetupVbPos3fCol4b_Range(int startVertex) {
 	uint32_t offset = startVertex * (uint32_t)sizeof(VertexP3fC4b);
 	glVertexPointer(3, GL_FLOAT,          sizeof(VertexP3fC4b), (void*)(VB_PTR + offset));
@@ -1816,6 +2138,13 @@ static void GL_SetupVbPos3fTex2fCol4b_Range(int startVertex) {
 	glTexCoordPointer(2, GL_FLOAT,        sizeof(VertexP3fT2fC4b), (void*)(VB_PTR + offset + 16));
 }
 
+static void GL_SetupVbPos3sTex2sCol4b_Range(int startVertex) {
+	uint32_t offset = startVertex * (uint32_t)sizeof(VertexP3sT2sC4b);
+	glVertexPointer(3, GL_SHORT,          sizeof(VertexP3sT2sC4b), (void*)(VB_PTR + offset));
+	glColorPointer(4, GL_UNSIGNED_BYTE,   sizeof(VertexP3sT2sC4b), (void*)(VB_PTR + offset + 8));
+	glTexCoordPointer(2, GL_SHORT,        sizeof(VertexP3sT2sC4b), (void*)(VB_PTR + offset + 12));
+}
+
 void Gfx_SetVertexFormat(VertexFormat fmt) {
 	if (fmt == gfx_batchFormat) return;
 	gfx_batchFormat = fmt;
@@ -1825,6 +2154,10 @@ void Gfx_SetVertexFormat(VertexFormat fmt) {
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 		gfx_setupVBFunc      = GL_SetupVbPos3fTex2fCol4b;
 		gfx_setupVBRangeFunc = GL_SetupVbPos3fTex2fCol4b_Range;
+	} else if (fmt == VERTEX_FORMAT_P3ST2SC4B) {
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		gfx_setupVBFunc      = GL_SetupVbPos3sTex2sCol4b;
+		gfx_setupVBRangeFunc = GL_SetupVbPos3sTex2sCol4b_Range;
 	} else {
 		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 		gfx_setupVBFunc      = GL_SetupVbPos3fCol4b;
@@ -1862,6 +2195,14 @@ void Gfx_DrawIndexedVb_TrisT2fC4b(int verticesCount, int startVertex) {
 	glDrawElements(GL_TRIANGLES,        ICOUNT(verticesCount),   GL_UNSIGNED_SHORT, NULL);
 }
 
+void Gfx_DrawIndexedVb_TrisT2sC4b(int verticesCount, int startVertex) {
+	uint32_t offset = startVertex * (uint32_t)sizeof(VertexP3sT2sC4b);
+	glVertexPointer(3, GL_SHORT,        sizeof(VertexP3sT2sC4b), (void*)(offset));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(VertexP3sT2sC4b), (void*)(offset + 8));
+	glTexCoordPointer(2, GL_SHORT,      sizeof(VertexP3sT2sC4b), (void*)(offset + 12));
+	glDrawElements(GL_TRIANGLES,        ICOUNT(verticesCount),   GL_UNSIGNED_SHORT, NULL);
+}
+
 static void GL_CheckSupport(void) {
 	const static String vboExt = String_FromConst("GL_ARB_vertex_buffer_object");
 	String extensions  = String_FromReadonly(glGetString(GL_EXTENSIONS));
@@ -1936,6 +2277,10 @@ void Gfx_DrawIndexedVb_TrisT2fC4b(int verticesCount, int startVertex) {
 	gl_lastPartialList = gfx_activeList;
 }
 
+void Gfx_DrawIndexedVb_TrisT2sC4b(int verticesCount, int startVertex) {
+	Gfx_DrawIndexedVb_TrisT2fC4b(verticesCount, startVertex);
+}
+
 static void GL_CheckSupport(void) {
 	Gfx_MakeIndices(gl_indices, GFX_MAX_INDICES);
 }
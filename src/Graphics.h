@@ -22,7 +22,7 @@ typedef enum BlendFunc_ {
 } BlendFunc;
 
 typedef enum VertexFormat_ {
-	VERTEX_FORMAT_P3FC4B, VERTEX_FORMAT_P3FT2FC4B
+	VERTEX_FORMAT_P3FC4B, VERTEX_FORMAT_P3FT2FC4B, VERTEX_FORMAT_P3ST2SC4B
 } VertexFormat;
 typedef enum FogFunc_ {
 	FOG_LINEAR, FOG_EXP, FOG_EXP2
@@ -49,6 +49,23 @@ CC_VAR extern struct _GfxData {
 	ScheduledTaskCallback LostContextFunction;
 } Gfx;
 
+#ifdef CC_BUILD_NULLGFX
+/* What the null graphics backend would have rendered. */
+struct GfxNullStats {
+	/* Number of currently allocated resources */
+	int VertexBuffers, IndexBuffers, Textures;
+	/* Number of draw calls made, and vertices drawn by them */
+	int DrawCalls, Vertices;
+	/* Number of times render state (incl. bound buffers/textures and matrices) was changed */
+	int StateChanges;
+	/* Bytes of vertex, index and texture data uploaded */
+	uint32_t BytesUploaded;
+};
+/* Stats for the frame currently being rendered, and for the last frame rendered. */
+/* NOTE: Per frame counters are reset by Gfx_BeginFrame, resource counts are never reset. */
+extern struct GfxNullStats GfxNull_Frame, GfxNull_LastFrame;
+#endif
+
 extern String Gfx_ApiInfo[7];
 extern GfxResourceID Gfx_defaultIb;
 extern GfxResourceID Gfx_quadVb, Gfx_texVb;
@@ -134,6 +151,12 @@ CC_API void Gfx_DeleteIb(GfxResourceID* ib);
 CC_API void Gfx_SetVertexFormat(VertexFormat fmt);
 /* Updates the data of a dynamic vertex buffer. */
 CC_API void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount);
+#ifndef CC_BUILD_GL11
+/* Updates part of the data of a dynamic vertex buffer, starting at the given vertex. */
+/* NOTE: Unlike Gfx_SetDynamicVbData, the rest of the vertex buffer's data is preserved. */
+/* NOTE: The range must not be used by any draws that the GPU may not have finished yet. */
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount);
+#endif
 /* Renders vertices from the currently bound vertex buffer as lines. */
 CC_API void Gfx_DrawVb_Lines(int verticesCount);
 /* Renders vertices from the currently bound vertex and index buffer as triangles. */
@@ -143,6 +166,18 @@ CC_API void Gfx_DrawVb_IndexedTris_Range(int verticesCount, int startVertex);
 CC_API void Gfx_DrawVb_IndexedTris(int verticesCount);
 /* Special case Gfx_DrawVb_IndexedTris_Range for map renderer */
 void Gfx_DrawIndexedVb_TrisT2fC4b(int verticesCount, int startVertex);
+#ifdef CC_BUILD_COMPACTCHUNKS
+/* Special case Gfx_DrawVb_IndexedTris_Range for map renderer, with compact chunk vertices */
+void Gfx_DrawIndexedVb_TrisT2sC4b(int verticesCount, int startVertex);
+#endif
+#ifdef CC_BUILD_SHADEDCHUNKS
+/* Sets the colours that VERTEX_FORMAT_P3ST2SC4B vertices in sunlight and in shadow are multiplied by. */
+/* The alpha of these vertices is how lit the vertex is instead. (see CHUNK_LIGHT_SUN) */
+void Gfx_SetChunkLightCols(PackedCol sun, PackedCol shadow);
+/* Sets the height of one tile of the 1D atlas, in texture coordinates after the texture matrix. */
+/* V of VERTEX_FORMAT_P3ST2SC4B vertices wraps around within the tile whose index is in W. */
+void Gfx_SetChunkTileSize(float size);
+#endif
 
 /* Loads the given matrix over the currently active matrix. */
 CC_API void Gfx_LoadMatrix(MatrixType type, struct Matrix* matrix);
@@ -4,6 +4,8 @@
 #include "Logger.h"
 #include "Stream.h"
 #include "GameStructs.h"
+#include "Options.h"
+#include "Event.h"
 
 #if defined CC_BUILD_WININET
 #define WIN32_LEAN_AND_MEAN
@@ -24,6 +26,10 @@
 #elif defined CC_BUILD_CURL
 #include <curl/curl.h>
 #include <time.h>
+/* curl_multi_poll and curl_multi_wakeup were added in curl 7.68.0 */
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define HTTP_CURL_WAKEUP
+#endif
 #endif
 
 void HttpRequest_Free(struct HttpRequest* request) {
@@ -77,21 +83,6 @@ static void RequestList_RemoveAt(struct RequestList* list, int i) {
 	list->Count--;
 }
 
-/* Finds index of request whose id matches the given id */
-static int RequestList_Find(struct RequestList* list, const String* id, struct HttpRequest* item) {
-	String reqID;
-	int i;
-
-	for (i = 0; i < list->Count; i++) {
-		reqID = String_FromRawArray(list->Entries[i].ID);
-		if (!String_Equals(id, &reqID)) continue;
-
-		*item = list->Entries[i];
-		return i;
-	}
-	return -1;
-}
-
 /* Resets state to default */
 static void RequestList_Init(struct RequestList* list) {
 	list->MaxElems = HTTP_DEF_ELEMS;
@@ -107,6 +98,74 @@ static void RequestList_Free(struct RequestList* list) {
 	RequestList_Init(list);
 }
 
+/* Hashes the ID of a request, see HttpRequest.IDHash */
+static uint32_t Http_HashID(const String* id) {
+	uint32_t hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < id->length; i++) {
+		hash = (hash ^ (uint8_t)id->buffer[i]) * 16777619U;
+	}
+	return hash;
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------Processed requests index------------------------------------------------*
+*#########################################################################################################################*/
+/* Processed requests are looked up every tick (e.g. by each player waiting for a skin), so rather than */
+/* comparing the ID of every processed request, they are chained together in buckets by their ID hash. */
+static struct RequestList processedReqs;
+#define HTTP_RESULT_BUCKETS 64
+static int resultsHead[HTTP_RESULT_BUCKETS];
+static int resultsDefNext[HTTP_DEF_ELEMS];
+static int* resultsNext = resultsDefNext;
+static uint32_t resultsMaxElems = HTTP_DEF_ELEMS;
+
+/* Adds the processed request at the given index to the index */
+static void HttpResults_Link(int i) {
+	int bucket = processedReqs.Entries[i].IDHash % HTTP_RESULT_BUCKETS;
+	while (resultsMaxElems < (uint32_t)processedReqs.MaxElems) {
+		resultsNext = Utils_Resize(resultsNext, &resultsMaxElems, sizeof(int), HTTP_DEF_ELEMS, 10);
+	}
+
+	resultsNext[i]      = resultsHead[bucket];
+	resultsHead[bucket] = i;
+}
+
+/* Rebuilds the index, after processed requests have been removed (and so moved) */
+static void HttpResults_Reindex(void) {
+	int i;
+	for (i = 0; i < HTTP_RESULT_BUCKETS; i++) { resultsHead[i] = -1; }
+	for (i = processedReqs.Count - 1; i >= 0; i--) { HttpResults_Link(i); }
+}
+
+/* Finds index of processed request whose id matches the given id */
+static int HttpResults_Find(const String* id, struct HttpRequest* item) {
+	uint32_t hash = Http_HashID(id);
+	String reqID;
+	int i;
+
+	for (i = resultsHead[hash % HTTP_RESULT_BUCKETS]; i >= 0; i = resultsNext[i]) {
+		if (processedReqs.Entries[i].IDHash != hash) continue;
+		reqID = String_FromRawArray(processedReqs.Entries[i].ID);
+		if (!String_Equals(id, &reqID)) continue;
+
+		*item = processedReqs.Entries[i];
+		return i;
+	}
+	return -1;
+}
+
+static void HttpResults_Free(void) {
+	RequestList_Free(&processedReqs);
+	if (resultsNext != resultsDefNext) Mem_Free(resultsNext);
+
+	resultsNext     = resultsDefNext;
+	resultsMaxElems = HTTP_DEF_ELEMS;
+	HttpResults_Reindex();
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------Common downloader code-------------------------------------------------*
@@ -119,16 +178,27 @@ static void* curRequestMutex;
 static volatile bool http_terminate;
 
 static struct RequestList pendingReqs;
-static struct RequestList processedReqs;
 static struct HttpRequest http_curRequest;
 static volatile int http_curProgress = ASYNC_PROGRESS_NOTHING;
+static volatile bool http_completed;
 
 #ifdef CC_BUILD_WEB
 static void Http_DownloadNextAsync(void);
 #endif
+#ifdef CC_BUILD_CURL
+static CURLM* curlm;
+#endif
+
+/* Wakes up the worker thread, whether it is waiting for requests or for network activity */
+static void Http_WakeWorker(void) {
+	Waitable_Signal(workerWaitable);
+#ifdef HTTP_CURL_WAKEUP
+	if (curlm) curl_multi_wakeup(curlm);
+#endif
+}
 
 /* Adds a req to the list of pending requests, waking up worker thread if needed. */
-static void Http_Add(const String* url, bool priority, const String* id, uint8_t type, TimeMS* lastModified, const String* etag, const void* data, uint32_t size) {
+static void Http_Add(const String* url, bool priority, const String* id, uint8_t type, uint8_t lane, TimeMS* lastModified, const String* etag, const void* data, uint32_t size) {
 	struct HttpRequest req = { 0 };
 	String reqUrl, reqID, reqEtag;
 
@@ -138,6 +208,8 @@ static void Http_Add(const String* url, bool priority, const String* id, uint8_t
 	String_Copy(&reqID, id);
 
 	req.RequestType = type;
+	req.Lane        = lane;
+	req.IDHash      = Http_HashID(&reqID);
 	Platform_Log2("Adding %s (type %b)", &reqUrl, &type);
 
 	String_InitArray(reqEtag, req.Etag);
@@ -162,25 +234,32 @@ static void Http_Add(const String* url, bool priority, const String* id, uint8_t
 	Mutex_Unlock(pendingMutex);
 
 #ifndef CC_BUILD_WEB
-	Waitable_Signal(workerWaitable);
+	Http_WakeWorker();
 #else
 	Http_DownloadNextAsync();
 #endif
 }
 
-/* Sets up state to begin a http request */
-static void Http_BeginRequest(struct HttpRequest* req) {
-	String url = String_FromRawArray(req->URL);
-	Platform_Log2("Downloading from %s (type %b)", &url, &req->RequestType);
-
+/* Sets the request whose progress is reported by Http_GetCurrent */
+static void Http_SetCurrent(struct HttpRequest* req, int progress) {
 	Mutex_Lock(curRequestMutex);
 	{
 		http_curRequest  = *req;
-		http_curProgress = ASYNC_PROGRESS_MAKING_REQUEST;
+		http_curProgress = progress;
 	}
 	Mutex_Unlock(curRequestMutex);
 }
 
+#ifndef CC_BUILD_CURL
+/* Sets up state to begin a http request */
+/* NOTE: The curl backend picks which of its transfers is current itself, see Http_StartTransfer */
+static void Http_BeginRequest(struct HttpRequest* req) {
+	String url = String_FromRawArray(req->URL);
+	Platform_Log2("Downloading from %s (type %b)", &url, &req->RequestType);
+	Http_SetCurrent(req, ASYNC_PROGRESS_MAKING_REQUEST);
+}
+#endif
+
 /* Adds given request to list of processed/completed requests */
 static void Http_CompleteRequest(struct HttpRequest* req) {
 	struct HttpRequest older;
@@ -188,7 +267,7 @@ static void Http_CompleteRequest(struct HttpRequest* req) {
 	int index;
 	req->TimeDownloaded = DateTime_CurrentUTC_MS();
 
-	index = RequestList_Find(&processedReqs, &id, &older);
+	index = HttpResults_Find(&id, &older);
 	if (index >= 0) {
 		/* very rare case - priority item was inserted, then inserted again (so put before first item), */
 		/* and both items got downloaded before an external function removed them from the queue */
@@ -201,11 +280,15 @@ static void Http_CompleteRequest(struct HttpRequest* req) {
 		}
 	} else {
 		RequestList_Append(&processedReqs, req);
+		HttpResults_Link(processedReqs.Count - 1);
 	}
+	http_completed = true;
 }
 
 /* Updates state after a completed http request */
 static void Http_FinishRequest(struct HttpRequest* req) {
+	String id = String_FromRawArray(req->ID);
+	String curID;
 	if (req->Data) Platform_Log1("HTTP returned data: %i bytes", &req->Size);
 	req->Success = !req->Result && req->StatusCode == 200 && req->Data && req->Size;
 
@@ -215,10 +298,14 @@ static void Http_FinishRequest(struct HttpRequest* req) {
 	}
 	Mutex_Unlock(processedMutex);
 
+	/* Other requests may have become the current request while this one was being downloaded */
 	Mutex_Lock(curRequestMutex);
 	{
-		http_curRequest.ID[0] = '\0';
-		http_curProgress = ASYNC_PROGRESS_NOTHING;
+		curID = String_FromRawArray(http_curRequest.ID);
+		if (http_curRequest.TimeAdded == req->TimeAdded && String_Equals(&curID, &id)) {
+			http_curRequest.ID[0] = '\0';
+			http_curProgress = ASYNC_PROGRESS_NOTHING;
+		}
 	}
 	Mutex_Unlock(curRequestMutex);
 }
@@ -533,19 +620,41 @@ static void Http_SysFree(void) {
 	InternetCloseHandle(hInternet);
 }
 #elif defined CC_BUILD_CURL
-static CURL* curl;
+/* State for a request being downloaded, see Http_WorkerLoop */
+struct HttpTransfer {
+	CURL* Handle;
+	struct HttpRequest Req;
+	struct curl_slist* Headers;
+	void* PostData;      /* POST data must persist until request finishes */
+	uint32_t BufferSize; /* Size of Req.Data buffer */
+	bool Active;
+};
+#define HTTP_MAX_TRANSFERS 8
+static struct HttpTransfer http_transfers[HTTP_MAX_TRANSFERS];
+/* Transfer whose progress is reported by Http_GetCurrent */
+static struct HttpTransfer* http_curTransfer;
+static int http_maxTransfers;
 
 static void Http_SysInit(void) {
 	CURLcode res = curl_global_init(CURL_GLOBAL_DEFAULT);
 	if (res) Logger_Abort2(res, "Failed to init curl");
 
-	curl = curl_easy_init();
-	if (!curl) Logger_Abort("Failed to init easy curl");
+	curlm = curl_multi_init();
+	if (!curlm) Logger_Abort("Failed to init multi curl");
+	http_maxTransfers = Options_GetInt(OPT_HTTP_CONCURRENCY, 1, HTTP_MAX_TRANSFERS, 4);
+
+	/* Connections are kept alive and reused by later requests to the same host */
+	curl_multi_setopt(curlm, CURLMOPT_MAXCONNECTS,          (long)(http_maxTransfers * 2));
+	curl_multi_setopt(curlm, CURLMOPT_MAX_HOST_CONNECTIONS, (long)http_maxTransfers);
+#ifdef CURLPIPE_MULTIPLEX
+	curl_multi_setopt(curlm, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
 }
 
 /* Updates progress of current download */
 static int Http_UpdateProgress(void* ptr, double total, double received, double a, double b) {
-	if (total) http_curProgress = (int)(100 * received / total);
+	struct HttpTransfer* t = (struct HttpTransfer*)ptr;
+	if (total && t == http_curTransfer) http_curProgress = (int)(100 * received / total);
 	return 0;
 }
 
@@ -567,7 +676,7 @@ static struct curl_slist* Http_MakeHeaders(struct HttpRequest* req) {
 
 	if (req->LastModified) {
 		String_InitArray_NT(tmp, buffer);
-		String_AppendConst(&tmp, "Last-Modified: ");
+		String_AppendConst(&tmp, "If-Modified-Since: ");
 
 		Http_FormatDate(req->LastModified, &tmp);
 		tmp.buffer[tmp.length] = '\0';
@@ -577,9 +686,10 @@ static struct curl_slist* Http_MakeHeaders(struct HttpRequest* req) {
 }
 
 /* Processes a HTTP header downloaded from the server */
-static size_t Http_ProcessHeader(char *buffer, size_t size, size_t nitems, struct HttpRequest* req) {
+static size_t Http_ProcessHeader(char *buffer, size_t size, size_t nitems, void* ptr) {
 	String tmp; char tmpBuffer[STRING_SIZE + 1];
 	String line, name, value;
+	struct HttpRequest* req = &((struct HttpTransfer*)ptr)->Req;
 	time_t time;
 
 	if (size != 1) return size * nitems; /* non byte header */
@@ -608,57 +718,68 @@ static size_t Http_ProcessHeader(char *buffer, size_t size, size_t nitems, struc
 	return nitems;
 }
 
-static int curlBufferSize;
 /* Processes a chunk of data downloaded from the web server */
-static size_t Http_ProcessData(char *buffer, size_t size, size_t nitems, struct HttpRequest* req) {
+static size_t Http_ProcessData(char *buffer, size_t size, size_t nitems, void* ptr) {
+	struct HttpTransfer* t   = (struct HttpTransfer*)ptr;
+	struct HttpRequest*  req = &t->Req;
 	uint8_t* dst;
 
-	if (!curlBufferSize) {
-		curlBufferSize = req->ContentLength ? req->ContentLength : 1;
-		req->Data = Mem_Alloc(curlBufferSize, 1, "http get data");
+	if (!t->BufferSize) {
+		t->BufferSize = req->ContentLength ? req->ContentLength : 1;
+		req->Data = Mem_Alloc(t->BufferSize, 1, "http get data");
 		req->Size = 0;
 	}
 
 	/* expand buffer if needed */
-	if (req->Size + nitems > curlBufferSize) {
-		curlBufferSize = req->Size + nitems;
-		req->Data      = Mem_Realloc(req->Data, curlBufferSize, 1, "http inc data");
+	if (req->Size + nitems > t->BufferSize) {
+		t->BufferSize = req->Size + nitems;
+		req->Data     = Mem_Realloc(req->Data, t->BufferSize, 1, "http inc data");
 	}
 
 	dst = (uint8_t*)req->Data + req->Size;
 	Mem_Copy(dst, buffer, nitems);
-	req->Size  += nitems;
+	req->Size += nitems;
 	return nitems;
 }
 
 /* Sets general curl options for a request */
-static void Http_SetCurlOpts(struct HttpRequest* req) {
+static void Http_SetCurlOpts(struct HttpTransfer* t) {
+	CURL* curl = t->Handle;
 	curl_easy_setopt(curl, CURLOPT_COOKIEJAR,      "");
 	curl_easy_setopt(curl, CURLOPT_USERAGENT,      GAME_APP_NAME);
 	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 
 	curl_easy_setopt(curl, CURLOPT_NOPROGRESS,       0L);
 	curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, Http_UpdateProgress);
+	curl_easy_setopt(curl, CURLOPT_PROGRESSDATA,     t);
 
 	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, Http_ProcessHeader);
-	curl_easy_setopt(curl, CURLOPT_HEADERDATA,     req);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA,     t);
 	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,  Http_ProcessData);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA,      req);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA,      t);
 }
 
-static ReturnCode Http_SysDo(struct HttpRequest* req) {
+/* Starts downloading the given request using the given transfer */
+static void Http_StartTransfer(struct HttpTransfer* t, struct HttpRequest* req) {
 	String url = String_FromRawArray(req->URL);
 	char urlStr[600];
-	void* post_data = req->Data;
-	struct curl_slist* list;
-	long status = 0;
-	CURLcode res;
+	CURL* curl;
+
+	if (!t->Handle) t->Handle = curl_easy_init();
+	if (!t->Handle) Logger_Abort("Failed to init easy curl");
+	curl = t->Handle;
+
+	Platform_Log2("Downloading from %s (type %b)", &url, &req->RequestType);
+	t->Req        = *req;
+	t->PostData   = NULL;
+	t->BufferSize = 0;
+	t->Active     = true;
 
 	curl_easy_reset(curl);
-	list = Http_MakeHeaders(req);
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list);
+	t->Headers = Http_MakeHeaders(req);
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t->Headers);
 
-	Http_SetCurlOpts(req);
+	Http_SetCurlOpts(t);
 	Platform_ConvertString(urlStr, &url);
 	curl_easy_setopt(curl, CURLOPT_URL, urlStr);
 
@@ -666,35 +787,167 @@ static ReturnCode Http_SysDo(struct HttpRequest* req) {
 		curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
 	} else if (req->RequestType == REQUEST_TYPE_POST) {
 		curl_easy_setopt(curl, CURLOPT_POST,   1L);
-		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE,  req->Size);
-		curl_easy_setopt(curl, CURLOPT_POSTFIELDS,     req->Data);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE,  t->Req.Size);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS,     t->Req.Data);
 
 		/* per curl docs, we must persist POST data until request finishes */
-		req->Data = NULL;
-		HttpRequest_Free(req);
+		t->PostData   = t->Req.Data;
+		t->Req.Data   = NULL;
+		HttpRequest_Free(&t->Req);
 	}
 
-	curlBufferSize = 0;
-	http_curProgress = ASYNC_PROGRESS_FETCHING_DATA;
-	res = curl_easy_perform(curl);
-	http_curProgress = 100;
+	/* Skins are rarely interesting to Http_GetCurrent callers (e.g. texture pack download progress) */
+	if (!http_curTransfer || (http_curTransfer->Req.Lane == HTTP_LANE_SKINS && req->Lane != HTTP_LANE_SKINS)) {
+		http_curTransfer = t;
+		Http_SetCurrent(&t->Req, ASYNC_PROGRESS_FETCHING_DATA);
+	}
+	curl_multi_add_handle(curlm, curl);
+}
+
+/* Makes another active transfer the current transfer, preferring transfers not in the skins lane */
+static void Http_NextCurrentTransfer(void) {
+	struct HttpTransfer* t;
+	int i;
+	http_curTransfer = NULL;
+
+	for (i = 0; i < http_maxTransfers; i++) {
+		t = &http_transfers[i];
+		if (!t->Active) continue;
+		if (!http_curTransfer || http_curTransfer->Req.Lane == HTTP_LANE_SKINS) http_curTransfer = t;
+	}
+	if (http_curTransfer) Http_SetCurrent(&http_curTransfer->Req, ASYNC_PROGRESS_FETCHING_DATA);
+}
+
+/* Cleans up after the given transfer has finished (or has been aborted) */
+static void Http_EndTransfer(struct HttpTransfer* t) {
+	curl_multi_remove_handle(curlm, t->Handle);
+	curl_slist_free_all(t->Headers);
+	Mem_Free(t->PostData);
+
+	t->Headers  = NULL;
+	t->PostData = NULL;
+	t->Active   = false;
+}
+
+static void Http_FinishTransfer(struct HttpTransfer* t, CURLcode res) {
+	long status = 0;
+	curl_easy_getinfo(t->Handle, CURLINFO_RESPONSE_CODE, &status);
+	t->Req.StatusCode = status;
+	t->Req.Result     = res;
+
+	Platform_Log2("HTTP: return code %i (http %i)", &t->Req.Result, &t->Req.StatusCode);
+	Http_EndTransfer(t);
+	Http_FinishRequest(&t->Req);
+	if (t == http_curTransfer) Http_NextCurrentTransfer();
+}
+
+/* Removes the first pending request whose lane is not already using up all of its transfers */
+static bool Http_TakeRequest(struct HttpRequest* req) {
+	int laneActive[HTTP_LANE_COUNT] = { 0 };
+	int laneMax[HTTP_LANE_COUNT];
+	int i, lane;
+
+	for (i = 0; i < http_maxTransfers; i++) {
+		if (http_transfers[i].Active) laneActive[http_transfers[i].Req.Lane]++;
+	}
+	/* Texture packs are large, so only download one at a time to leave room for other requests */
+	laneMax[HTTP_LANE_DEFAULT]  = http_maxTransfers;
+	laneMax[HTTP_LANE_TEXTURES] = 1;
+	laneMax[HTTP_LANE_SKINS]    = http_maxTransfers;
+
+	for (i = 0; i < pendingReqs.Count; i++) {
+		lane = pendingReqs.Entries[i].Lane;
+		if (laneActive[lane] >= laneMax[lane]) continue;
+
+		*req = pendingReqs.Entries[i];
+		RequestList_RemoveAt(&pendingReqs, i);
+		return true;
+	}
+	return false;
+}
+
+static void Http_WorkerLoop(void) {
+	struct HttpRequest request;
+	struct HttpTransfer* t;
+	CURLMsg* msg;
+	int i, running, left, active;
+	bool hasRequest, stop;
+
+	for (;;) {
+		/* Start downloading pending requests in any free transfers */
+		for (i = 0; i < http_maxTransfers; i++) {
+			t = &http_transfers[i];
+			if (t->Active) continue;
+
+			Mutex_Lock(pendingMutex);
+			{
+				stop       = http_terminate;
+				hasRequest = !stop && Http_TakeRequest(&request);
+			}
+			Mutex_Unlock(pendingMutex);
+
+			if (!hasRequest) break;
+			Http_StartTransfer(t, &request);
+		}
+
+		active = 0;
+		for (i = 0; i < http_maxTransfers; i++) {
+			if (http_transfers[i].Active) active++;
+		}
+		if (http_terminate) break;
 
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
-	req->StatusCode = status;
+		/* Block until another thread submits a req to do */
+		if (!active) {
+			Platform_LogConst("Going back to sleep...");
+			Waitable_Wait(workerWaitable);
+			continue;
+		}
+
+		curl_multi_perform(curlm, &running);
+		while ((msg = curl_multi_info_read(curlm, &left))) {
+			if (msg->msg != CURLMSG_DONE) continue;
 
-	curl_slist_free_all(list);
-	/* can free now that request has finished */
-	Mem_Free(post_data);
-	return res;
+			for (i = 0; i < http_maxTransfers; i++) {
+				t = &http_transfers[i];
+				if (t->Active && t->Handle == msg->easy_handle) break;
+			}
+			if (i < http_maxTransfers) Http_FinishTransfer(t, msg->data.result);
+		}
+
+#ifdef HTTP_CURL_WAKEUP
+		/* Sleep until there is network activity, or Http_WakeWorker is called for a newly submitted request */
+		/* (curl shortens the timeout to when it next needs to handle its own timers) */
+		curl_multi_poll(curlm, NULL, 0, 10000, NULL);
+#else
+		/* Wait for network activity, or for a while so newly submitted requests are noticed */
+		curl_multi_wait(curlm, NULL, 0, 50, NULL);
+#endif
+	}
+
+	/* Abort requests still being downloaded */
+	for (i = 0; i < http_maxTransfers; i++) {
+		t = &http_transfers[i];
+		if (!t->Active) continue;
+
+		Http_EndTransfer(t);
+		HttpRequest_Free(&t->Req);
+	}
 }
 
 static void Http_SysFree(void) {
-	curl_easy_cleanup(curl);
+	int i;
+	for (i = 0; i < HTTP_MAX_TRANSFERS; i++) {
+		if (!http_transfers[i].Handle) continue;
+		curl_easy_cleanup(http_transfers[i].Handle);
+		http_transfers[i].Handle = NULL;
+	}
+
+	curl_multi_cleanup(curlm);
 	curl_global_cleanup();
 }
 #endif
 
-#ifndef CC_BUILD_WEB
+#if defined CC_BUILD_WININET
 static void Http_WorkerLoop(void) {
 	struct HttpRequest request;
 	bool hasRequest, stop;
@@ -748,31 +1001,35 @@ const static String skinServer = String_FromConst("/static/skins/");
 const static String skinServer = String_FromConst("http://static.classicube.net/skins/");
 #endif
 
-void Http_AsyncGetSkin(const String* id, const String* skinName) {
-	String url; char urlBuffer[STRING_SIZE];
-	String_InitArray(url, urlBuffer);
-
+void Http_GetSkinUrl(const String* skinName, String* url) {
 	if (Utils_IsUrlPrefix(skinName, 0)) {
-		String_Copy(&url, skinName);
+		String_AppendString(url, skinName);
 	} else {
-		String_AppendString(&url, &skinServer);
-		String_AppendColorless(&url, skinName);
-		String_AppendConst(&url, ".png");
+		String_AppendString(url, &skinServer);
+		String_AppendColorless(url, skinName);
+		String_AppendConst(url, ".png");
 	}
-	Http_AsyncGetData(&url, false, id);
+}
+
+void Http_AsyncGetSkin(const String* id, const String* skinName, TimeMS* lastModified) {
+	String url; char urlBuffer[URL_MAX_SIZE];
+	String_InitArray(url, urlBuffer);
+
+	Http_GetSkinUrl(skinName, &url);
+	Http_Add(&url, false, id, REQUEST_TYPE_GET, HTTP_LANE_SKINS, lastModified, NULL, NULL, 0);
 }
 
 void Http_AsyncGetData(const String* url, bool priority, const String* id) {
-	Http_Add(url, priority, id, REQUEST_TYPE_GET, NULL, NULL, NULL, 0);
+	Http_Add(url, priority, id, REQUEST_TYPE_GET,  HTTP_LANE_DEFAULT, NULL, NULL, NULL, 0);
 }
 void Http_AsyncGetHeaders(const String* url, bool priority, const String* id) {
-	Http_Add(url, priority, id, REQUEST_TYPE_HEAD, NULL, NULL, NULL, 0);
+	Http_Add(url, priority, id, REQUEST_TYPE_HEAD, HTTP_LANE_DEFAULT, NULL, NULL, NULL, 0);
 }
 void Http_AsyncPostData(const String* url, bool priority, const String* id, const void* data, uint32_t size) {
-	Http_Add(url, priority, id, REQUEST_TYPE_POST, NULL, NULL, data, size);
+	Http_Add(url, priority, id, REQUEST_TYPE_POST, HTTP_LANE_DEFAULT, NULL, NULL, data, size);
 }
 void Http_AsyncGetDataEx(const String* url, bool priority, const String* id, TimeMS* lastModified, const String* etag) {
-	Http_Add(url, priority, id, REQUEST_TYPE_GET, lastModified, etag, NULL, 0);
+	Http_Add(url, priority, id, REQUEST_TYPE_GET,  HTTP_LANE_TEXTURES, lastModified, etag, NULL, 0);
 }
 
 void Http_PurgeOldEntriesTask(struct ScheduledTask* task) {
@@ -789,16 +1046,27 @@ void Http_PurgeOldEntriesTask(struct ScheduledTask* task) {
 			HttpRequest_Free(item);
 			RequestList_RemoveAt(&processedReqs, i);
 		}
+		HttpResults_Reindex();
 	}
 	Mutex_Unlock(processedMutex);
 }
 
+/* Raises HttpEvents.RequestsCompleted on the main thread, after requests have been downloaded */
+static void Http_CheckCompletedTask(struct ScheduledTask* task) {
+	if (!http_completed) return;
+	http_completed = false;
+	Event_RaiseVoid(&HttpEvents.RequestsCompleted);
+}
+
 bool Http_GetResult(const String* id, struct HttpRequest* item) {
 	int i;
 	Mutex_Lock(processedMutex);
 	{
-		i = RequestList_Find(&processedReqs, id, item);
-		if (i >= 0) RequestList_RemoveAt(&processedReqs, i);
+		i = HttpResults_Find(id, item);
+		if (i >= 0) {
+			RequestList_RemoveAt(&processedReqs, i);
+			HttpResults_Reindex();
+		}
 	}
 	Mutex_Unlock(processedMutex);
 	return i >= 0;
@@ -820,7 +1088,7 @@ void Http_ClearPending(void) {
 		RequestList_Free(&pendingReqs);
 	}
 	Mutex_Unlock(pendingMutex);
-	Waitable_Signal(workerWaitable);
+	Http_WakeWorker();
 }
 
 static bool Http_UrlDirect(uint8_t c) {
@@ -874,8 +1142,10 @@ void Http_FormatDate(TimeMS ms, String* str) {
 *#########################################################################################################################*/
 static void Http_Init(void) {
 	ScheduledTask_Add(30, Http_PurgeOldEntriesTask);
+	ScheduledTask_Add(GAME_DEF_TICKS, Http_CheckCompletedTask);
 	RequestList_Init(&pendingReqs);
 	RequestList_Init(&processedReqs);
+	HttpResults_Reindex();
 	Http_SysInit();
 
 	workerWaitable  = Waitable_Create();
@@ -895,7 +1165,7 @@ static void Http_Free(void) {
 #endif
 
 	RequestList_Free(&pendingReqs);
-	RequestList_Free(&processedReqs);
+	HttpResults_Free();
 	Http_SysFree();
 
 	Waitable_Free(workerWaitable);
@@ -13,6 +13,9 @@ struct ScheduledTask;
 extern struct IGameComponent Http_Component;
 
 enum HttpRequestType { REQUEST_TYPE_GET, REQUEST_TYPE_HEAD, REQUEST_TYPE_POST };
+/* Requests in different lanes are downloaded concurrently, so e.g. a large texture pack */
+/* download does not stop skins from being downloaded until it has finished. */
+enum HttpLane { HTTP_LANE_DEFAULT, HTTP_LANE_TEXTURES, HTTP_LANE_SKINS, HTTP_LANE_COUNT };
 enum HttpProgress {
 	ASYNC_PROGRESS_NOTHING        = -3,
 	ASYNC_PROGRESS_MAKING_REQUEST = -2,
@@ -34,16 +37,22 @@ struct HttpRequest {
 	TimeMS LastModified;    /* Time item cached at (if at all) */
 	char Etag[STRING_SIZE]; /* ETag of cached item (if any) */
 	uint8_t RequestType;    /* See the various REQUEST_TYPE_ */
+	uint8_t Lane;           /* See the various HTTP_LANE_ */
+	uint32_t IDHash;        /* Hash of ID, used to quickly find completed requests. */
 	bool Success;           /* Whether Result is 0, status is 200, and data is not NULL */
 };
 
 /* Frees data from a HTTP request. */
 void HttpRequest_Free(struct HttpRequest* request);
 
-/* Aschronously performs a http GET request to download a skin. */
-/* If url is a skin, this is the same as Http_AsyncGetData. */
-/* If not, instead downloads from http://static.classicube.net/skins/[skinName].png */
-void Http_AsyncGetSkin(const String* id, const String* skinName);
+/* Appends the URL a skin is downloaded from to the given string. */
+/* If skinName is a url, this is just skinName. */
+/* If not, this is http://static.classicube.net/skins/[skinName].png */
+void Http_GetSkinUrl(const String* skinName, String* url);
+/* Aschronously performs a http GET request to download a skin, from the URL given by Http_GetSkinUrl. */
+/* Also sets the If-Modified-Since header. (if not NULL) */
+/* NOTE: Skins are downloaded in the HTTP_LANE_SKINS lane. */
+void Http_AsyncGetSkin(const String* id, const String* skinName, TimeMS* lastModified);
 /* Asynchronously performs a http GET request. (e.g. to download data) */
 void Http_AsyncGetData(const String* url, bool priority, const String* id);
 /* Asynchronously performs a http HEAD request. (e.g. to get Content-Length header) */
@@ -53,6 +62,7 @@ void Http_AsyncGetHeaders(const String* url, bool priority, const String* id);
 void Http_AsyncPostData(const String* url, bool priority, const String* id, const void* data, uint32_t size);
 /* Asynchronously performs a http GET request. (e.g. to download data) */
 /* Also sets the If-Modified-Since and If-None-Match headers. (if not NULL)  */
+/* NOTE: This is used for texture packs, so is downloaded in the HTTP_LANE_TEXTURES lane. */
 void Http_AsyncGetDataEx(const String* url, bool priority, const String* id, TimeMS* lastModified, const String* etag);
 
 /* Encodes data using % or URL encoding. */
@@ -64,10 +74,12 @@ void Http_UrlEncodeUtf8(String* dst, const String* src);
 void Http_FormatDate(TimeMS ms, String* str);
 
 /* Attempts to retrieve a fully completed request. */
+/* NOTE: HttpEvents.RequestsCompleted is raised after requests complete, so you don't have to check every tick. */
 /* NOTE: You MUST also check Result/StatusCode, and check Size is > 0. */
 /* (because a completed request may not have completed successfully) */
 bool Http_GetResult(const String* id, struct HttpRequest* item);
 /* Retrieves information about the request currently being processed. */
+/* NOTE: When multiple requests are being processed, requests not in HTTP_LANE_SKINS are preferred. */
 bool Http_GetCurrent(struct HttpRequest* request, int* progress);
 /* Clears the list of pending requests. */
 void Http_ClearPending(void);
@@ -175,11 +175,11 @@ void IsometricDrawer_DrawBatch(BlockID block, float size, float x, float y) {
 		Drawer.Tinted  = Blocks.Tinted[block];
 		Drawer.TintCol = Blocks.FogCol[block];
 
-		Drawer_XMax(1, bright ? iso_col : iso_colXSide, 
+		Drawer_XMax(&Drawer, 1, bright ? iso_col : iso_colXSide, 
 			IsometricDrawer_GetTexLoc(block, FACE_XMAX), &iso_vertices);
-		Drawer_ZMin(1, bright ? iso_col : iso_colZSide, 
+		Drawer_ZMin(&Drawer, 1, bright ? iso_col : iso_colZSide, 
 			IsometricDrawer_GetTexLoc(block, FACE_ZMIN), &iso_vertices);
-		Drawer_YMax(1, iso_col, 
+		Drawer_YMax(&Drawer, 1, iso_col, 
 			IsometricDrawer_GetTexLoc(block, FACE_YMAX), &iso_vertices);
 	}
 }
@@ -7,125 +7,62 @@
 #include "Logger.h"
 #include "Event.h"
 #include "GameStructs.h"
-
-int16_t* Lighting_Heightmap;
-#define HEIGHT_UNCALCULATED Int16_MaxValue
-
-#define Lighting_CalcBody(get_block)\
-for (y = maxY; y >= 0; y--, i -= World.OneY) {\
-	block = get_block;\
-\
-	if (Blocks.BlocksLight[block]) {\
-		offset = (Blocks.LightOffset[block] >> FACE_YMAX) & 1;\
-		Lighting_Heightmap[hIndex] = y - offset;\
-		return y - offset;\
-	}\
-}
-
-static int Lighting_CalcHeightAt(int x, int maxY, int z, int hIndex) {
-	int i = World_Pack(x, maxY, z);
-	BlockID block;
-	int y, offset;
-
-#ifndef EXTENDED_BLOCKS
-	Lighting_CalcBody(World.Blocks[i]);
-#else
-	if (World.IDMask <= 0xFF) {
-		Lighting_CalcBody(World.Blocks[i]);
-	} else {
-		Lighting_CalcBody(World.Blocks[i] | (World.Blocks2[i] << 8));
-	}
-#endif
-
-	Lighting_Heightmap[hIndex] = -10;
-	return -10;
-}
-
-static int Lighting_GetLightHeight(int x, int z) {
-	int hIndex = Lighting_Pack(x, z);
-	int lightH = Lighting_Heightmap[hIndex];
-	return lightH == HEIGHT_UNCALCULATED ? Lighting_CalcHeightAt(x, World.Height - 1, z, hIndex) : lightH;
-}
+#include "Builder.h"
+#include "Options.h"
+#include "Game.h"
+
+/* Guards handing out jobs to lighting worker threads */
+static void* lighting_mutex;
+/* Whether all lighting needs to be recalculated at the next tick. (see Lighting_ScheduleRefresh) */
+static bool lighting_refreshPending;
+static void Fancy_Calculate(void);
+static void Fancy_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+static void Lighting_CalcColumns(void);
 
 /* Outside colour is same as sunlight colour, so we reuse when possible */
 bool Lighting_IsLit(int x, int y, int z) {
-	return y > Lighting_GetLightHeight(x, z);
+	return y > Lighting_Height(x, z);
 }
 
 PackedCol Lighting_Col(int x, int y, int z) {
-	return y > Lighting_GetLightHeight(x, z) ? Env.SunCol : Env.ShadowCol;
+	if (Lighting_Fancy) {
+		return PackedCol_Lerp(Env.ShadowCol, Env.SunCol, Lighting_Level(x, y, z) / (float)LIGHTING_MAX_LEVEL);
+	}
+	return y > Lighting_Height(x, z) ? Env.SunCol : Env.ShadowCol;
 }
 
 PackedCol Lighting_Col_XSide(int x, int y, int z) {
-	return y > Lighting_GetLightHeight(x, z) ? Env.SunXSide : Env.ShadowXSide;
-}
-
-PackedCol Lighting_Col_Sprite_Fast(int x, int y, int z) {
-	return y > Lighting_Heightmap[Lighting_Pack(x, z)] ? Env.SunCol : Env.ShadowCol;
+	if (Lighting_Fancy) {
+		return PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, Lighting_Level(x, y, z) / (float)LIGHTING_MAX_LEVEL);
+	}
+	return y > Lighting_Height(x, z) ? Env.SunXSide : Env.ShadowXSide;
 }
 
-PackedCol Lighting_Col_YMax_Fast(int x, int y, int z) {
-	return y > Lighting_Heightmap[Lighting_Pack(x, z)] ? Env.SunCol : Env.ShadowCol;
+bool Lighting_IsLit_Fast(int x, int y, int z) {
+	return y > Lighting_Height(x, z);
 }
 
-PackedCol Lighting_Col_YMin_Fast(int x, int y, int z) {
-	return y > Lighting_Heightmap[Lighting_Pack(x, z)] ? Env.SunYMin : Env.ShadowYMin;
+void Lighting_Refresh(void) {
+	Lighting_CalcColumns();
+	if (Lighting_Fancy) Fancy_Calculate();
 }
 
-PackedCol Lighting_Col_XSide_Fast(int x, int y, int z) {
-	return y > Lighting_Heightmap[Lighting_Pack(x, z)] ? Env.SunXSide : Env.ShadowXSide;
-}
+void Lighting_ScheduleRefresh(void) { lighting_refreshPending = true; }
 
-PackedCol Lighting_Col_ZSide_Fast(int x, int y, int z) {
-	return y > Lighting_Heightmap[Lighting_Pack(x, z)] ? Env.SunZSide : Env.ShadowZSide;
-}
+static void Lighting_CheckRefresh(struct ScheduledTask* task) {
+	if (!lighting_refreshPending) return;
+	lighting_refreshPending = false;
+	if (!World.Loaded) return;
 
-void Lighting_Refresh(void) {
-	int i;
-	for (i = 0; i < World.Width * World.Length; i++) {
-		Lighting_Heightmap[i] = HEIGHT_UNCALCULATED;
-	}
+	/* Stops background builders and discards every mesh, as all of them may use the old lighting */
+	MapRenderer_Refresh();
+	Lighting_Refresh();
 }
 
 
 /*########################################################################################################################*
 *----------------------------------------------------Lighting update------------------------------------------------------*
 *#########################################################################################################################*/
-static void Lighting_UpdateLighting(int x, int y, int z, BlockID oldBlock, BlockID newBlock, int index, int lightH) {
-	bool didBlock  = Blocks.BlocksLight[oldBlock];
-	bool nowBlocks = Blocks.BlocksLight[newBlock];
-	int oldOffset  = (Blocks.LightOffset[oldBlock] >> FACE_YMAX) & 1;
-	int newOffset  = (Blocks.LightOffset[newBlock] >> FACE_YMAX) & 1;
-	BlockID above;
-
-	/* Two cases we need to handle here: */
-	if (didBlock == nowBlocks) {
-		if (!didBlock) return;              /* a) both old and new block do not block light */
-		if (oldOffset == newOffset) return; /* b) both blocks blocked light at the same Y coordinate */
-	}
-
-	if ((y - newOffset) >= lightH) {
-		if (nowBlocks) {
-			Lighting_Heightmap[index] = y - newOffset;
-		} else {
-			/* Part of the column is now visible to light, we don't know how exactly how high it should be though. */
-			/* However, we know that if the old block was above or equal to light height, then the new light height must be <= old block.y */
-			Lighting_CalcHeightAt(x, y, z, index);
-		}
-	} else if (y == lightH && oldOffset == 0) {
-		/* For a solid block on top of an upside down slab, they will both have the same light height. */
-		/* So we need to account for this particular case. */
-		above = y == (World.Height - 1) ? BLOCK_AIR : World_GetBlock(x, y + 1, z);
-		if (Blocks.BlocksLight[above]) return;
-
-		if (nowBlocks) {
-			Lighting_Heightmap[index] = y - newOffset;
-		} else {
-			Lighting_CalcHeightAt(x, y - 1, z, index);
-		}
-	}
-}
-
 static bool Lighting_Needs(BlockID block, BlockID other) {
 	return Blocks.Draw[block] != DRAW_OPAQUE || Blocks.Draw[other] != DRAW_GAS;
 }
@@ -141,8 +78,15 @@ for (; y >= minY; y--, i -= World.OneY) {\
 static bool Lighting_NeedsNeighour(BlockID block, int i, int minY, int y, int nY) {
 	BlockID other;
 	bool affected;
+#ifdef CC_BUILD_SPARSEWORLD
+	int x, z;
+#endif
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_SPARSEWORLD
+	x = i % World.Width;
+	z = (i / World.Width) % World.Length;
+	Lighting_NeedsNeighourBody(World_GetBlock(x, y, z));
+#elif !defined EXTENDED_BLOCKS
 	Lighting_NeedsNeighourBody(World.Blocks[i]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -219,152 +163,580 @@ static void Lighting_RefreshAffected(int x, int y, int z, BlockID block, int old
 }
 
 void Lighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
-	int hIndex = Lighting_Pack(x, z);
-	int lightH = Lighting_Heightmap[hIndex];
-	int newHeight;
+	int lightH, newHeight;
+	if (Lighting_Fancy) Fancy_OnBlockChanged(x, y, z, oldBlock, newBlock);
 
-	/* Since light wasn't checked to begin with, means column never had meshes for any of its chunks built. */
-	/* So we don't need to do anything. */
-	if (lightH == HEIGHT_UNCALCULATED) return;
+	lightH = Lighting_Height(x, z);
+	World_UpdateColumn(x, y, z, oldBlock, newBlock);
+	newHeight = Lighting_Height(x, z) + 1;
 
-	Lighting_UpdateLighting(x, y, z, oldBlock, newBlock, hIndex, lightH);
-	newHeight = Lighting_Heightmap[hIndex] + 1;
+	/* Flood fill lighting refreshes the chunks it changed itself, the heightmap is then only used by physics */
+	if (Lighting_Fancy) return;
 	Lighting_RefreshAffected(x, y, z, newBlock, lightH + 1, newHeight);
 }
 
+#define Lighting_EditColumn(e) Lighting_Pack((e)->X, (e)->Z)
+static struct BlockEdit* sort_edits;
+
+static void Lighting_QuickSort(int left, int right) {
+	struct BlockEdit* keys = sort_edits; struct BlockEdit key;
+
+	while (left < right) {
+		int i = left, j = right;
+		int pivot = Lighting_EditColumn(&keys[(i + j) >> 1]);
+
+		/* partition the list */
+		while (i <= j) {
+			while (pivot > Lighting_EditColumn(&keys[i])) i++;
+			while (pivot < Lighting_EditColumn(&keys[j])) j--;
+			QuickSort_Swap_Maybe();
+		}
+		/* recurse into the smaller subset */
+		QuickSort_Recurse(Lighting_QuickSort)
+	}
+}
+
+void Lighting_OnBlocksChanged(struct BlockEdit* edits, int count) {
+	struct BlockEdit* e;
+	struct BlockEdit* top;
+	struct WorldColumn old;
+	int i, j, hIndex, lightH, newHeight, fields;
+
+	/* The world already contains every new block, but the flood fill still converges when updated one block at a time */
+	if (Lighting_Fancy) {
+		for (i = 0; i < count; i++) {
+			e = &edits[i];
+			Fancy_OnBlockChanged(e->X, e->Y, e->Z, e->Old, e->New);
+		}
+	}
+
+	/* Group together changes to the same column */
+	sort_edits = edits;
+	Lighting_QuickSort(0, count - 1);
+
+	for (i = 0; i < count; i = j) {
+		hIndex = Lighting_EditColumn(&edits[i]);
+		top    = &edits[i];
+
+		for (j = i; j < count && Lighting_EditColumn(&edits[j]) == hIndex; j++) {
+			if (edits[j].Y > top->Y) top = &edits[j];
+		}
+
+		/* Changes below the highest block of a field cannot affect that field, */
+		/* and nothing above both it and the highest changed block can match it either */
+		old    = World.Columns[hIndex];
+		fields = 0;
+		if (top->Y >= old.LightY) fields |= COLUMN_LIGHT;
+		if (top->Y >= old.RainY)  fields |= COLUMN_RAIN;
+		if (top->Y >= old.SolidY) fields |= COLUMN_SOLID;
+
+		if (fields) {
+			World_CalcColumn(top->X, min(max(top->Y, old.LightY + 1), World.MaxY), top->Z, fields);
+		}
+		lightH    = old.LightY;
+		newHeight = World.Columns[hIndex].LightY;
+
+		/* Same as in Lighting_OnBlockChanged */
+		if (Lighting_Fancy) continue;
+
+		if (newHeight != lightH) {
+			Lighting_RefreshAffected(top->X, top->Y, top->Z, top->New, lightH + 1, newHeight + 1);
+		}
+		/* Chunks beside changed blocks on the edge of a chunk */
+		for (; i < j; i++) {
+			e = &edits[i];
+			Lighting_RefreshAffected(e->X, e->Y, e->Z, e->New, e->Y, e->Y);
+		}
+	}
+}
+
 
 /*########################################################################################################################*
-*---------------------------------------------------Lighting heightmap----------------------------------------------------*
+*---------------------------------------------------Flood fill lighting---------------------------------------------------*
 *#########################################################################################################################*/
-static int Lighting_InitialHeightmapCoverage(int x1, int z1, int xCount, int zCount, int32_t* skip) {
-	int elemsLeft = 0, index = 0, curRunCount = 0;
-	int x, z, hIndex, lightH;
-
-	for (z = 0; z < zCount; z++) {
-		hIndex = Lighting_Pack(x1, z1 + z);
-		for (x = 0; x < xCount; x++) {
-			lightH = Lighting_Heightmap[hIndex++];
-
-			skip[index] = 0;
-			if (lightH == HEIGHT_UNCALCULATED) {
-				elemsLeft++;
-				curRunCount = 0;
+bool Lighting_Fancy;
+/* Light level of each block in the world. Upper 4 bits are sky light, lower 4 bits are block light. */
+/* Blocks that block light still receive light from their neighbours, but do not pass it on. */
+static uint8_t* fancy_levels;
+#define FANCY_SKY   4 /* Shift of sky light level in fancy_levels */
+#define FANCY_BLOCK 0 /* Shift of block light level in fancy_levels */
+#define Fancy_Get(i, shift) ((fancy_levels[i] >> (shift)) & 0x0F)
+#define Fancy_Set(i, shift, level) fancy_levels[i] = (uint8_t)((fancy_levels[i] & ~(0x0F << (shift))) | ((level) << (shift)))
+/* Whether light spreads from the given block to its neighbours. Light emitting blocks always spread block light. */
+#define Fancy_Spreads(block, shift) (!Blocks.BlocksLight[block] || ((shift) == FANCY_BLOCK && Blocks.FullBright[block]))
+
+static const int fancy_dx[FACE_COUNT] = { -1, 1,  0, 0,  0, 0 };
+static const int fancy_dy[FACE_COUNT] = {  0, 0,  0, 0, -1, 1 };
+static const int fancy_dz[FACE_COUNT] = {  0, 0, -1, 1,  0, 0 };
+
+struct LightNode { int Index, Level; };
+/* Resizable FIFO queue of blocks whose light needs to be spread to (or removed from) their neighbours. */
+struct LightQueue {
+	struct LightNode* Entries;
+	int Size, Mask; /* Size is always a power of two */
+	int Head, Count;
+};
+
+static void LightQueue_Push(struct LightQueue* queue, int index, int level) {
+	struct LightNode* entries;
+	int i, size;
+
+	if (queue->Count == queue->Size) {
+		size    = queue->Size ? queue->Size * 2 : 1024;
+		entries = (struct LightNode*)Mem_Alloc(size, sizeof(struct LightNode), "light queue");
+
+		for (i = 0; i < queue->Count; i++) {
+			entries[i] = queue->Entries[(queue->Head + i) & queue->Mask];
+		}
+		Mem_Free(queue->Entries);
+
+		queue->Entries = entries;
+		queue->Size    = size;
+		queue->Mask    = size - 1;
+		queue->Head    = 0;
+	}
+
+	i = (queue->Head + queue->Count) & queue->Mask;
+	queue->Entries[i].Index = index;
+	queue->Entries[i].Level = level;
+	queue->Count++;
+}
+
+static struct LightNode LightQueue_Pop(struct LightQueue* queue) {
+	struct LightNode node = queue->Entries[queue->Head];
+	queue->Head = (queue->Head + 1) & queue->Mask;
+	queue->Count--;
+	return node;
+}
+
+static void LightQueue_Free(struct LightQueue* queue) {
+	Mem_Free(queue->Entries);
+	queue->Entries = NULL;
+	queue->Size = 0; queue->Mask  = 0;
+	queue->Head = 0; queue->Count = 0;
+}
+
+/* Bounds of the blocks whose light level changed in the current update */
+static int fancy_minX, fancy_minY, fancy_minZ;
+static int fancy_maxX, fancy_maxY, fancy_maxZ;
+
+static void Fancy_MarkChanged(int x, int y, int z) {
+	if (x < fancy_minX) fancy_minX = x;
+	if (y < fancy_minY) fancy_minY = y;
+	if (z < fancy_minZ) fancy_minZ = z;
+	if (x > fancy_maxX) fancy_maxX = x;
+	if (y > fancy_maxY) fancy_maxY = y;
+	if (z > fancy_maxZ) fancy_maxZ = z;
+}
+
+/* Spreads light from the blocks in the queue to their neighbours, until the queue is empty. */
+/* Only blocks with Z between z1 and z2 are changed, light that would spread beyond is queued in border instead. */
+/* With no border, changed blocks are tracked so that their chunks can be refreshed. */
+static void Fancy_Spread(struct LightQueue* queue, int shift, int z1, int z2, struct LightQueue* border) {
+	struct LightNode node;
+	int x, y, z, nx, ny, nz;
+	int dir, n, level, newLevel;
+
+	while (queue->Count) {
+		node  = LightQueue_Pop(queue);
+		level = Fancy_Get(node.Index, shift);
+		if (level <= 1) continue;
+
+		World_Unpack(node.Index, x, y, z);
+		if (!Fancy_Spreads(World_GetBlock(x, y, z), shift)) continue;
+
+		for (dir = 0; dir < FACE_COUNT; dir++) {
+			nx = x + fancy_dx[dir]; ny = y + fancy_dy[dir]; nz = z + fancy_dz[dir];
+			if (!World_Contains(nx, ny, nz)) continue;
+
+			/* Sunlight shines straight down without getting dimmer */
+			newLevel = level - 1;
+			if (shift == FANCY_SKY && dir == FACE_YMIN && level == LIGHTING_MAX_LEVEL) newLevel = level;
+
+			if (nz < z1 || nz >= z2) { LightQueue_Push(border, node.Index, 0); continue; }
+			n = World_Pack(nx, ny, nz);
+			if (Fancy_Get(n, shift) >= newLevel) continue;
+
+			Fancy_Set(n, shift, newLevel);
+			if (!border) Fancy_MarkChanged(nx, ny, nz);
+			LightQueue_Push(queue, n, 0);
+		}
+	}
+}
+
+static struct LightQueue fancy_removed, fancy_relight;
+/* Removes light from all blocks that may have been lit by the blocks in fancy_removed. */
+/* Blocks that are lit independently are queued in fancy_relight, to spread light back into the darkened area. */
+static void Fancy_Darken(int shift) {
+	struct LightNode node;
+	int x, y, z, nx, ny, nz;
+	int dir, n, level;
+
+	while (fancy_removed.Count) {
+		node = LightQueue_Pop(&fancy_removed);
+		World_Unpack(node.Index, x, y, z);
+
+		for (dir = 0; dir < FACE_COUNT; dir++) {
+			nx = x + fancy_dx[dir]; ny = y + fancy_dy[dir]; nz = z + fancy_dz[dir];
+			if (!World_Contains(nx, ny, nz)) continue;
+
+			n     = World_Pack(nx, ny, nz);
+			level = Fancy_Get(n, shift);
+			if (!level) continue;
+
+			if (level < node.Level || (shift == FANCY_SKY && dir == FACE_YMIN && level == LIGHTING_MAX_LEVEL && node.Level == LIGHTING_MAX_LEVEL)) {
+				Fancy_Set(n, shift, 0);
+				Fancy_MarkChanged(nx, ny, nz);
+				LightQueue_Push(&fancy_removed, n, level);
 			} else {
-				skip[index - curRunCount]++;
-				curRunCount++;
+				LightQueue_Push(&fancy_relight, n, 0);
 			}
-			index++;
 		}
-		curRunCount = 0; /* We can only skip an entire X row at most. */
 	}
-	return elemsLeft;
-}
-
-#define Lighting_CalculateBody(get_block)\
-for (y = World.Height - 1; y >= 0; y--) {\
-	if (elemsLeft <= 0) { return true; } \
-	mapIndex = World_Pack(x1, y, z1);\
-	hIndex   = Lighting_Pack(x1, z1);\
-\
-	for (z = 0; z < zCount; z++) {\
-		baseIndex = mapIndex;\
-		index = z * xCount;\
-		for (x = 0; x < xCount;) {\
-			curRunCount = skip[index];\
-			x += curRunCount; mapIndex += curRunCount; index += curRunCount;\
-\
-			if (x < xCount && Blocks.BlocksLight[get_block]) {\
-				lightOffset = (Blocks.LightOffset[get_block] >> FACE_YMAX) & 1;\
-				Lighting_Heightmap[hIndex + x] = (int16_t)(y - lightOffset);\
-				elemsLeft--;\
-				skip[index] = 0;\
-\
-				offset = prevRunCount + curRunCount;\
-				newRunCount = skip[index - offset] + 1;\
-\
-				/* consider case 1 0 1 0, where we are at last 0 */ \
-				/* we need to make this 3 0 0 0 and advance by 1 */ \
-				oldRunCount = (x - offset + newRunCount) < xCount ? skip[index - offset + newRunCount] : 0; \
-				if (oldRunCount != 0) {\
-					skip[index - offset + newRunCount] = 0; \
-					newRunCount += oldRunCount; \
-				} \
-				skip[index - offset] = newRunCount; \
-				x += oldRunCount; index += oldRunCount; mapIndex += oldRunCount; \
-				prevRunCount = newRunCount; \
-			} else { \
-				prevRunCount = 0; \
-			}\
-			x++; mapIndex++; index++; \
-		}\
-		prevRunCount = 0;\
-		hIndex += World.Width;\
-		mapIndex = baseIndex + World.Width; /* advance one Z */ \
-	}\
-}
-
-static bool Lighting_CalculateHeightmapCoverage(int x1, int z1, int xCount, int zCount, int elemsLeft, int32_t* skip) {
-	int prevRunCount = 0, curRunCount, newRunCount, oldRunCount;
-	int lightOffset, offset;
-	int mapIndex, hIndex, baseIndex, index;
-	int x, y, z;
-
-#ifndef EXTENDED_BLOCKS
-	Lighting_CalculateBody(World.Blocks[mapIndex]);
-#else
-	if (World.IDMask <= 0xFF) {
-		Lighting_CalculateBody(World.Blocks[mapIndex]);
+}
+
+static void Fancy_UpdateChannel(int x, int y, int z, BlockID block, int shift) {
+	int i = World_Pack(x, y, z);
+	int level = Fancy_Get(i, shift);
+	int dir, nx, ny, nz, n;
+
+	if (level) {
+		Fancy_Set(i, shift, 0);
+		Fancy_MarkChanged(x, y, z);
+		LightQueue_Push(&fancy_removed, i, level);
+	}
+	Fancy_Darken(shift);
+
+	if (shift == FANCY_BLOCK && Blocks.FullBright[block]) {
+		level = LIGHTING_MAX_LEVEL;
 	} else {
-		Lighting_CalculateBody(World.Blocks[mapIndex] | (World.Blocks2[mapIndex] << 8));
+		level = (shift == FANCY_SKY && y == World.MaxY) ? LIGHTING_MAX_LEVEL : 0;
+	}
+	if (level) {
+		Fancy_Set(i, shift, level);
+		Fancy_MarkChanged(x, y, z);
+		LightQueue_Push(&fancy_relight, i, 0);
+	}
+
+	/* Neighbours light the changed block again, and spread through it if light passes through it now */
+	for (dir = 0; dir < FACE_COUNT; dir++) {
+		nx = x + fancy_dx[dir]; ny = y + fancy_dy[dir]; nz = z + fancy_dz[dir];
+		if (!World_Contains(nx, ny, nz)) continue;
+
+		n = World_Pack(nx, ny, nz);
+		if (Fancy_Get(n, shift)) LightQueue_Push(&fancy_relight, n, 0);
+	}
+	Fancy_Spread(&fancy_relight, shift, 0, World.Length, NULL);
+}
+
+static void Fancy_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
+	bool blocksLight = Blocks.BlocksLight[oldBlock] != Blocks.BlocksLight[newBlock];
+	bool emitsLight  = Blocks.FullBright[oldBlock]  != Blocks.FullBright[newBlock];
+	int cx, cy, cz, x1, y1, z1, x2, y2, z2;
+	if (!fancy_levels || (!blocksLight && !emitsLight)) return;
+
+	fancy_minX = World.Width; fancy_minY = World.Height; fancy_minZ = World.Length;
+	fancy_maxX = -1;          fancy_maxY = -1;           fancy_maxZ = -1;
+
+	if (blocksLight) Fancy_UpdateChannel(x, y, z, newBlock, FANCY_SKY);
+	Fancy_UpdateChannel(x, y, z, newBlock, FANCY_BLOCK);
+	if (fancy_maxX == -1) return;
+
+	/* Faces of neighbouring blocks also use the light of the changed blocks */
+	x1 = max(fancy_minX - 1, 0) >> CHUNK_SHIFT; x2 = (fancy_maxX + 1) >> CHUNK_SHIFT;
+	y1 = max(fancy_minY - 1, 0) >> CHUNK_SHIFT; y2 = (fancy_maxY + 1) >> CHUNK_SHIFT;
+	z1 = max(fancy_minZ - 1, 0) >> CHUNK_SHIFT; z2 = (fancy_maxZ + 1) >> CHUNK_SHIFT;
+
+	for (cy = y1; cy <= y2; cy++) {
+		for (cz = z1; cz <= z2; cz++) {
+			for (cx = x1; cx <= x2; cx++) {
+				MapRenderer_RefreshChunk(cx, cy, cz);
+			}
+		}
+	}
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------Lighting workers-----------------------------------------------------*
+*#########################################################################################################################*/
+#define LIGHTING_MAX_THREADS 8
+static void* lighting_threads[LIGHTING_MAX_THREADS];
+static int lighting_threadsCount;
+/* Signalled when there are jobs to run, and when the last job finishes */
+static void* lighting_waitable;
+static void* lighting_doneWaitable;
+static volatile bool lighting_terminate;
+
+static int lighting_jobsCount, lighting_nextJob, lighting_jobsDone;
+static void (*lighting_jobFunc)(int job);
+
+/* Runs jobs until there are none left to hand out. Returns whether the workers are stopping. */
+static bool Lighting_RunNextJobs(void) {
+	void (*func)(int job);
+	int job;
+	bool stop, moreJobs, finished;
+
+	for (;;) {
+		Mutex_Lock(lighting_mutex);
+		{
+			stop = lighting_terminate;
+			job  = lighting_nextJob < lighting_jobsCount ? lighting_nextJob++ : -1;
+			func = lighting_jobFunc;
+			moreJobs = lighting_nextJob < lighting_jobsCount;
+		}
+		Mutex_Unlock(lighting_mutex);
+
+		/* Each signal only wakes up one worker, so pass it on to the next worker */
+		if ((stop || moreJobs) && lighting_threadsCount) Waitable_Signal(lighting_waitable);
+		if (stop || job == -1) return stop;
+		func(job);
+
+		Mutex_Lock(lighting_mutex);
+		{
+			finished = ++lighting_jobsDone == lighting_jobsCount;
+		}
+		Mutex_Unlock(lighting_mutex);
+		if (finished && lighting_threadsCount) Waitable_Signal(lighting_doneWaitable);
+	}
+}
+
+static void Lighting_WorkerLoop(void) {
+	for (;;) {
+		if (Lighting_RunNextJobs()) return;
+		/* Block until more jobs are started */
+		Waitable_Wait(lighting_waitable);
+	}
+}
+
+/* Starts as many worker threads as there are mesh builders. Workers are kept until Lighting_Free. */
+static void Lighting_StartWorkers(void) {
+	int i;
+	lighting_threadsCount = min(Builder_WorkersCount, LIGHTING_MAX_THREADS);
+	if (!lighting_threadsCount) return;
+
+	lighting_terminate    = false;
+	lighting_waitable     = Waitable_Create();
+	lighting_doneWaitable = Waitable_Create();
+
+	for (i = 0; i < lighting_threadsCount; i++) {
+		lighting_threads[i] = Thread_Start(Lighting_WorkerLoop, false);
+	}
+}
+
+static void Lighting_StopWorkers(void) {
+	int i;
+	if (!lighting_threadsCount) return;
+
+	Mutex_Lock(lighting_mutex);
+	lighting_terminate = true;
+	Mutex_Unlock(lighting_mutex);
+
+	/* Each worker wakes up the next one when stopping */
+	Waitable_Signal(lighting_waitable);
+	for (i = 0; i < lighting_threadsCount; i++) {
+		Thread_Join(lighting_threads[i]);
+	}
+
+	Waitable_Free(lighting_waitable);
+	Waitable_Free(lighting_doneWaitable);
+	lighting_threadsCount = 0;
+}
+
+/* Calls the given function for jobs 0 to count - 1, using the calling thread and the worker threads */
+/* NOTE: Jobs must not write to the same data, as they run in parallel. */
+static void Lighting_RunJobs(void (*func)(int job), int jobsCount) {
+	bool finished;
+	if (!lighting_threadsCount) Lighting_StartWorkers();
+
+	Mutex_Lock(lighting_mutex);
+	{
+		lighting_jobFunc   = func;
+		lighting_jobsCount = jobsCount;
+		lighting_nextJob   = 0;
+		lighting_jobsDone  = 0;
+	}
+	Mutex_Unlock(lighting_mutex);
+
+	if (lighting_threadsCount) Waitable_Signal(lighting_waitable);
+	Lighting_RunNextJobs();
+	if (!lighting_threadsCount) return;
+
+	/* Jobs handed out to workers may still be running */
+	for (;;) {
+		Mutex_Lock(lighting_mutex);
+		finished = lighting_jobsDone == lighting_jobsCount;
+		Mutex_Unlock(lighting_mutex);
+
+		if (finished) return;
+		Waitable_Wait(lighting_doneWaitable);
 	}
-#endif
-	return false;
 }
 
-static void Lighting_FinishHeightmapCoverage(int x1, int z1, int xCount, int zCount) {
-	int x, z, hIndex, lightH;
 
-	for (z = 0; z < zCount; z++) {
-		hIndex = Lighting_Pack(x1, z1 + z);
-		for (x = 0; x < xCount; x++, hIndex++) {
-			lightH = Lighting_Heightmap[hIndex];
+/*########################################################################################################################*
+*-----------------------------------------------Flood fill lighting calculation-------------------------------------------*
+*#########################################################################################################################*/
+/* The world is split along Z into slabs of 16 rows, which are lit in parallel. */
+#define FANCY_SLAB_SIZE 16
+
+struct FancySlab {
+	struct LightQueue Sky, Block;
+	/* Blocks whose light spreads into neighbouring slabs */
+	struct LightQueue SkyBorder, BlockBorder;
+};
+static struct FancySlab* fancy_slabs;
+static int fancy_slabsCount;
+/* Y of the highest block that blocks light in each column, -1 if there is none */
+static int16_t* fancy_tops;
+
+static void Fancy_CalcTops(int slab) {
+	int z1 = slab * FANCY_SLAB_SIZE, z2 = min(z1 + FANCY_SLAB_SIZE, World.Length);
+	int x, z, top;
+
+	for (z = z1; z < z2; z++) {
+		for (x = 0; x < World.Width; x++) {
+			top = Lighting_Height(x, z);
+
+			/* Light height is one below the highest block, when that block's light offset is set */
+			if (top == -10) {
+				top = -1;
+			} else if (top < World.MaxY && Blocks.BlocksLight[World_GetBlock(x, top + 1, z)]) {
+				top++;
+			}
+			fancy_tops[Lighting_Pack(x, z)] = top;
+		}
+	}
+}
+
+static void Fancy_LightSlab(int slab) {
+	struct FancySlab* s = &fancy_slabs[slab];
+	int z1 = slab * FANCY_SLAB_SIZE, z2 = min(z1 + FANCY_SLAB_SIZE, World.Length);
+	int x, y, z, i, top, maxTop, hIndex;
+
+	for (z = z1; z < z2; z++) {
+		for (x = 0; x < World.Width; x++) {
+			hIndex = Lighting_Pack(x, z);
+			top    = fancy_tops[hIndex];
+
+			/* Blocks above the highest block that blocks light are in full sunlight */
+			/* (and that highest block receives full sunlight, even though it doesn't pass it on) */
+			for (y = World.MaxY, i = World_Pack(x, y, z); y >= 0 && y >= top; y--, i -= World.OneY) {
+				Fancy_Set(i, FANCY_SKY, LIGHTING_MAX_LEVEL);
+			}
+
+			/* Sunlight then spreads sideways into neighbouring columns that are in shadow at that height */
+			maxTop = top;
+			if (x > 0)           maxTop = max(maxTop, fancy_tops[hIndex - 1]);
+			if (x < World.MaxX)  maxTop = max(maxTop, fancy_tops[hIndex + 1]);
+			if (z > 0)           maxTop = max(maxTop, fancy_tops[hIndex - World.Width]);
+			if (z < World.MaxZ)  maxTop = max(maxTop, fancy_tops[hIndex + World.Width]);
+
+			for (y = top + 1; y <= maxTop; y++) {
+				LightQueue_Push(&s->Sky, World_Pack(x, y, z), 0);
+			}
 
-			if (lightH == HEIGHT_UNCALCULATED) {
-				Lighting_Heightmap[hIndex] = -10;
+			for (y = 0, i = World_Pack(x, 0, z); y < World.Height; y++, i += World.OneY) {
+				if (!Blocks.FullBright[World_GetBlock(x, y, z)]) continue;
+				Fancy_Set(i, FANCY_BLOCK, LIGHTING_MAX_LEVEL);
+				LightQueue_Push(&s->Block, i, 0);
 			}
 		}
 	}
+
+	Fancy_Spread(&s->Sky,   FANCY_SKY,   z1, z2, &s->SkyBorder);
+	Fancy_Spread(&s->Block, FANCY_BLOCK, z1, z2, &s->BlockBorder);
 }
 
-void Lighting_LightHint(int startX, int startZ) {
-	int x1 = max(startX, 0), x2 = min(World.Width,  startX + EXTCHUNK_SIZE);
-	int z1 = max(startZ, 0), z2 = min(World.Length, startZ + EXTCHUNK_SIZE);
-	int xCount = x2 - x1, zCount = z2 - z1;
-	int32_t skip[EXTCHUNK_SIZE * EXTCHUNK_SIZE];
+static void Fancy_Calculate(void) {
+	struct FancySlab* s;
+	int i;
+
+	fancy_slabsCount = (World.Length + FANCY_SLAB_SIZE - 1) / FANCY_SLAB_SIZE;
+	fancy_slabs = (struct FancySlab*)Mem_AllocCleared(fancy_slabsCount, sizeof(struct FancySlab), "light slabs");
+	fancy_tops  = (int16_t*)Mem_Alloc(World.Width * World.Length, 2, "light tops");
+	Mem_Set(fancy_levels, 0, World.Volume);
 
-	int elemsLeft = Lighting_InitialHeightmapCoverage(x1, z1, xCount, zCount, skip);
-	if (!Lighting_CalculateHeightmapCoverage(x1, z1, xCount, zCount, elemsLeft, skip)) {
-		Lighting_FinishHeightmapCoverage(x1, z1, xCount, zCount);
+	Lighting_RunJobs(Fancy_CalcTops,  fancy_slabsCount);
+	Lighting_RunJobs(Fancy_LightSlab, fancy_slabsCount);
+
+	/* Light spreading into neighbouring slabs would race with the other threads, so spread it now instead */
+	for (i = 0; i < fancy_slabsCount; i++) {
+		s = &fancy_slabs[i];
+		Fancy_Spread(&s->SkyBorder,   FANCY_SKY,   0, World.Length, NULL);
+		Fancy_Spread(&s->BlockBorder, FANCY_BLOCK, 0, World.Length, NULL);
+
+		LightQueue_Free(&s->Sky);       LightQueue_Free(&s->Block);
+		LightQueue_Free(&s->SkyBorder); LightQueue_Free(&s->BlockBorder);
 	}
+
+	Mem_Free(fancy_slabs);
+	Mem_Free(fancy_tops);
+	fancy_slabs = NULL;
+	fancy_tops  = NULL;
+}
+
+int Lighting_Level(int x, int y, int z) {
+	int i, sky, block;
+	if (!World_Contains(x, y, z)) return LIGHTING_MAX_LEVEL;
+	if (!Lighting_Fancy) return y > Lighting_Height(x, z) ? LIGHTING_MAX_LEVEL : 0;
+
+	i     = World_Pack(x, y, z);
+	sky   = Fancy_Get(i, FANCY_SKY);
+	block = Fancy_Get(i, FANCY_BLOCK);
+	return max(sky, block);
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------Lighting columns----------------------------------------------------*
+*#########################################################################################################################*/
+/* Number of rows of columns calculated by each job */
+#define COLUMNS_SLAB_SIZE 16
+
+static void Lighting_CalcColumnsSlab(int slab) {
+	int z1 = slab * COLUMNS_SLAB_SIZE, z2 = min(z1 + COLUMNS_SLAB_SIZE, World.Length);
+	World_CalcColumns(z1, z2);
+}
+
+/* Calculates the summary of every column in the world in parallel */
+static void Lighting_CalcColumns(void) {
+	Lighting_RunJobs(Lighting_CalcColumnsSlab, (World.Length + COLUMNS_SLAB_SIZE - 1) / COLUMNS_SLAB_SIZE);
 }
 
 
 /*########################################################################################################################*
 *---------------------------------------------------Lighting component----------------------------------------------------*
 *#########################################################################################################################*/
+static void Lighting_Init(void) {
+	lighting_mutex = Mutex_Create();
+	Lighting_Fancy = Options_GetBool(OPT_FANCY_LIGHTING, false);
+	ScheduledTask_Add(GAME_DEF_TICKS, Lighting_CheckRefresh);
+}
+
 static void Lighting_Reset(void) {
-	Mem_Free(Lighting_Heightmap);
-	Lighting_Heightmap = NULL;
+	lighting_refreshPending = false;
+	Mem_Free(fancy_levels);
+	fancy_levels = NULL;
+}
+
+static void Lighting_Free(void) {
+	Lighting_Reset();
+	LightQueue_Free(&fancy_removed);
+	LightQueue_Free(&fancy_relight);
+	Lighting_StopWorkers();
+	Mutex_Free(lighting_mutex);
 }
 
 static void Lighting_OnNewMapLoaded(void) {
-	Lighting_Heightmap = (int16_t*)Mem_Alloc(World.Width * World.Length, 2, "lighting heightmap");
+	World.Columns = (struct WorldColumn*)Mem_Alloc(World.Width * World.Length, sizeof(struct WorldColumn), "world columns");
+	if (Lighting_Fancy) fancy_levels = (uint8_t*)Mem_Alloc(World.Volume, 1, "light levels");
 	Lighting_Refresh();
 }
 
 struct IGameComponent Lighting_Component = {
-	NULL,           /* Init  */
-	Lighting_Reset, /* Free  */
+	Lighting_Init,  /* Init  */
+	Lighting_Free,  /* Free  */
 	Lighting_Reset, /* Reset */
 	Lighting_Reset, /* OnNewMap */
 	Lighting_OnNewMapLoaded /* OnNewMapLoaded */
@@ -3,24 +3,34 @@
 #include "PackedCol.h"
 /* Manages lighting of blocks in the world.
 BasicLighting: Uses a simple heightmap, where each block is either in sun or shadow.
+FancyLighting: Also flood fills 4 bit sky and block light levels outwards from the sky and light emitting blocks.
    Copyright 2014-2017 ClassicalSharp | Licensed under BSD-3
 */
 struct IGameComponent;
+struct BlockEdit;
 extern struct IGameComponent Lighting_Component;
 
-#define Lighting_Pack(x, z) ((x) + World.Width * (z))
-extern int16_t* Lighting_Heightmap;
+#define Lighting_Pack(x, z) World_ColumnPack(x, z)
+/* Blocks at or below this Y in the given column are in shadow. (see WorldColumn.LightY) */
+#define Lighting_Height(x, z) World.Columns[World_ColumnPack(x, z)].LightY
+/* Whether flood fill lighting is used. (see Lighting_Level) */
+/* NOTE: Only read from options on startup, as changing this requires recalculating lighting. */
+extern bool Lighting_Fancy;
+#define LIGHTING_MAX_LEVEL 15
 
-/* Equivalent to (but far more optimised form of)
-* for x = startX; x < startX + 18; x++
-*   for z = startZ; z < startZ + 18; z++
-*      CalcLight(x, maxY, z)                         */
-void Lighting_LightHint(int startX, int startZ);
-
-/* Called when a block is changed, to update the lighting information. */
+/* Called when a block is changed, to update the lighting information and column summary. (see World_UpdateColumn) */
 /* NOTE: Implementations ***MUST*** mark all chunks affected by this lighting changeas needing to be refreshed. */
 void Lighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+/* Called when a batch of blocks was changed, instead of calling Lighting_OnBlockChanged for every block. */
+/* The summary of each changed column is only recalculated once. (see Game_EndBatch) */
+/* NOTE: The given changes are reordered. */
+void Lighting_OnBlocksChanged(struct BlockEdit* edits, int count);
+/* Recalculates the summary of every column, and flood fill lighting if used. */
+/* NOTE: Background mesh builders must not be running, as they read lighting. (see Builder_CancelChunks) */
 void Lighting_Refresh(void);
+/* Marks all lighting as needing to be recalculated. Multiple calls in the same tick only recalculate once, */
+/* after stopping background mesh builders and discarding every chunk's mesh. */
+void Lighting_ScheduleRefresh(void);
 
 /* Returns whether the block at the given coordinates is fully in sunlight. */
 /* NOTE: Does ***NOT*** check that the coordinates are inside the map. */
@@ -32,9 +42,11 @@ PackedCol Lighting_Col(int x, int y, int z);
 /* NOTE: Does ***NOT*** check that the coordinates are inside the map. */
 PackedCol Lighting_Col_XSide(int x, int y, int z);
 
-PackedCol Lighting_Col_Sprite_Fast(int x, int y, int z);
-PackedCol Lighting_Col_YMax_Fast(int x, int y, int z);
-PackedCol Lighting_Col_YMin_Fast(int x, int y, int z);
-PackedCol Lighting_Col_XSide_Fast(int x, int y, int z);
-PackedCol Lighting_Col_ZSide_Fast(int x, int y, int z);
+/* Returns whether the block at the given coordinates is fully in sunlight. */
+/* NOTE: Does ***NOT*** check that the coordinates are inside the map. */
+bool Lighting_IsLit_Fast(int x, int y, int z);
+/* Returns the light level of the block at the given coordinates, from 0 (dark) to LIGHTING_MAX_LEVEL. */
+/* With basic lighting, this is either 0 (in shadow) or LIGHTING_MAX_LEVEL (in sunlight). */
+/* NOTE: Coordinates outside the map are fully lit. */
+int Lighting_Level(int x, int y, int z);
 #endif
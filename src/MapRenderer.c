@@ -9,6 +9,8 @@
 #include "Funcs.h"
 #include "Game.h"
 #include "Graphics.h"
+#include "Logger.h"
+#include "Options.h"
 #include "Platform.h"
 #include "TexturePack.h"
 #include "Utils.h"
@@ -16,12 +18,14 @@
 
 int MapRenderer_ChunksX, MapRenderer_ChunksY, MapRenderer_ChunksZ;
 int MapRenderer_1DUsedCount, MapRenderer_ChunksCount;
-int MapRenderer_MaxUpdates;
+int MapRenderer_MaxUpdates, MapRenderer_UpdateBudget;
 struct ChunkPartInfo* MapRenderer_PartsNormal;
 struct ChunkPartInfo* MapRenderer_PartsTranslucent;
 
 static bool inTranslucent;
 static Vector3I chunkPos;
+/* Vertex buffer currently bound when rendering chunks */
+static GfxResourceID boundVb;
 
 /* The number of non-empty Normal/Translucent ChunkPartInfos (across entire world) for each 1D atlas batch. */
 /* 1D atlas batches that do not have any ChunkPartInfos can be entirely skipped. */
@@ -43,6 +47,27 @@ static struct ChunkInfo** renderChunks;
 static int renderChunksCount;
 /* Distance of each chunk from the camera. */
 static uint32_t* distances;
+/* Whether chunks hidden behind other chunks are skipped when rendering. */
+static bool occlusionCulling;
+/* Whether the Occluded flag of chunks needs to be recalculated. */
+static bool occlusionDirty;
+/* Chunks (as indices into mapChunks) waiting to be visited by the occlusion flood fill. */
+static int* occlusionQueue;
+/* Faces each chunk was entered through by the occlusion flood fill, and whether it has been queued. */
+static uint8_t* occlusionFaces;
+/* Binary min heap of chunks (as indices into mapChunks) waiting to be rebuilt, ordered by distance from the camera. */
+static int* dirtyChunks;
+/* Distance from the camera of each chunk in dirtyChunks. */
+static uint32_t* dirtyDists;
+static int dirtyCount;
+/* Chunks are grouped into columns of 4x4 chunks, so only groups partially inside the frustum */
+/* need each of their chunks to be individually tested against the frustum. */
+#define CHUNK_GROUP_SHIFT 2
+#define CHUNK_GROUP_MASK ((1 << CHUNK_GROUP_SHIFT) - 1)
+#define CHUNK_GROUP_SIZE (CHUNK_SIZE << CHUNK_GROUP_SHIFT)
+/* Result of frustum culling (see FRUSTUM_RESULT) for each group of chunk columns. */
+static uint8_t* groupsFrustum;
+static int groupsX, groupsZ;
 
 /* Buffer for all chunk parts. There are (MapRenderer_ChunksCount * Atlas1D_Count) * 2 parts in the buffer,
  with parts for 'normal' buffer being in lower half. */
@@ -55,11 +80,15 @@ struct ChunkInfo* MapRenderer_GetChunk(int cx, int cy, int cz) {
 void ChunkInfo_Reset(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->CentreX = x + 8; chunk->CentreY = y + 8; chunk->CentreZ = z + 8;
 #ifndef CC_BUILD_GL11
-	chunk->Vb = GFX_NULL;
+	chunk->Arena   = 0;
+	chunk->VbCount = 0;
 #endif
 
 	chunk->Visible = true;        chunk->Empty = false;
 	chunk->PendingDelete = false; chunk->AllAir = false;
+	chunk->Building = false;      chunk->Occluded = false;
+	chunk->Dirty    = false;      chunk->Reconnected = false;
+	chunk->Connectivity = CHUNK_ALL_CONNECTED;
 	chunk->DrawXMin = false; chunk->DrawXMax = false; chunk->DrawZMin = false;
 	chunk->DrawZMax = false; chunk->DrawYMin = false; chunk->DrawYMax = false;
 
@@ -79,9 +108,308 @@ CC_NOINLINE static int MapRenderer_UsedAtlases(void) {
 }
 
 
+/*########################################################################################################################*
+*---------------------------------------------------Chunk vertex arenas---------------------------------------------------*
+*#########################################################################################################################*/
+#ifndef CC_BUILD_GL11
+/* Number of vertices in each vertex arena. (8 MB with compact chunk vertices) */
+#define CHUNK_ARENA_VERTICES (1 << 19)
+#define CHUNK_MAX_ARENAS 256
+/* Vertices of deleted chunk meshes are only freed this many frames later, since the GPU */
+/* may still be drawing earlier frames that use them. (see Gfx_SetDynamicVbRange) */
+#define CHUNK_FREE_DELAY 3
+
+struct ChunkArenaRange { int Offset, Count; };
+struct ChunkArena {
+	GfxResourceID Vb;
+	int Size, Used, Allocs;
+	/* Free ranges of vertices, sorted by offset. Adjacent free ranges are always merged together. */
+	struct ChunkArenaRange* Free;
+	int FreeCount, FreeCapacity;
+};
+static struct ChunkArena arenas[CHUNK_MAX_ARENAS];
+static int arenasCount;
+
+struct ChunkArenaPending { int Arena, Offset, Count; };
+/* Vertices waiting to be freed, for each of the last CHUNK_FREE_DELAY frames */
+static struct ChunkArenaPending* pendingFree[CHUNK_FREE_DELAY];
+static int pendingCount[CHUNK_FREE_DELAY], pendingCapacity[CHUNK_FREE_DELAY];
+static int pendingFrame, pendingVertices;
+
+/* Rounds up to one of 16 size classes per power of two, wasting less than 1/16 of the vertices. */
+/* Freed ranges then usually fit a later chunk mesh exactly, instead of leaving small unusable gaps. */
+static int ChunkArena_SizeClass(int count) {
+	int step = 64;
+	while (step * 16 < count) step <<= 1;
+	return (count + step - 1) & ~(step - 1);
+}
+
+static void ChunkArena_InsertFree(struct ChunkArena* a, int index, int offset, int count) {
+	int i;
+	if (a->FreeCount == a->FreeCapacity) {
+		a->FreeCapacity = a->FreeCapacity ? a->FreeCapacity * 2 : 16;
+		a->Free = Mem_Realloc(a->Free, a->FreeCapacity, sizeof(struct ChunkArenaRange), "arena free ranges");
+	}
+
+	for (i = a->FreeCount; i > index; i--) { a->Free[i] = a->Free[i - 1]; }
+	a->Free[index].Offset = offset;
+	a->Free[index].Count  = count;
+	a->FreeCount++;
+}
+
+static void ChunkArena_RemoveFree(struct ChunkArena* a, int index) {
+	int i;
+	a->FreeCount--;
+	for (i = index; i < a->FreeCount; i++) { a->Free[i] = a->Free[i + 1]; }
+}
+
+static void ChunkArena_Create(struct ChunkArena* a, int size) {
+	a->Vb     = Gfx_CreateDynamicVb(CHUNK_VERTEX_FORMAT, size);
+	a->Size   = size;
+	a->Used   = 0;
+	a->Allocs = 0;
+	a->FreeCount = 0;
+	ChunkArena_InsertFree(a, 0, 0, size);
+}
+
+static void ChunkArena_Delete(struct ChunkArena* a) {
+	Gfx_DeleteVb(&a->Vb);
+	Mem_Free(a->Free);
+	a->Free = NULL;
+	a->Size = 0; a->Used = 0; a->Allocs = 0;
+	a->FreeCount = 0; a->FreeCapacity = 0;
+}
+
+/* Returns offset of smallest free range that can fit the given number of vertices, -1 if none can */
+static int ChunkArena_Alloc(struct ChunkArena* a, int count) {
+	struct ChunkArenaRange* range;
+	int i, best = -1, offset;
+
+	for (i = 0; i < a->FreeCount; i++) {
+		if (a->Free[i].Count < count) continue;
+		if (best == -1 || a->Free[i].Count < a->Free[best].Count) best = i;
+		if (a->Free[i].Count == count) break;
+	}
+	if (best == -1) return -1;
+
+	range  = &a->Free[best];
+	offset = range->Offset;
+	range->Offset += count;
+	range->Count  -= count;
+	if (!range->Count) ChunkArena_RemoveFree(a, best);
+
+	a->Used += count;
+	a->Allocs++;
+	return offset;
+}
+
+static void ChunkArena_Free(struct ChunkArena* a, int offset, int count) {
+	struct ChunkArenaRange* free = a->Free;
+	int lo = 0, hi = a->FreeCount, mid;
+	bool mergePrev, mergeNext;
+
+	/* Find index of the first free range after the freed vertices */
+	while (lo < hi) {
+		mid = (lo + hi) >> 1;
+		if (free[mid].Offset < offset) { lo = mid + 1; } else { hi = mid; }
+	}
+	a->Used -= count;
+	a->Allocs--;
+
+	mergePrev = lo > 0            && free[lo - 1].Offset + free[lo - 1].Count == offset;
+	mergeNext = lo < a->FreeCount && offset + count == free[lo].Offset;
+
+	if (mergePrev && mergeNext) {
+		free[lo - 1].Count += count + free[lo].Count;
+		ChunkArena_RemoveFree(a, lo);
+	} else if (mergePrev) {
+		free[lo - 1].Count += count;
+	} else if (mergeNext) {
+		free[lo].Offset = offset;
+		free[lo].Count += count;
+	} else {
+		ChunkArena_InsertFree(a, lo, offset, count);
+	}
+}
+
+void MapRenderer_AllocVertices(struct ChunkInfo* info, void* vertices, int count) {
+	struct ChunkArena* a = NULL;
+	int i, offset = -1;
+	int size = ChunkArena_SizeClass(count);
+
+	for (i = 0; i < arenasCount; i++) {
+		a = &arenas[i];
+		if (a->Vb == GFX_NULL) continue;
+		if ((offset = ChunkArena_Alloc(a, size)) >= 0) break;
+	}
+
+	/* No arena has enough room left, so recreate a deleted arena or add a new one */
+	if (offset < 0) {
+		for (i = 0; i < arenasCount; i++) {
+			if (arenas[i].Vb == GFX_NULL) break;
+		}
+		if (i == CHUNK_MAX_ARENAS) Logger_Abort("Ran out of chunk vertex arenas");
+		if (i == arenasCount) arenasCount++;
+
+		a = &arenas[i];
+		ChunkArena_Create(a, max(size, CHUNK_ARENA_VERTICES));
+		offset = ChunkArena_Alloc(a, size);
+	}
+
+	info->Arena    = i;
+	info->VbOffset = offset;
+	info->VbCount  = size;
+	Gfx_SetDynamicVbRange(a->Vb, CHUNK_VERTEX_FORMAT, vertices, offset, count);
+}
+
+static void MapRenderer_FreeVertices(struct ChunkInfo* info) {
+	struct ChunkArenaPending* pending;
+	int i = pendingFrame;
+	if (!info->VbCount) return;
+
+	if (pendingCount[i] == pendingCapacity[i]) {
+		pendingCapacity[i] = pendingCapacity[i] ? pendingCapacity[i] * 2 : 64;
+		pendingFree[i] = Mem_Realloc(pendingFree[i], pendingCapacity[i], sizeof(struct ChunkArenaPending), "arena pending frees");
+	}
+
+	pending = &pendingFree[i][pendingCount[i]++];
+	pending->Arena  = info->Arena;
+	pending->Offset = info->VbOffset;
+	pending->Count  = info->VbCount;
+
+	pendingVertices += info->VbCount;
+	info->VbCount    = 0;
+}
+
+/* Frees the vertices of chunk meshes that were deleted CHUNK_FREE_DELAY frames ago */
+static void MapRenderer_ReleaseVertices(void) {
+	struct ChunkArenaPending* pending;
+	struct ChunkArena* a;
+	int i;
+	pendingFrame = (pendingFrame + 1) % CHUNK_FREE_DELAY;
+
+	for (i = 0; i < pendingCount[pendingFrame]; i++) {
+		pending = &pendingFree[pendingFrame][i];
+		a = &arenas[pending->Arena];
+
+		ChunkArena_Free(a, pending->Offset, pending->Count);
+		pendingVertices -= pending->Count;
+		/* Give the memory of empty arenas back, but always keep the first arena */
+		/* around, to avoid constantly recreating it when rebuilding small worlds */
+		if (!a->Allocs && pending->Arena) ChunkArena_Delete(a);
+	}
+	pendingCount[pendingFrame] = 0;
+}
+
+static void MapRenderer_FreeArenas(void) {
+	int i;
+	for (i = 0; i < arenasCount; i++) {
+		ChunkArena_Delete(&arenas[i]);
+	}
+	arenasCount = 0;
+
+	/* Deleting the vertex buffers already frees all of their vertices */
+	for (i = 0; i < CHUNK_FREE_DELAY; i++) {
+		Mem_Free(pendingFree[i]);
+		pendingFree[i]     = NULL;
+		pendingCount[i]    = 0;
+		pendingCapacity[i] = 0;
+	}
+	pendingVertices = 0;
+}
+
+void MapRenderer_GetArenaStats(struct ChunkArenaStats* stats) {
+	struct ChunkArena* a;
+	int i, j;
+	Mem_Set(stats, 0, sizeof(struct ChunkArenaStats));
+
+	for (i = 0; i < arenasCount; i++) {
+		a = &arenas[i];
+		if (a->Vb == GFX_NULL) continue;
+
+		stats->Arenas++;
+		stats->Allocs       += a->Allocs;
+		stats->UsedVertices += a->Used;
+		stats->FreeVertices += a->Size - a->Used;
+		stats->FreeRanges   += a->FreeCount;
+
+		for (j = 0; j < a->FreeCount; j++) {
+			stats->LargestFree = max(stats->LargestFree, a->Free[j].Count);
+		}
+	}
+	/* Vertices waiting to be freed are still counted as used by their arena */
+	stats->UsedVertices   -= pendingVertices;
+	stats->PendingVertices = pendingVertices;
+}
+#else
+#define MapRenderer_FreeVertices(info)
+#define MapRenderer_ReleaseVertices()
+#define MapRenderer_FreeArenas()
+#endif
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------Map rendering-----------------------------------------------------*
 *#########################################################################################################################*/
+#ifdef CC_BUILD_COMPACTCHUNKS
+#define MapRenderer_DrawTris Gfx_DrawIndexedVb_TrisT2sC4b
+static struct Matrix chunkView;
+
+/* Sets up matrices for scaling compact chunk vertices back into blocks and tiles */
+static void MapRenderer_BeginChunks(void) {
+	struct Matrix tex;
+	float scale = 1.0f / CHUNK_POS_SCALE;
+
+	chunkView = Gfx.View;
+	chunkView.Row0.X *= scale; chunkView.Row0.Y *= scale; chunkView.Row0.Z *= scale; chunkView.Row0.W *= scale;
+	chunkView.Row1.X *= scale; chunkView.Row1.Y *= scale; chunkView.Row1.Z *= scale; chunkView.Row1.W *= scale;
+	chunkView.Row2.X *= scale; chunkView.Row2.Y *= scale; chunkView.Row2.Z *= scale; chunkView.Row2.W *= scale;
+
+	Matrix_Scale(&tex, 1.0f / CHUNK_U_SCALE, 1.0f / CHUNK_V_SCALE, 1.0f);
+	Gfx_LoadMatrix(MATRIX_TEXTURE, &tex);
+#ifdef CC_BUILD_SHADEDCHUNKS
+	Gfx_SetChunkLightCols(Env.SunCol, Env.ShadowCol);
+	Gfx_SetChunkTileSize(Atlas1D.InvTileSize);
+#endif
+}
+
+/* Loads view matrix that translates the given chunk's vertices to the chunk's position in the world */
+static void MapRenderer_TranslateChunk(struct ChunkInfo* info) {
+	const struct Matrix* v = &Gfx.View;
+	float x = (float)(info->CentreX - 8), y = (float)(info->CentreY - 8), z = (float)(info->CentreZ - 8);
+
+	chunkView.Row3.X = x * v->Row0.X + y * v->Row1.X + z * v->Row2.X + v->Row3.X;
+	chunkView.Row3.Y = x * v->Row0.Y + y * v->Row1.Y + z * v->Row2.Y + v->Row3.Y;
+	chunkView.Row3.Z = x * v->Row0.Z + y * v->Row1.Z + z * v->Row2.Z + v->Row3.Z;
+	chunkView.Row3.W = x * v->Row0.W + y * v->Row1.W + z * v->Row2.W + v->Row3.W;
+	Gfx_LoadMatrix(MATRIX_VIEW, &chunkView);
+}
+
+static void MapRenderer_EndChunks(void) {
+	Gfx_LoadIdentityMatrix(MATRIX_TEXTURE);
+	Gfx_LoadMatrix(MATRIX_VIEW, &Gfx.View);
+}
+#else
+#define MapRenderer_DrawTris Gfx_DrawIndexedVb_TrisT2fC4b
+#define MapRenderer_BeginChunks()
+#define MapRenderer_TranslateChunk(info)
+#define MapRenderer_EndChunks()
+#endif
+
+/* Binds the vertex buffer containing the given chunk part's vertices, */
+/* then returns the offset of the chunk's vertices in that vertex buffer */
+static int MapRenderer_BindPart(struct ChunkInfo* info, struct ChunkPartInfo* part) {
+#ifndef CC_BUILD_GL11
+	GfxResourceID vb = arenas[info->Arena].Vb;
+	/* Consecutive chunks in the same vertex arena don't need to rebind it */
+	if (vb != boundVb) { Gfx_BindVb(vb); boundVb = vb; }
+	return info->VbOffset;
+#else
+	Gfx_BindVb(part->Vb);
+	return 0;
+#endif
+}
+
 static void MapRenderer_CheckWeather(double delta) {
 	Vector3I pos;
 	BlockID block;
@@ -102,14 +430,14 @@ static void MapRenderer_CheckWeather(double delta) {
 #define MapRenderer_DrawNormalFaces(minFace, maxFace) \
 if (drawMin && drawMax) { \
 	Gfx_SetFaceCulling(true); \
-	Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[minFace] + part.Counts[maxFace], offset); \
+	MapRenderer_DrawTris(part.Counts[minFace] + part.Counts[maxFace], offset); \
 	Gfx_SetFaceCulling(false); \
 	Game_Vertices += (part.Counts[minFace] + part.Counts[maxFace]); \
 } else if (drawMin) { \
-	Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[minFace], offset); \
+	MapRenderer_DrawTris(part.Counts[minFace], offset); \
 	Game_Vertices += part.Counts[minFace]; \
 } else if (drawMax) { \
-	Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[maxFace], offset + part.Counts[minFace]); \
+	MapRenderer_DrawTris(part.Counts[maxFace], offset + part.Counts[minFace]); \
 	Game_Vertices += part.Counts[maxFace]; \
 }
 
@@ -118,7 +446,8 @@ static void MapRenderer_RenderNormalBatch(int batch) {
 	struct ChunkInfo* info;
 	struct ChunkPartInfo part;
 	bool drawMin, drawMax;
-	int i, offset, count;
+	int i, base, offset, count;
+	boundVb = GFX_NULL;
 
 	for (i = 0; i < renderChunksCount; i++) {
 		info = renderChunks[i];
@@ -128,13 +457,10 @@ static void MapRenderer_RenderNormalBatch(int batch) {
 		if (part.Offset < 0) continue;
 		hasNormParts[batch] = true;
 
-#ifndef CC_BUILD_GL11
-		Gfx_BindVb(info->Vb);
-#else
-		Gfx_BindVb(part.Vb);
-#endif
+		base = MapRenderer_BindPart(info, &part);
+		MapRenderer_TranslateChunk(info);
 
-		offset  = part.Offset + part.SpriteCount;
+		offset  = base + part.Offset + part.SpriteCount;
 		drawMin = info->DrawXMin && part.Counts[FACE_XMIN];
 		drawMax = info->DrawXMax && part.Counts[FACE_XMAX];
 		MapRenderer_DrawNormalFaces(FACE_XMIN, FACE_XMAX);
@@ -150,24 +476,24 @@ static void MapRenderer_RenderNormalBatch(int batch) {
 		MapRenderer_DrawNormalFaces(FACE_YMIN, FACE_YMAX);
 
 		if (!part.SpriteCount) continue;
-		offset = part.Offset;
+		offset = base + part.Offset;
 		count  = part.SpriteCount >> 2; /* 4 per sprite */
 
 		Gfx_SetFaceCulling(true);
 		if (info->DrawXMax || info->DrawZMin) {
-			Gfx_DrawIndexedVb_TrisT2fC4b(count, offset); Game_Vertices += count;
+			MapRenderer_DrawTris(count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->DrawXMin || info->DrawZMax) {
-			Gfx_DrawIndexedVb_TrisT2fC4b(count, offset); Game_Vertices += count;
+			MapRenderer_DrawTris(count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->DrawXMin || info->DrawZMin) {
-			Gfx_DrawIndexedVb_TrisT2fC4b(count, offset); Game_Vertices += count;
+			MapRenderer_DrawTris(count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->DrawXMax || info->DrawZMax) {
-			Gfx_DrawIndexedVb_TrisT2fC4b(count, offset); Game_Vertices += count;
+			MapRenderer_DrawTris(count, offset); Game_Vertices += count;
 		}
 		Gfx_SetFaceCulling(false);
 	}
@@ -177,7 +503,8 @@ void MapRenderer_RenderNormal(double delta) {
 	int batch;
 	if (!mapChunks) return;
 
-	Gfx_SetVertexFormat(VERTEX_FORMAT_P3FT2FC4B);
+	Gfx_SetVertexFormat(CHUNK_VERTEX_FORMAT);
+	MapRenderer_BeginChunks();
 	Gfx_SetTexturing(true);
 	Gfx_SetAlphaTest(true);
 	
@@ -191,24 +518,22 @@ void MapRenderer_RenderNormal(double delta) {
 		}
 	}
 	Gfx_DisableMipmaps();
+	MapRenderer_EndChunks();
 
 	MapRenderer_CheckWeather(delta);
 	Gfx_SetAlphaTest(false);
 	Gfx_SetTexturing(false);
-#if DEBUG_OCCLUSION
-	DebugPickedPos();
-#endif
 }
 
 #define MapRenderer_DrawTranslucentFaces(minFace, maxFace) \
 if (drawMin && drawMax) { \
-	Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[minFace] + part.Counts[maxFace], offset); \
+	MapRenderer_DrawTris(part.Counts[minFace] + part.Counts[maxFace], offset); \
 	Game_Vertices += (part.Counts[minFace] + part.Counts[maxFace]); \
 } else if (drawMin) { \
-	Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[minFace], offset); \
+	MapRenderer_DrawTris(part.Counts[minFace], offset); \
 	Game_Vertices += part.Counts[minFace]; \
 } else if (drawMax) { \
-	Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[maxFace], offset + part.Counts[minFace]); \
+	MapRenderer_DrawTris(part.Counts[maxFace], offset + part.Counts[minFace]); \
 	Game_Vertices += part.Counts[maxFace]; \
 }
 
@@ -218,6 +543,7 @@ static void MapRenderer_RenderTranslucentBatch(int batch) {
 	struct ChunkPartInfo part;
 	bool drawMin, drawMax;
 	int i, offset;
+	boundVb = GFX_NULL;
 
 	for (i = 0; i < renderChunksCount; i++) {
 		info = renderChunks[i];
@@ -227,13 +553,9 @@ static void MapRenderer_RenderTranslucentBatch(int batch) {
 		if (part.Offset < 0) continue;
 		hasTranParts[batch] = true;
 
-#ifndef CC_BUILD_GL11
-		Gfx_BindVb(info->Vb);
-#else
-		Gfx_BindVb(part.Vb);
-#endif
+		offset = MapRenderer_BindPart(info, &part) + part.Offset;
+		MapRenderer_TranslateChunk(info);
 
-		offset  = part.Offset;
 		drawMin = (inTranslucent || info->DrawXMin) && part.Counts[FACE_XMIN];
 		drawMax = (inTranslucent || info->DrawXMax) && part.Counts[FACE_XMAX];
 		MapRenderer_DrawTranslucentFaces(FACE_XMIN, FACE_XMAX);
@@ -256,7 +578,8 @@ void MapRenderer_RenderTranslucent(double delta) {
 
 	/* First fill depth buffer */
 	vertices = Game_Vertices;
-	Gfx_SetVertexFormat(VERTEX_FORMAT_P3FT2FC4B);
+	Gfx_SetVertexFormat(CHUNK_VERTEX_FORMAT);
+	MapRenderer_BeginChunks();
 	Gfx_SetTexturing(false);
 	Gfx_SetAlphaBlending(false);
 	Gfx_SetColWriteMask(false, false, false, false);
@@ -284,6 +607,7 @@ void MapRenderer_RenderTranslucent(double delta) {
 		MapRenderer_RenderTranslucentBatch(batch);
 	}
 	Gfx_DisableMipmaps();
+	MapRenderer_EndChunks();
 
 	Gfx_SetDepthWrite(true);
 	/* If we weren't under water, render weather after to blend properly */
@@ -312,11 +636,22 @@ static void MapRenderer_FreeChunks(void) {
 	Mem_Free(sortedChunks);
 	Mem_Free(renderChunks);
 	Mem_Free(distances);
+	Mem_Free(occlusionQueue);
+	Mem_Free(occlusionFaces);
+	Mem_Free(dirtyChunks);
+	Mem_Free(dirtyDists);
+	Mem_Free(groupsFrustum);
 
 	mapChunks    = NULL;
 	sortedChunks = NULL;
 	renderChunks = NULL;
 	distances    = NULL;
+	occlusionQueue = NULL;
+	occlusionFaces = NULL;
+	dirtyChunks    = NULL;
+	dirtyDists     = NULL;
+	dirtyCount     = 0;
+	groupsFrustum  = NULL;
 }
 
 static void MapRenderer_AllocateParts(void) {
@@ -331,6 +666,14 @@ static void MapRenderer_AllocateChunks(void) {
 	sortedChunks = Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct ChunkInfo*), "sorted chunk info");
 	renderChunks = Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct ChunkInfo*), "render chunk info");
 	distances    = Mem_Alloc(MapRenderer_ChunksCount, 4, "chunk distances");
+	occlusionQueue = Mem_Alloc(MapRenderer_ChunksCount, sizeof(int), "chunk occlusion queue");
+	occlusionFaces = Mem_Alloc(MapRenderer_ChunksCount, 1, "chunk occlusion faces");
+	dirtyChunks    = Mem_Alloc(MapRenderer_ChunksCount, sizeof(int), "dirty chunks");
+	dirtyDists     = Mem_Alloc(MapRenderer_ChunksCount, 4, "dirty chunk distances");
+
+	groupsX = (MapRenderer_ChunksX + CHUNK_GROUP_MASK) >> CHUNK_GROUP_SHIFT;
+	groupsZ = (MapRenderer_ChunksZ + CHUNK_GROUP_MASK) >> CHUNK_GROUP_SHIFT;
+	groupsFrustum = Mem_AllocCleared(groupsX * groupsZ, 1, "chunk groups frustum");
 }
 
 static void MapRenderer_ResetPartFlags(void) {
@@ -381,18 +724,23 @@ static void MapRenderer_ResetChunks(void) {
 static void MapRenderer_DeleteChunks(void) {
 	int i;
 	if (!mapChunks) return;
+	Builder_CancelChunks();
 
 	for (i = 0; i < MapRenderer_ChunksCount; i++) {
 		MapRenderer_DeleteChunk(&mapChunks[i]);
+		mapChunks[i].Building = false;
+		mapChunks[i].Dirty    = false;
 	}
+	dirtyCount = 0;
 	MapRenderer_ResetPartCounts();
+	MapRenderer_FreeArenas();
 }
 
 void MapRenderer_Refresh(void) {
 	int oldCount;
 	chunkPos = Vector3I_MaxValue();
 
-	if (mapChunks && World.Blocks) {
+	if (mapChunks && World.Loaded) {
 		MapRenderer_DeleteChunks();
 		MapRenderer_ResetChunks();
 
@@ -412,7 +760,7 @@ void MapRenderer_RefreshBorders(int maxHeight) {
 	bool onBorder;
 
 	chunkPos = Vector3I_MaxValue();
-	if (!mapChunks || !World.Blocks) return;
+	if (!mapChunks || !World.Loaded) return;
 
 	for (cz = 0; cz < MapRenderer_ChunksZ; cz++) {
 		for (cy = 0; cy < MapRenderer_ChunksY; cy++) {
@@ -428,11 +776,100 @@ void MapRenderer_RefreshBorders(int maxHeight) {
 }
 
 
+/*########################################################################################################################*
+*----------------------------------------------------Occlusion culling----------------------------------------------------*
+*#########################################################################################################################*/
+#define OCCLUSION_QUEUED 0x80
+
+/* Returns mask of faces the given chunk can be exited through, when entered through the given mask of faces. */
+static int MapRenderer_ExitFaces(int connectivity, int entered) {
+	int exits = 0, i, j;
+
+	for (i = 0; i < FACE_COUNT; i++) {
+		if (!(entered & (1 << i))) continue;
+
+		for (j = 0; j < FACE_COUNT; j++) {
+			if (i == j) continue;
+			if (connectivity & (i < j ? Chunk_ConnectivityBit(i, j) : Chunk_ConnectivityBit(j, i))) exits |= 1 << j;
+		}
+	}
+	return exits;
+}
+
+#define MapRenderer_VisitChunk(index, face) \
+if (!(occlusionFaces[index] & OCCLUSION_QUEUED)) { occlusionQueue[tail++] = index; } \
+occlusionFaces[index] |= OCCLUSION_QUEUED | (1 << (face));
+
+/* Flood fills outwards from the chunk the camera is in, only travelling between */
+/* two faces of a chunk when those faces can see each other through the chunk. */
+/* Chunks never reached by the flood fill cannot be seen by the camera, so are marked as occluded. */
+static void MapRenderer_CalcOcclusion(void) {
+	struct ChunkInfo* info;
+	int strideY = MapRenderer_ChunksX, strideZ = MapRenderer_ChunksX * MapRenderer_ChunksY;
+	int camX, camY, camZ, camIndex;
+	int cx, cy, cz, i, index, head, tail, exits;
+	bool inside;
+	occlusionDirty = false;
+
+	camX = chunkPos.X >> CHUNK_SHIFT; camY = chunkPos.Y >> CHUNK_SHIFT; camZ = chunkPos.Z >> CHUNK_SHIFT;
+	inside = occlusionCulling && camX >= 0 && camY >= 0 && camZ >= 0
+		&& camX < MapRenderer_ChunksX && camY < MapRenderer_ChunksY && camZ < MapRenderer_ChunksZ;
+
+	/* Camera outside the map can see into any chunk on the map's surface */
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		mapChunks[i].Occluded = inside;
+	}
+	if (!inside) return;
+
+	Mem_Set(occlusionFaces, 0, MapRenderer_ChunksCount);
+	camIndex = MapRenderer_Pack(camX, camY, camZ);
+	occlusionQueue[0] = camIndex;
+	occlusionFaces[camIndex] = OCCLUSION_QUEUED;
+	head = 0; tail = 1;
+
+	/* Every step moves one chunk further from the camera chunk, so all the chunks */
+	/* that can enter a chunk have been visited by the time that chunk is visited */
+	while (head < tail) {
+		index = occlusionQueue[head++];
+		info  = &mapChunks[index];
+		info->Occluded = false;
+
+		cx = info->CentreX >> CHUNK_SHIFT; cy = info->CentreY >> CHUNK_SHIFT; cz = info->CentreZ >> CHUNK_SHIFT;
+		exits = index == camIndex ? 0x3F : MapRenderer_ExitFaces(info->Connectivity, occlusionFaces[index]);
+
+		/* Never travel back towards the camera */
+		if (cx > camX) exits &= ~(1 << FACE_XMIN);
+		if (cx < camX) exits &= ~(1 << FACE_XMAX);
+		if (cy > camY) exits &= ~(1 << FACE_YMIN);
+		if (cy < camY) exits &= ~(1 << FACE_YMAX);
+		if (cz > camZ) exits &= ~(1 << FACE_ZMIN);
+		if (cz < camZ) exits &= ~(1 << FACE_ZMAX);
+
+		if ((exits & (1 << FACE_XMIN)) && cx > 0) {
+			MapRenderer_VisitChunk(index - 1, FACE_XMAX);
+		}
+		if ((exits & (1 << FACE_XMAX)) && cx < MapRenderer_ChunksX - 1) {
+			MapRenderer_VisitChunk(index + 1, FACE_XMIN);
+		}
+		if ((exits & (1 << FACE_YMIN)) && cy > 0) {
+			MapRenderer_VisitChunk(index - strideY, FACE_YMAX);
+		}
+		if ((exits & (1 << FACE_YMAX)) && cy < MapRenderer_ChunksY - 1) {
+			MapRenderer_VisitChunk(index + strideY, FACE_YMIN);
+		}
+		if ((exits & (1 << FACE_ZMIN)) && cz > 0) {
+			MapRenderer_VisitChunk(index - strideZ, FACE_ZMAX);
+		}
+		if ((exits & (1 << FACE_ZMAX)) && cz < MapRenderer_ChunksZ - 1) {
+			MapRenderer_VisitChunk(index + strideZ, FACE_ZMIN);
+		}
+	}
+}
+
+
 /*########################################################################################################################*
 *--------------------------------------------------Chunks updating/sorting------------------------------------------------*
 *#########################################################################################################################*/
-#define CHUNK_TARGET_TIME ((1.0/30) + 0.01)
-static int chunksTarget = 12;
 static Vector3 lastCamPos;
 static float lastHeadY, lastHeadX;
 /* Max distance from camera that chunks are rendered within */
@@ -453,15 +890,172 @@ static void MapRenderer_CalcViewDists(void) {
 	renderDistSquared = MapRenderer_AdjustDist(Game_ViewDistance);
 }
 
+/* Stopwatch measurement of when chunk updating started this frame */
+static uint64_t updateStart;
+/* Whether the time budget for chunk updates has been used up this frame */
+static bool updateBudgetUsed;
+
+/* Whether more chunks can be built this frame, without exceeding the per frame budget */
+static bool MapRenderer_CanUpdate(int chunkUpdates) {
+	if (updateBudgetUsed || chunkUpdates >= MapRenderer_MaxUpdates) return false;
+
+	updateBudgetUsed = Stopwatch_ElapsedMicroseconds(updateStart, Stopwatch_Measure()) >= MapRenderer_UpdateBudget;
+	return !updateBudgetUsed;
+}
+
+static uint32_t MapRenderer_DistToCamera(struct ChunkInfo* info) {
+	int dx, dy, dz;
+	/* Sort order is invalid, so distance will be recalculated in MapRenderer_UpdateSortOrder anyways */
+	if (chunkPos.X == Int32_MaxValue) return 0;
+
+	dx = info->CentreX - chunkPos.X; dy = info->CentreY - chunkPos.Y; dz = info->CentreZ - chunkPos.Z;
+	return dx * dx + dy * dy + dz * dz;
+}
+
+static void MapRenderer_SiftDirtyDown(int i) {
+	int child, index;
+	uint32_t dist;
+
+	for (;;) {
+		child = i * 2 + 1;
+		if (child >= dirtyCount) return;
+		if (child + 1 < dirtyCount && dirtyDists[child + 1] < dirtyDists[child]) child++;
+		if (dirtyDists[i] <= dirtyDists[child]) return;
+
+		index = dirtyChunks[i]; dirtyChunks[i] = dirtyChunks[child]; dirtyChunks[child] = index;
+		dist  = dirtyDists[i];  dirtyDists[i]  = dirtyDists[child];  dirtyDists[child]  = dist;
+		i = child;
+	}
+}
+
+/* Adds the given chunk to the queue of chunks waiting to be rebuilt. */
+static void MapRenderer_PushDirty(struct ChunkInfo* info) {
+	int i, parent;
+	uint32_t dist;
+	if (info->Dirty) return;
+
+	info->Dirty = true;
+	dist = MapRenderer_DistToCamera(info);
+	/* Sift up towards the root, until parent is closer to the camera */
+	for (i = dirtyCount++; i > 0; i = parent) {
+		parent = (i - 1) / 2;
+		if (dirtyDists[parent] <= dist) break;
+
+		dirtyChunks[i] = dirtyChunks[parent];
+		dirtyDists[i]  = dirtyDists[parent];
+	}
+	dirtyChunks[i] = (int)(info - mapChunks);
+	dirtyDists[i]  = dist;
+}
+
+static void MapRenderer_PopDirty(void) {
+	mapChunks[dirtyChunks[0]].Dirty = false;
+	dirtyCount--;
+	if (!dirtyCount) return;
+
+	dirtyChunks[0] = dirtyChunks[dirtyCount];
+	dirtyDists[0]  = dirtyDists[dirtyCount];
+	MapRenderer_SiftDirtyDown(0);
+}
+
+/* Recalculates distances of queued chunks after the camera moves to another chunk */
+static void MapRenderer_SortDirtyChunks(void) {
+	int i;
+	for (i = 0; i < dirtyCount; i++) {
+		dirtyDists[i] = MapRenderer_DistToCamera(&mapChunks[dirtyChunks[i]]);
+	}
+	for (i = dirtyCount / 2 - 1; i >= 0; i--) {
+		MapRenderer_SiftDirtyDown(i);
+	}
+}
+
+/* Rebuilds queued chunks, nearest to the camera first, until the per frame budget is used up */
+static void MapRenderer_BuildDirtyChunks(int* chunkUpdates) {
+	struct ChunkInfo* info;
+
+	while (dirtyCount && MapRenderer_CanUpdate(*chunkUpdates)) {
+		/* Remaining chunks are all too far away to be built */
+		if (dirtyDists[0] > buildDistSquared) return;
+		info = &mapChunks[dirtyChunks[0]];
+
+		/* Chunk is queued again once its current build is finished (see MapRenderer_HookBuiltChunks) */
+		if (info->Building || !info->PendingDelete) { MapRenderer_PopDirty(); continue; }
+
+		MapRenderer_BuildChunk(info, chunkUpdates);
+		/* Background workers have too many chunks queued already */
+		if (info->PendingDelete) return;
+		MapRenderer_PopDirty();
+	}
+}
+
+/* Whether chunks too far away to be built or rendered may still have meshes that need to be unloaded */
+static bool unloadPending;
+
+/* Returns number of chunks at the start of sortedChunks that are close enough to be built or rendered */
+static int MapRenderer_NearChunksCount(void) {
+	uint32_t maxDist = max(renderDistSquared + 1, buildDistSquared + 32 * 16);
+	int lo = 0, hi = MapRenderer_ChunksCount, mid;
+
+	/* Chunks are sorted by distance, so binary search for the first chunk that is too far away */
+	while (lo < hi) {
+		mid = (lo + hi) >> 1;
+		if (distances[mid] < maxDist) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+
+/* Unloads meshes of chunks that are too far away, starting from the given index in sortedChunks */
+static void MapRenderer_UnloadFarChunks(int i) {
+	struct ChunkInfo* info;
+	for (; i < MapRenderer_ChunksCount; i++) {
+		info = sortedChunks[i];
+		info->Visible = false;
+		if (info->NormalParts || info->TranslucentParts) MapRenderer_DeleteChunk(info);
+	}
+	unloadPending = false;
+}
+
+/* Only groups within render distance of the camera are tested, since other groups are never looked up */
+static void MapRenderer_CalcGroupsFrustum(void) {
+	float x1, z1, x2, z2, y2;
+	int gx, gz, gx1, gz1, gx2, gz2, dist;
+
+	dist = Math_Ceil(Math_SqrtF((float)renderDistSquared));
+	gx1  = max(0, chunkPos.X - dist) / CHUNK_GROUP_SIZE; gx2 = min(groupsX - 1, max(0, chunkPos.X + dist) / CHUNK_GROUP_SIZE);
+	gz1  = max(0, chunkPos.Z - dist) / CHUNK_GROUP_SIZE; gz2 = min(groupsZ - 1, max(0, chunkPos.Z + dist) / CHUNK_GROUP_SIZE);
+
+	y2 = (float)(MapRenderer_ChunksY * CHUNK_SIZE);
+	for (gz = gz1; gz <= gz2; gz++) {
+		for (gx = gx1; gx <= gx2; gx++) {
+			x1 = (float)(gx * CHUNK_GROUP_SIZE); x2 = (float)min(x1 + CHUNK_GROUP_SIZE, MapRenderer_ChunksX * CHUNK_SIZE);
+			z1 = (float)(gz * CHUNK_GROUP_SIZE); z2 = (float)min(z1 + CHUNK_GROUP_SIZE, MapRenderer_ChunksZ * CHUNK_SIZE);
+
+			groupsFrustum[gz * groupsX + gx] = FrustumCulling_BoxInFrustum(x1, 0, z1, x2, y2, z2);
+		}
+	}
+}
+
+static bool MapRenderer_ChunkInFrustum(struct ChunkInfo* info) {
+	int group = (info->CentreZ / CHUNK_GROUP_SIZE) * groupsX + (info->CentreX / CHUNK_GROUP_SIZE);
+
+	switch (groupsFrustum[group]) {
+	case FRUSTUM_OUTSIDE: return false;
+	case FRUSTUM_INSIDE:  return true;
+	}
+	return FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+}
+
 static int MapRenderer_UpdateChunksAndVisibility(int* chunkUpdates) {
 	int renderDistSqr = renderDistSquared;
 	int buildDistSqr  = buildDistSquared;
 
 	struct ChunkInfo* info;
 	int i, j = 0, distSqr;
+	int count = MapRenderer_NearChunksCount();
 	bool noData;
+	MapRenderer_CalcGroupsFrustum();
 
-	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+	for (i = 0; i < count; i++) {
 		info = sortedChunks[i];
 		if (info->Empty) continue;
 
@@ -474,15 +1068,15 @@ static int MapRenderer_UpdateChunksAndVisibility(int* chunkUpdates) {
 		}
 		noData |= info->PendingDelete;
 
-		if (noData && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			MapRenderer_DeleteChunk(info);
+		if (noData && distSqr <= buildDistSqr && !info->Dirty && !info->Building && MapRenderer_CanUpdate(*chunkUpdates)) {
 			MapRenderer_BuildChunk(info, chunkUpdates);
 		}
 
-		info->Visible = distSqr <= renderDistSqr &&
-			FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+		info->Visible = !info->Occluded && distSqr <= renderDistSqr && MapRenderer_ChunkInFrustum(info);
 		if (info->Visible && !info->Empty) { renderChunks[j] = info; j++; }
 	}
+
+	if (unloadPending) MapRenderer_UnloadFarChunks(count);
 	return j;
 }
 
@@ -492,9 +1086,10 @@ static int MapRenderer_UpdateChunksStill(int* chunkUpdates) {
 
 	struct ChunkInfo* info;
 	int i, j = 0, distSqr;
+	int count = MapRenderer_NearChunksCount();
 	bool noData;
 
-	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+	for (i = 0; i < count; i++) {
 		info = sortedChunks[i];
 		if (info->Empty) continue;
 
@@ -507,34 +1102,56 @@ static int MapRenderer_UpdateChunksStill(int* chunkUpdates) {
 		}
 		noData |= info->PendingDelete;
 
-		if (noData && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			MapRenderer_DeleteChunk(info);
+		if (noData && distSqr <= buildDistSqr && !info->Dirty && !info->Building && MapRenderer_CanUpdate(*chunkUpdates)) {
 			MapRenderer_BuildChunk(info, chunkUpdates);
 
 			/* only need to update the visibility of chunks in range. */
-			info->Visible = distSqr <= renderDistSqr &&
-				FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+			info->Visible = !info->Occluded && distSqr <= renderDistSqr && MapRenderer_ChunkInFrustum(info);
 			if (info->Visible && !info->Empty) { renderChunks[j] = info; j++; }
 		} else if (info->Visible) {
 			renderChunks[j] = info; j++;
 		}
 	}
+
+	if (unloadPending) MapRenderer_UnloadFarChunks(count);
 	return j;
 }
 
+static void MapRenderer_OnChunkBuilt(struct ChunkInfo* info);
+static int MapRenderer_HookBuiltChunks(void) {
+	struct ChunkInfo* info;
+	int count = 0;
+
+	/* Creating vertex buffers for meshes also counts towards the per frame budget */
+	while (MapRenderer_CanUpdate(0) && (info = Builder_HookNextChunk())) {
+		MapRenderer_OnChunkBuilt(info);
+		count++;
+		/* Chunk was changed again while its mesh was being built */
+		if (info->PendingDelete) MapRenderer_PushDirty(info);
+	}
+	return count;
+}
+
 static void MapRenderer_UpdateChunks(double delta) {
 	struct LocalPlayer* p;
 	bool samePos;
-	int chunkUpdates = 0;
-
-	/* Build more chunks if 30 FPS or over, otherwise slowdown */
-	chunksTarget += delta < CHUNK_TARGET_TIME ? 1 : -1; 
-	Math_Clamp(chunksTarget, 4, MapRenderer_MaxUpdates);
+	int chunkUpdates = 0, chunksHooked;
+	updateStart  = Stopwatch_Measure();
+	updateBudgetUsed = false;
+	chunksHooked = MapRenderer_HookBuiltChunks();
 
 	p = &LocalPlayer_Instance;
 	samePos = Vector3_Equals(&Camera.CurrentPos, &lastCamPos)
 		&& p->Base.HeadX == lastHeadX && p->Base.HeadY == lastHeadY;
 
+	/* Visibility of every chunk needs to be recalculated when occlusion changes */
+	if (occlusionDirty) {
+		MapRenderer_CalcOcclusion();
+		samePos = false;
+	}
+	/* Changed chunks are rebuilt before building chunks that have never been built */
+	MapRenderer_BuildDirtyChunks(&chunkUpdates);
+
 	renderChunksCount = samePos ?
 		MapRenderer_UpdateChunksStill(&chunkUpdates) :
 		MapRenderer_UpdateChunksAndVisibility(&chunkUpdates);
@@ -543,7 +1160,7 @@ static void MapRenderer_UpdateChunks(double delta) {
 	lastHeadX  = p->Base.HeadX; 
 	lastHeadY  = p->Base.HeadY;
 
-	if (!samePos || chunkUpdates) {
+	if (!samePos || chunkUpdates || chunksHooked) {
 		MapRenderer_ResetPartFlags();
 	}
 }
@@ -605,12 +1222,16 @@ static void MapRenderer_UpdateSortOrder(void) {
 	}
 
 	MapRenderer_QuickSort(0, MapRenderer_ChunksCount - 1);
+	MapRenderer_SortDirtyChunks();
 	MapRenderer_ResetPartFlags();
-	/*SimpleOcclusionCulling();*/
+	/* Chunks that were close enough before may now be too far away */
+	unloadPending = true;
+	occlusionDirty = true;
 }
 
 void MapRenderer_Update(double deltaTime) {
 	if (!mapChunks) return;
+	MapRenderer_ReleaseVertices();
 	MapRenderer_UpdateSortOrder();
 	MapRenderer_UpdateChunks(deltaTime);
 }
@@ -628,6 +1249,7 @@ void MapRenderer_RefreshChunk(int cx, int cy, int cz) {
 	if (info->AllAir) return; /* do not recreate chunks completely air */
 	info->Empty         = false;
 	info->PendingDelete = true;
+	MapRenderer_PushDirty(info);
 }
 
 void MapRenderer_DeleteChunk(struct ChunkInfo* info) {
@@ -635,13 +1257,7 @@ void MapRenderer_DeleteChunk(struct ChunkInfo* info) {
 	int i;
 
 	info->Empty = false; info->AllAir = false;
-#ifdef OCCLUSION
-	info.OcclusionFlags = 0;
-	info.OccludedFlags = 0;
-#endif
-#ifndef CC_BUILD_GL11
-	Gfx_DeleteVb(&info->Vb);
-#endif
+	MapRenderer_FreeVertices(info);
 
 	if (info->NormalParts) {
 		ptr = info->NormalParts;
@@ -668,18 +1284,18 @@ void MapRenderer_DeleteChunk(struct ChunkInfo* info) {
 	}
 }
 
-void MapRenderer_BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
+static void MapRenderer_OnChunkBuilt(struct ChunkInfo* info) {
 	struct ChunkPartInfo* ptr;
 	int i;
 
 	Game.ChunkUpdates++;
-	(*chunkUpdates)++;
-	info->PendingDelete = false;
-	Builder_MakeChunk(info);
-
+	/* Occlusion only depends on which faces of chunks are connected */
+	if (info->Reconnected) occlusionDirty = true;
 	if (!info->NormalParts && !info->TranslucentParts) {
 		info->Empty = true; return;
 	}
+	/* Camera may have moved too far away while the chunk was being built */
+	if (MapRenderer_DistToCamera(info) >= buildDistSquared + 32 * 16) unloadPending = true;
 	
 	if (info->NormalParts) {
 		ptr = info->NormalParts;
@@ -696,9 +1312,45 @@ void MapRenderer_BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
 	}
 }
 
+void MapRenderer_BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
+	if (Builder_WorkersCount) {
+		/* Previous mesh is kept for drawing until the new mesh is ready */
+		if (!Builder_QueueChunk(info)) return;
+		info->Building = true;
+	} else {
+		MapRenderer_DeleteChunk(info);
+		Builder_MakeChunk(info);
+		MapRenderer_OnChunkBuilt(info);
+	}
+
+	(*chunkUpdates)++;
+	info->PendingDelete = false;
+}
+
+#ifndef CC_BUILD_SHADEDCHUNKS
+/* Queues every chunk that has a mesh to be rebuilt, drawing its current mesh until then */
+/* NOTE: Direct3D9 and fixed function OpenGL bake sun/shadow colours into meshes, so must rebuild them */
+static void MapRenderer_RebuildChunks(void) {
+	struct ChunkInfo* info;
+	int i;
+	if (!mapChunks) return;
+
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		info = &mapChunks[i];
+		if (!info->NormalParts && !info->TranslucentParts && !info->Building) continue;
+
+		info->PendingDelete = true;
+		MapRenderer_PushDirty(info);
+	}
+}
+#endif
+
 static void MapRenderer_EnvVariableChanged(void* obj, int envVar) {
 	if (envVar == ENV_VAR_SUN_COL || envVar == ENV_VAR_SHADOW_COL) {
-		MapRenderer_Refresh();
+		/* With CC_BUILD_SHADEDCHUNKS, sun and shadow colours are applied when drawing instead */
+#ifndef CC_BUILD_SHADEDCHUNKS
+		MapRenderer_RebuildChunks();
+#endif
 	} else if (envVar == ENV_VAR_EDGE_HEIGHT || envVar == ENV_VAR_SIDES_OFFSET) {
 		int oldClip        = Builder_EdgeLevel;
 		Builder_SidesLevel = max(0, Env_SidesHeight);
@@ -730,6 +1382,7 @@ static void MapRenderer_BlockDefinitionChanged(void* obj) {
 static void MapRenderer_RecalcVisibility(void* obj) {
 	lastCamPos = Vector3_BigPos();
 	MapRenderer_CalcViewDists();
+	unloadPending = true;
 }
 static void MapRenderer_DeleteChunks_(void* obj) { MapRenderer_DeleteChunks(); }
 static void MapRenderer_Refresh_(void* obj)      { MapRenderer_Refresh(); }
@@ -779,6 +1432,8 @@ static void MapRenderer_Init(void) {
 	MapRenderer_1DUsedCount = 87; /* Atlas1D_UsedAtlasesCount(); */
 	chunkPos   = Vector3I_MaxValue();
 	MapRenderer_MaxUpdates = Options_GetInt(OPT_MAX_CHUNK_UPDATES, 4, 1024, 30);
+	MapRenderer_UpdateBudget = Options_GetInt(OPT_CHUNK_UPDATE_BUDGET, 500, 1000000, 4000);
+	occlusionCulling       = Options_GetBool(OPT_OCCLUSION_CULLING, true);
 
 	Builder_Init();
 	Builder_ApplyActive();
@@ -796,6 +1451,7 @@ static void MapRenderer_Free(void) {
 	Event_UnregisterVoid(&GfxEvents.ContextRecreated,    NULL, MapRenderer_Refresh_);
 
 	MapRenderer_OnNewMap();
+	Builder_Free();
 }
 
 struct IGameComponent MapRenderer_Component = {
@@ -20,12 +20,42 @@ extern int MapRenderer_1DUsedCount;
 extern int MapRenderer_ChunksCount;
 /* Maximum number of chunk updates that can be performed in one frame. */
 extern int MapRenderer_MaxUpdates;
+/* Maximum time (in microseconds) spent building chunk meshes in one frame. */
+extern int MapRenderer_UpdateBudget;
 
 /* Buffer for all chunk parts. There are (MapRenderer_ChunksCount * Atlas1D_Count) parts in the buffer,
 with parts for 'normal' buffer being in lower half. */
 extern struct ChunkPartInfo* MapRenderer_PartsNormal; /* TODO: THAT DESC SUCKS */
 extern struct ChunkPartInfo* MapRenderer_PartsTranslucent;
 
+#ifdef CC_BUILD_COMPACTCHUNKS
+#define CHUNK_VERTEX_FORMAT VERTEX_FORMAT_P3ST2SC4B
+/* Chunk mesh vertex positions are relative to the chunk's minimum corner, in 1/CHUNK_POS_SCALE blocks. */
+#define CHUNK_POS_SCALE 1024.0f
+/* Chunk mesh vertex U texture coordinates are in 1/CHUNK_U_SCALE tiles. */
+#define CHUNK_U_SCALE 1024.0f
+/* Chunk mesh vertex V texture coordinates are in 1/CHUNK_V_SCALE atlases. */
+/* Leaves room for 16 tiles of greedy meshing past V = 1 (see Builder_GreedyMeshing) */
+#define CHUNK_V_SCALE ((float)((32767 / (Atlas1D.TilesPerAtlas + 16)) * Atlas1D.TilesPerAtlas))
+#else
+#define CHUNK_VERTEX_FORMAT VERTEX_FORMAT_P3FT2FC4B
+#endif
+
+#ifdef CC_BUILD_SHADEDCHUNKS
+/* Chunk mesh vertex colours store face shading and block tint in RGB, and how lit the vertex is in A. */
+/* Shaders multiply RGB by the sun/shadow colour (see Gfx_SetChunkLightCols), so changing */
+/* the sun or shadow colour does not require rebuilding chunk meshes. */
+#define CHUNK_LIGHT_SHADOW 0
+#define CHUNK_LIGHT_SUN 254
+/* Alpha of vertices of fully bright blocks, whose colour is unaffected by sun/shadow colour */
+#define CHUNK_LIGHT_FULLBRIGHT 255
+#endif
+
+/* Bit in ChunkInfo.Connectivity for whether faces a and b (where a < b) can see each other through the chunk. */
+#define Chunk_ConnectivityBit(a, b) (1 << ((a) * (11 - (a)) / 2 + ((b) - (a) - 1)))
+/* ChunkInfo.Connectivity with every pair of the chunk's faces connected */
+#define CHUNK_ALL_CONNECTED 0x7FFF
+
 /* Describes a portion of the data needed for rendering a chunk. */
 struct ChunkPartInfo {
 #ifdef CC_BUILD_GL11
@@ -44,6 +74,10 @@ struct ChunkInfo {
 	uint8_t Empty : 1;         /* Whether the chunk is empty of data */
 	uint8_t PendingDelete : 1; /* Whether chunk is pending deletion */
 	uint8_t AllAir : 1;        /* Whether chunk is completely air */
+	uint8_t Building : 1;      /* Whether a background worker is building the chunk's mesh */
+	uint8_t Occluded : 1;      /* Whether chunk is hidden from the camera by other chunks */
+	uint8_t Dirty : 1;         /* Whether chunk is in the queue of chunks waiting to be rebuilt */
+	uint8_t Reconnected : 1;   /* Whether the chunk's latest mesh changed its Connectivity */
 	uint8_t : 0;               /* pad to next byte*/
 
 	uint8_t DrawXMin : 1;
@@ -53,12 +87,13 @@ struct ChunkInfo {
 	uint8_t DrawYMin : 1;
 	uint8_t DrawYMax : 1;
 	uint8_t : 0;          /* pad to next byte */
-#ifdef OCCLUSION
-	public bool Visited = false, Occluded = false;
-	public byte OcclusionFlags, OccludedFlags, DistanceFlags;
-#endif
+	/* Which pairs of faces of the chunk are connected by non-opaque blocks. (see Chunk_ConnectivityBit) */
+	/* Unbuilt chunks are treated as having all pairs of faces connected. */
+	uint16_t Connectivity;
 #ifndef CC_BUILD_GL11
-	GfxResourceID Vb;
+	uint16_t Arena;  /* Index of the vertex arena the chunk's vertices are in */
+	int VbOffset;    /* Offset of the chunk's vertices within the vertex arena */
+	int VbCount;     /* Number of vertices allocated in the vertex arena, 0 if none */
 #endif
 	struct ChunkPartInfo* NormalParts;
 	struct ChunkPartInfo* TranslucentParts;
@@ -80,6 +115,23 @@ void MapRenderer_Update(double deltaTime);
 /* Marks the given chunk as needing to be rebuilt/redrawn. */
 /* NOTE: Coordinates outside the map are simply ignored. */
 void MapRenderer_RefreshChunk(int cx, int cy, int cz);
+#ifndef CC_BUILD_GL11
+/* Chunk meshes are sub-allocated from a few large vertex buffers (vertex arenas), */
+/* instead of every chunk mesh having its own vertex buffer. */
+struct ChunkArenaStats {
+	int Arenas;          /* Number of vertex arenas */
+	int Allocs;          /* Number of chunk meshes allocated in the vertex arenas */
+	int UsedVertices;    /* Number of vertices allocated to chunk meshes */
+	int PendingVertices; /* Number of vertices of deleted chunk meshes, not yet free for allocation */
+	int FreeVertices;    /* Number of vertices free for allocation */
+	int FreeRanges;      /* Number of free ranges of vertices, higher means more fragmented */
+	int LargestFree;     /* Largest free range of vertices */
+};
+/* Allocates space in a vertex arena for the given chunk's vertices, then uploads the vertices. */
+void MapRenderer_AllocVertices(struct ChunkInfo* info, void* vertices, int count);
+/* Gets statistics about the vertex arenas chunk meshes are allocated from. */
+void MapRenderer_GetArenaStats(struct ChunkArenaStats* stats);
+#endif
 /* Deletes the vertex buffer associated with the given chunk. */
 /* NOTE: This method also adjusts internal state, so do not bypass this. */
 void MapRenderer_DeleteChunk(struct ChunkInfo* info);
@@ -103,6 +103,7 @@ struct SaveLevelScreen {
 	struct ButtonWidget Buttons[3];
 	struct MenuInputWidget Input;
 	struct TextWidget MCEdit, Desc;
+	bool Saving; int Percent;
 };
 
 #define MENUOPTIONS_MAX_DESC 5
@@ -1224,48 +1225,44 @@ static void SaveLevelScreen_MakeDesc(struct SaveLevelScreen* s, const String* te
 }
 
 static void SaveLevelScreen_SaveMap(struct SaveLevelScreen* s, const String* path) {
-	const static String cw = String_FromConst(".cw");
-	struct Stream stream, compStream;
-	struct GZipState state;
-	ReturnCode res;
-
-	res = Stream_CreateFile(&stream, path);
-	if (res) { Logger_Warn2(res, "creating", path); return; }
-	GZip_MakeStream(&compStream, &state, &stream);
-
-	if (String_CaselessEnds(path, &cw)) {
-		res = Cw_Save(&compStream);
-	} else {
-		res = Schematic_Save(&compStream);
-	}
+	Map_SaveTo(path);
+	s->Saving  = Map_Saving;
+	s->Percent = -1;
+}
 
-	if (res) {
-		stream.Close(&stream);
-		Logger_Warn2(res, "encoding", path); return;
-	}
+/* Map is saved in the background, so show progress until it is done */
+static void SaveLevelScreen_UpdateProgress(struct SaveLevelScreen* s) {
+	String desc; char descBuffer[STRING_SIZE];
+	int percent;
 
-	if ((res = compStream.Close(&compStream))) {
-		stream.Close(&stream);
-		Logger_Warn2(res, "closing", path); return;
+	if (!Map_Saving) {
+		s->Saving = false;
+		Gui_FreeActive();
+		Gui_SetActive(PauseScreen_MakeInstance()); return;
 	}
 
-	res = stream.Close(&stream);
-	if (res) { Logger_Warn2(res, "closing", path); return; }
+	percent = (int)(Map_SaveProgress * 100);
+	if (percent == s->Percent) return;
+	s->Percent = percent;
 
-	Chat_Add1("&eSaved map to: %s", path);
-	Gui_FreeActive();
-	Gui_SetActive(PauseScreen_MakeInstance());
+	String_InitArray(desc, descBuffer);
+	String_Format1(&desc, "&eSaving map.. %i%%", &percent);
+	SaveLevelScreen_MakeDesc(s, &desc);
 }
 
 static void SaveLevelScreen_Save(void* screen, void* widget, const char* ext) {
 	const static String overMsg = String_FromConst("&cOverwrite existing?");
 	const static String fileMsg = String_FromConst("&ePlease enter a filename");
+	const static String busyMsg = String_FromConst("&eAlready saving a map");
 	String path; char pathBuffer[FILENAME_SIZE];
 
 	struct SaveLevelScreen* s = (struct SaveLevelScreen*)screen;
 	struct ButtonWidget* btn  = (struct ButtonWidget*)widget;
 	String file = s->Input.Base.Text;
 
+	if (Map_Saving) {
+		SaveLevelScreen_MakeDesc(s, &busyMsg); return;
+	}
 	if (!file.length) {
 		SaveLevelScreen_MakeDesc(s, &fileMsg); return;
 	}
@@ -1284,12 +1281,14 @@ static void SaveLevelScreen_Classic(void* a, void* b)   { SaveLevelScreen_Save(a
 static void SaveLevelScreen_Schematic(void* a, void* b) { SaveLevelScreen_Save(a, b, ".schematic"); }
 
 static void SaveLevelScreen_Render(void* screen, double delta) {
+	struct SaveLevelScreen* s = (struct SaveLevelScreen*)screen;
 	PackedCol grey = PACKEDCOL_CONST(150, 150, 150, 255);
 	int x, y;
 	MenuScreen_Render(screen, delta);
 
 	x = Game.Width / 2; y = Game.Height / 2;
 	Gfx_Draw2DFlat(x - 250, y + 90, 500, 2, grey);
+	if (s->Saving) SaveLevelScreen_UpdateProgress(s);
 }
 
 static bool SaveLevelScreen_KeyPress(void* screen, char keyChar) {
@@ -1341,6 +1340,7 @@ struct Screen* SaveLevelScreen_MakeInstance(void) {
 	static struct Widget* widgets[6];
 	struct SaveLevelScreen* s = &SaveLevelScreen_Instance;
 	
+	s->Saving          = false;
 	s->HandlesAllInput = true;
 	s->Closable        = true;
 	s->Widgets         = widgets;
@@ -2366,6 +2366,8 @@ static void GraphicsOptionsScreen_SetViewDist(const String* v) { Game_UserSetVie
 static void GraphicsOptionsScreen_GetSmooth(String* v) { Menu_GetBool(v, Builder_SmoothLighting); }
 static void GraphicsOptionsScreen_SetSmooth(const String* v) {
 	Builder_SmoothLighting = Menu_SetBool(v, OPT_SMOOTH_LIGHTING);
+	/* Workers must not be building any chunks while the mesh builder functions are swapped */
+	Builder_CancelChunks();
 	Builder_ApplyActive();
 	MapRenderer_Refresh();
 }
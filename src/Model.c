@@ -1601,12 +1601,12 @@ static void BlockModel_DrawParts(bool sprite) {
 		Drawer.X1 = min.X - 0.5f; Drawer.Y1 = min.Y; Drawer.Z1 = min.Z - 0.5f;
 		Drawer.X2 = max.X - 0.5f; Drawer.Y2 = max.Y; Drawer.Z2 = max.Z - 0.5f;		
 
-		loc = BlockModel_GetTex(FACE_YMIN, &ptr); Drawer_YMin(1, Models.Cols[1], loc, &ptr);
-		loc = BlockModel_GetTex(FACE_ZMIN, &ptr); Drawer_ZMin(1, Models.Cols[3], loc, &ptr);
-		loc = BlockModel_GetTex(FACE_XMAX, &ptr); Drawer_XMax(1, Models.Cols[5], loc, &ptr);
-		loc = BlockModel_GetTex(FACE_ZMAX, &ptr); Drawer_ZMax(1, Models.Cols[2], loc, &ptr);
-		loc = BlockModel_GetTex(FACE_XMIN, &ptr); Drawer_XMin(1, Models.Cols[4], loc, &ptr);
-		loc = BlockModel_GetTex(FACE_YMAX, &ptr); Drawer_YMax(1, Models.Cols[0], loc, &ptr);
+		loc = BlockModel_GetTex(FACE_YMIN, &ptr); Drawer_YMin(&Drawer, 1, Models.Cols[1], loc, &ptr);
+		loc = BlockModel_GetTex(FACE_ZMIN, &ptr); Drawer_ZMin(&Drawer, 1, Models.Cols[3], loc, &ptr);
+		loc = BlockModel_GetTex(FACE_XMAX, &ptr); Drawer_XMax(&Drawer, 1, Models.Cols[5], loc, &ptr);
+		loc = BlockModel_GetTex(FACE_ZMAX, &ptr); Drawer_ZMax(&Drawer, 1, Models.Cols[2], loc, &ptr);
+		loc = BlockModel_GetTex(FACE_XMIN, &ptr); Drawer_XMin(&Drawer, 1, Models.Cols[4], loc, &ptr);
+		loc = BlockModel_GetTex(FACE_YMAX, &ptr); Drawer_YMax(&Drawer, 1, Models.Cols[0], loc, &ptr);
 	}
 }
 
@@ -64,6 +64,13 @@
 #define OPT_CLASSIC_HACKS "nostalgia-hacks"
 #define OPT_CLASSIC_ARM_MODEL "nostalgia-classicarm"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_CHUNK_UPDATE_BUDGET "gfx-chunkupdatebudget"
+#define OPT_BUILDER_THREADS "gfx-builderthreads"
+#define OPT_GREEDY_MESHING "gfx-greedymeshing"
+#define OPT_OCCLUSION_CULLING "gfx-occlusionculling"
+#define OPT_FANCY_LIGHTING "gfx-fancylighting"
+#define OPT_HTTP_CONCURRENCY "http-concurrency"
+#define OPT_SKIN_DISK_CACHE "skin-diskcache"
 
 extern struct EntryList Options;
 /* Returns the number of options changed via Options_SetXYZ since last save. */
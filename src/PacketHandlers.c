@@ -36,10 +36,22 @@ static TimeMS map_receiveStart;
 static struct InflateState map_inflateState;
 static struct Stream map_stream, map_part;
 static struct GZipHeader map_gzHeader;
-static int map_sizeIndex, map_index, map_volume;
+static int map_sizeIndex, map_volume;
+static volatile int map_index;
 static uint8_t map_size[4];
 static BlockRaw* map_blocks;
 
+/* Received map data is decompressed on a worker thread, so that it overlaps with receiving the rest of the map */
+struct MapChunk { uint16_t Length; uint8_t Value; uint8_t Data[1024]; };
+#define MAP_DEF_CHUNKS 32
+static struct MapChunk map_defQueue[MAP_DEF_CHUNKS];
+static struct MapChunk* map_queue = map_defQueue;
+static uint32_t map_queueHead, map_queueCount, map_queueMax = MAP_DEF_CHUNKS;
+static void* map_mutex;
+static void* map_waitable;
+static void* map_thread;
+static volatile bool map_queueDone, map_abort;
+
 #ifdef EXTENDED_BLOCKS
 static struct InflateState map2_inflateState;
 static struct Stream map2_stream;
@@ -385,6 +397,107 @@ static void Classic_Handshake(uint8_t* data) {
 
 static void Classic_Ping(uint8_t* data) { }
 
+static void Classic_DecompressChunk(struct MapChunk* chunk) {
+	uint32_t left, read;
+	ReturnCode res;
+	Stream_ReadonlyMemory(&map_part, chunk->Data, chunk->Length);
+
+	if (!map_gzHeader.Done) {
+		res = GZipHeader_Read(&map_part, &map_gzHeader);
+		if (res && res != ERR_END_OF_STREAM) Logger_Abort2(res, "reading map data");
+	}
+	if (!map_gzHeader.Done) return;
+
+	if (map_sizeIndex < 4) {
+		left = 4 - map_sizeIndex;
+		map_stream.Read(&map_stream, &map_size[map_sizeIndex], left, &read); 
+		map_sizeIndex += read;
+	}
+	if (map_sizeIndex < 4) return;
+
+	if (!map_blocks) {
+		map_volume = Stream_GetU32_BE(map_size);
+		map_blocks = Mem_Alloc(map_volume, 1, "map blocks");
+	}
+
+#ifndef EXTENDED_BLOCKS
+	left = map_volume - map_index;
+	map_stream.Read(&map_stream, &map_blocks[map_index], left, &read);
+	map_index += read;
+#else
+	if (cpe_extBlocks && chunk->Value) {
+		/* Only allocate map2 when needed */
+		if (!map2_blocks) map2_blocks = Mem_Alloc(map_volume, 1, "map blocks upper");
+
+		left = map_volume - map2_index;
+		map2_stream.Read(&map2_stream, &map2_blocks[map2_index], left, &read); 
+		map2_index += read;
+	} else {
+		left = map_volume - map_index;
+		map_stream.Read(&map_stream, &map_blocks[map_index], left, &read); 
+		map_index += read;
+	}
+#endif
+}
+
+#ifndef CC_BUILD_WEB
+static void Classic_DecompressLoop(void) {
+	struct MapChunk chunk;
+	bool hasChunk, done;
+
+	for (;;) {
+		Mutex_Lock(map_mutex);
+		{
+			hasChunk = map_queueHead < map_queueCount;
+			if (hasChunk) chunk = map_queue[map_queueHead++];
+			/* Reuse start of queue once all chunks have been taken */
+			if (map_queueHead == map_queueCount) { map_queueHead = 0; map_queueCount = 0; }
+			done = map_queueDone;
+		}
+		Mutex_Unlock(map_mutex);
+
+		if (map_abort) return;
+		if (hasChunk) { Classic_DecompressChunk(&chunk); continue; }
+		if (done) return;
+		Waitable_WaitFor(map_waitable, 10);
+	}
+}
+#endif
+
+static void Classic_StartDecompressor(void) {
+	map_queueDone = false;
+	map_abort     = false;
+#ifndef CC_BUILD_WEB
+	if (!map_mutex) {
+		map_mutex    = Mutex_Create();
+		map_waitable = Waitable_Create();
+	}
+	map_thread = Thread_Start(Classic_DecompressLoop, false);
+#endif
+}
+
+/* Waits for the worker to decompress all the queued map data (or to just stop when aborting) */
+static void Classic_StopDecompressor(bool abort) {
+	if (!map_thread) return;
+	map_abort = abort;
+
+	Mutex_Lock(map_mutex);
+	{
+		map_queueDone = true;
+	}
+	Mutex_Unlock(map_mutex);
+
+	Waitable_Signal(map_waitable);
+	Thread_Join(map_thread);
+	map_thread = NULL;
+
+	if (map_queueMax > MAP_DEF_CHUNKS) Mem_Free(map_queue);
+	map_queue      = map_defQueue;
+	map_queueMax   = MAP_DEF_CHUNKS;
+	map_queueHead  = 0;
+	map_queueCount = 0;
+}
+
 static void Classic_StartLoading(void) {
 	World_Reset();
 	Event_RaiseVoid(&WorldEvents.NewMap);
@@ -413,6 +526,7 @@ static void Classic_StartLoading(void) {
 	Inflate_MakeStream(&map2_stream, &map2_inflateState, &map_part);
 	map2_index = 0;
 #endif
+	Classic_StartDecompressor();
 }
 
 static void Classic_LevelInit(uint8_t* data) {
@@ -427,63 +541,34 @@ static void Classic_LevelInit(uint8_t* data) {
 	}
 }
 
+static void Classic_ReadChunk(struct MapChunk* chunk, uint8_t* data) {
+	int usedLength = Stream_GetU16_BE(data); data += 2;
+	chunk->Length  = min(usedLength, 1024);
+	chunk->Value   = data[1024]; /* progress in original classic, but we ignore it */
+	Mem_Copy(chunk->Data, data, chunk->Length);
+}
+
 static void Classic_LevelDataChunk(uint8_t* data) {
-	int usedLength;
 	float progress;
-	uint32_t left, read;
-	uint8_t value;
-	ReturnCode res;
-
 	/* Workaround for some servers that send LevelDataChunk before LevelInit due to their async sending behaviour */
 	if (!map_begunLoading) Classic_StartLoading();
-	usedLength = Stream_GetU16_BE(data); data += 2;
-
-	map_part.Meta.Mem.Cur    = data;
-	map_part.Meta.Mem.Base   = data;
-	map_part.Meta.Mem.Left   = usedLength;
-	map_part.Meta.Mem.Length = usedLength;
 
-	data += 1024;
-	value = *data; /* progress in original classic, but we ignore it */
-
-	if (!map_gzHeader.Done) {
-		res = GZipHeader_Read(&map_part, &map_gzHeader);
-		if (res && res != ERR_END_OF_STREAM) Logger_Abort2(res, "reading map data");
-	}
-
-	if (map_gzHeader.Done) {
-		if (map_sizeIndex < 4) {
-			left = 4 - map_sizeIndex;
-			map_stream.Read(&map_stream, &map_size[map_sizeIndex], left, &read); 
-			map_sizeIndex += read;
-		}
-
-		if (map_sizeIndex == 4) {
-			if (!map_blocks) {
-				map_volume = Stream_GetU32_BE(map_size);
-				map_blocks = Mem_Alloc(map_volume, 1, "map blocks");
-			}
-
-#ifndef EXTENDED_BLOCKS
-			left = map_volume - map_index;
-			map_stream.Read(&map_stream, &map_blocks[map_index], left, &read);
-			map_index += read;
+#ifdef CC_BUILD_WEB
+	/* No threads, so have to decompress on the main thread instead */
+	Classic_ReadChunk(&map_defQueue[0], data);
+	Classic_DecompressChunk(&map_defQueue[0]);
 #else
-			if (cpe_extBlocks && value) {
-				/* Only allocate map2 when needed */
-				if (!map2_blocks) map2_blocks = Mem_Alloc(map_volume, 1, "map blocks upper");
-
-				left = map_volume - map2_index;
-				map2_stream.Read(&map2_stream, &map2_blocks[map2_index], left, &read); 
-				map2_index += read;
-			} else {
-				left = map_volume - map_index;
-				map_stream.Read(&map_stream, &map_blocks[map_index], left, &read); 
-				map_index += read;
-			}
-#endif
+	Mutex_Lock(map_mutex);
+	{
+		if (map_queueCount == map_queueMax) {
+			map_queue = (struct MapChunk*)Utils_Resize(map_queue, &map_queueMax,
+										sizeof(struct MapChunk), MAP_DEF_CHUNKS, 256);
 		}
+		Classic_ReadChunk(&map_queue[map_queueCount++], data);
 	}
+	Mutex_Unlock(map_mutex);
+	Waitable_Signal(map_waitable);
+#endif
 
 	progress = !map_blocks ? 0.0f : (float)map_index / map_volume;
 	Event_RaiseFloat(&WorldEvents.Loading, progress);
@@ -493,6 +578,8 @@ static void Classic_LevelFinalise(uint8_t* data) {
 	int width, height, length;
 	int loadingMs;
 
+	/* Remaining data may still be being decompressed */
+	Classic_StopDecompressor(false);
 	Gui_CloseActive();
 	Gui_Active = classic_prevScreen;
 	classic_prevScreen = NULL;
@@ -681,6 +768,7 @@ static void Classic_ReadAbsoluteLocation(uint8_t* data, EntityID id, bool interp
 }
 
 static void Classic_Reset(void) {
+	Classic_StopDecompressor(true);
 	map_begunLoading = false;
 	classic_receivedFirstPos = false;
 
@@ -1176,6 +1264,7 @@ static void CPE_BulkBlockUpdate(uint8_t* data) {
 		data += BULK_MAX_BLOCKS / 4;
 	}
 
+	Game_BeginBatch();
 	for (i = 0; i < count; i++) {
 		index = indices[i];
 		if (index < 0 || index >= World.Volume) continue;
@@ -1185,6 +1274,7 @@ static void CPE_BulkBlockUpdate(uint8_t* data) {
 			Game_UpdateBlock(x, y, z, blocks[i]);
 		}
 	}
+	Game_EndBatch();
 }
 
 static void CPE_SetTextColor(uint8_t* data) {
@@ -1366,9 +1456,9 @@ static void CPE_Tick(void) {
 *------------------------------------------------------Custom blocks------------------------------------------------------*
 *#########################################################################################################################*/
 static void BlockDefs_OnBlockUpdated(BlockID block, bool didBlockLight) {
-	if (!World.Blocks) return;
+	if (!World.Loaded) return;
 	/* Need to refresh lighting when a block's light blocking state changes */
-	if (Blocks.BlocksLight[block] != didBlockLight) { Lighting_Refresh(); }
+	if (Blocks.BlocksLight[block] != didBlockLight) { Lighting_ScheduleRefresh(); }
 }
 
 static TextureLoc BlockDefs_Tex(uint8_t** ptr) {
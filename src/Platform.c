@@ -427,6 +427,12 @@ ReturnCode File_SetModifiedTime(const String* path, TimeMS time) {
 	return res;
 }
 
+ReturnCode File_Delete(const String* path) {
+	TCHAR str[300];
+	Platform_ConvertString(str, path);
+	return DeleteFile(str) ? 0 : GetLastError();
+}
+
 static ReturnCode File_Do(FileHandle* file, const String* path, DWORD access, DWORD createMode) {
 	TCHAR str[300]; 
 	Platform_ConvertString(str, path);
@@ -561,6 +567,12 @@ ReturnCode File_SetModifiedTime(const String* path, TimeMS time) {
 	return utime(str, &times) == -1 ? errno : 0;
 }
 
+ReturnCode File_Delete(const String* path) {
+	char str[600];
+	Platform_ConvertString(str, path);
+	return unlink(str) == -1 ? errno : 0;
+}
+
 static ReturnCode File_Do(FileHandle* file, const String* path, int mode) {
 	char str[600]; 
 	Platform_ConvertString(str, path);
@@ -650,6 +662,7 @@ void Thread_Join(void* handle) {
 	WaitForSingleObject((HANDLE)handle, INFINITE);
 	Thread_Detach(handle);
 }
+void Thread_MemoryBarrier(void) { MemoryBarrier(); }
 
 void* Mutex_Create(void) {
 	CRITICAL_SECTION* ptr = Mem_Alloc(1, sizeof(CRITICAL_SECTION), "mutex");
@@ -692,6 +705,7 @@ void Thread_Sleep(uint32_t milliseconds) { usleep(milliseconds * 1000); }
 void* Thread_Start(Thread_StartFunc* func, bool detach) { (*func)(); return NULL; }
 void Thread_Detach(void* handle) { }
 void Thread_Join(void* handle) { }
+void Thread_MemoryBarrier(void) { }
 
 void* Mutex_Create(void) { return NULL; }
 void Mutex_Free(void* handle) { }
@@ -733,6 +747,7 @@ void Thread_Join(void* handle) {
 	if (res) Logger_Abort2(res, "Joining thread");
 	Mem_Free(ptr);
 }
+void Thread_MemoryBarrier(void) { __sync_synchronize(); }
 
 void* Mutex_Create(void) {
 	pthread_mutex_t* ptr = (pthread_mutex_t*)Mem_Alloc(1, sizeof(pthread_mutex_t), "mutex");
@@ -760,6 +775,7 @@ void Mutex_Unlock(void* handle) {
 struct WaitData {
 	pthread_cond_t  cond;
 	pthread_mutex_t mutex;
+	bool signalled; /* Whether Waitable_Signal was called with no thread waiting yet */
 };
 
 void* Waitable_Create(void) {
@@ -770,6 +786,7 @@ void* Waitable_Create(void) {
 	if (res) Logger_Abort2(res, "Creating waitable");
 	res = pthread_mutex_init(&ptr->mutex, NULL);
 	if (res) Logger_Abort2(res, "Creating waitable mutex");
+	ptr->signalled = false;
 	return ptr;
 }
 
@@ -786,7 +803,13 @@ void Waitable_Free(void* handle) {
 
 void Waitable_Signal(void* handle) {
 	struct WaitData* ptr = handle;
-	int res = pthread_cond_signal(&ptr->cond);
+	int res;
+
+	Mutex_Lock(&ptr->mutex);
+	ptr->signalled = true;
+	Mutex_Unlock(&ptr->mutex);
+
+	res = pthread_cond_signal(&ptr->cond);
 	if (res) Logger_Abort2(res, "Signalling event");
 }
 
@@ -795,8 +818,11 @@ void Waitable_Wait(void* handle) {
 	int res;
 
 	Mutex_Lock(&ptr->mutex);
-	res = pthread_cond_wait(&ptr->cond, &ptr->mutex);
-	if (res) Logger_Abort2(res, "Waitable wait");
+	while (!ptr->signalled) {
+		res = pthread_cond_wait(&ptr->cond, &ptr->mutex);
+		if (res) Logger_Abort2(res, "Waitable wait");
+	}
+	ptr->signalled = false;
 	Mutex_Unlock(&ptr->mutex);
 }
 
@@ -814,8 +840,11 @@ void Waitable_WaitFor(void* handle, uint32_t milliseconds) {
 	ts.tv_nsec %= NS_PER_SEC;
 
 	Mutex_Lock(&ptr->mutex);
-	res = pthread_cond_timedwait(&ptr->cond, &ptr->mutex, &ts);
-	if (res && res != ETIMEDOUT) Logger_Abort2(res, "Waitable wait for");
+	if (!ptr->signalled) {
+		res = pthread_cond_timedwait(&ptr->cond, &ptr->mutex, &ts);
+		if (res && res != ETIMEDOUT) Logger_Abort2(res, "Waitable wait for");
+	}
+	ptr->signalled = false;
 	Mutex_Unlock(&ptr->mutex);
 }
 #endif
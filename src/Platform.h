@@ -135,6 +135,8 @@ CC_API bool File_Exists(const String* path);
 CC_API ReturnCode File_GetModifiedTime(const String* path, TimeMS* ms);
 /* Sets the last time the file was modified, as number of milliseconds since 1/1/0001 */
 CC_API ReturnCode File_SetModifiedTime(const String* path, TimeMS ms);
+/* Attempts to delete the given file. */
+CC_API ReturnCode File_Delete(const String* path);
 
 /* Attempts to create a new (or overwrite) file for writing. */
 /* NOTE: If the file already exists, its contents are discarded. */
@@ -167,6 +169,9 @@ CC_API void Thread_Detach(void* handle);
 /* Blocks the current thread, until the given thread has finished. */
 /* NOTE: Once a thread has been detached, you can no longer use this method. */
 CC_API void Thread_Join(void* handle);
+/* Ensures memory writes made before this call are seen by other threads before writes made after it. */
+/* NOTE: Used to publish data to threads that read it without locking a mutex. */
+CC_API void Thread_MemoryBarrier(void);
 
 /* Allocates a new mutex. (used to synchronise access to a shared resource) */
 CC_API void* Mutex_Create(void);
@@ -181,7 +186,8 @@ CC_API void  Mutex_Unlock(void* handle);
 CC_API void* Waitable_Create(void);
 /* Frees an allocated waitable. */
 CC_API void  Waitable_Free(void* handle);
-/* Signals a waitable, waking up blocked threads. */
+/* Signals a waitable, waking up one blocked thread. */
+/* If no thread is blocked yet, the next wait on the waitable returns immediately instead. */
 CC_API void  Waitable_Signal(void* handle);
 /* Blocks the calling thread until the waitable gets signalled. */
 CC_API void  Waitable_Wait(void* handle);
@@ -19,6 +19,7 @@
 #include "Block.h"
 #include "Menus.h"
 #include "World.h"
+#include "Formats.h"
 
 struct InventoryScreen {
 	Screen_Layout
@@ -694,6 +695,34 @@ struct Screen* GeneratingScreen_MakeInstance(void) {
 }
 
 
+/*########################################################################################################################*
+*---------------------------------------------------MapLoadingScreen------------------------------------------------------*
+*#########################################################################################################################*/
+static void MapLoadingScreen_Render(void* screen, double delta) {
+	struct LoadingScreen* s = (struct LoadingScreen*)screen;
+	LoadingScreen_Render(s, delta);
+
+	/* The map itself is set as the world by Formats.c once importing finishes */
+	if (!Map_Loading) { Gui_CloseActive(); return; }
+	s->Progress = Map_LoadProgress;
+}
+
+static struct ScreenVTABLE MapLoadingScreen_VTABLE = {
+	LoadingScreen_Init,      MapLoadingScreen_Render, LoadingScreen_Free,      Gui_DefaultRecreate,
+	LoadingScreen_KeyDown,   LoadingScreen_KeyUp,     LoadingScreen_KeyPress,
+	LoadingScreen_MouseDown, LoadingScreen_MouseUp,   LoadingScreen_MouseMove, LoadingScreen_MouseScroll,
+	LoadingScreen_OnResize,  LoadingScreen_ContextLost, LoadingScreen_ContextRecreated,
+};
+struct Screen* MapLoadingScreen_MakeInstance(void) {
+	const static String title   = String_FromConst("Loading level");
+	const static String message = String_FromConst("Decompressing..");
+
+	struct Screen* s = LoadingScreen_MakeInstance(&title, &message);
+	s->VTABLE = &MapLoadingScreen_VTABLE;
+	return s;
+}
+
+
 /*########################################################################################################################*
 *--------------------------------------------------------ChatScreen-------------------------------------------------------*
 *#########################################################################################################################*/
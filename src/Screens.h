@@ -11,6 +11,7 @@ struct Screen* InventoryScreen_MakeInstance(void);
 struct Screen* StatusScreen_MakeInstance(void);
 struct Screen* LoadingScreen_MakeInstance(const String* title, const String* message);
 struct Screen* GeneratingScreen_MakeInstance(void);
+struct Screen* MapLoadingScreen_MakeInstance(void);
 struct Screen* HUDScreen_MakeInstance(void);
 struct Screen* DisconnectScreen_MakeInstance(const String* title, const String* message);
 
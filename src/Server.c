@@ -153,7 +153,6 @@ static void SPConnection_BeginConnect(void) {
 	path = Game_Username;
 	if (SP_HasDir(path) && File_Exists(&path)) {
 		Map_LoadFrom(&path);
-		Gui_CloseActive();
 		return;
 	}
 
@@ -247,9 +246,24 @@ uint16_t Net_PacketSizes[OPCODE_COUNT];
 Net_Handler Net_Handlers[OPCODE_COUNT];
 
 static SocketHandle net_socket;
-static uint8_t  net_readBuffer[4096 * 5];
-static uint8_t  net_writeBuffer[131];
-static uint8_t* net_readCurrent;
+static uint8_t net_writeBuffer[131];
+
+/* Received data is buffered in a ring, which is filled by the reader thread and drained on the main thread. */
+/* Read/Write are free running positions, i.e. they are only masked when indexing into the ring. */
+#define NET_RING_SIZE (1024 * 1024)
+#define NET_RING_MASK (NET_RING_SIZE - 1)
+/* Packets that wrap around the end of the ring have their start copied here, so handlers see contiguous data */
+#define NET_RING_EXTRA 2048
+static uint8_t net_ring[NET_RING_SIZE + NET_RING_EXTRA];
+static volatile uint32_t net_ringRead, net_ringWrite;
+
+static void* net_ringMutex;
+static void* net_readWaitable;
+static void* net_readThread;
+static volatile bool net_readStop;
+static volatile ReturnCode net_readRes;
+/* Max time spent handling packets each tick, to avoid stalling the frame on large bursts */
+#define NET_TICK_BUDGET_US 4000
 
 static bool net_writeFailed;
 static TimeMS net_lastPacket;
@@ -261,14 +275,76 @@ static TimeMS net_connectTimeout;
 #define NET_TIMEOUT_MS (15 * 1000)
 
 static void Server_Free(void);
+/* Reads as much data as fits in the contiguous free space after the write position of the ring */
+/* NOTE: full is set to true when there is no free space in the ring (nothing is read in that case) */
+static ReturnCode MPConnection_ReadRing(uint32_t* read, bool* full) {
+	uint32_t readPos, writePos, offset, count;
+	ReturnCode res;
+
+	Mutex_Lock(net_ringMutex);
+	{
+		readPos  = net_ringRead;
+		writePos = net_ringWrite;
+	}
+	Mutex_Unlock(net_ringMutex);
+
+	*read  = 0;
+	offset = writePos & NET_RING_MASK;
+	count  = NET_RING_SIZE - (writePos - readPos);
+	count  = min(count, NET_RING_SIZE - offset);
+
+	*full = count == 0;
+	if (*full) return 0;
+
+	res = Socket_Read(net_socket, &net_ring[offset], count, read);
+	if (res || !(*read)) return res;
+
+	Mutex_Lock(net_ringMutex);
+	{
+		net_ringWrite = writePos + *read;
+	}
+	Mutex_Unlock(net_ringMutex);
+	return 0;
+}
+
+#ifndef CC_BUILD_WEB
+static void MPConnection_ReadLoop(void) {
+	uint32_t read;
+	bool full;
+	ReturnCode res;
+
+	while (!net_readStop) {
+		res = MPConnection_ReadRing(&read, &full);
+		/* Socket is shutdown by Server_Free to stop this thread, so ignore errors from that */
+		if (net_readStop) break;
+		if (res) { net_readRes = res; break; }
+
+		if (full) {
+			/* Wait for main thread to handle some packets */
+			Waitable_WaitFor(net_readWaitable, 100);
+		} else if (!read) {
+			/* Server closed connection, MPConnection_CheckDisconnection will notice this */
+			break;
+		}
+	}
+}
+#endif
+
 static void MPConnection_FinishConnect(void) {
 	net_connecting = false;
 	Event_RaiseVoid(&NetEvents.Connected);
 	Event_RaiseFloat(&WorldEvents.Loading, 0.0f);
 
-	net_readCurrent    = net_readBuffer;
+	net_ringRead = 0; net_ringWrite = 0;
+	net_readStop = false; net_readRes = 0;
 	Server.WriteBuffer = net_writeBuffer;
 
+	net_ringMutex    = Mutex_Create();
+	net_readWaitable = Waitable_Create();
+#ifndef CC_BUILD_WEB
+	net_readThread   = Thread_Start(MPConnection_ReadLoop, false);
+#endif
+
 	Protocol_Reset();
 	Classic_SendLogin(&Game_Username, &Game_Mppass);
 	net_lastPacket = DateTime_CurrentUTC_MS();
@@ -393,11 +469,16 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 
 	struct LocalPlayer* p;
 	TimeMS now;
-	uint32_t pending;
-	uint8_t* readEnd;
+	uint64_t beg;
+	uint32_t readPos, writePos, offset, size;
+	uint8_t* data;
 	Net_Handler handler;
-	int i, remaining;
+	bool batching = false;
 	ReturnCode res;
+#ifdef CC_BUILD_WEB
+	uint32_t pending;
+	bool full;
+#endif
 
 	if (Server.Disconnected) return;
 	if (net_connecting) { MPConnection_TickConnect(); return; }
@@ -409,15 +490,14 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 	}
 	if (Server.Disconnected) return;
 
+#ifdef CC_BUILD_WEB
+	/* No threads, so have to read data on the main thread instead */
 	pending = 0;
 	res     = Socket_Available(net_socket, &pending);
-	readEnd = net_readCurrent;
-
-	if (!res && pending) {
-		/* NOTE: Always using a read call that is a multiple of 4096 (appears to?) improve read performance */	
-		res = Socket_Read(net_socket, net_readCurrent, 4096 * 4, &pending);
-		readEnd += pending;
-	}
+	if (!res && pending) res = MPConnection_ReadRing(&pending, &full);
+#else
+	res = net_readRes;
+#endif
 
 	if (res) {
 		String_InitArray(msg, msgBuffer);
@@ -428,14 +508,34 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		return;
 	}
 
-	net_readCurrent = net_readBuffer;
-	while (net_readCurrent < readEnd) {
-		uint8_t opcode = net_readCurrent[0];
+	Mutex_Lock(net_ringMutex);
+	{
+		writePos = net_ringWrite;
+	}
+	Mutex_Unlock(net_ringMutex);
+
+	readPos = net_ringRead;
+	beg     = Stopwatch_Measure();
+
+	while (readPos != writePos) {
+		uint8_t opcode;
+		offset = readPos & NET_RING_MASK;
+		data   = &net_ring[offset];
+		opcode = data[0];
+
+		/* Block changes received together are applied together, so lighting and chunks are only updated once */
+		if (opcode == OPCODE_SET_BLOCK || opcode == OPCODE_BULK_BLOCK_UPDATE) {
+			if (!batching) Game_BeginBatch();
+			batching = true;
+		} else if (batching) {
+			Game_EndBatch();
+			batching = false;
+		}
 
 		/* Workaround for older D3 servers which wrote one byte too many for HackControl packets */
 		if (cpe_needD3Fix && net_lastOpcode == OPCODE_HACK_CONTROL && (opcode == 0x00 || opcode == 0xFF)) {
 			Platform_LogConst("Skipping invalid HackControl byte from D3 server");
-			net_readCurrent++;
+			readPos++;
 
 			p = &LocalPlayer_Instance;
 			p->Physics.JumpVel = 0.42f; /* assume default jump height */
@@ -444,30 +544,40 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		}
 
 		if (opcode >= OPCODE_COUNT) {
-			Game_Disconnect(&title_disc, &msg_invalid); return; 
+			Game_Disconnect(&title_disc, &msg_invalid); break;
 		}
 
-		if (net_readCurrent + Net_PacketSizes[opcode] > readEnd) break;
+		/* Protocol packets might be split up across TCP packets */
+		/* If so, leave the partial packet in the ring until rest of it is received */
+		size = Net_PacketSizes[opcode];
+		if (size > writePos - readPos) break;
 		net_lastOpcode = opcode;
 		net_lastPacket = DateTime_CurrentUTC_MS();
 
 		handler = Net_Handlers[opcode];
 		if (!handler) {
-			Game_Disconnect(&title_disc, &msg_invalid); return;
+			Game_Disconnect(&title_disc, &msg_invalid); break;
 		}
 
-		handler(net_readCurrent + 1);  /* skip opcode */
-		net_readCurrent += Net_PacketSizes[opcode];
+		if (offset + size > NET_RING_SIZE) {
+			Mem_Copy(&net_ring[NET_RING_SIZE], net_ring, offset + size - NET_RING_SIZE);
+		}
+		handler(data + 1); /* skip opcode */
+		readPos += size;
+
+		/* Handler may have disconnected (e.g. kicked), in which case rest of the data is discarded */
+		if (Server.Disconnected) break;
+		if (Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure()) >= NET_TICK_BUDGET_US) break;
 	}
+	if (batching) Game_EndBatch();
+	if (Server.Disconnected) return;
 
-	/* Protocol packets might be split up across TCP packets */
-	/* If so, copy last few unprocessed bytes back to beginning of buffer */
-	/* These bytes are then later combined with subsequently read TCP packet data */
-	remaining = (int)(readEnd - net_readCurrent);
-	for (i = 0; i < remaining; i++) {
-		net_readBuffer[i] = net_readCurrent[i];
+	Mutex_Lock(net_ringMutex);
+	{
+		net_ringRead = readPos;
 	}
-	net_readCurrent = net_readBuffer + remaining;
+	Mutex_Unlock(net_ringMutex);
+	Waitable_Signal(net_readWaitable);
 
 	/* Network is ticked 60 times a second. We only send position updates 20 times a second */
 	if ((ticks % 3) == 0) {
@@ -510,9 +620,7 @@ static void MPConnection_Init(void) {
 	Server.SendChat     = MPConnection_SendChat;
 	Server.SendPosition = MPConnection_SendPosition;
 	Server.SendData     = MPConnection_SendData;
-
-	net_readCurrent    = net_readBuffer;
-	Server.WriteBuffer = net_writeBuffer;
+	Server.WriteBuffer  = net_writeBuffer;
 }
 
 
@@ -561,8 +669,21 @@ static void Server_Free(void) {
 		Physics_Free();
 	} else {
 		if (Server.Disconnected) return;
+		/* Closing socket also wakes up reader thread if it is blocked in Socket_Read */
+		net_readStop = true;
 		Socket_Close(net_socket);
 		Server.Disconnected = true;
+
+		if (net_readThread) {
+			Waitable_Signal(net_readWaitable);
+			Thread_Join(net_readThread);
+			net_readThread = NULL;
+		}
+		if (net_ringMutex) {
+			Mutex_Free(net_ringMutex);
+			Waitable_Free(net_readWaitable);
+			net_ringMutex = NULL;
+		}
 	}
 }
 
@@ -17,6 +17,7 @@
 #include "Chat.h"
 #include "Options.h"
 #include "Logger.h"
+#include "Builder.h"
 
 #ifndef CC_BUILD_WEB
 #define LIQUID_ANIM_MAX 64
@@ -360,7 +361,7 @@ static void Animations_PackChanged(void* obj) {
 static void Animations_FileChanged(void* obj, struct Stream* stream, const String* name) {
 	ReturnCode res;
 	if (String_CaselessEqualsConst(name, "animations.png")) {
-		res = Png_Decode(&anims_bmp, stream);
+		res = TexturePack_DecodeFile(&anims_bmp, stream);
 		if (!res) return;
 
 		Logger_Warn2(res, "decoding", name);
@@ -442,6 +443,11 @@ static void Atlas_Update1D(void) {
 	maxAtlasHeight   = min(4096, Gfx.MaxTexHeight);
 	maxTilesPerAtlas = maxAtlasHeight / Atlas2D.TileSize;
 	maxTiles         = Atlas2D.RowsCount * ATLAS2D_TILES_PER_ROW;
+#ifndef CC_BUILD_SHADEDCHUNKS
+	/* Greedy meshing needs textures to repeat vertically, which without the chunk shader */
+	/* wrapping V within each tile requires one tile per atlas (see Gfx_SetChunkTileSize) */
+	if (Builder_GreedyMeshing) maxTilesPerAtlas = 1;
+#endif
 
 	Atlas1D.TilesPerAtlas = min(maxTilesPerAtlas, maxTiles);
 	Atlas1D.Count = Math_CeilDiv(maxTiles, Atlas1D.TilesPerAtlas);
@@ -623,6 +629,288 @@ void TextureCache_SetLastModified(const String* url, const TimeMS* lastModified)
 }
 
 
+/*########################################################################################################################*
+*---------------------------------------------------TexturePack decoder---------------------------------------------------*
+*#########################################################################################################################*/
+/* Texture packs from servers are extracted and have their .png files decoded on a background thread, so that */
+/* a large texture pack does not freeze the game. The main thread then raises TextureEvents for each file, */
+/* and handlers get the already decoded bitmap through TexturePack_DecodeFile. */
+struct TexPackFile {
+	char Name[STRING_SIZE]; /* Filename of the entry, without any directories */
+	uint8_t* Data;          /* Contents of the entry */
+	uint32_t Size;
+	bool Decoded;           /* Whether Bmp and Res are the result of decoding the entry as a .png */
+	ReturnCode Res;
+	Bitmap Bmp;
+};
+
+struct TexPackJob {
+	char URL[URL_MAX_SIZE]; /* URL the texture pack was downloaded from */
+	uint8_t* Data;          /* Contents of the .zip or terrain .png */
+	uint32_t Size;
+	bool Zip;
+	ReturnCode Res;         /* Result of extracting the .zip or decoding the .png */
+	struct TexPackFile* Files;
+	int Count, Capacity;
+};
+
+#define TEXPACK_MAX_FILE_SIZE (64 * 1024 * 1024)
+static struct TexPackJob* texpack_queued; /* Waiting to be done by the background thread */
+static struct TexPackJob* texpack_done;   /* Waiting to be applied by the main thread */
+static struct TexPackFile* texpack_curFile;
+static uint32_t texpack_generation;       /* Changes whenever the texture pack is changed */
+static void* texpack_mutex;
+static void* texpack_waitable;
+static void* texpack_thread;
+static volatile bool texpack_stop;
+
+static void TexPackJob_Free(struct TexPackJob* job) {
+	int i;
+	if (!job) return;
+
+	for (i = 0; i < job->Count; i++) {
+		Mem_Free(job->Files[i].Data);
+		Mem_Free(job->Files[i].Bmp.Scan0);
+	}
+	Mem_Free(job->Files);
+	Mem_Free(job->Data);
+	Mem_Free(job);
+}
+
+static struct TexPackFile* TexPackJob_AddFile(struct TexPackJob* job, const String* name) {
+	struct TexPackFile* file;
+	String fileName;
+
+	if (job->Count == job->Capacity) {
+		job->Capacity = job->Capacity ? job->Capacity * 2 : 32;
+		job->Files    = Mem_Realloc(job->Files, job->Capacity, sizeof(struct TexPackFile), "texture pack files");
+	}
+
+	file = &job->Files[job->Count++];
+	Mem_Set(file, 0, sizeof(struct TexPackFile));
+	fileName = String_ClearedArray(file->Name);
+	String_AppendString(&fileName, name);
+	return file;
+}
+
+static void TexPackFile_Decode(struct TexPackFile* file, uint8_t* data, uint32_t size) {
+	struct Stream mem;
+	Stream_ReadonlyMemory(&mem, data, size);
+
+	file->Res     = Png_Decode(&file->Bmp, &mem);
+	file->Decoded = true;
+	if (!file->Res) return;
+
+	Mem_Free(file->Bmp.Scan0);
+	file->Bmp.Scan0 = NULL;
+}
+
+static ReturnCode TexPackJob_ProcessEntry(const String* path, struct Stream* data, struct ZipState* s) {
+	const static String pngExt = String_FromConst(".png");
+	struct TexPackJob* job = (struct TexPackJob*)s->Obj;
+	struct TexPackFile* file;
+	uint32_t size = s->_curEntry->UncompressedSize;
+	String name   = *path;
+	ReturnCode res;
+
+	/* Size comes from the .zip, so don't trust it for a huge allocation */
+	if (size > TEXPACK_MAX_FILE_SIZE) return ERR_INVALID_ARGUMENT;
+
+	Utils_UNSAFE_GetFilename(&name);
+	file       = TexPackJob_AddFile(job, &name);
+	file->Data = size ? (uint8_t*)Mem_Alloc(size, 1, "texture pack file") : NULL;
+	file->Size = size;
+	if ((res = Stream_Read(data, file->Data, size))) return res;
+
+	if (String_CaselessEnds(&name, &pngExt)) TexPackFile_Decode(file, file->Data, size);
+	return 0;
+}
+
+static void TexPackJob_Run(struct TexPackJob* job) {
+	const static String terrain = String_FromConst("terrain.png");
+	struct TexPackFile* file;
+	struct ZipState state;
+	struct Stream mem;
+
+	if (job->Zip) {
+		Stream_ReadonlyMemory(&mem, job->Data, job->Size);
+		Zip_Init(&state, &mem);
+		state.ProcessEntry = TexPackJob_ProcessEntry;
+		state.Obj          = job;
+		job->Res = Zip_Extract(&state);
+	} else {
+		file = TexPackJob_AddFile(job, &terrain);
+		TexPackFile_Decode(file, job->Data, job->Size);
+		job->Res = file->Res;
+	}
+}
+
+static void TexPackJob_Apply(struct TexPackJob* job) {
+	String url = String_FromRawArray(job->URL);
+	struct TexPackFile* file;
+	struct Stream mem;
+	String name;
+	Bitmap bmp;
+	int i;
+
+	if (job->Res) Logger_Warn2(job->Res, job->Zip ? "extracting" : "decoding", &url);
+	if (!job->Zip) {
+		if (job->Res) return;
+		bmp = job->Files[0].Bmp;
+		job->Files[0].Bmp.Scan0 = NULL;
+
+		Event_RaiseVoid(&TextureEvents.PackChanged);
+		if (!Game_ChangeTerrainAtlas(&bmp)) Mem_Free(bmp.Scan0);
+		return;
+	}
+
+	Event_RaiseVoid(&TextureEvents.PackChanged);
+	if (Gfx.LostContext) return;
+
+	for (i = 0; i < job->Count; i++) {
+		file = &job->Files[i];
+		name = String_FromRawArray(file->Name);
+		Stream_ReadonlyMemory(&mem, file->Data, file->Size);
+
+		texpack_curFile = file;
+		Event_RaiseEntry(&TextureEvents.FileChanged, &mem, &name);
+	}
+	texpack_curFile = NULL;
+}
+
+ReturnCode TexturePack_DecodeFile(Bitmap* bmp, struct Stream* src) {
+	struct TexPackFile* file = texpack_curFile;
+	if (!file || !file->Decoded) return Png_Decode(bmp, src);
+
+	/* Handlers take ownership of the bitmap, so any later handler must decode the file itself */
+	*bmp = file->Bmp;
+	file->Decoded   = false;
+	file->Bmp.Scan0 = NULL;
+	return file->Res;
+}
+
+#ifndef CC_BUILD_WEB
+static void TexturePack_DecodeLoop(void) {
+	struct TexPackJob* job;
+	uint32_t generation;
+
+	for (;;) {
+		Mutex_Lock(texpack_mutex);
+		{
+			job        = texpack_queued;
+			generation = texpack_generation;
+			texpack_queued = NULL;
+		}
+		Mutex_Unlock(texpack_mutex);
+
+		if (texpack_stop) { TexPackJob_Free(job); return; }
+		if (!job) { Waitable_Wait(texpack_waitable); continue; }
+		TexPackJob_Run(job);
+
+		Mutex_Lock(texpack_mutex);
+		{
+			/* Texture pack was changed again while this one was being extracted */
+			if (generation != texpack_generation) {
+				TexPackJob_Free(job);
+			} else {
+				TexPackJob_Free(texpack_done);
+				texpack_done = job;
+			}
+		}
+		Mutex_Unlock(texpack_mutex);
+	}
+}
+#endif
+
+/* Discards any texture pack still being extracted or waiting to be applied */
+static void TexturePack_CancelJobs(void) {
+#ifndef CC_BUILD_WEB
+	Mutex_Lock(texpack_mutex);
+	{
+		texpack_generation++;
+		TexPackJob_Free(texpack_queued);
+		TexPackJob_Free(texpack_done);
+		texpack_queued = NULL;
+		texpack_done   = NULL;
+	}
+	Mutex_Unlock(texpack_mutex);
+#endif
+}
+
+/* Extracts the given texture pack data on the background thread, then applies it in TexturePack_CheckDone */
+/* NOTE: The job takes ownership of data */
+static void TexturePack_QueueJob(const String* url, uint8_t* data, uint32_t size, bool zip) {
+	struct TexPackJob* job = (struct TexPackJob*)Mem_AllocCleared(1, sizeof(struct TexPackJob), "texture pack job");
+	String jobUrl = String_ClearedArray(job->URL);
+
+	String_AppendString(&jobUrl, url);
+	job->Data = data;
+	job->Size = size;
+	job->Zip  = zip;
+
+#ifdef CC_BUILD_WEB
+	TexPackJob_Run(job);
+	TexPackJob_Apply(job);
+	TexPackJob_Free(job);
+#else
+	TexturePack_CancelJobs();
+	Mutex_Lock(texpack_mutex);
+	{
+		texpack_queued = job;
+	}
+	Mutex_Unlock(texpack_mutex);
+	Waitable_Signal(texpack_waitable);
+#endif
+}
+
+#ifndef CC_BUILD_WEB
+static void TexturePack_CheckDone(struct ScheduledTask* task) {
+	struct TexPackJob* job;
+
+	Mutex_Lock(texpack_mutex);
+	{
+		job = texpack_done;
+		texpack_done = NULL;
+	}
+	Mutex_Unlock(texpack_mutex);
+
+	if (!job) return;
+	TexPackJob_Apply(job);
+	TexPackJob_Free(job);
+}
+#endif
+
+static void Textures_Init(void) {
+#ifndef CC_BUILD_WEB
+	texpack_stop     = false;
+	texpack_mutex    = Mutex_Create();
+	texpack_waitable = Waitable_Create();
+	texpack_thread   = Thread_Start(TexturePack_DecodeLoop, false);
+	ScheduledTask_Add(GAME_DEF_TICKS, TexturePack_CheckDone);
+#endif
+}
+
+static void Textures_Free(void) {
+#ifndef CC_BUILD_WEB
+	texpack_stop = true;
+	Waitable_Signal(texpack_waitable);
+	Thread_Join(texpack_thread);
+
+	Mutex_Free(texpack_mutex);
+	Waitable_Free(texpack_waitable);
+#endif
+	TexPackJob_Free(texpack_queued);
+	TexPackJob_Free(texpack_done);
+	texpack_queued = NULL;
+	texpack_done   = NULL;
+}
+
+struct IGameComponent Textures_Component = {
+	Textures_Init, /* Init  */
+	Textures_Free  /* Free  */
+};
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------TexturePack-------------------------------------------------------*
 *#########################################################################################################################*/
@@ -635,6 +923,7 @@ static ReturnCode TexturePack_ProcessZipEntry(const String* path, struct Stream*
 
 static ReturnCode TexturePack_ExtractZip(struct Stream* stream) {
 	struct ZipState state;
+	TexturePack_CancelJobs();
 	Event_RaiseVoid(&TextureEvents.PackChanged);
 	if (Gfx.LostContext) return 0;
 	
@@ -675,19 +964,6 @@ void TexturePack_ExtractZip_File(const String* filename) {
 #endif
 }
 
-ReturnCode TexturePack_ExtractTerrainPng(struct Stream* stream) {
-	Bitmap bmp; 
-	ReturnCode res = Png_Decode(&bmp, stream);
-
-	if (!res) {
-		Event_RaiseVoid(&TextureEvents.PackChanged);
-		if (Game_ChangeTerrainAtlas(&bmp)) return 0;
-	}
-
-	Mem_Free(bmp.Scan0);
-	return res;
-}
-
 void TexturePack_ExtractDefault(void) {
 	String texPack; char texPackBuffer[STRING_SIZE];
 
@@ -701,6 +977,8 @@ void TexturePack_ExtractDefault(void) {
 void TexturePack_ExtractCurrent(const String* url) {
 	const static String zipExt = String_FromConst(".zip");
 	struct Stream stream;
+	uint8_t* data;
+	uint32_t len;
 	bool zip;
 	ReturnCode res = 0;
 
@@ -714,9 +992,13 @@ void TexturePack_ExtractCurrent(const String* url) {
 			zip = String_ContainsString(url, &zipExt);
 			String_Copy(&World_TextureUrl, url);
 
-			res = zip ? TexturePack_ExtractZip(&stream) :
-						TexturePack_ExtractTerrainPng(&stream);		
-			if (res) Logger_Warn2(res, zip ? "extracting" : "decoding", url);
+			res = stream.Length(&stream, &len);
+			if (!res) {
+				data = (uint8_t*)Mem_Alloc(len, 1, "texture pack");
+				res  = Stream_Read(&stream, data, len);
+				if (res) { Mem_Free(data); } else { TexturePack_QueueJob(url, data, len, zip); }
+			}
+			if (res) Logger_Warn2(res, "reading cache for", url);
 		}
 
 		res = stream.Close(&stream);
@@ -727,9 +1009,7 @@ void TexturePack_ExtractCurrent(const String* url) {
 void TexturePack_Extract_Req(struct HttpRequest* item) {
 	String url, etag;
 	void* data; uint32_t len;
-	struct Stream mem;
 	bool png;
-	ReturnCode res;
 
 	url  = String_FromRawArray(item->URL);
 	String_Copy(&World_TextureUrl, &url);
@@ -741,11 +1021,9 @@ void TexturePack_Extract_Req(struct HttpRequest* item) {
 	TextureCache_SetETag(&url, &etag);
 	TextureCache_SetLastModified(&url, &item->LastModified);
 
-	Stream_ReadonlyMemory(&mem, data, len);
 	png = Png_Detect(data, len);
-	res = png ? TexturePack_ExtractTerrainPng(&mem) 
-			 : TexturePack_ExtractZip(&mem);
-
-	if (res) Logger_Warn2(res, png ? "decoding" : "extracting", &url);
-	HttpRequest_Free(item);
+	/* The job now owns the downloaded data */
+	TexturePack_QueueJob(&url, (uint8_t*)data, len, !png);
+	item->Data = NULL;
+	item->Size = 0;
 }
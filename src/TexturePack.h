@@ -13,6 +13,7 @@ struct Stream;
 struct HttpRequest;
 struct IGameComponent;
 extern struct IGameComponent Animations_Component;
+extern struct IGameComponent Textures_Component;
 
 /* Number of tiles in each row */
 #define ATLAS2D_TILES_PER_ROW 16
@@ -103,4 +104,7 @@ void TexturePack_ExtractZip_File(const String* filename);
 void TexturePack_ExtractDefault(void);
 void TexturePack_ExtractCurrent(const String* url);
 void TexturePack_Extract_Req(struct HttpRequest* item);
+/* Decodes the .png file given to a TextureEvents.FileChanged handler. */
+/* NOTE: Returns the bitmap already decoded on a background thread if there is one. */
+ReturnCode TexturePack_DecodeFile(Bitmap* bmp, struct Stream* src);
 #endif
@@ -245,6 +245,43 @@ bool FrustumCulling_SphereInFrustum(float x, float y, float z, float radius) {
 	return true;
 }
 
+/* Tests box against a plane, using the corners of the box furthest along and furthest against the plane normal */
+static int FrustumCulling_BoxPlane(float a, float b, float c, float d, const float* boxMin, const float* boxMax) {
+	float outer = a * (a >= 0 ? boxMax[0] : boxMin[0]) + b * (b >= 0 ? boxMax[1] : boxMin[1]) + c * (c >= 0 ? boxMax[2] : boxMin[2]) + d;
+	float inner = a * (a >= 0 ? boxMin[0] : boxMax[0]) + b * (b >= 0 ? boxMin[1] : boxMax[1]) + c * (c >= 0 ? boxMin[2] : boxMax[2]) + d;
+
+	if (outer <= 0) return FRUSTUM_OUTSIDE;
+	if (inner <= 0) return FRUSTUM_INTERSECTS;
+	return FRUSTUM_INSIDE;
+}
+
+int FrustumCulling_BoxInFrustum(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+	float boxMin[3], boxMax[3];
+	int result = FRUSTUM_INSIDE, plane;
+	boxMin[0] = minX; boxMin[1] = minY; boxMin[2] = minZ;
+	boxMax[0] = maxX; boxMax[1] = maxY; boxMax[2] = maxZ;
+
+	plane = FrustumCulling_BoxPlane(frustum00, frustum01, frustum02, frustum03, boxMin, boxMax);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_BoxPlane(frustum10, frustum11, frustum12, frustum13, boxMin, boxMax);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_BoxPlane(frustum20, frustum21, frustum22, frustum23, boxMin, boxMax);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_BoxPlane(frustum30, frustum31, frustum32, frustum33, boxMin, boxMax);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_BoxPlane(frustum40, frustum41, frustum42, frustum43, boxMin, boxMax);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	return min(result, plane);
+}
+
 void FrustumCulling_CalcFrustumEquations(struct Matrix* projection, struct Matrix* modelView) {
 	struct Matrix clipMatrix;
 	float* clip = (float*)&clipMatrix;
@@ -146,5 +146,9 @@ void Matrix_PerspectiveOffCenter(struct Matrix* result, float left, float right,
 void Matrix_LookRot(struct Matrix* result, Vector3 pos, Vector2 rot);
 
 bool FrustumCulling_SphereInFrustum(float x, float y, float z, float radius);
+enum FRUSTUM_RESULT { FRUSTUM_OUTSIDE, FRUSTUM_INTERSECTS, FRUSTUM_INSIDE };
+/* Returns whether the given axis aligned box is entirely outside, partially inside, or entirely inside the frustum. */
+/* NOTE: Like FrustumCulling_SphereInFrustum, the near plane is not tested. */
+int FrustumCulling_BoxInFrustum(float minX, float minY, float minZ, float maxX, float maxY, float maxZ);
 void FrustumCulling_CalcFrustumEquations(struct Matrix* projection, struct Matrix* modelView);
 #endif
@@ -9,4 +9,7 @@
 typedef struct VertexP3fC4b_ { float X, Y, Z; PackedCol Col; } VertexP3fC4b;
 /* 3 floats for position (XYZ), 2 floats for texture coordinates (UV), 4 bytes for colour. */
 typedef struct VertexP3fT2fC4b_ { float X, Y, Z; PackedCol Col; float U, V; } VertexP3fT2fC4b;
+/* 3 shorts for position (XYZ), 4 bytes for colour, 2 shorts for texture coordinates (UV). */
+/* NOTE: Position and texture coordinates are fixed point, so must be scaled by view and texture matrices. */
+typedef struct VertexP3sT2sC4b_ { int16_t X, Y, Z, W; PackedCol Col; int16_t U, V; } VertexP3sT2sC4b;
 #endif
@@ -2628,8 +2628,8 @@ static void Window_RefreshBounds(void) {
 static void Window_CorrectFocus(void) {
 	/* Sometimes emscripten_request_pointerlock doesn't always acquire focus */
 	/* Browser also only allows pointer locks requests in response to user input */
-	EmscriptenPointerlockChangeEvent status;
-	status.isActive = false;
+	EmscriptenPointerlockChangeEvent status;
+	status.isActive = false;
 	emscripten_get_pointerlock_status(&status);
 	if (win_rawMouse && !status.isActive) Window_EnableRawMouse();
 }
@@ -2703,45 +2703,45 @@ static Key Window_MapKey(int k) {
 	if (k >= DOM_VK_F1      && k <= DOM_VK_F24)      { return KEY_F1  + (k - DOM_VK_F1); }
 	if (k >= DOM_VK_NUMPAD0 && k <= DOM_VK_NUMPAD9)  { return KEY_KP0 + (k - DOM_VK_NUMPAD0); }
 
-	switch (k) {
-	case DOM_VK_BACK_SPACE: return KEY_BACKSPACE;
-	case DOM_VK_TAB:        return KEY_TAB;
-	case DOM_VK_RETURN:     return KEY_ENTER;
-	case DOM_VK_SHIFT:      return KEY_LSHIFT;
-	case DOM_VK_CONTROL:    return KEY_LCTRL;
-	case DOM_VK_ALT:        return KEY_LALT;
-	case DOM_VK_PAUSE:      return KEY_PAUSE;
-	case DOM_VK_CAPS_LOCK:  return KEY_CAPSLOCK;
-	case DOM_VK_ESCAPE:     return KEY_ESCAPE;
-	case DOM_VK_SPACE:      return KEY_SPACE;
-
-	case DOM_VK_PAGE_UP:     return KEY_PAGEUP;
-	case DOM_VK_PAGE_DOWN:   return KEY_PAGEDOWN;
-	case DOM_VK_END:         return KEY_END;
-	case DOM_VK_HOME:        return KEY_HOME;
-	case DOM_VK_LEFT:        return KEY_LEFT;
-	case DOM_VK_UP:          return KEY_UP;
-	case DOM_VK_RIGHT:       return KEY_RIGHT;
-	case DOM_VK_DOWN:        return KEY_DOWN;
-	case DOM_VK_PRINTSCREEN: return KEY_PRINTSCREEN;
-	case DOM_VK_INSERT:      return KEY_INSERT;
-	case DOM_VK_DELETE:      return KEY_DELETE;
-
-	case DOM_VK_SEMICOLON:   return KEY_SEMICOLON;
-	case DOM_VK_EQUALS:      return KEY_EQUALS;
-	case DOM_VK_WIN:         return KEY_LWIN;
-	case DOM_VK_MULTIPLY:    return KEY_KP_MULTIPLY;
-	case DOM_VK_ADD:         return KEY_KP_PLUS;
-	case DOM_VK_SUBTRACT:    return KEY_KP_MINUS;
-	case DOM_VK_DECIMAL:     return KEY_KP_DECIMAL;
-	case DOM_VK_DIVIDE:      return KEY_KP_DIVIDE;
-	case DOM_VK_NUM_LOCK:    return KEY_NUMLOCK;
+	switch (k) {
+	case DOM_VK_BACK_SPACE: return KEY_BACKSPACE;
+	case DOM_VK_TAB:        return KEY_TAB;
+	case DOM_VK_RETURN:     return KEY_ENTER;
+	case DOM_VK_SHIFT:      return KEY_LSHIFT;
+	case DOM_VK_CONTROL:    return KEY_LCTRL;
+	case DOM_VK_ALT:        return KEY_LALT;
+	case DOM_VK_PAUSE:      return KEY_PAUSE;
+	case DOM_VK_CAPS_LOCK:  return KEY_CAPSLOCK;
+	case DOM_VK_ESCAPE:     return KEY_ESCAPE;
+	case DOM_VK_SPACE:      return KEY_SPACE;
+
+	case DOM_VK_PAGE_UP:     return KEY_PAGEUP;
+	case DOM_VK_PAGE_DOWN:   return KEY_PAGEDOWN;
+	case DOM_VK_END:         return KEY_END;
+	case DOM_VK_HOME:        return KEY_HOME;
+	case DOM_VK_LEFT:        return KEY_LEFT;
+	case DOM_VK_UP:          return KEY_UP;
+	case DOM_VK_RIGHT:       return KEY_RIGHT;
+	case DOM_VK_DOWN:        return KEY_DOWN;
+	case DOM_VK_PRINTSCREEN: return KEY_PRINTSCREEN;
+	case DOM_VK_INSERT:      return KEY_INSERT;
+	case DOM_VK_DELETE:      return KEY_DELETE;
+
+	case DOM_VK_SEMICOLON:   return KEY_SEMICOLON;
+	case DOM_VK_EQUALS:      return KEY_EQUALS;
+	case DOM_VK_WIN:         return KEY_LWIN;
+	case DOM_VK_MULTIPLY:    return KEY_KP_MULTIPLY;
+	case DOM_VK_ADD:         return KEY_KP_PLUS;
+	case DOM_VK_SUBTRACT:    return KEY_KP_MINUS;
+	case DOM_VK_DECIMAL:     return KEY_KP_DECIMAL;
+	case DOM_VK_DIVIDE:      return KEY_KP_DIVIDE;
+	case DOM_VK_NUM_LOCK:    return KEY_NUMLOCK;
 	case DOM_VK_SCROLL_LOCK: return KEY_SCROLLLOCK;
 		
 	case DOM_VK_HYPHEN_MINUS:  return KEY_MINUS;
-	case DOM_VK_COMMA:         return KEY_COMMA;
-	case DOM_VK_PERIOD:        return KEY_PERIOD;
-	case DOM_VK_SLASH:         return KEY_SLASH;
+	case DOM_VK_COMMA:         return KEY_COMMA;
+	case DOM_VK_PERIOD:        return KEY_PERIOD;
+	case DOM_VK_SLASH:         return KEY_SLASH;
 	case DOM_VK_BACK_QUOTE:    return KEY_TILDE;
 	case DOM_VK_OPEN_BRACKET:  return KEY_LBRACKET;
 	case DOM_VK_BACK_SLASH:    return KEY_BACKSLASH;
@@ -2836,13 +2836,13 @@ void Window_Init(void) {
 	Display_BitsPerPixel  = 24;
 
 	/* copy text, but only if user isn't selecting something else */
-	EM_ASM(window.addEventListener('copy', function(e) {
-		if (window.getSelection && window.getSelection().toString()) return;
-		if (window.cc_copyText) {
-			e.clipboardData.setData('text/plain', window.cc_copyText);
-			e.preventDefault();
-			window.cc_copyText = null;
-		}	
+	EM_ASM(window.addEventListener('copy', function(e) {
+		if (window.getSelection && window.getSelection().toString()) return;
+		if (window.cc_copyText) {
+			e.clipboardData.setData('text/plain', window.cc_copyText);
+			e.preventDefault();
+			window.cc_copyText = null;
+		}	
 	});
 	);
 }
@@ -2960,6 +2960,88 @@ void Window_DisableRawMouse(void) {
 #endif
 
 
+/*########################################################################################################################*
+*-------------------------------------------------------Null window-------------------------------------------------------*
+*#########################################################################################################################*/
+/* No window is actually created, so the null graphics backend also works without a display (see CC_BUILD_NULLGFX) */
+#ifdef CC_BUILD_NULLGFX
+static bool win_visible;
+static int win_state;
+static Point2D win_cursorPos;
+
+void Window_Init(void) {
+	Display_Bounds.Width  = 1920;
+	Display_Bounds.Height = 1080;
+	Display_BitsPerPixel  = 32;
+}
+
+void Window_Create(int x, int y, int width, int height, struct GraphicsMode* mode) {
+	Window_Bounds.X = x; Window_Bounds.Width  = width;
+	Window_Bounds.Y = y; Window_Bounds.Height = height;
+	Window_ClientBounds = Window_Bounds;
+
+	Window_Exists  = true;
+	Window_Focused = true;
+	win_visible    = true;
+}
+
+void Window_SetTitle(const String* title) { }
+void Window_GetClipboardText(String* value) { }
+void Window_SetClipboardText(const String* value) { }
+
+bool Window_GetVisible(void) { return win_visible; }
+void Window_SetVisible(bool visible) { win_visible = visible; }
+void* Window_GetHandle(void) { return NULL; }
+
+int Window_GetWindowState(void) { return win_state; }
+void Window_SetWindowState(int state) {
+	if (state == win_state) return;
+	win_state = state;
+	Event_RaiseVoid(&WindowEvents.StateChanged);
+}
+
+void Window_SetLocation(int x, int y) {
+	Window_Bounds.X = x; Window_Bounds.Y = y;
+	Window_ClientBounds = Window_Bounds;
+	Event_RaiseVoid(&WindowEvents.Moved);
+}
+
+void Window_SetSize(int width, int height) {
+	Window_Bounds.Width = width; Window_Bounds.Height = height;
+	Window_ClientBounds = Window_Bounds;
+	Event_RaiseVoid(&WindowEvents.Resized);
+}
+
+void Window_Close(void) {
+	if (!Window_Exists) return;
+	Event_RaiseVoid(&WindowEvents.Closing);
+	Window_Exists = false;
+	Event_RaiseVoid(&WindowEvents.Destroyed);
+}
+
+void Window_ProcessEvents(void) { }
+
+Point2D Cursor_GetScreenPos(void) { return win_cursorPos; }
+void Cursor_SetScreenPos(int x, int y) { win_cursorPos.X = x; win_cursorPos.Y = y; }
+void Cursor_SetVisible(bool visible) { win_cursorVisible = visible; }
+
+void Window_ShowDialog(const char* title, const char* msg) {
+	Platform_LogConst(title);
+	Platform_LogConst(msg);
+}
+
+void Window_InitRaw(Bitmap* bmp) {
+	Mem_Free(bmp->Scan0);
+	bmp->Scan0 = Mem_Alloc(bmp->Width * bmp->Height, 4, "window pixels");
+}
+void Window_DrawRaw(Rect2D r) { }
+
+void Window_EnableRawMouse(void)  { Window_DefaultEnableRawMouse();  }
+void Window_UpdateRawMouse(void)  { Window_DefaultUpdateRawMouse();  }
+void Window_DisableRawMouse(void) { Window_DefaultDisableRawMouse(); }
+#endif
+
+
 #ifndef CC_BUILD_D3D9
 /*########################################################################################################################*
 *-------------------------------------------------------WGL OpenGL--------------------------------------------------------*
@@ -3486,9 +3568,9 @@ static EMSCRIPTEN_WEBGL_CONTEXT_HANDLE ctx_handle;
 void GLContext_Init(struct GraphicsMode* mode) {
 	EmscriptenWebGLContextAttributes attribs;
 	emscripten_webgl_init_context_attributes(&attribs);
-	attribs.alpha     = false;
-	attribs.depth     = true;
-	attribs.stencil   = false;
+	attribs.alpha     = false;
+	attribs.depth     = true;
+	attribs.stencil   = false;
 	attribs.antialias = false;
 
 	ctx_handle = emscripten_webgl_create_context(NULL, &attribs);
@@ -3507,8 +3589,8 @@ void* GLContext_GetAddress(const char* function) { return NULL; }
 void GLContext_SwapBuffers(void) { /* Browser implicitly does this */ }
 
 void GLContext_SetFpsLimit(bool vsync, float minFrameMs) {
-	if (vsync) {
-		emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
+	if (vsync) {
+		emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
 	} else {
 		emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, (int)minFrameMs);
 	}
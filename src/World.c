@@ -8,8 +8,20 @@
 #include "ExtMath.h"
 #include "Physics.h"
 #include "Game.h"
+#include "Builder.h"
+#include "Utils.h"
+#include "Funcs.h"
+#include "Stream.h"
 
 struct _WorldData World;
+#ifdef CC_BUILD_SPARSEWORLD
+static void World_BuildSections(void);
+static void World_FreeSections(void);
+static void World_MergeUpper(BlockRaw* blocks);
+#endif
+static void World_DetachSnapshot(void);
+static void World_InitNewMap(void);
+static void World_CopyPage(int page);
 /*########################################################################################################################*
 *----------------------------------------------------------World----------------------------------------------------------*
 *#########################################################################################################################*/
@@ -35,6 +47,8 @@ static void World_NewUuid(void) {
 }
 
 void World_Reset(void) {
+	Builder_CancelChunks();
+	World_DetachSnapshot();
 #ifdef EXTENDED_BLOCKS
 	if (World.Blocks != World.Blocks2) Mem_Free(World.Blocks2);
 	World.Blocks2 = NULL;
@@ -42,6 +56,12 @@ void World_Reset(void) {
 #endif
 	Mem_Free(World.Blocks);
 	World.Blocks = NULL;
+#ifdef CC_BUILD_SPARSEWORLD
+	World_FreeSections();
+#endif
+	World.Loaded = false;
+	Mem_Free(World.Columns);
+	World.Columns = NULL;
 
 	World_SetDimensions(0, 0, 0);
 	Env_Reset();
@@ -59,9 +79,17 @@ void World_SetNewMap(BlockRaw* blocks, int width, int height, int length) {
 		World.IDMask  = 0xFF;
 	}
 #endif
+	World.Loaded = World.Blocks != NULL;
+#ifdef CC_BUILD_SPARSEWORLD
+	World_BuildSections();
+#endif
+	World_InitNewMap();
+}
 
-	if (Env.EdgeHeight == -1)   { Env.EdgeHeight   = height / 2; }
-	if (Env.CloudsHeight == -1) { Env.CloudsHeight = height + 2; }
+/* Sets environment settings that depend on the new map, and gives it a new UUID */
+static void World_InitNewMap(void) {
+	if (Env.EdgeHeight == -1)   { Env.EdgeHeight   = World.Height / 2; }
+	if (Env.CloudsHeight == -1) { Env.CloudsHeight = World.Height + 2; }
 	World_NewUuid();
 }
 
@@ -77,14 +105,32 @@ CC_NOINLINE void World_SetDimensions(int width, int height, int length) {
 
 #ifdef EXTENDED_BLOCKS
 void World_SetMapUpper(BlockRaw* blocks) {
+#ifdef CC_BUILD_SPARSEWORLD
+	/* Multiplayer maps set upper 8 bits after the map, .cw maps set it before */
+	if (World.Loaded) { World_MergeUpper(blocks); return; }
+#endif
 	World.Blocks2 = blocks;
 	World.IDMask  = 0x3FF;
 }
 #endif
 
 
+#if defined CC_BUILD_SPARSEWORLD
+static void WorldSection_Set(struct WorldSection* s, int i, BlockID block);
+static int  WorldSection_GetIndex(struct WorldSectionData* data, int i);
+
+static void World_SetBlockCore(int x, int y, int z, BlockID block) {
+	struct WorldSection* s = &World.Sections[World_PackSection(x >> WORLD_SECTION_SHIFT, 
+								y >> WORLD_SECTION_SHIFT, z >> WORLD_SECTION_SHIFT)];
+	int i = ((y & WORLD_SECTION_MASK) << 8) | ((z & WORLD_SECTION_MASK) << 4) | (x & WORLD_SECTION_MASK);
+
 #ifdef EXTENDED_BLOCKS
-void World_SetBlock(int x, int y, int z, BlockID block) {
+	if (block > 0xFF) World.IDMask = 0x3FF;
+#endif
+	WorldSection_Set(s, i, block);
+}
+#elif defined EXTENDED_BLOCKS
+static void World_SetBlockCore(int x, int y, int z, BlockID block) {
 	int i = World_Pack(x, y, z);
 	World.Blocks[i] = (BlockRaw)block;
 
@@ -96,7 +142,7 @@ void World_SetBlock(int x, int y, int z, BlockID block) {
 	World.Blocks2[i] = (BlockRaw)(block >> 8);
 }
 #else
-void World_SetBlock(int x, int y, int z, BlockID block) {
+static void World_SetBlockCore(int x, int y, int z, BlockID block) {
 	World.Blocks[World_Pack(x, y, z)] = block; 
 }
 #endif
@@ -113,6 +159,674 @@ BlockID World_SafeGetBlock_3I(Vector3I p) {
 }
 
 
+/*########################################################################################################################*
+*-----------------------------------------------------World snapshot------------------------------------------------------*
+*#########################################################################################################################*/
+#define WORLD_PAGE_SHIFT 12
+#define WORLD_PAGE_SIZE (1 << WORLD_PAGE_SHIFT)
+/* Copies of pages (ranges of packed indices) made before they were first changed, NULL if unchanged */
+static BlockID** snapshot_pages;
+static int snapshot_pagesCount, snapshot_volume;
+/* Guards pages and changing blocks while a snapshot is active */
+static void* snapshot_mutex;
+/* Whether the world was reset while the snapshot was active, see World_DetachSnapshot */
+static bool snapshot_detached;
+/* The world the snapshot was taken of, with its blocks now owned by the snapshot */
+static struct _WorldData snapshot_world;
+
+static void World_ReadLive(const struct _WorldData* w, int index, int count, BlockID* blocks) {
+#if defined CC_BUILD_SPARSEWORLD
+	int x = index % w->Width, z = (index / w->Width) % w->Length, y = index / w->OneY;
+	struct WorldSection* s;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		s = &w->Sections[((y >> WORLD_SECTION_SHIFT) * w->SectionsZ + (z >> WORLD_SECTION_SHIFT)) 
+							* w->SectionsX + (x >> WORLD_SECTION_SHIFT)];
+		blocks[i] = !s->Data ? s->Uniform : s->Data->Palette[WorldSection_GetIndex(s->Data,
+			((y & WORLD_SECTION_MASK) << 8) | ((z & WORLD_SECTION_MASK) << 4) | (x & WORLD_SECTION_MASK))];
+
+		if (++x < w->Width)  continue;
+		x = 0;
+		if (++z < w->Length) continue;
+		z = 0; y++;
+	}
+#elif defined EXTENDED_BLOCKS
+	int i;
+	for (i = 0; i < count; i++, index++) {
+		blocks[i] = (BlockID)((w->Blocks[index] | (w->Blocks2[index] << 8)) & w->IDMask);
+	}
+#else
+	Mem_Copy(blocks, &w->Blocks[index], count);
+#endif
+}
+
+static void World_CopyPage(int page) {
+	int index = page << WORLD_PAGE_SHIFT;
+	int count = min(WORLD_PAGE_SIZE, snapshot_volume - index);
+	if (snapshot_pages[page]) return;
+
+	snapshot_pages[page] = (BlockID*)Mem_Alloc(count, sizeof(BlockID), "snapshot page");
+	World_ReadLive(&World, index, count, snapshot_pages[page]);
+}
+
+/* Hands the world's blocks over to the snapshot, so that World_Reset doesn't free them */
+static void World_DetachSnapshot(void) {
+	if (!snapshot_pages || snapshot_detached) return;
+
+	Mutex_Lock(snapshot_mutex);
+	{
+		snapshot_world    = World;
+		snapshot_detached = true;
+	}
+	Mutex_Unlock(snapshot_mutex);
+
+	World.Blocks = NULL;
+#ifdef EXTENDED_BLOCKS
+	World.Blocks2 = NULL;
+#endif
+#ifdef CC_BUILD_SPARSEWORLD
+	World.Sections = NULL;
+#endif
+}
+
+void World_SetBlock(int x, int y, int z, BlockID block) {
+	int page;
+	/* Blocks of a new map have nothing to do with the snapshot of the old map */
+	if (!snapshot_pages || snapshot_detached) { World_SetBlockCore(x, y, z, block); return; }
+	page = World_Pack(x, y, z) >> WORLD_PAGE_SHIFT;
+
+	Mutex_Lock(snapshot_mutex);
+	if (page < snapshot_pagesCount) World_CopyPage(page);
+	World_SetBlockCore(x, y, z, block);
+	Mutex_Unlock(snapshot_mutex);
+}
+
+void World_BeginSnapshot(void) {
+	if (snapshot_pages) Logger_Abort("World snapshot already active");
+	snapshot_volume     = World.Volume;
+	snapshot_pagesCount = (World.Volume + (WORLD_PAGE_SIZE - 1)) >> WORLD_PAGE_SHIFT;
+
+	snapshot_mutex = Mutex_Create();
+	/* +1 so that an empty world still has a non NULL pages array */
+	snapshot_pages = (BlockID**)Mem_AllocCleared(snapshot_pagesCount + 1, sizeof(BlockID*), "snapshot pages");
+}
+
+void World_ReadSnapshot(int index, int count, BlockID* blocks) {
+	int page, offset, n;
+	if (!snapshot_pages) { World_ReadLive(&World, index, count, blocks); return; }
+
+	Mutex_Lock(snapshot_mutex);
+	while (count) {
+		page   = index >> WORLD_PAGE_SHIFT;
+		offset = index & (WORLD_PAGE_SIZE - 1);
+		n      = min(count, WORLD_PAGE_SIZE - offset);
+
+		if (snapshot_pages[page]) {
+			Mem_Copy(blocks, &snapshot_pages[page][offset], n * sizeof(BlockID));
+		} else {
+			World_ReadLive(snapshot_detached ? &snapshot_world : &World, index, n, blocks);
+		}
+		index += n; blocks += n; count -= n;
+	}
+	Mutex_Unlock(snapshot_mutex);
+}
+
+void World_EndSnapshot(void) {
+	int page;
+#ifdef CC_BUILD_SPARSEWORLD
+	int count;
+#endif
+	if (!snapshot_pages) return;
+
+	for (page = 0; page < snapshot_pagesCount; page++) { Mem_Free(snapshot_pages[page]); }
+	Mem_Free(snapshot_pages);
+	Mutex_Free(snapshot_mutex);
+	snapshot_pages = NULL;
+
+	if (!snapshot_detached) return;
+	snapshot_detached = false;
+#ifdef CC_BUILD_SPARSEWORLD
+	count = snapshot_world.SectionsX * snapshot_world.SectionsY * snapshot_world.SectionsZ;
+	if (snapshot_world.Sections) {
+		for (page = 0; page < count; page++) { Mem_Free(snapshot_world.Sections[page].Data); }
+	}
+	Mem_Free(snapshot_world.Sections);
+#endif
+#ifdef EXTENDED_BLOCKS
+	if (snapshot_world.Blocks != snapshot_world.Blocks2) Mem_Free(snapshot_world.Blocks2);
+#endif
+	Mem_Free(snapshot_world.Blocks);
+}
+
+
+#ifdef CC_BUILD_SPARSEWORLD
+/*########################################################################################################################*
+*-----------------------------------------------------World sections------------------------------------------------------*
+*#########################################################################################################################*/
+#define SECTION_VOLUME (WORLD_SECTION_SIZE * WORLD_SECTION_SIZE * WORLD_SECTION_SIZE)
+#define SECTION_MAX_BLOCKS 1024
+/* Number of palette entries allocated for the given bits per index. (never more than there are blocks) */
+#define WorldSection_Capacity(bits) min(1 << (bits), SECTION_MAX_BLOCKS)
+/* Section data replaced by other data, which chunk builder threads may still be reading from. */
+/* Freed once every chunk build started before the data was replaced has finished. */
+struct RetiredSection { struct WorldSectionData* Data; uint32_t Started; };
+static struct RetiredSection retired_default[64];
+static struct RetiredSection* retired = retired_default;
+static uint32_t retiredCount, retiredMax = Array_Elems(retired_default);
+
+static struct WorldSectionData* WorldSection_AllocData(int bits) {
+	struct WorldSectionData* data;
+	int words    = SECTION_VOLUME * bits / 32;
+	int capacity = WorldSection_Capacity(bits);
+
+	/* indices, palette and reference counts are stored in the same allocation, after the data */
+	data = (struct WorldSectionData*)Mem_AllocCleared(1, sizeof(struct WorldSectionData)
+			+ words * 4 + capacity * (sizeof(BlockID) + sizeof(uint16_t)), "world section");
+	data->Bits    = bits;
+	data->Indices = (uint32_t*)(data + 1);
+	data->Palette = (BlockID*)(data->Indices + words);
+	data->Refs    = (uint16_t*)(data->Palette + capacity);
+	return data;
+}
+
+static int WorldSection_GetIndex(struct WorldSectionData* data, int i) {
+	int bit = i * data->Bits;
+	return (data->Indices[bit >> 5] >> (bit & 31)) & ((1 << data->Bits) - 1);
+}
+
+static void WorldSection_SetIndex(struct WorldSectionData* data, int i, int value) {
+	int bit = i * data->Bits;
+	uint32_t mask = (1u << data->Bits) - 1;
+	uint32_t* word = &data->Indices[bit >> 5];
+
+	*word = (*word & ~(mask << (bit & 31))) | ((uint32_t)value << (bit & 31));
+}
+
+/* Replaces the data of a section in the live world, which chunk builder threads read without locking. */
+/* NOTE: Uniform must already be set when data is NULL. */
+static void WorldSection_Publish(struct WorldSection* s, struct WorldSectionData* data) {
+	struct WorldSectionData* old = s->Data;
+	/* data must be fully written before other threads can see the pointer to it */
+	Thread_MemoryBarrier();
+	s->Data = data;
+	if (!old) return;
+
+	if (retiredCount == retiredMax) {
+		retired = Utils_Resize(retired, &retiredMax,
+								sizeof(struct RetiredSection), Array_Elems(retired_default), 512);
+	}
+	/* Builds started after this can only see the new data */
+	retired[retiredCount].Data    = old;
+	retired[retiredCount].Started = Builder_StartedBuilds();
+	retiredCount++;
+}
+
+void World_FreeRetiredSections(void) {
+	int i, freed;
+	/* Data is retired in order, so once builds that may see some data have finished, */
+	/*  builds that may see any data retired before that have also finished */
+	for (freed = retiredCount; freed > 0; freed--) {
+		if (Builder_FinishedBuilds(retired[freed - 1].Started)) break;
+	}
+	if (!freed) return;
+
+	for (i = 0; i < freed; i++) { Mem_Free(retired[i].Data); }
+	for (i = freed; i < retiredCount; i++) { retired[i - freed] = retired[i]; }
+	retiredCount -= freed;
+}
+
+/* Replaces data of the section with data using the given bits per index, dropping unused palette entries */
+static struct WorldSectionData* WorldSection_Resize(struct WorldSection* s, int bits) {
+	uint16_t remap[SECTION_MAX_BLOCKS];
+	struct WorldSectionData* old  = s->Data;
+	struct WorldSectionData* data = WorldSection_AllocData(bits);
+	int i, p;
+
+	for (p = 0; p < old->Count; p++) {
+		if (!old->Refs[p]) continue;
+		remap[p] = data->Count;
+
+		data->Palette[data->Count] = old->Palette[p];
+		data->Refs[data->Count]    = old->Refs[p];
+		data->Count++;
+	}
+	data->Used = data->Count;
+
+	for (i = 0; i < SECTION_VOLUME; i++) {
+		WorldSection_SetIndex(data, i, remap[WorldSection_GetIndex(old, i)]);
+	}
+	WorldSection_Publish(s, data);
+	return data;
+}
+
+/* Shrinks data of the section once its palette is mostly unused */
+static void WorldSection_Shrink(struct WorldSection* s, struct WorldSectionData* data) {
+	int p, bits = 1;
+
+	if (data->Used == 1) {
+		for (p = 0; !data->Refs[p]; p++) { }
+		s->Uniform = data->Palette[p];
+		WorldSection_Publish(s, NULL);
+		return;
+	}
+
+	/* Leave room for as many blocks again, so the palette doesn't keep growing and shrinking */
+	while ((1 << bits) < data->Used * 2) bits <<= 1;
+	if (bits < data->Bits) WorldSection_Resize(s, bits);
+}
+
+static void WorldSection_Set(struct WorldSection* s, int i, BlockID block) {
+	struct WorldSectionData* data = s->Data;
+	int p, old;
+
+	if (!data) {
+		if (block == s->Uniform) return;
+		data = WorldSection_AllocData(1);
+		data->Palette[0] = s->Uniform; data->Refs[0] = SECTION_VOLUME - 1;
+		data->Palette[1] = block;      data->Refs[1] = 1;
+		data->Count = 2; data->Used = 2;
+
+		WorldSection_SetIndex(data, i, 1);
+		WorldSection_Publish(s, data);
+		return;
+	}
+
+	old = WorldSection_GetIndex(data, i);
+	if (data->Palette[old] == block) return;
+	if (!--data->Refs[old]) data->Used--;
+
+	for (p = 0; p < data->Count; p++) {
+		if (data->Palette[p] == block) break;
+	}
+
+	if (p == data->Count) {
+		/* Reuse the entry of a block no longer in this section, before adding a new entry */
+		for (p = 0; p < data->Count; p++) {
+			if (!data->Refs[p]) break;
+		}
+
+		if (p == data->Count) {
+			if (p == WorldSection_Capacity(data->Bits)) data = WorldSection_Resize(s, data->Bits << 1);
+			data->Count++;
+		}
+		data->Palette[p] = block;
+	}
+
+	WorldSection_SetIndex(data, i, p);
+	if (!data->Refs[p]++) data->Used++;
+	if (!data->Refs[old]) WorldSection_Shrink(s, data);
+}
+
+/* Builds the data of a section that isn't visible to other threads yet from all of its blocks */
+static void WorldSection_Build(struct WorldSection* s, const BlockID* blocks, int16_t* lookup) {
+	BlockID palette[SECTION_MAX_BLOCKS];
+	uint16_t refs[SECTION_MAX_BLOCKS];
+	struct WorldSectionData* data;
+	int i, count = 0, bits = 1;
+
+	for (i = 0; i < SECTION_VOLUME; i++) {
+		if (lookup[blocks[i]] == -1) {
+			lookup[blocks[i]] = count;
+			palette[count]    = blocks[i];
+			refs[count++]     = 0;
+		}
+		refs[lookup[blocks[i]]]++;
+	}
+
+	if (count == 1) {
+		s->Data    = NULL;
+		s->Uniform = palette[0];
+		lookup[palette[0]] = -1;
+		return;
+	}
+
+	while ((1 << bits) < count) bits <<= 1;
+	data = WorldSection_AllocData(bits);
+	Mem_Copy(data->Palette, palette, count * sizeof(BlockID));
+	Mem_Copy(data->Refs,    refs,    count * sizeof(uint16_t));
+	data->Count = count;
+	data->Used  = count;
+
+	for (i = 0; i < SECTION_VOLUME; i++) {
+		WorldSection_SetIndex(data, i, lookup[blocks[i]]);
+	}
+
+	for (i = 0; i < count; i++) { lookup[palette[i]] = -1; }
+	s->Data = data;
+}
+
+/* Copies the blocks of the section at x1,y1,z1 out of flat arrays of blocks in World_Pack order */
+/* Blocks outside the arrays (in sections on the edges of the world) are air */
+static void WorldSection_Gather(BlockID* dst, const BlockRaw* lower, const BlockRaw* upper,
+								int width, int height, int length, int x1, int y1, int z1) {
+	int x, y, z, index;
+
+	for (y = y1; y < y1 + WORLD_SECTION_SIZE; y++) {
+		for (z = z1; z < z1 + WORLD_SECTION_SIZE; z++) {
+			for (x = x1; x < x1 + WORLD_SECTION_SIZE; x++, dst++) {
+				if (x >= width || y >= height || z >= length) { *dst = BLOCK_AIR; continue; }
+
+				index = (y * length + z) * width + x;
+				*dst  = lower[index];
+#ifdef EXTENDED_BLOCKS
+				if (upper) *dst = (*dst | (upper[index] << 8)) & 0x3FF;
+#endif
+			}
+		}
+	}
+}
+
+/* Builds the sections from the blocks in World.Blocks/World.Blocks2 */
+static void World_BuildSections(void) {
+	BlockID blocks[SECTION_VOLUME];
+	int16_t lookup[SECTION_MAX_BLOCKS];
+	const BlockRaw* upper = NULL;
+	int x, y, z, i = 0;
+	if (!World.Blocks) return;
+
+	World.SectionsX = (World.Width  + WORLD_SECTION_MASK) >> WORLD_SECTION_SHIFT;
+	World.SectionsY = (World.Height + WORLD_SECTION_MASK) >> WORLD_SECTION_SHIFT;
+	World.SectionsZ = (World.Length + WORLD_SECTION_MASK) >> WORLD_SECTION_SHIFT;
+	World.Sections  = (struct WorldSection*)Mem_Alloc(World.SectionsX * World.SectionsY * World.SectionsZ,
+											sizeof(struct WorldSection), "world sections");
+	Mem_Set(lookup, 0xFF, sizeof(lookup));
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks2 != World.Blocks) upper = World.Blocks2;
+#endif
+
+	for (y = 0; y < World.SectionsY; y++) {
+		for (z = 0; z < World.SectionsZ; z++) {
+			for (x = 0; x < World.SectionsX; x++, i++) {
+				WorldSection_Gather(blocks, World.Blocks, upper, World.Width, World.Height, World.Length,
+									x << WORLD_SECTION_SHIFT, y << WORLD_SECTION_SHIFT, z << WORLD_SECTION_SHIFT);
+				WorldSection_Build(&World.Sections[i], blocks, lookup);
+			}
+		}
+	}
+
+	/* The flat arrays were only needed while importing the map */
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) Mem_Free(World.Blocks2);
+	World.Blocks2 = NULL;
+#endif
+	Mem_Free(World.Blocks);
+	World.Blocks = NULL;
+}
+
+static void World_FreeSections(void) {
+	int i, count = World.SectionsX * World.SectionsY * World.SectionsZ;
+
+	if (World.Sections) {
+		for (i = 0; i < count; i++) { Mem_Free(World.Sections[i].Data); }
+	}
+	Mem_Free(World.Sections);
+	World.Sections  = NULL;
+	World.SectionsX = 0; World.SectionsY = 0; World.SectionsZ = 0;
+
+	for (i = 0; i < retiredCount; i++) { Mem_Free(retired[i].Data); }
+	if (retired != retired_default) Mem_Free(retired);
+
+	retired      = retired_default;
+	retiredCount = 0;
+	retiredMax   = Array_Elems(retired_default);
+}
+
+#ifdef EXTENDED_BLOCKS
+static void World_MergeUpper(BlockRaw* blocks) {
+	int x, y, z, i = 0;
+	World.IDMask = 0x3FF;
+
+	for (y = 0; y < World.Height; y++) {
+		for (z = 0; z < World.Length; z++) {
+			for (x = 0; x < World.Width; x++, i++) {
+				if (!blocks[i]) continue;
+				World_SetBlock(x, y, z, (World_GetBlock(x, y, z) | (blocks[i] << 8)) & 0x3FF);
+			}
+		}
+	}
+	Mem_Free(blocks);
+}
+#endif
+
+
+/*########################################################################################################################*
+*-------------------------------------------------World sections builder--------------------------------------------------*
+*#########################################################################################################################*/
+void WorldSections_Begin(struct WorldSectionsBuilder* b, int width, int height, int length) {
+	b->Width  = width; b->Height = height; b->Length = length;
+	b->SectionsX = (width  + WORLD_SECTION_MASK) >> WORLD_SECTION_SHIFT;
+	b->SectionsY = (height + WORLD_SECTION_MASK) >> WORLD_SECTION_SHIFT;
+	b->SectionsZ = (length + WORLD_SECTION_MASK) >> WORLD_SECTION_SHIFT;
+
+	/* Cleared, so that sections not read yet have no data to free */
+	b->Sections = (struct WorldSection*)Mem_AllocCleared(b->SectionsX * b->SectionsY * b->SectionsZ,
+											sizeof(struct WorldSection), "world sections");
+	b->Slab = (BlockRaw*)Mem_Alloc(width * length, WORLD_SECTION_SIZE, "world sections slab");
+}
+
+ReturnCode WorldSections_Read(struct WorldSectionsBuilder* b, struct Stream* stream, const BlockRaw* table) {
+	BlockID blocks[SECTION_VOLUME];
+	int16_t lookup[SECTION_MAX_BLOCKS];
+	int layers, count;
+	int x, y, z, i = 0, j;
+	ReturnCode res;
+	Mem_Set(lookup, 0xFF, sizeof(lookup));
+
+	for (y = 0; y < b->SectionsY; y++) {
+		layers = min(WORLD_SECTION_SIZE, b->Height - (y << WORLD_SECTION_SHIFT));
+		count  = layers * b->Width * b->Length;
+		if ((res = Stream_Read(stream, b->Slab, count))) return res;
+
+		if (table) {
+			for (j = 0; j < count; j++) { b->Slab[j] = table[b->Slab[j]]; }
+		}
+
+		for (z = 0; z < b->SectionsZ; z++) {
+			for (x = 0; x < b->SectionsX; x++, i++) {
+				WorldSection_Gather(blocks, b->Slab, NULL, b->Width, layers, b->Length,
+									x << WORLD_SECTION_SHIFT, 0, z << WORLD_SECTION_SHIFT);
+				WorldSection_Build(&b->Sections[i], blocks, lookup);
+			}
+		}
+	}
+
+	Mem_Free(b->Slab);
+	b->Slab = NULL;
+	return 0;
+}
+
+void WorldSections_Replace(struct WorldSectionsBuilder* b, int x, int y, int z, BlockID block, const BlockRaw* blocks) {
+	BlockID cur[SECTION_VOLUME];
+	int16_t lookup[SECTION_MAX_BLOCKS];
+	struct WorldSection* s;
+	int i;
+	
+	s = &b->Sections[((y >> WORLD_SECTION_SHIFT) * b->SectionsZ + (z >> WORLD_SECTION_SHIFT))
+						* b->SectionsX + (x >> WORLD_SECTION_SHIFT)];
+	if (!s->Data && s->Uniform != block) return;
+
+	for (i = 0; i < SECTION_VOLUME; i++) {
+		cur[i] = !s->Data ? s->Uniform : s->Data->Palette[WorldSection_GetIndex(s->Data, i)];
+		if (cur[i] == block) cur[i] = blocks[i];
+	}
+
+	/* Sections being built aren't visible to other threads, so can just be freed */
+	Mem_Free(s->Data);
+	Mem_Set(lookup, 0xFF, sizeof(lookup));
+	WorldSection_Build(s, cur, lookup);
+}
+
+void WorldSections_Free(struct WorldSectionsBuilder* b) {
+	int i, count = b->SectionsX * b->SectionsY * b->SectionsZ;
+
+	if (b->Sections) {
+		for (i = 0; i < count; i++) { Mem_Free(b->Sections[i].Data); }
+	}
+	Mem_Free(b->Sections);
+	Mem_Free(b->Slab);
+	b->Sections = NULL;
+	b->Slab     = NULL;
+}
+
+void World_SetNewSections(struct WorldSectionsBuilder* b) {
+	World_SetDimensions(b->Width, b->Height, b->Length);
+	World.Sections  = b->Sections;
+	World.SectionsX = b->SectionsX; World.SectionsY = b->SectionsY; World.SectionsZ = b->SectionsZ;
+	b->Sections     = NULL;
+
+	World.Loaded = World.Volume > 0;
+	World_InitNewMap();
+}
+#endif
+
+
+/*########################################################################################################################*
+*------------------------------------------------------World columns------------------------------------------------------*
+*#########################################################################################################################*/
+/* Checks whether the given block at Y is the highest block for any of the given fields of the column. */
+/* Returns the fields that still need a lower block. */
+static int World_TestColumn(struct WorldColumn* col, int fields, BlockID block, int y) {
+	uint8_t draw;
+	if ((fields & COLUMN_LIGHT) && Blocks.BlocksLight[block]) {
+		col->LightY = y - ((Blocks.LightOffset[block] >> FACE_YMAX) & 1);
+		fields &= ~COLUMN_LIGHT;
+	}
+
+	draw = Blocks.Draw[block];
+	if ((fields & COLUMN_RAIN) && !(draw == DRAW_GAS || draw == DRAW_SPRITE)) {
+		col->RainY = y;
+		fields &= ~COLUMN_RAIN;
+	}
+	if ((fields & COLUMN_SOLID) && Blocks.Collide[block] == COLLIDE_SOLID) {
+		col->SolidY = y;
+		fields &= ~COLUMN_SOLID;
+	}
+	return fields;
+}
+
+/* Sets the given fields of the column to the value used when no block in the column matches. */
+static void World_FinishColumn(struct WorldColumn* col, int fields) {
+	if (fields & COLUMN_LIGHT) col->LightY = -10;
+	if (fields & COLUMN_RAIN)  col->RainY  = -1;
+	if (fields & COLUMN_SOLID) col->SolidY = -1;
+}
+
+#define World_CalcColumnsBody(get_block)\
+for (y = World.MaxY; y >= 0 && left; y--) {\
+	i = World_Pack(0, y, z1); j = 0;\
+\
+	for (z = z1; z < z2; z++) {\
+		for (x = 0; x < World.Width; x++, i++, j++) {\
+			if (!pending[j]) continue;\
+\
+			pending[j] = World_TestColumn(&cols[j], pending[j], get_block, y);\
+			if (!pending[j]) left--;\
+		}\
+	}\
+}
+
+void World_CalcColumns(int z1, int z2) {
+	struct WorldColumn* cols = &World.Columns[World_ColumnPack(0, z1)];
+	int count = World.Width * (z2 - z1), left = count;
+	uint8_t* pending;
+	int x, y, z, i, j;
+	if (!count) return;
+
+	/* Fields of each column that have not been found yet */
+	pending = (uint8_t*)Mem_Alloc(count, 1, "column fields");
+	Mem_Set(pending, COLUMN_ALL, count);
+
+#if defined CC_BUILD_SPARSEWORLD
+	World_CalcColumnsBody(World_GetBlock(x, y, z));
+#elif !defined EXTENDED_BLOCKS
+	World_CalcColumnsBody(World.Blocks[i]);
+#else
+	if (World.IDMask <= 0xFF) {
+		World_CalcColumnsBody(World.Blocks[i]);
+	} else {
+		World_CalcColumnsBody(World.Blocks[i] | (World.Blocks2[i] << 8));
+	}
+#endif
+
+	for (j = 0; j < count; j++) {
+		World_FinishColumn(&cols[j], pending[j]);
+	}
+	Mem_Free(pending);
+}
+
+void World_CalcColumn(int x, int maxY, int z, int fields) {
+	struct WorldColumn* col = &World.Columns[World_ColumnPack(x, z)];
+	int y;
+
+	for (y = maxY; y >= 0 && fields; y--) {
+		fields = World_TestColumn(col, fields, World_GetBlock(x, y, z), y);
+	}
+	World_FinishColumn(col, fields);
+}
+
+static void World_UpdateLight(struct WorldColumn* col, int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
+	bool didBlock  = Blocks.BlocksLight[oldBlock];
+	bool nowBlocks = Blocks.BlocksLight[newBlock];
+	int oldOffset  = (Blocks.LightOffset[oldBlock] >> FACE_YMAX) & 1;
+	int newOffset  = (Blocks.LightOffset[newBlock] >> FACE_YMAX) & 1;
+	BlockID above;
+
+	/* Two cases we need to handle here: */
+	if (didBlock == nowBlocks) {
+		if (!didBlock) return;              /* a) both old and new block do not block light */
+		if (oldOffset == newOffset) return; /* b) both blocks blocked light at the same Y coordinate */
+	}
+
+	if ((y - newOffset) >= col->LightY) {
+		if (nowBlocks) {
+			col->LightY = y - newOffset;
+		} else {
+			/* Part of the column is now visible to light, we don't know how exactly how high it should be though. */
+			/* However, we know that if the old block was above or equal to light height, then the new light height must be <= old block.y */
+			/* (or the Y above, if that is an upside down slab that was resting on the old block) */
+			World_CalcColumn(x, min(y + 1, World.MaxY), z, COLUMN_LIGHT);
+		}
+	} else if (y == col->LightY && oldOffset == 0) {
+		/* For a solid block on top of an upside down slab, they will both have the same light height. */
+		/* So we need to account for this particular case. */
+		above = y == (World.Height - 1) ? BLOCK_AIR : World_GetBlock(x, y + 1, z);
+		if (Blocks.BlocksLight[above]) return;
+
+		if (nowBlocks) {
+			col->LightY = y - newOffset;
+		} else {
+			World_CalcColumn(x, y - 1, z, COLUMN_LIGHT);
+		}
+	}
+}
+
+/* Updates a field that is just the Y of the highest block with some property. */
+static void World_UpdateTop(int16_t* top, int field, int x, int y, int z, bool did, bool now) {
+	/* Changes below the current highest block can be skipped */
+	if (did == now || y < *top) return;
+
+	if (now) {
+		/* Simple case: rest of the column below no longer matters. */
+		*top = y;
+	} else {
+		/* The new highest block must be <= the old highest block */
+		World_CalcColumn(x, y, z, field);
+	}
+}
+
+void World_UpdateColumn(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
+	struct WorldColumn* col = &World.Columns[World_ColumnPack(x, z)];
+	uint8_t oldDraw = Blocks.Draw[oldBlock], newDraw = Blocks.Draw[newBlock];
+
+	World_UpdateLight(col, x, y, z, oldBlock, newBlock);
+	World_UpdateTop(&col->RainY, COLUMN_RAIN, x, y, z,
+		!(oldDraw == DRAW_GAS || oldDraw == DRAW_SPRITE), !(newDraw == DRAW_GAS || newDraw == DRAW_SPRITE));
+	World_UpdateTop(&col->SolidY, COLUMN_SOLID, x, y, z,
+		Blocks.Collide[oldBlock] == COLLIDE_SOLID, Blocks.Collide[newBlock] == COLLIDE_SOLID);
+}
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------Environment-------------------------------------------------------*
 *#########################################################################################################################*/
@@ -263,17 +977,45 @@ float Respawn_HighestSolidY(struct AABB* bb) {
 	return highestY;
 }
 
+/* Returns the highest solid block Y in the columns the given bounding box covers. */
+/* Returns World.MaxY when this is unknown. (e.g. the box goes outside the map) */
+static int Respawn_HighestColumn(struct AABB* bb) {
+	int minX = Math_Floor(bb->Min.X), maxX = Math_Floor(bb->Max.X);
+	int minZ = Math_Floor(bb->Min.Z), maxZ = Math_Floor(bb->Max.Z);
+	int x, z, highest = -1;
+
+	/* Columns are only calculated once the map has finished loading */
+	if (!World.Columns) return World.MaxY;
+	/* Outside the map's sides counts as solid bedrock */
+	if (!World_ContainsXZ(minX, minZ) || !World_ContainsXZ(maxX, maxZ)) return World.MaxY;
+
+	for (z = minZ; z <= maxZ; z++) {
+		for (x = minX; x <= maxX; x++) {
+			highest = max(highest, World.Columns[World_ColumnPack(x, z)].SolidY);
+		}
+	}
+	return highest;
+}
+
 Vector3 Respawn_FindSpawnPosition(float x, float z, Vector3 modelSize) {
 	Vector3 spawn = Vector3_Create3(x, 0.0f, z);
 	struct AABB bb;
 	float highestY;
-	int y;
+	int y, skip;
 
 	spawn.Y = World.Height + ENTITY_ADJUSTMENT;
 	AABB_Make(&bb, &spawn, &modelSize);
 	spawn.Y = 0.0f;
+
+	/* Skip straight down to just above the highest solid block the bounding box can touch */
+	skip = (int)bb.Min.Y - (Respawn_HighestColumn(&bb) + 1);
+	if (skip > 0) {
+		bb.Min.Y -= skip; bb.Max.Y -= skip;
+	} else {
+		skip = 0;
+	}
 	
-	for (y = World.Height; y >= 0; y--) {
+	for (y = World.Height - skip; y >= 0; y--) {
 		highestY = Respawn_HighestSolidY(&bb);
 		if (highestY != RESPAWN_NOT_FOUND) {
 			spawn.Y = highestY; break;
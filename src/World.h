@@ -13,14 +13,67 @@ struct AABB;
 /* Packs an x,y,z into a single index */
 #define World_Pack(x, y, z) (((y) * World.Length + (z)) * World.Width + (x))
 
+#ifdef CC_BUILD_SPARSEWORLD
+#define WORLD_SECTION_SHIFT 4
+#define WORLD_SECTION_SIZE 16
+#define WORLD_SECTION_MASK 15
+/* Packs an x,y,z section coordinate into a single index */
+#define World_PackSection(x, y, z) (((y) * World.SectionsZ + (z)) * World.SectionsX + (x))
+
+/* Blocks of a 16x16x16 section, stored as bit-packed indices into a palette of blocks. */
+struct WorldSectionData {
+	int Bits;  /* Number of bits per index, either 1, 2, 4, 8 or 16 */
+	int Count; /* Number of entries in the palette, at most 1 << Bits (and 1024) */
+	int Used;  /* Number of entries in the palette still used by at least one block */
+	BlockID* Palette;
+	uint16_t* Refs; /* Number of blocks using each entry in the palette */
+	uint32_t* Indices;
+};
+struct WorldSection {
+	/* Palette and indices of the blocks in this section. */
+	/* NULL when every block in this section is the same (Uniform) */
+	struct WorldSectionData* Data;
+	BlockID Uniform;
+};
+#endif
+
+/* Packs an x,z into a single column index */
+#define World_ColumnPack(x, z) ((x) + World.Width * (z))
+/* Summary of the highest blocks of interest in a column of the world. */
+struct WorldColumn {
+	/* Blocks at or below this Y are in shadow. (-10 if no block blocks light) */
+	/* NOTE: One below the highest block that blocks light, if that block's YMAX light offset is set. */
+	int16_t LightY;
+	/* Y of the highest block that stops rain and snow. (i.e. not gas or sprite, -1 if none) */
+	int16_t RainY;
+	/* Y of the highest solid block. (-1 if none) */
+	int16_t SolidY;
+};
+#define COLUMN_LIGHT 0x01 /* WorldColumn.LightY */
+#define COLUMN_RAIN  0x02 /* WorldColumn.RainY  */
+#define COLUMN_SOLID 0x04 /* WorldColumn.SolidY */
+#define COLUMN_ALL   0x07
+
 CC_VAR extern struct _WorldData {
 	/* The blocks in the world. */
+	/* NOTE: With CC_BUILD_SPARSEWORLD, only used while a map is being imported. */
 	BlockRaw* Blocks;
 #ifdef EXTENDED_BLOCKS
 	/* The upper 8 bit of blocks in the world. */
 	/* If only 8 bit blocks are used, equals World_Blocks. */
 	BlockRaw* Blocks2;
 #endif
+#ifdef CC_BUILD_SPARSEWORLD
+	/* The sections of blocks in the world. */
+	struct WorldSection* Sections;
+	/* Number of sections along each axis. */
+	int SectionsX, SectionsY, SectionsZ;
+#endif
+	/* Whether the blocks of a map have been set. */
+	bool Loaded;
+	/* Summary of each column of blocks, updated as blocks change. (see Lighting_OnBlockChanged) */
+	/* NOTE: NULL until the map has finished loading. (see Lighting_Refresh) */
+	struct WorldColumn* Columns;
 	/* Volume of the world. */
 	int Volume;
 
@@ -37,6 +90,7 @@ CC_VAR extern struct _WorldData {
 #ifdef EXTENDED_BLOCKS
 	/* Masks access to World.Blocks/World.Blocks2 */
 	/* e.g. this will be 255 if only 8 bit blocks are used */
+	/* NOTE: With CC_BUILD_SPARSEWORLD, only indicates whether any block is above 255. */
 	int IDMask;
 #endif
 } World;
@@ -47,6 +101,32 @@ CC_API void World_Reset(void);
 /* Sets the blocks array and dimensions of the map. */
 /* May also sets some environment settings like border/clouds height, if they are -1 */
 CC_API void World_SetNewMap(BlockRaw* blocks, int width, int height, int length);
+#ifdef CC_BUILD_SPARSEWORLD
+struct Stream;
+/* Sections of a map being imported, built directly from its blocks as they are read. */
+/* This avoids ever needing to store the blocks of the whole map in one flat array. */
+struct WorldSectionsBuilder {
+	struct WorldSection* Sections;
+	int SectionsX, SectionsY, SectionsZ;
+	int Width, Height, Length;
+	/* Blocks of the layers of sections currently being read */
+	BlockRaw* Slab;
+};
+/* Allocates the sections for a map of the given dimensions. */
+void WorldSections_Begin(struct WorldSectionsBuilder* b, int width, int height, int length);
+/* Reads every block of the map from the stream (in World_Pack order), 16 layers at a time. */
+/* If table is non-NULL, each block read is converted to table[block]. */
+ReturnCode WorldSections_Read(struct WorldSectionsBuilder* b, struct Stream* stream, const BlockRaw* table);
+/* Replaces every block of the given type in the section at x,y,z with the block in blocks at the same index. */
+void WorldSections_Replace(struct WorldSectionsBuilder* b, int x, int y, int z, BlockID block, const BlockRaw* blocks);
+/* Frees the sections, unless they have been set as the world's blocks. */
+void WorldSections_Free(struct WorldSectionsBuilder* b);
+/* Sets the sections as the blocks of the world, like World_SetNewMap. */
+void World_SetNewSections(struct WorldSectionsBuilder* b);
+/* Frees section data replaced by block changes, once no chunk builds can still be reading it. */
+void World_FreeRetiredSections(void);
+#endif
+
 /* Sets the various dimension and max coordinate related variables. */
 /* NOTE: This is an internal API. Use World_SetNewMap instead. */
 CC_NOINLINE void World_SetDimensions(int width, int height, int length);
@@ -54,7 +134,22 @@ CC_NOINLINE void World_SetDimensions(int width, int height, int length);
 #ifdef EXTENDED_BLOCKS
 /* Sets World.Blocks2 and updates internal state for more than 256 blocks. */
 void World_SetMapUpper(BlockRaw* blocks);
+#endif
+
+#if defined CC_BUILD_SPARSEWORLD
+/* Gets the block at the given coordinates. */
+/* NOTE: Does NOT check that the coordinates are inside the map. */
+static CC_INLINE BlockID World_GetBlock(int x, int y, int z) {
+	struct WorldSection* s = &World.Sections[World_PackSection(x >> WORLD_SECTION_SHIFT, 
+								y >> WORLD_SECTION_SHIFT, z >> WORLD_SECTION_SHIFT)];
+	struct WorldSectionData* data = s->Data;
+	int i;
+	if (!data) return s->Uniform;
 
+	i = (((y & WORLD_SECTION_MASK) << 8) | ((z & WORLD_SECTION_MASK) << 4) | (x & WORLD_SECTION_MASK)) * data->Bits;
+	return data->Palette[(data->Indices[i >> 5] >> (i & 31)) & ((1 << data->Bits) - 1)];
+}
+#elif defined EXTENDED_BLOCKS
 /* Gets the block at the given coordinates. */
 /* NOTE: Does NOT check that the coordinates are inside the map. */
 static CC_INLINE BlockID World_GetBlock(int x, int y, int z) {
@@ -72,10 +167,29 @@ BlockID World_GetPhysicsBlock(int x, int y, int z);
 /* Sets the block at the given coordinates. */
 /* NOTE: Does NOT check that the coordinates are inside the map. */
 void World_SetBlock(int x, int y, int z, BlockID block);
+
+/* Begins a copy-on-write snapshot of the blocks in the world. */
+/* Blocks are only copied when World_SetBlock is about to change them. */
+/* NOTE: Only one snapshot can be active at a time. */
+void World_BeginSnapshot(void);
+/* Reads the blocks at the given range of packed indices, as they were when the snapshot began. */
+/* NOTE: Can be called from any thread. Reads the world's blocks directly if no snapshot is active. */
+void World_ReadSnapshot(int index, int count, BlockID* blocks);
+/* Ends the snapshot, freeing any blocks that were copied for it. */
+void World_EndSnapshot(void);
 /* If coordinates are outside the map, returns BLOCK_AIR. */
 /* Otherwise returns the block at the given coordinates. */
 BlockID World_SafeGetBlock_3I(Vector3I p);
 
+/* Calculates the summaries of every column in rows z1 up to (but not including) z2. */
+/* NOTE: Rows are scanned a whole layer of blocks at a time, so this is much faster than World_CalcColumn. */
+void World_CalcColumns(int z1, int z2);
+/* Recalculates the given fields (see COLUMN_ flags) of a column's summary. */
+/* NOTE: Only blocks at or below maxY are checked, so blocks above must not match any of the fields. */
+void World_CalcColumn(int x, int maxY, int z, int fields);
+/* Updates the summary of a column, after the block at the given coordinates has been changed. */
+void World_UpdateColumn(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+
 /* Whether the given coordinates lie inside the map. */
 static CC_INLINE bool World_Contains(int x, int y, int z) {
 	return (unsigned)x < (unsigned)World.Width
@@ -0,0 +1,139 @@
+#include "InflateBaseline.h"
+#include "Deflate.h"
+#include "Generator.h"
+#include "World.h"
+#include "Stream.h"
+#include "Platform.h"
+#include "Funcs.h"
+/* Headless benchmark of the DEFLATE decoder, built with 'make bench-inflate'.
+Compresses the given files (or a classic vanilla world generated from a fixed seed, when no files are given),
+then measures how long decompressing them takes with the current decoder, the current decoder's bit by bit
+state machine only, and the decoder from before the inflate fast path was rewritten. (see InflateBaseline.h)
+   Usage: BenchInflate [file1 file2 ...]
+*/
+#define BENCH_RUNS 5
+
+static uint8_t* BenchInflate_Compress(const uint8_t* data, uint32_t size, uint32_t* compSize) {
+	struct Stream dst, stream;
+	struct DeflateState* state;
+	uint8_t* comp;
+	/* DEFLATE may make incompressible data slightly larger */
+	uint32_t compMax = size + (size >> 3) + 1024;
+
+	comp  = (uint8_t*)Mem_Alloc(compMax, 1, "benchmark compressed");
+	state = (struct DeflateState*)Mem_Alloc(1, sizeof(struct DeflateState), "deflate state");
+
+	Stream_WriteonlyMemory(&dst, comp, compMax);
+	Deflate_MakeStream(&stream, state, &dst);
+	Stream_Write(&stream, data, size);
+	stream.Close(&stream);
+
+	Mem_Free(state);
+	*compSize = compMax - dst.Meta.Mem.Left;
+	return comp;
+}
+
+/* Measures microseconds spent decompressing using the baseline decoder, returning whether the output was correct */
+static bool BenchInflate_TimeBaseline(const uint8_t* data, uint32_t size, uint8_t* comp, uint32_t compSize, uint64_t* time) {
+	struct Stream src, stream;
+	struct BaselineInflateState* state;
+	uint8_t* decomp;
+	uint64_t beg, end;
+	uint32_t i;
+
+	state  = (struct BaselineInflateState*)Mem_Alloc(1, sizeof(struct BaselineInflateState), "inflate state");
+	decomp = (uint8_t*)Mem_Alloc(size, 1, "benchmark decompressed");
+	Stream_ReadonlyMemory(&src, comp, compSize);
+	BaselineInflate_MakeStream(&stream, state, &src);
+
+	beg = Stopwatch_Measure();
+	Stream_Read(&stream, decomp, size);
+	end = Stopwatch_Measure();
+	*time = Stopwatch_ElapsedMicroseconds(beg, end);
+
+	for (i = 0; i < size && data[i] == decomp[i]; i++) { }
+	Mem_Free(decomp);
+	Mem_Free(state);
+	return i == size;
+}
+
+static void BenchInflate_Run(const String* name, const uint8_t* data, uint32_t size) {
+	struct InflateBenchmark bench;
+	uint64_t fastTime = 0, slowTime = 0, baseTime = 0, time;
+	uint8_t* comp;
+	uint32_t compSize;
+	int i, kb, compKb, fastRate, slowRate, baseRate;
+	bool valid = true;
+
+	comp = BenchInflate_Compress(data, size, &compSize);
+	/* Fastest of several runs, to reduce noise from the OS and from cold caches */
+	for (i = 0; i < BENCH_RUNS; i++) {
+		Inflate_Benchmark(&bench, data, size);
+		valid &= bench.Valid;
+		valid &= BenchInflate_TimeBaseline(data, size, comp, compSize, &time);
+
+		fastTime = i ? min(fastTime, bench.FastTime) : bench.FastTime;
+		slowTime = i ? min(slowTime, bench.SlowTime) : bench.SlowTime;
+		baseTime = i ? min(baseTime, time)           : time;
+	}
+	Mem_Free(comp);
+
+	kb     = (int)(size >> 10);
+	compKb = (int)(compSize >> 10);
+	/* bytes per microsecond is the same as MB per second */
+	fastRate = (int)(size / max(1, fastTime));
+	slowRate = (int)(size / max(1, slowTime));
+	baseRate = (int)(size / max(1, baseTime));
+
+	Platform_Log3("%s: %i KB compressed to %i KB", name, &kb, &compKb);
+	Platform_Log3("  current %i MB/s, bit by bit decoder only %i MB/s, baseline %i MB/s", &fastRate, &slowRate, &baseRate);
+	if (!valid) Platform_LogConst("  Decompressed data did not match original data!");
+}
+
+static void BenchInflate_RunWorld(void) {
+	static const String name = String_FromConst("Generated 256x64x256 world");
+	World_SetDimensions(256, 64, 256);
+	Gen_Seed = 1337;
+	NotchyGen_Generate();
+
+	BenchInflate_Run(&name, Gen_Blocks, World.Volume);
+	Mem_Free(Gen_Blocks);
+	Gen_Blocks = NULL;
+}
+
+static void BenchInflate_RunFile(const String* path) {
+	struct Stream s;
+	uint8_t* data;
+	uint32_t size;
+	ReturnCode res;
+
+	res = Stream_OpenFile(&s, path);
+	if (res) { Platform_Log2("Error %i opening %s", &res, path); return; }
+
+	res = s.Length(&s, &size);
+	if (res || !size) { s.Close(&s); Platform_Log1("Empty or unreadable file %s", path); return; }
+
+	data = (uint8_t*)Mem_Alloc(size, 1, "benchmark file");
+	res  = Stream_Read(&s, data, size);
+	s.Close(&s);
+
+	if (res) {
+		Platform_Log2("Error %i reading %s", &res, path);
+	} else {
+		BenchInflate_Run(path, data, size);
+	}
+	Mem_Free(data);
+}
+
+int main(int argc, char** argv) {
+	String path;
+	int i;
+	Platform_Init();
+
+	if (argc <= 1) { BenchInflate_RunWorld(); return 0; }
+	for (i = 1; i < argc; i++) {
+		path = String_FromReadonly(argv[i]);
+		BenchInflate_RunFile(&path);
+	}
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include "Builder.h"
+#include "Block.h"
+#include "World.h"
+#include "Lighting.h"
+#include "Generator.h"
+#include "Formats.h"
+#include "TexturePack.h"
+#include "MapRenderer.h"
+#include "Graphics.h"
+#include "Platform.h"
+#include "GameStructs.h"
+#include "Bitmap.h"
+#include "Funcs.h"
+/* Headless benchmark of the chunk mesh builders, built with 'make bench-mesher'.
+Imports the given .cw/.lvl/.fcm/.dat map file, or when no map file is given, generates a classic vanilla
+world from a fixed seed, so every run benchmarks the same blocks. Then builds the mesh of every chunk with
+the normal and smooth lighting mesh builders, using the null graphics backend.
+With EXTENDED_BLOCKS, a generated world is then also built through the 10 bit block IDs read path.
+   Usage: BenchMesher [map file]
+          BenchMesher [width height length [seed]]
+*/
+
+/* Index of maximum used 1D atlas + 1 (see MapRenderer_UsedAtlases) */
+static int BenchMesher_UsedAtlases(void) {
+	TextureLoc maxLoc = 0;
+	int i;
+
+	for (i = 0; i < Array_Elems(Blocks.Textures); i++) {
+		maxLoc = max(maxLoc, Blocks.Textures[i]);
+	}
+	return Atlas1D_Index(maxLoc) + 1;
+}
+
+/* Recalculates everything the mesh builders read from the world */
+static void BenchMesher_MapLoaded(void) {
+	Lighting_Component.OnNewMapLoaded();
+	Builder_OnNewMapLoaded();
+	MapRenderer_1DUsedCount = BenchMesher_UsedAtlases();
+}
+
+/* Replaces the world with the given blocks */
+static void BenchMesher_SetWorld(BlockRaw* blocks, BlockRaw* blocks2, int width, int height, int length) {
+	Lighting_Component.OnNewMap();
+	World_Reset();
+	World_SetNewMap(blocks, width, height, length);
+#if defined EXTENDED_BLOCKS && !defined CC_BUILD_SPARSEWORLD
+	if (blocks2) World_SetMapUpper(blocks2);
+#endif
+	BenchMesher_MapLoaded();
+}
+
+static void BenchMesher_Init(void) {
+	Bitmap atlas;
+	Platform_Init();
+	Gfx_Init();
+	Blocks_Component.Init();
+	Lighting_Component.Init();
+	Builder_Init();
+
+	/* Same layout as the default terrain.png, textures are irrelevant to building meshes */
+	Bitmap_AllocateClearedPow2(&atlas, 256, 256);
+	Atlas_Update(&atlas);
+}
+
+static int BenchMesher_ParseArg(char** argv, int i, int argc, int value) {
+	String arg;
+	if (i >= argc) return value;
+
+	arg = String_FromReadonly(argv[i]);
+	if (!Convert_ParseInt(&arg, &value) || value <= 0) {
+		Platform_Log1("Invalid argument: %s", &arg);
+		Process_Exit(1);
+	}
+	return value;
+}
+
+static void BenchMesher_RunMap(const String* path) {
+	ReturnCode res;
+	Platform_Log1("Importing %s..", path);
+	Lighting_Component.OnNewMap();
+
+	res = Map_ImportFrom(path);
+	if (res) { Platform_Log2("Error %i importing %s", &res, path); Process_Exit(1); }
+	BenchMesher_MapLoaded();
+
+	Platform_Log3("Imported %ix%ix%i world", &World.Width, &World.Height, &World.Length);
+	Builder_RunBenchmark("Normal",          false, Platform_Log);
+	Builder_RunBenchmark("Smooth lighting", true,  Platform_Log);
+}
+
+static void BenchMesher_RunGenerated(int argc, char** argv) {
+	int width  = BenchMesher_ParseArg(argv, 1, argc, 256);
+	int height = BenchMesher_ParseArg(argv, 2, argc, 128);
+	int length = BenchMesher_ParseArg(argv, 3, argc, 256);
+	int seed   = BenchMesher_ParseArg(argv, 4, argc, 1337);
+	BlockRaw* blocks;
+#if defined EXTENDED_BLOCKS && !defined CC_BUILD_SPARSEWORLD
+	BlockRaw* copy;
+#endif
+
+	Platform_Log4("Generating %ix%ix%i world with seed %i..", &width, &height, &length, &seed);
+	World_SetDimensions(width, height, length);
+	Gen_Seed = seed;
+	NotchyGen_Generate();
+
+	blocks     = Gen_Blocks;
+	Gen_Blocks = NULL;
+#if defined EXTENDED_BLOCKS && !defined CC_BUILD_SPARSEWORLD
+	copy = (BlockRaw*)Mem_Alloc(World.Volume, 1, "benchmark blocks");
+	Mem_Copy(copy, blocks, World.Volume);
+#endif
+
+	BenchMesher_SetWorld(blocks, NULL, width, height, length);
+	Builder_RunBenchmark("Normal",          false, Platform_Log);
+	Builder_RunBenchmark("Smooth lighting", true,  Platform_Log);
+
+#if defined EXTENDED_BLOCKS && !defined CC_BUILD_SPARSEWORLD
+	/* All zero upper byte, so the meshes are the same but read through the 10 bit block IDs path */
+	BenchMesher_SetWorld(copy, (BlockRaw*)Mem_AllocCleared(World.Volume, 1, "benchmark blocks"), width, height, length);
+	Builder_RunBenchmark("Normal (10 bit IDs)",          false, Platform_Log);
+	Builder_RunBenchmark("Smooth lighting (10 bit IDs)", true,  Platform_Log);
+#endif
+}
+
+int main(int argc, char** argv) {
+	String arg;
+	int value;
+	BenchMesher_Init();
+
+	arg = String_FromReadonly(argc > 1 ? argv[1] : "");
+	if (arg.length && !Convert_ParseInt(&arg, &value)) {
+		BenchMesher_RunMap(&arg);
+	} else {
+		BenchMesher_RunGenerated(argc, argv);
+	}
+
+	Builder_Free();
+	World_Reset();
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "Bitmap.h"
+#include "Stream.h"
+#include "Platform.h"
+/* Headless benchmark of the PNG decoder, built with 'make bench-png'.
+Decodes the given .png files, and every .png file in the given .zip files (e.g. texture packs), several times
+both with and without the SIMD filters and row expanders, then checks both decoded every image the same.
+When no files are given, the default texture pack (texpacks/default.zip) is used.
+   Usage: BenchPng [file1 file2 ...]
+*/
+
+static void BenchPng_RunFile(struct PngBenchmark* bench, const String* path) {
+	const static String png = String_FromConst(".png");
+	struct Stream s;
+	uint8_t* data;
+	uint32_t size;
+	ReturnCode res;
+
+	res = Stream_OpenFile(&s, path);
+	if (res) { Platform_Log2("Error %i opening %s", &res, path); return; }
+
+	if (!String_CaselessEnds(path, &png)) {
+		res = Png_BenchmarkZip(bench, &s);
+		if (res) Platform_Log2("Error %i extracting %s", &res, path);
+		s.Close(&s); return;
+	}
+
+	res = s.Length(&s, &size);
+	if (res || !size) { s.Close(&s); Platform_Log1("Empty or unreadable file %s", path); return; }
+
+	data = (uint8_t*)Mem_Alloc(size, 1, "benchmark png");
+	res  = Stream_Read(&s, data, size);
+	s.Close(&s);
+
+	if (res) {
+		Platform_Log2("Error %i reading %s", &res, path);
+	} else {
+		Png_Benchmark(bench, data, size);
+	}
+	Mem_Free(data);
+}
+
+int main(int argc, char** argv) {
+	const static String defPack = String_FromConst("texpacks/default.zip");
+	struct PngBenchmark bench;
+	String path;
+	int i;
+
+	Platform_Init();
+	Mem_Set(&bench, 0, sizeof(struct PngBenchmark));
+
+	if (argc <= 1) BenchPng_RunFile(&bench, &defPack);
+	for (i = 1; i < argc; i++) {
+		path = String_FromReadonly(argv[i]);
+		BenchPng_RunFile(&bench, &path);
+	}
+
+	Png_PrintBenchmark(&bench, Platform_Log);
+	return bench.Mismatched ? 1 : 0;
+}
@@ -0,0 +1,635 @@
+#include "InflateBaseline.h"
+#include "Logger.h"
+#include "Funcs.h"
+#include "Platform.h"
+#include "Stream.h"
+#include "Errors.h"
+#include "Utils.h"
+
+/*########################################################################################################################*
+*--------------------------------------------------Inflate (decompress)---------------------------------------------------*
+*#########################################################################################################################*/
+enum BASELINE_INFLATE_STATE_ {
+	BASELINE_INFLATE_STATE_HEADER, BASELINE_INFLATE_STATE_UNCOMPRESSED_HEADER,
+	BASELINE_INFLATE_STATE_UNCOMPRESSED_DATA, BASELINE_INFLATE_STATE_DYNAMIC_HEADER,
+	BASELINE_INFLATE_STATE_DYNAMIC_CODELENS, BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTS,
+	BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTSREPEAT, BASELINE_INFLATE_STATE_COMPRESSED_LIT,
+	BASELINE_INFLATE_STATE_COMPRESSED_LITREPEAT, BASELINE_INFLATE_STATE_COMPRESSED_DIST,
+	BASELINE_INFLATE_STATE_COMPRESSED_DISTREPEAT, BASELINE_INFLATE_STATE_COMPRESSED_DATA,
+	BASELINE_INFLATE_STATE_FASTCOMPRESSED, BASELINE_INFLATE_STATE_DONE
+};
+
+/* Insert next byte into the bit buffer */
+#define BaselineInflate_GetByte(state) state->AvailIn--; state->Bits |= (uint32_t)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
+/* Retrieves bits from the bit buffer */
+#define BaselineInflate_PeekBits(state, bits) (state->Bits & ((1UL << (bits)) - 1UL))
+/* Consumes/eats up bits from the bit buffer */
+#define BaselineInflate_ConsumeBits(state, bits) state->Bits >>= (bits); state->NumBits -= (bits);
+/* Aligns bit buffer to be on a byte boundary */
+#define BaselineInflate_AlignBits(state) uint32_t alignSkip = state->NumBits & 7; BaselineInflate_ConsumeBits(state, alignSkip);
+/* Ensures there are 'bitsCount' bits, or returns if not */
+#define BaselineInflate_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { if (!state->AvailIn) return; BaselineInflate_GetByte(state); }
+/* Ensures there are 'bitsCount' bits */
+#define BaselineInflate_UNSAFE_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { BaselineInflate_GetByte(state); }
+/* Peeks then consumes given bits */
+#define BaselineInflate_ReadBits(state, bitsCount) BaselineInflate_PeekBits(state, bitsCount); BaselineInflate_ConsumeBits(state, bitsCount);
+
+/* Goes to the next state, after having read data of a block */
+#define BaselineInflate_NextBlockState(state) (state->LastBlock ? BASELINE_INFLATE_STATE_DONE : BASELINE_INFLATE_STATE_HEADER)
+/* Goes to the next state, after having finished reading a compressed entry */
+#define BaselineInflate_NextCompressState(state) ((state->AvailIn >= BASELINE_INFLATE_FASTINF_IN && state->AvailOut >= BASELINE_INFLATE_FASTINF_OUT) ? BASELINE_INFLATE_STATE_FASTCOMPRESSED : BASELINE_INFLATE_STATE_COMPRESSED_LIT)
+/* The maximum amount of bytes that can be output is 258 */
+#define BASELINE_INFLATE_FASTINF_OUT 258
+/* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Add 3 extra bytes to account for putting data into the bit buffer. */
+#define BASELINE_INFLATE_FASTINF_IN 10
+
+static uint32_t BaselineHuffman_ReverseBits(uint32_t n, uint8_t bits) {
+	n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
+	n = ((n & 0xCCCC) >> 2) | ((n & 0x3333) << 2);
+	n = ((n & 0xF0F0) >> 4) | ((n & 0x0F0F) << 4);
+	n = ((n & 0xFF00) >> 8) | ((n & 0x00FF) << 8);
+	return n >> (16 - bits);
+}
+
+/* Builds a huffman tree, based on input lengths of each codeword */
+static void BaselineHuffman_Build(struct BaselineHuffmanTable* table, const uint8_t* bitLens, int count) {
+	int bl_count[BASELINE_INFLATE_MAX_BITS], bl_offsets[BASELINE_INFLATE_MAX_BITS];
+	int code, offset, value;
+	int i, j;
+
+	/* Initialise 'zero bit length' codewords */
+	table->FirstCodewords[0] = 0;
+	table->FirstOffsets[0]   = 0;
+	table->EndCodewords[0]   = 0;
+
+	/* Count number of codewords assigned to each bit length */
+	for (i = 0; i < BASELINE_INFLATE_MAX_BITS; i++) bl_count[i] = 0;
+	for (i = 0; i < count; i++) {
+		bl_count[bitLens[i]]++;
+	}
+
+	/* Ensure huffman tree actually makes sense */
+	bl_count[0] = 0;
+	for (i = 1; i < BASELINE_INFLATE_MAX_BITS; i++) {
+		if (bl_count[i] > (1 << i)) {
+			Logger_Abort("Too many huffman codes for bit length");
+		}
+	}
+
+	/* Compute the codewords for the huffman tree.
+	*  Codewords are ordered, so consider this example tree:
+	*     2 of length 2, 3 of length 3, 1 of length 4
+	*  Codewords produced would be: 00,01 100,101,110, 1110 
+	*/
+	code = 0; offset = 0;
+	for (i = 1; i < BASELINE_INFLATE_MAX_BITS; i++) {
+		code = (code + bl_count[i - 1]) << 1;
+		bl_offsets[i] = offset;
+
+		table->FirstCodewords[i] = code;
+		table->FirstOffsets[i]   = offset;
+		offset += bl_count[i];
+
+		/* Last codeword is actually: code + (bl_count[i] - 1)
+		*  However, when decoding we peform < against this value though, so need to add 1 here.
+		*  This way, don't need to special case bit lengths with 0 codewords when decoding.
+		*/
+		if (bl_count[i]) {
+			table->EndCodewords[i] = code + bl_count[i];
+		} else {
+			table->EndCodewords[i] = 0;
+		}
+	}
+
+	/* Assigns values to each codeword.
+	*  Note that although codewords are ordered, values may not be.
+	*  Some values may also not be assigned to any codeword.
+	*/
+	value = 0;
+	Mem_Set(table->Fast, UInt8_MaxValue, sizeof(table->Fast));
+	for (i = 0; i < count; i++, value++) {
+		int len = bitLens[i];
+		if (!len) continue;
+		table->Values[bl_offsets[len]] = value;
+
+		/* Compute the accelerated lookup table values for this codeword.
+		* For example, assume len = 4 and codeword = 0100
+		* - Shift it left to be 0100_00000
+		* - Then, for all the indices from 0100_00000 to 0100_11111,
+		*   - bit reverse index, as huffman codes are read backwards
+		*   - set fast value to specify a 'value' value, and to skip 'len' bits
+		*/
+		if (len <= BASELINE_INFLATE_FAST_BITS) {
+			int16_t packed = (int16_t)((len << BASELINE_INFLATE_FAST_BITS) | value);
+			int codeword = table->FirstCodewords[len] + (bl_offsets[len] - table->FirstOffsets[len]);
+			codeword <<= (BASELINE_INFLATE_FAST_BITS - len);
+
+			for (j = 0; j < 1 << (BASELINE_INFLATE_FAST_BITS - len); j++, codeword++) {
+				int index = BaselineHuffman_ReverseBits(codeword, BASELINE_INFLATE_FAST_BITS);
+				table->Fast[index] = packed;
+			}
+		}
+		bl_offsets[len]++;
+	}
+}
+
+/* Attempts to read the next huffman encoded value from the bitstream, using given table */
+/* Returns -1 if there are insufficient bits to read the value */
+static int BaselineHuffman_Decode(struct BaselineInflateState* state, struct BaselineHuffmanTable* table) {
+	uint32_t i, j, codeword;
+	int packed, bits, offset;
+
+	/* Buffer as many bits as possible */
+	while (state->NumBits <= BASELINE_INFLATE_MAX_BITS) {
+		if (!state->AvailIn) break;
+		BaselineInflate_GetByte(state);
+	}
+
+	/* Try fast accelerated table lookup */
+	if (state->NumBits >= BASELINE_INFLATE_FAST_BITS) {
+		packed = table->Fast[BaselineInflate_PeekBits(state, BASELINE_INFLATE_FAST_BITS)];
+		if (packed >= 0) {
+			bits = packed >> BASELINE_INFLATE_FAST_BITS;
+			BaselineInflate_ConsumeBits(state, bits);
+			return packed & 0x1FF;
+		}
+	}
+
+	/* Slow, bit by bit lookup */
+	codeword = 0;
+	for (i = 1, j = 0; i < BASELINE_INFLATE_MAX_BITS; i++, j++) {
+		if (state->NumBits < i) return -1;
+		codeword = (codeword << 1) | ((state->Bits >> j) & 1);
+
+		if (codeword < table->EndCodewords[i]) {
+			offset = table->FirstOffsets[i] + (codeword - table->FirstCodewords[i]);
+			BaselineInflate_ConsumeBits(state, i);
+			return table->Values[offset];
+		}
+	}
+
+	Logger_Abort("DEFLATE - Invalid huffman code");
+	return -1;
+}
+
+/* Inline the common <= 9 bits case */
+#define BaselineHuffman_Unsafe_Decode(state, table, result) \
+{\
+	BaselineInflate_UNSAFE_EnsureBits(state, BASELINE_INFLATE_MAX_BITS);\
+	packed = table.Fast[BaselineInflate_PeekBits(state, BASELINE_INFLATE_FAST_BITS)];\
+	if (packed >= 0) {\
+		consumedBits = packed >> BASELINE_INFLATE_FAST_BITS;\
+		BaselineInflate_ConsumeBits(state, consumedBits);\
+		result = packed & 0x1FF;\
+	} else {\
+		result = BaselineHuffman_Unsafe_Decode_Slow(state, &table);\
+	}\
+}
+
+static int BaselineHuffman_Unsafe_Decode_Slow(struct BaselineInflateState* state, struct BaselineHuffmanTable* table) {
+	uint32_t i, j, codeword;
+	int offset;
+
+	/* Slow, bit by bit lookup. Need to reverse order for huffman. */
+	codeword = BaselineInflate_PeekBits(state,       BASELINE_INFLATE_FAST_BITS);
+	codeword = BaselineHuffman_ReverseBits(codeword, BASELINE_INFLATE_FAST_BITS);
+
+	for (i = BASELINE_INFLATE_FAST_BITS + 1, j = BASELINE_INFLATE_FAST_BITS; i < BASELINE_INFLATE_MAX_BITS; i++, j++) {
+		codeword = (codeword << 1) | ((state->Bits >> j) & 1);
+
+		if (codeword < table->EndCodewords[i]) {
+			offset = table->FirstOffsets[i] + (codeword - table->FirstCodewords[i]);
+			BaselineInflate_ConsumeBits(state, i);
+			return table->Values[offset];
+		}
+	}
+
+	Logger_Abort("DEFLATE - Invalid huffman code");
+	return -1;
+}
+
+static void BaselineInflate_Init(struct BaselineInflateState* state, struct Stream* source) {
+	state->State = BASELINE_INFLATE_STATE_HEADER;
+	state->LastBlock = false;
+	state->Bits = 0;
+	state->NumBits = 0;
+	state->NextIn  = state->Input;
+	state->AvailIn = 0;
+	state->Output = NULL;
+	state->AvailOut = 0;
+	state->Source = source;
+	state->WindowIndex = 0;
+}
+
+const static uint8_t fixed_lits[BASELINE_INFLATE_MAX_LITS] = {
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,8,8,8,8,8,8,8,8
+};
+const static uint8_t fixed_dists[BASELINE_INFLATE_MAX_DISTS] = {
+	5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5, 5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5
+};
+
+const static uint16_t len_base[31] = { 
+	3,4,5,6,7,8,9,10,11,13,
+	15,17,19,23,27,31,35,43,51,59,
+	67,83,99,115,131,163,195,227,258,0,0 
+};
+const static uint8_t len_bits[31] = { 
+	0,0,0,0,0,0,0,0,1,1,
+	1,1,2,2,2,2,3,3,3,3,
+	4,4,4,4,5,5,5,5,0,0,0 
+};
+const static uint16_t dist_base[32] = {
+	1,2,3,4,5,7,9,13,17,25,
+	33,49,65,97,129,193,257,385,513,769,
+	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0 
+};
+const static uint8_t dist_bits[32] = {
+	0,0,0,0,1,1,2,2,3,3,
+	4,4,5,5,6,6,7,7,8,8,
+	9,9,10,10,11,11,12,12,13,13,0,0 
+};
+const static uint8_t codelens_order[BASELINE_INFLATE_MAX_CODELENS] = {
+	16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 
+};
+
+static void BaselineInflate_InflateFast(struct BaselineInflateState* state) {
+	/* huffman variables */
+	uint32_t lit, len, dist;
+	uint32_t bits, lenIdx, distIdx;
+	int packed, consumedBits;
+
+	/* window variables */
+	uint8_t* window;
+	uint32_t i, curIdx, startIdx;
+	uint32_t copyStart, copyLen, partLen;
+
+	window = state->Window;
+	curIdx = state->WindowIndex;
+	copyStart = state->WindowIndex;
+	copyLen   = 0;
+
+#define BASELINE_INFLATE_FAST_COPY_MAX (BASELINE_INFLATE_WINDOW_SIZE - BASELINE_INFLATE_FASTINF_OUT)
+	while (state->AvailOut >= BASELINE_INFLATE_FASTINF_OUT && state->AvailIn >= BASELINE_INFLATE_FASTINF_IN && copyLen < BASELINE_INFLATE_FAST_COPY_MAX) {
+		BaselineHuffman_Unsafe_Decode(state, state->Table.Lits, lit);
+
+		if (lit <= 256) {
+			if (lit < 256) {
+				window[curIdx] = (uint8_t)lit;
+				state->AvailOut--; copyLen++;
+				curIdx = (curIdx + 1) & BASELINE_INFLATE_WINDOW_MASK;
+			} else {
+				state->State = BaselineInflate_NextBlockState(state);
+				break;
+			}
+		} else {
+			lenIdx = lit - 257;
+			bits = len_bits[lenIdx];
+			BaselineInflate_UNSAFE_EnsureBits(state, bits);
+			len  = len_base[lenIdx] + BaselineInflate_ReadBits(state, bits);
+
+			BaselineHuffman_Unsafe_Decode(state, state->TableDists, distIdx);
+			bits = dist_bits[distIdx];
+			BaselineInflate_UNSAFE_EnsureBits(state, bits);
+			dist = dist_base[distIdx] + BaselineInflate_ReadBits(state, bits);
+	
+			/* Window is infinitely repeating like ... [xyz][xyz][xyz] ... */
+			/* If start and end don't cross a boundary, can avoid masking index */
+			startIdx = (curIdx - dist) & BASELINE_INFLATE_WINDOW_MASK;
+			if (curIdx >= startIdx && (curIdx + len) < BASELINE_INFLATE_WINDOW_SIZE) {
+				uint8_t* src = &window[startIdx]; 
+				uint8_t* dst = &window[curIdx];
+
+				for (i = 0; i < (len & ~0x3); i += 4) {
+					*dst++ = *src++; *dst++ = *src++; *dst++ = *src++; *dst++ = *src++;
+				}
+				for (; i < len; i++) { *dst++ = *src++; }
+			} else {
+				for (i = 0; i < len; i++) {
+					window[(curIdx + i) & BASELINE_INFLATE_WINDOW_MASK] = window[(startIdx + i) & BASELINE_INFLATE_WINDOW_MASK];
+				}
+			}
+			curIdx = (curIdx + len) & BASELINE_INFLATE_WINDOW_MASK;
+			state->AvailOut -= len; copyLen += len;
+		}
+	}
+
+	state->WindowIndex = curIdx;
+	if (!copyLen) return;
+
+	if (copyStart + copyLen < BASELINE_INFLATE_WINDOW_SIZE) {
+		Mem_Copy(state->Output, &state->Window[copyStart], copyLen);
+		state->Output += copyLen;
+	} else {
+		partLen = BASELINE_INFLATE_WINDOW_SIZE - copyStart;
+		Mem_Copy(state->Output, &state->Window[copyStart], partLen);
+		state->Output += partLen;
+		Mem_Copy(state->Output, state->Window, copyLen - partLen);
+		state->Output += (copyLen - partLen);
+	}
+}
+
+static void BaselineInflate_Process(struct BaselineInflateState* state) {
+	uint32_t len, dist, nlen;
+	uint32_t i, bits;
+	uint32_t blockHeader;
+
+	/* len/dist table variables */
+	uint32_t distIdx, lenIdx;
+	int lit;
+	/* code lens table variables */
+	uint32_t count, repeatCount;
+	uint8_t  repeatValue;
+	/* window variables */
+	uint32_t startIdx, curIdx;
+	uint32_t copyLen, windowCopyLen;
+
+	for (;;) {
+		switch (state->State) {
+		case BASELINE_INFLATE_STATE_HEADER: {
+			BaselineInflate_EnsureBits(state, 3);
+			blockHeader      = BaselineInflate_ReadBits(state, 3);
+			state->LastBlock = blockHeader & 1;
+
+			switch (blockHeader >> 1) {
+			case 0: { /* Uncompressed block */
+				BaselineInflate_AlignBits(state);
+				state->State = BASELINE_INFLATE_STATE_UNCOMPRESSED_HEADER;
+			} break;
+
+			case 1: { /* Fixed/static huffman compressed */
+				BaselineHuffman_Build(&state->Table.Lits, fixed_lits,  BASELINE_INFLATE_MAX_LITS);
+				BaselineHuffman_Build(&state->TableDists, fixed_dists, BASELINE_INFLATE_MAX_DISTS);
+				state->State = BaselineInflate_NextCompressState(state);
+			} break;
+
+			case 2: { /* Dynamic huffman compressed */
+				state->State = BASELINE_INFLATE_STATE_DYNAMIC_HEADER;
+			} break;
+
+			case 3: {
+				Logger_Abort("DEFLATE - Invalid block type");
+			} break;
+
+			}
+			break;
+		}
+
+		case BASELINE_INFLATE_STATE_UNCOMPRESSED_HEADER: {
+			BaselineInflate_EnsureBits(state, 32);
+			len  = BaselineInflate_ReadBits(state, 16);
+			nlen = BaselineInflate_ReadBits(state, 16);
+
+			if (len != (nlen ^ 0xFFFFUL)) {
+				Logger_Abort("DEFLATE - Uncompressed block LEN check failed");
+			}
+			state->Index = len; /* Reuse for 'uncompressed length' */
+			state->State = BASELINE_INFLATE_STATE_UNCOMPRESSED_DATA;
+		}
+
+		case BASELINE_INFLATE_STATE_UNCOMPRESSED_DATA: {
+			/* read bits left in bit buffer (slow way) */
+			while (state->NumBits && state->AvailOut && state->Index) {
+				*state->Output = BaselineInflate_ReadBits(state, 8);
+				state->Window[state->WindowIndex] = *state->Output;
+
+				state->WindowIndex = (state->WindowIndex + 1) & BASELINE_INFLATE_WINDOW_MASK;
+				state->Output++; state->AvailOut--;	state->Index--;
+			}
+			if (!state->AvailIn || !state->AvailOut) return;
+
+			copyLen = min(state->AvailIn, state->AvailOut);
+			copyLen = min(copyLen, state->Index);
+			if (copyLen > 0) {
+				Mem_Copy(state->Output, state->NextIn, copyLen);
+				windowCopyLen = BASELINE_INFLATE_WINDOW_SIZE - state->WindowIndex;
+				windowCopyLen = min(windowCopyLen, copyLen);
+
+				Mem_Copy(&state->Window[state->WindowIndex], state->Output, windowCopyLen);
+				/* Wrap around remainder of copy to start from beginning of window */
+				if (windowCopyLen < copyLen) {
+					Mem_Copy(state->Window, &state->Output[windowCopyLen], copyLen - windowCopyLen);
+				}
+
+				state->WindowIndex = (state->WindowIndex + copyLen) & BASELINE_INFLATE_WINDOW_MASK;
+				state->Output += copyLen; state->AvailOut -= copyLen; state->Index -= copyLen;
+				state->NextIn += copyLen; state->AvailIn  -= copyLen;		
+			}
+
+			if (!state->Index) { state->State = BaselineInflate_NextBlockState(state); }
+			break;
+		}
+
+		case BASELINE_INFLATE_STATE_DYNAMIC_HEADER: {
+			BaselineInflate_EnsureBits(state, 14);
+			state->NumLits   = 257 + BaselineInflate_ReadBits(state, 5);
+			state->NumDists    = 1 + BaselineInflate_ReadBits(state, 5);
+			state->NumCodeLens = 4 + BaselineInflate_ReadBits(state, 4);
+			state->Index = 0;
+			state->State = BASELINE_INFLATE_STATE_DYNAMIC_CODELENS;
+		}
+
+		case BASELINE_INFLATE_STATE_DYNAMIC_CODELENS: {
+			while (state->Index < state->NumCodeLens) {
+				BaselineInflate_EnsureBits(state, 3);
+				i = codelens_order[state->Index];
+				state->Buffer[i] = BaselineInflate_ReadBits(state, 3);
+				state->Index++;
+			}
+			for (i = state->NumCodeLens; i < BASELINE_INFLATE_MAX_CODELENS; i++) {
+				state->Buffer[codelens_order[i]] = 0;
+			}
+
+			state->Index = 0;
+			state->State = BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTS;
+			BaselineHuffman_Build(&state->Table.CodeLens, state->Buffer, BASELINE_INFLATE_MAX_CODELENS);
+		}
+
+		case BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTS: {
+			count = state->NumLits + state->NumDists;
+			while (state->Index < count) {
+				int bits = BaselineHuffman_Decode(state, &state->Table.CodeLens);
+				if (bits < 16) {
+					if (bits == -1) return;
+					state->Buffer[state->Index] = (uint8_t)bits;
+					state->Index++;
+				} else {
+					state->TmpCodeLens = bits;
+					state->State = BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTSREPEAT;
+					break;
+				}
+			}
+
+			if (state->Index == count) {
+				state->Index = 0;
+				state->State = BaselineInflate_NextCompressState(state);
+				BaselineHuffman_Build(&state->Table.Lits, state->Buffer, state->NumLits);
+				BaselineHuffman_Build(&state->TableDists, &state->Buffer[state->NumLits], state->NumDists);
+			}
+			break;
+		}
+
+		case BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTSREPEAT: {
+			switch (state->TmpCodeLens) {
+			case 16:
+				BaselineInflate_EnsureBits(state, 2);
+				repeatCount = BaselineInflate_ReadBits(state, 2);
+				if (!state->Index) Logger_Abort("DEFLATE - Tried to repeat invalid byte");
+				repeatCount += 3; repeatValue = state->Buffer[state->Index - 1];
+				break;
+
+			case 17:
+				BaselineInflate_EnsureBits(state, 3);
+				repeatCount = BaselineInflate_ReadBits(state, 3);
+				repeatCount += 3; repeatValue = 0;
+				break;
+
+			case 18:
+				BaselineInflate_EnsureBits(state, 7);
+				repeatCount = BaselineInflate_ReadBits(state, 7);
+				repeatCount += 11; repeatValue = 0;
+				break;
+			}
+
+			count = state->NumLits + state->NumDists;
+			if (state->Index + repeatCount > count) {
+				Logger_Abort("DEFLATE - Tried to repeat past end");
+			}
+
+			Mem_Set(&state->Buffer[state->Index], repeatValue, repeatCount);
+			state->Index += repeatCount;
+			state->State = BASELINE_INFLATE_STATE_DYNAMIC_LITSDISTS;
+			break;
+		}
+
+		case BASELINE_INFLATE_STATE_COMPRESSED_LIT: {
+			if (!state->AvailOut) return;
+			lit = BaselineHuffman_Decode(state, &state->Table.Lits);
+
+			if (lit < 256) {
+				if (lit == -1) return;
+				*state->Output = (uint8_t)lit;
+				state->Window[state->WindowIndex] = (uint8_t)lit;
+				state->Output++; state->AvailOut--;
+				state->WindowIndex = (state->WindowIndex + 1) & BASELINE_INFLATE_WINDOW_MASK;
+				break;
+			} else if (lit == 256) {
+				state->State = BaselineInflate_NextBlockState(state);
+				break;
+			} else {
+				state->TmpLit = lit - 257;
+				state->State  = BASELINE_INFLATE_STATE_COMPRESSED_LITREPEAT;
+			}
+		}
+
+		case BASELINE_INFLATE_STATE_COMPRESSED_LITREPEAT: {
+			lenIdx = state->TmpLit;
+			bits   = len_bits[lenIdx];
+			BaselineInflate_EnsureBits(state, bits);
+			state->TmpLit = len_base[lenIdx] + BaselineInflate_ReadBits(state, bits);
+			state->State  = BASELINE_INFLATE_STATE_COMPRESSED_DIST;
+		}
+
+		case BASELINE_INFLATE_STATE_COMPRESSED_DIST: {
+			state->TmpDist = BaselineHuffman_Decode(state, &state->TableDists);
+			if (state->TmpDist == -1) return;
+			state->State = BASELINE_INFLATE_STATE_COMPRESSED_DISTREPEAT;
+		}
+
+		case BASELINE_INFLATE_STATE_COMPRESSED_DISTREPEAT: {
+			distIdx = state->TmpDist;
+			bits    = dist_bits[distIdx];
+			BaselineInflate_EnsureBits(state, bits);
+			state->TmpDist = dist_base[distIdx] + BaselineInflate_ReadBits(state, bits);
+			state->State   = BASELINE_INFLATE_STATE_COMPRESSED_DATA;
+		}
+
+		case BASELINE_INFLATE_STATE_COMPRESSED_DATA: {
+			if (!state->AvailOut) return;
+			len = state->TmpLit; dist = state->TmpDist;
+			len = min(len, state->AvailOut);
+
+			/* TODO: Should we test outside of the loop, whether a masking will be required or not? */		
+			startIdx = (state->WindowIndex - dist) & BASELINE_INFLATE_WINDOW_MASK;
+			curIdx   = state->WindowIndex;
+			for (i = 0; i < len; i++) {
+				uint8_t value = state->Window[(startIdx + i) & BASELINE_INFLATE_WINDOW_MASK];
+				*state->Output = value;
+				state->Window[(curIdx + i) & BASELINE_INFLATE_WINDOW_MASK] = value;
+				state->Output++;
+			}
+
+			state->WindowIndex = (curIdx + len) & BASELINE_INFLATE_WINDOW_MASK;
+			state->TmpLit   -= len;
+			state->AvailOut -= len;
+			if (!state->TmpLit) { state->State = BaselineInflate_NextCompressState(state); }
+			break;
+		}
+
+		case BASELINE_INFLATE_STATE_FASTCOMPRESSED: {
+			BaselineInflate_InflateFast(state);
+			if (state->State == BASELINE_INFLATE_STATE_FASTCOMPRESSED) {
+				state->State = BaselineInflate_NextCompressState(state);
+			}
+			break;
+		}
+
+		case BASELINE_INFLATE_STATE_DONE:
+			return;
+		}
+	}
+}
+
+static ReturnCode BaselineInflate_StreamRead(struct Stream* stream, uint8_t* data, uint32_t count, uint32_t* modified) {
+	struct BaselineInflateState* state;
+	uint8_t* inputEnd;
+	uint32_t read, left;
+	uint32_t startAvailOut;
+	bool hasInput;
+	ReturnCode res;
+
+	*modified = 0;
+	state = stream->Meta.Inflate;
+	state->Output   = data;
+	state->AvailOut = count;
+
+	hasInput = true;
+	while (state->AvailOut > 0 && hasInput) {
+		if (state->State == BASELINE_INFLATE_STATE_DONE) break;
+
+		if (!state->AvailIn) {
+			/* Fully used up input buffer. Cycle back to start. */
+			inputEnd = state->Input + BASELINE_INFLATE_MAX_INPUT;
+			if (state->NextIn == inputEnd) state->NextIn = state->Input;
+
+			left = (uint32_t)(inputEnd - state->NextIn);
+			res  = state->Source->Read(state->Source, state->NextIn, left, &read);
+			if (res) return res;
+
+			/* Did we fail to read in more input data? Can't immediately return here, */
+			/* because there might be a few bits of data left in the bit buffer */
+			hasInput = read > 0;
+			state->AvailIn += read;
+		}
+		
+		/* Reading data reduces available out */
+		startAvailOut = state->AvailOut;
+		BaselineInflate_Process(state);
+		*modified += (startAvailOut - state->AvailOut);
+	}
+	return 0;
+}
+
+void BaselineInflate_MakeStream(struct Stream* stream, struct BaselineInflateState* state, struct Stream* underlying) {
+	Stream_Init(stream);
+	BaselineInflate_Init(state, underlying);
+	stream->Meta.Inflate = state;
+	stream->Read = BaselineInflate_StreamRead;
+}
@@ -0,0 +1,56 @@
+#ifndef CC_INFLATEBASELINE_H
+#define CC_INFLATEBASELINE_H
+#include "Core.h"
+/* Frozen copy of the DEFLATE decoder from before the inflate fast path was rewritten, */
+/* with the same structure but Baseline prefixed names. Only used by bench/BenchInflate.c, */
+/* so the current decoder can be compared against it. Do not change it to match Deflate.c. */
+struct Stream;
+
+#define BASELINE_INFLATE_MAX_INPUT 8192
+#define BASELINE_INFLATE_MAX_CODELENS 19
+#define BASELINE_INFLATE_MAX_LITS 288
+#define BASELINE_INFLATE_MAX_DISTS 32
+#define BASELINE_INFLATE_MAX_LITS_DISTS (BASELINE_INFLATE_MAX_LITS + BASELINE_INFLATE_MAX_DISTS)
+#define BASELINE_INFLATE_MAX_BITS 16
+#define BASELINE_INFLATE_FAST_BITS 9
+#define BASELINE_INFLATE_WINDOW_SIZE 0x8000UL
+#define BASELINE_INFLATE_WINDOW_MASK 0x7FFFUL
+
+struct BaselineHuffmanTable {
+	int16_t Fast[1 << BASELINE_INFLATE_FAST_BITS];      /* Fast lookup table for huffman codes */
+	uint16_t FirstCodewords[BASELINE_INFLATE_MAX_BITS]; /* Starting codeword for each bit length */
+	uint16_t EndCodewords[BASELINE_INFLATE_MAX_BITS];   /* (Last codeword + 1) for each bit length. 0 is ignored. */
+	uint16_t FirstOffsets[BASELINE_INFLATE_MAX_BITS];   /* Base offset into Values for codewords of each bit length. */
+	uint16_t Values[BASELINE_INFLATE_MAX_LITS];         /* Values/Symbols list */
+};
+
+struct BaselineInflateState {
+	uint8_t State;
+	bool LastBlock;   /* Whether the last DEFLATE block has been encounted in the stream */
+	uint32_t Bits;    /* Holds bits across byte boundaries */
+	uint32_t NumBits; /* Number of bits in Bits buffer */
+
+	uint8_t* NextIn;   /* Pointer within Input buffer to next byte that can be read */
+	uint32_t AvailIn;  /* Max number of bytes that can be read from Input buffer */
+	uint8_t* Output;   /* Pointer for output data */
+	uint32_t AvailOut; /* Max number of bytes that can be written to Output buffer */
+	struct Stream* Source;  /* Source for filling Input buffer */
+
+	uint32_t Index;                          /* General purpose index / counter */
+	uint32_t WindowIndex;                    /* Current index within window circular buffer */
+	uint32_t NumCodeLens, NumLits, NumDists; /* Temp counters */
+	uint32_t TmpCodeLens, TmpLit, TmpDist;   /* Temp huffman codes */
+
+	uint8_t Input[BASELINE_INFLATE_MAX_INPUT];       /* Buffer for input to DEFLATE */
+	uint8_t Buffer[BASELINE_INFLATE_MAX_LITS_DISTS]; /* General purpose temp array */
+	union {
+		struct BaselineHuffmanTable CodeLens;       /* Values represent codeword lengths of lits/dists codewords */
+		struct BaselineHuffmanTable Lits;           /* Values represent literal or lengths */
+	} Table; /* union to save on memory */
+	struct BaselineHuffmanTable TableDists;         /* Values represent distances back */
+	uint8_t Window[BASELINE_INFLATE_WINDOW_SIZE];    /* Holds circular buffer of recent output data, used for LZ77 */
+};
+
+/* Decompresses input data read from another stream using the baseline DEFLATE decoder. Read only stream. */
+void BaselineInflate_MakeStream(struct Stream* stream, struct BaselineInflateState* state, struct Stream* underlying);
+#endif